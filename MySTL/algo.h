@@ -430,7 +430,7 @@ RandomIterator upper_bound_dispatch(RandomIterator first, RandomIterator last, c
             ++first;
             len -= half + 1;
         }else {
-            half = len;
+            len = half;
         }
     }
     return first;
@@ -474,7 +474,7 @@ RandomIterator upper_bound_dispatch(RandomIterator first, RandomIterator last, c
             ++first;
             len -= half + 1;
         }else {
-            half = len;
+            len = half;
         }
     }
     return first;
@@ -802,7 +802,8 @@ void insertion_sort(RandomIterator first, RandomIterator last) {
 template <class RandomIterator>
 void unchecked_insertion_sort(RandomIterator first, RandomIterator last) {
     for(auto i = first ; i != last ; ++i) {
-        unchecked_linear_insert(i, *i);
+        auto value = *i;    // 先拷贝出来，移动元素时会覆盖*i
+        unchecked_linear_insert(i, value);
     }
 }
 
@@ -857,7 +858,7 @@ void intro_sort(RandomIterator first, RandomIterator last, Size depth_limit, Com
         }
         --depth_limit;
         // mid_of_three 找首 中 尾三个值的中间值，防止分割区间退化
-        auto mid = median(*(first), *(first + (last - first) / 2), *(last - 1)/* , comp */);
+        auto mid = median(*(first), *(first + (last - first) / 2), *(last - 1), comp);
         auto cut = unchecked_partition(first, last, mid, comp);     // 将[first, last)分割，左半部分 <= pivot，右半部分 > pivot，返回分割区间
         intro_sort(cut, last, depth_limit, comp);     // 递归分割右半部分
         last = cut; // 循环处理左半部分
@@ -901,7 +902,8 @@ void insertion_sort(RandomIterator first, RandomIterator last, Compare comp) {
 template <class RandomIterator, class Compare>
 void unchecked_insertion_sort(RandomIterator first, RandomIterator last, Compare comp) {
     for(auto i = first ; i != last ; ++i) {
-        unchecked_linear_insert(i, *i, comp);
+        auto value = *i;    // 先拷贝出来，移动元素时会覆盖*i
+        unchecked_linear_insert(i, value, comp);
     }
 }
 
@@ -928,6 +930,62 @@ void sort(RandomIterator first, RandomIterator last, Compare comp) {
     }
 }
 
+/*****************************************************************************************/
+// stable_sort
+// 稳定排序，相等的元素保持原来的相对次序。自底向上归并排序，在[first, last)和buffer之间来回归并，
+// buffer要指向至少last - first个已构造、可赋值的元素，排序后其中的内容无意义
+/*****************************************************************************************/
+// 把[first1, last1)和[first2, last2)移动归并到result，相等时先取第一段的元素
+template <class InputIterator1, class InputIterator2, class OutputIterator, class Compare>
+OutputIterator
+stable_merge_move(InputIterator1 first1, InputIterator1 last1,
+                  InputIterator2 first2, InputIterator2 last2,
+                  OutputIterator result, Compare        comp) {
+    while(first1 != last1 && first2 != last2) {
+        if(comp(*first2, *first1)) {
+            *result = mystl::move(*first2);
+            ++first2;
+        }else {
+            *result = mystl::move(*first1);
+            ++first1;
+        }
+        ++result;
+    }
+    for(; first1 != last1 ; ++first1, ++result) *result = mystl::move(*first1);
+    for(; first2 != last2 ; ++first2, ++result) *result = mystl::move(*first2);
+    return result;
+}
+
+// 把[first, last)中每两段长为step的有序区间归并到result
+template <class RandomIterator1, class RandomIterator2, class Distance, class Compare>
+void merge_sort_loop(RandomIterator1 first, RandomIterator1 last, RandomIterator2 result,
+                     Distance step, Compare comp) {
+    while(last - first > step) {
+        RandomIterator1 mid = first + step;
+        RandomIterator1 next = last - mid > step ? mid + step : last;
+        result = stable_merge_move(first, mid, mid, next, result, comp);
+        first = next;
+    }
+    stable_merge_move(first, last, last, last, result, comp);
+}
+
+template <class RandomIterator, class BufferIterator, class Compare>
+void stable_sort(RandomIterator first, RandomIterator last, BufferIterator buffer, Compare comp) {
+    typedef typename iterator_traits<RandomIterator>::difference_type Distance;
+    const Distance len = last - first;
+    const Distance chunk = 7;
+    // 先对每一小段插入排序，插入排序只在严格小于时移动，本身是稳定的
+    RandomIterator it = first;
+    for(; last - it > chunk ; it += chunk) insertion_sort(it, it + chunk, comp);
+    insertion_sort(it, last, comp);
+
+    // 每轮归并两次，结果总是回到[first, last)
+    for(Distance step = chunk ; step < len ; step *= 4) {
+        merge_sort_loop(first, last, buffer, step, comp);
+        merge_sort_loop(buffer, buffer + len, first, step * 2, comp);
+    }
+}
+
 
 } // end of namespace mystl
 
@@ -0,0 +1,143 @@
+#ifndef __ATOMIC_WAIT_H__
+#define __ATOMIC_WAIT_H__
+
+// 这个头文件定义了并发容器共用的一些底层工具：缓存行大小、自旋等待的pause，以及futex风格的等待/唤醒
+// linux下直接使用futex系统调用，其他平台退化为yield自旋
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace mystl {
+
+// 缓存行大小，生产者和消费者各自频繁修改的变量要放在不同的缓存行上，避免伪共享
+#ifndef MYSTL_CACHE_LINE_SIZE
+#define MYSTL_CACHE_LINE_SIZE 64
+#endif
+
+// 进入阻塞等待之前的自旋次数
+#ifndef MYSTL_SPIN_COUNT
+#define MYSTL_SPIN_COUNT 128
+#endif
+
+// 自旋时让出流水线，降低功耗以及对另一个超线程的干扰
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// 如果*addr == expected，则阻塞直到被唤醒；否则立即返回。允许虚假唤醒，调用者需要循环检查条件
+inline void futex_wait(std::atomic<uint32_t>* addr, uint32_t expected) {
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    while(addr->load(std::memory_order_acquire) == expected) {
+        std::this_thread::yield();
+    }
+#endif
+}
+
+// 唤醒所有等在addr上的线程
+inline void futex_wake_all(std::atomic<uint32_t>* addr) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+    (void)addr;
+#endif
+}
+
+// 一个等待点：条件不满足的线程在这里睡眠，修改条件的线程负责唤醒
+// 使用方法（Dekker式的握手，两边都需要seq_cst栅栏）：
+//   等待方 : seq = prepare_wait(); 再次检查条件; 条件仍不满足则 wait(seq);
+//   唤醒方 : 修改条件; notify();
+// sleeping_由唤醒方清零，所以一次睡眠最多只会引起一次系统调用，之后的notify只有一个栅栏和一次load
+class wait_point {
+private:
+    std::atomic<uint32_t> seq_;        // 每次唤醒都加一，futex等在这个字上
+    std::atomic<uint32_t> sleeping_;   // 有线程准备睡眠时置1
+
+public:
+    wait_point() : seq_(0), sleeping_(0) {}
+    wait_point(const wait_point&) = delete;
+    wait_point& operator=(const wait_point&) = delete;
+
+    uint32_t prepare_wait() {
+        uint32_t seq = seq_.load(std::memory_order_acquire);
+        sleeping_.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return seq;
+    }
+
+    // seq在prepare_wait之后被修改过则立即返回
+    void wait(uint32_t seq) {
+        futex_wait(&seq_, seq);
+    }
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(sleeping_.load(std::memory_order_relaxed) != 0) {
+            sleeping_.store(0, std::memory_order_relaxed);
+            seq_.fetch_add(1, std::memory_order_release);
+            futex_wake_all(&seq_);
+        }
+    }
+
+    // 阻塞直到cond()为真，先自旋一段时间再睡眠
+    template <class Predicate>
+    void wait_until(Predicate cond) {
+        for(int spin = 0 ; spin < MYSTL_SPIN_COUNT ; ++spin) {
+            if(cond()) return;
+            cpu_relax();
+        }
+        while(!cond()) {
+            uint32_t seq = prepare_wait();
+            if(!cond()) {
+                wait(seq);
+            }
+        }
+    }
+};
+
+// 很短的临界区用的自旋锁，只有一个字节，可以放进每个结点里
+// 先用relaxed的load等锁空闲再尝试exchange，避免在锁被占用时反复写缓存行
+class spin_lock {
+private:
+    std::atomic<bool> locked_;
+
+public:
+    spin_lock() : locked_(false) {}
+    spin_lock(const spin_lock&) = delete;
+    spin_lock& operator=(const spin_lock&) = delete;
+
+    void lock() {
+        for(int spin = 0 ; ; ++spin) {
+            if(!locked_.exchange(true, std::memory_order_acquire)) return;
+            while(locked_.load(std::memory_order_relaxed)) {
+                if(++spin < MYSTL_SPIN_COUNT) cpu_relax();
+                else std::this_thread::yield();
+            }
+        }
+    }
+    bool try_lock() {
+        return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+    }
+    void unlock() { locked_.store(false, std::memory_order_release); }
+};
+
+}
+
+#endif
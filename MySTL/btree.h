@@ -0,0 +1,837 @@
+#ifndef __BTREE_H__
+#define __BTREE_H__
+
+#include <initializer_list>
+#include <cstring>
+
+#include "allocator.h"
+#include "construct.h"
+#include "algobase.h"
+#include "functional.h"
+#include "exceptdef.h"
+#include "iterator.h"
+#include "util.h"
+
+// 这个文件定义了B树 btree，作为btree_set/btree_map的底层
+
+/*
+* rb_tree每个元素一个结点，三个指针加颜色是32字节的额外开销，查找时每下降一层都可能cache miss。
+* B树的结点很宽，默认叶子结点大约256字节，一个结点里连续存放很多个元素，树高只有log_B(n)，
+* 结点内用二分查找，同一个结点内的比较都在几条cache line里完成。
+*
+* 结构：
+*   每个结点存放count_个有序的元素，内部结点还有count_ + 1个孩子，孩子i中的元素都在元素i-1和元素i之间。
+*   结点记录父结点和自己在父结点中的下标position_，迭代器由 (结点, 结点内下标) 组成，可以向上回溯。
+*   end()是(最右叶子, count_)，空树时为(nullptr, 0)。
+*
+* 插入：
+*   总是插入到叶子。叶子满了就分裂成两个，中间的元素上移到父结点，父结点满了继续向上分裂，根分裂时树长高一层。
+*   插在结点最后（顺序插入）时，分裂让左边保持满的，插在最前面时让右边保持满的，这样有序插入时结点都是满的。
+* 删除：
+*   内部结点的元素用后继（右子树最左叶子的第一个元素）顶替，转化为在叶子中删除。
+*   结点不足半满时，先向左右兄弟借一个元素，兄弟也只有半满就和兄弟合并，父结点少一个元素，可能继续向上调整。
+*
+* 插入删除会让被修改的结点上的迭代器失效，insert和erase会返回新的有效迭代器。
+* 结点内移动元素要求value_type的移动构造和移动赋值不抛出异常。
+*/
+
+namespace mystl {
+
+// 叶子结点的大小
+#ifndef MYSTL_BTREE_NODE_BYTES
+#define MYSTL_BTREE_NODE_BYTES 256
+#endif
+
+// 根据T的大小决定一个结点放多少个元素，至少3个
+template <class T>
+struct btree_node_size {
+    static constexpr size_t bytes = MYSTL_BTREE_NODE_BYTES - 2 * sizeof(void*);
+    static constexpr size_t value = bytes / sizeof(T) < 3 ? 3 : bytes / sizeof(T);
+};
+
+// 叶子结点，内部结点在它后面再加上孩子数组
+template <class T, size_t N>
+struct btree_node {
+    btree_node*     parent_;
+    unsigned short  position_;  // 在父结点中是第几个孩子
+    unsigned short  count_;     // 结点内元素个数
+    bool            leaf_;
+    alignas(T) unsigned char data_[N * sizeof(T)];  // 未初始化的内存
+
+    T* data() { return reinterpret_cast<T*>(data_); }
+    T& value(size_t i) { return data()[i]; }
+};
+
+template <class T, size_t N>
+struct btree_internal_node : public btree_node<T, N> {
+    btree_node<T, N>* children_[N + 1];
+};
+
+template <class T, size_t N>
+inline btree_node<T, N>*& btree_child(btree_node<T, N>* x, size_t i) {
+    return static_cast<btree_internal_node<T, N>*>(x)->children_[i];
+}
+
+// 迭代器的设计
+template <class T, size_t N, class Ref, class Ptr>
+struct btree_iterator {
+    typedef btree_iterator<T, N, T&, T*> iterator;
+    typedef btree_iterator<T, N, const T&, const T*> const_iterator;
+    typedef btree_iterator self;
+
+    typedef bidirectional_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef Ptr pointer;
+    typedef Ref reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    typedef btree_node<T, N>* node_ptr;
+
+    node_ptr node_;     // 所在结点
+    int position_;      // 结点内的下标
+
+    btree_iterator() : node_(nullptr), position_(0) {}
+    btree_iterator(node_ptr x, int i) : node_(x), position_(i) {}
+    btree_iterator(const iterator& rhs) : node_(rhs.node_), position_(rhs.position_) {}
+
+    reference operator*() const { return node_->value(position_); }
+    pointer operator->() const { return &(operator*()); }
+
+    self& operator++() {
+        increment();
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp = *this;
+        increment();
+        return tmp;
+    }
+
+    self& operator--() {
+        decrement();
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp = *this;
+        decrement();
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const { return node_ == rhs.node_ && position_ == rhs.position_; }
+    bool operator!=(const self& rhs) const { return !(*this == rhs); }
+
+    void increment() {
+        if(!node_->leaf_) {
+            // 右边孩子的最左叶子
+            node_ = btree_child(node_, position_ + 1);
+            while(!node_->leaf_) node_ = btree_child(node_, 0);
+            position_ = 0;
+            return;
+        }
+        if(++position_ < node_->count_) return;
+        // 叶子走完了，向上找第一个还有元素的祖先；一直走到根都没有，说明原来就是最后一个元素，停在end()
+        node_ptr x = node_;
+        int pos = position_;
+        while(pos == x->count_ && x->parent_ != nullptr) {
+            pos = x->position_;
+            x = x->parent_;
+        }
+        if(pos < x->count_) {
+            node_ = x;
+            position_ = pos;
+        }
+    }
+
+    void decrement() {
+        if(!node_->leaf_) {
+            // 左边孩子的最右叶子
+            node_ = btree_child(node_, position_);
+            while(!node_->leaf_) node_ = btree_child(node_, node_->count_);
+            position_ = node_->count_ - 1;
+            return;
+        }
+        if(position_ > 0) {
+            --position_;
+            return;
+        }
+        while(position_ == 0 && node_->parent_ != nullptr) {
+            position_ = node_->position_;
+            node_ = node_->parent_;
+        }
+        --position_;
+    }
+};
+
+// 模板类 btree，参数和rb_tree一样，KeyOfValue从元素中取出键值
+template <class Key, class Value, class Compare = mystl::less<Key>, class KeyOfValue = mystl::identity<Value>>
+class btree {
+public:
+    static constexpr size_t N = btree_node_size<Value>::value;
+    static constexpr size_t kMinValues = N / 2;     // 除根以外，每个结点至少的元素个数
+
+    typedef Key         key_type;
+    typedef Value       value_type;
+    typedef Compare     key_compare;
+
+    typedef mystl::allocator<Value> allocator_type;
+    typedef btree_node<Value, N>            leaf_node;
+    typedef btree_internal_node<Value, N>   internal_node;
+    typedef mystl::allocator<leaf_node>     leaf_allocator;
+    typedef mystl::allocator<internal_node> internal_allocator;
+    typedef leaf_node*  node_ptr;
+
+    typedef Value*          pointer;
+    typedef const Value*    const_pointer;
+    typedef Value&          reference;
+    typedef const Value&    const_reference;
+    typedef size_t          size_type;
+    typedef ptrdiff_t       difference_type;
+
+    typedef btree_iterator<Value, N, Value&, Value*>             iterator;
+    typedef btree_iterator<Value, N, const Value&, const Value*> const_iterator;
+    typedef mystl::reverse_iterator<iterator>       reverse_iterator;
+    typedef mystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    allocator_type get_allocator() const { return allocator_type(); }
+    key_compare    key_comp()      const { return key_comp_; }
+
+private:
+    node_ptr    root_;
+    node_ptr    leftmost_;      // 最左叶子，begin()
+    node_ptr    rightmost_;     // 最右叶子，end()
+    size_type   size_;
+    key_compare key_comp_;
+
+public:
+    btree() : root_(nullptr), leftmost_(nullptr), rightmost_(nullptr), size_(0), key_comp_() {}
+
+    btree(const btree& rhs) : btree() {
+        key_comp_ = rhs.key_comp_;
+        if(rhs.root_ != nullptr) {
+            root_ = copy_from(rhs.root_, nullptr);
+            size_ = rhs.size_;
+            update_extremes();
+        }
+    }
+
+    btree(btree&& rhs) noexcept : btree() {
+        swap(rhs);
+    }
+
+    btree& operator=(const btree& rhs) {
+        if(this != &rhs) {
+            btree tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    btree& operator=(btree&& rhs) noexcept {
+        if(this != &rhs) {
+            clear();
+            swap(rhs);
+        }
+        return *this;
+    }
+
+    ~btree() { clear(); }
+
+public:
+    // 迭代器相关操作
+    iterator begin() { return leftmost_ ? iterator(leftmost_, 0) : end(); }
+    const_iterator begin() const { return leftmost_ ? const_iterator(leftmost_, 0) : end(); }
+    iterator end() { return rightmost_ ? iterator(rightmost_, rightmost_->count_) : iterator(); }
+    const_iterator end() const { return rightmost_ ? const_iterator(rightmost_, rightmost_->count_) : const_iterator(); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // 容量相关操作
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type max_size() const { return static_cast<size_type>(-1) / sizeof(value_type); }
+
+    // 插入，和rb_tree一样分为unique和equal两种，equal时相等元素保持插入顺序
+    mystl::pair<iterator, bool> insert_unique(const value_type& value) {
+        return insert_unique_aux(value_type(value));
+    }
+    mystl::pair<iterator, bool> insert_unique(value_type&& value) {
+        return insert_unique_aux(mystl::move(value));
+    }
+    iterator insert_equal(const value_type& value) {
+        return insert_equal_aux(value_type(value));
+    }
+    iterator insert_equal(value_type&& value) {
+        return insert_equal_aux(mystl::move(value));
+    }
+
+    template <class ...Args>
+    mystl::pair<iterator, bool> emplace_unique(Args&& ...args) {
+        return insert_unique_aux(value_type(mystl::forward<Args>(args)...));
+    }
+    template <class ...Args>
+    iterator emplace_equal(Args&& ...args) {
+        return insert_equal_aux(value_type(mystl::forward<Args>(args)...));
+    }
+
+    // hint只在begin()和end()时使用，有序插入可以不用从根查找
+    iterator insert_unique(const_iterator hint, const value_type& value);
+    iterator insert_equal(const_iterator hint, const value_type& value);
+
+    template <class Iterator>
+    void insert_unique(Iterator first, Iterator last) {
+        for(; first != last ; ++first) insert_unique(end(), *first);
+    }
+
+    template <class Iterator>
+    void insert_equal(Iterator first, Iterator last) {
+        for(; first != last ; ++first) insert_equal(end(), *first);
+    }
+
+    // 删除
+    iterator erase(const_iterator pos);
+    size_type erase(const key_type& key);
+    iterator erase(const_iterator first, const_iterator last);
+
+    void clear() {
+        if(root_ != nullptr) {
+            clear_subtree(root_);
+            root_ = leftmost_ = rightmost_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    // 查找相关操作
+    iterator find(const key_type& key) {
+        iterator it = lower_bound(key);
+        return (it == end() || key_comp_(key, KeyOfValue()(*it))) ? end() : it;
+    }
+    const_iterator find(const key_type& key) const {
+        const_iterator it = lower_bound(key);
+        return (it == end() || key_comp_(key, KeyOfValue()(*it))) ? end() : it;
+    }
+
+    size_type count(const key_type& key) const {
+        auto p = equal_range(key);
+        return mystl::distance(p.first, p.second);
+    }
+
+    iterator lower_bound(const key_type& key) { return bound_aux(key, false); }
+    const_iterator lower_bound(const key_type& key) const { return const_cast<btree*>(this)->bound_aux(key, false); }
+    iterator upper_bound(const key_type& key) { return bound_aux(key, true); }
+    const_iterator upper_bound(const key_type& key) const { return const_cast<btree*>(this)->bound_aux(key, true); }
+
+    mystl::pair<iterator, iterator> equal_range(const key_type& key) {
+        return mystl::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+    }
+    mystl::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+        return mystl::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    void swap(btree& rhs) noexcept {
+        mystl::swap(root_, rhs.root_);
+        mystl::swap(leftmost_, rhs.leftmost_);
+        mystl::swap(rightmost_, rhs.rightmost_);
+        mystl::swap(size_, rhs.size_);
+        mystl::swap(key_comp_, rhs.key_comp_);
+    }
+
+    // 树高，叶子为1
+    size_type height() const {
+        size_type h = 0;
+        for(node_ptr x = root_ ; x != nullptr ; x = x->leaf_ ? nullptr : btree_child(x, 0)) ++h;
+        return h;
+    }
+
+    // 结点占用的字节数
+    size_type bytes_used() const { return root_ ? bytes_used(root_) : 0; }
+
+private:
+    // 结点相关
+    static node_ptr new_node(bool leaf) {
+        node_ptr x = leaf ? leaf_allocator::allocate(1)
+                          : static_cast<node_ptr>(internal_allocator::allocate(1));
+        x->parent_ = nullptr;
+        x->position_ = 0;
+        x->count_ = 0;
+        x->leaf_ = leaf;
+        return x;
+    }
+
+    static void delete_node(node_ptr x) {
+        if(x->leaf_) leaf_allocator::deallocate(x);
+        else internal_allocator::deallocate(static_cast<internal_node*>(x));
+    }
+
+    static void set_child(node_ptr x, size_t i, node_ptr c) {
+        btree_child(x, i) = c;
+        c->parent_ = x;
+        c->position_ = static_cast<unsigned short>(i);
+    }
+
+    const key_type& key_of(node_ptr x, size_t i) const { return KeyOfValue()(x->value(i)); }
+
+    // 结点内第一个不小于（upper为true时大于）key的下标
+    int search_in_node(node_ptr x, const key_type& key, bool upper) const {
+        int lo = 0, hi = x->count_;
+        while(lo < hi) {
+            int mid = (lo + hi) >> 1;
+            bool go_right = upper ? !key_comp_(key, key_of(x, mid)) : key_comp_(key_of(x, mid), key);
+            if(go_right) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // 结点内元素移动，shift_right把[i, count_)右移一位，空出位置i；
+    // shift_left把(i, count_)左移一位覆盖位置i，最后一个位置由调用者析构
+    static void shift_right(node_ptr x, size_t i);
+    static void shift_left(node_ptr x, size_t i);
+
+    void update_extremes() {
+        if(root_ == nullptr) {
+            leftmost_ = rightmost_ = nullptr;
+            return;
+        }
+        leftmost_ = root_;
+        while(!leftmost_->leaf_) leftmost_ = btree_child(leftmost_, 0);
+        rightmost_ = root_;
+        while(!rightmost_->leaf_) rightmost_ = btree_child(rightmost_, rightmost_->count_);
+    }
+
+    iterator bound_aux(const key_type& key, bool upper);
+
+    mystl::pair<iterator, bool> insert_unique_aux(value_type&& value);
+    iterator insert_equal_aux(value_type&& value);
+
+    // 在叶子x的位置i插入，满了先分裂
+    iterator insert_leaf(node_ptr x, int i, value_type&& value);
+
+    // 分裂满结点x，i为将要插入的位置，返回插入位置在分裂后的结点和下标
+    mystl::pair<node_ptr, int> split(node_ptr x, int i);
+
+    // 删除后的调整，track为被删除元素的下一个元素，调整时跟着移动
+    void rebalance_after_erase(node_ptr x, iterator& track);
+    void rotate_from_left(node_ptr x, iterator& track);
+    void rotate_from_right(node_ptr x, iterator& track);
+    void merge_with_right(node_ptr left, iterator& track);
+
+    node_ptr copy_from(node_ptr x, node_ptr parent);
+    void clear_subtree(node_ptr x);
+    size_type bytes_used(node_ptr x) const {
+        if(x->leaf_) return sizeof(leaf_node);
+        size_type n = sizeof(internal_node);
+        for(size_t i = 0 ; i <= x->count_ ; ++i) n += bytes_used(btree_child(x, i));
+        return n;
+    }
+};
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+void btree<Key, Value, Compare, KeyOfValue>::shift_right(node_ptr x, size_t i) {
+    value_type* p = x->data();
+    if(std::is_trivially_copyable<value_type>::value) {
+        std::memmove(static_cast<void*>(p + i + 1), static_cast<const void*>(p + i), (x->count_ - i) * sizeof(value_type));
+        return;
+    }
+    for(size_t j = x->count_ ; j > i ; --j) {
+        mystl::construct(p + j, mystl::move(p[j - 1]));
+        mystl::destroy(p + j - 1);
+    }
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+void btree<Key, Value, Compare, KeyOfValue>::shift_left(node_ptr x, size_t i) {
+    value_type* p = x->data();
+    if(std::is_trivially_copyable<value_type>::value) {
+        std::memmove(static_cast<void*>(p + i), static_cast<const void*>(p + i + 1), (x->count_ - i - 1) * sizeof(value_type));
+        return;
+    }
+    for(size_t j = i ; j + 1 < x->count_ ; ++j) {
+        p[j] = mystl::move(p[j + 1]);
+    }
+}
+
+// 同时记录沿途最后一个满足条件的元素，叶子中没有时它就是答案
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::iterator
+btree<Key, Value, Compare, KeyOfValue>::bound_aux(const key_type& key, bool upper) {
+    iterator result = end();
+    node_ptr x = root_;
+    while(x != nullptr) {
+        int i = search_in_node(x, key, upper);
+        if(i < x->count_) result = iterator(x, i);
+        x = x->leaf_ ? nullptr : btree_child(x, i);
+    }
+    return result;
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+mystl::pair<typename btree<Key, Value, Compare, KeyOfValue>::iterator, bool>
+btree<Key, Value, Compare, KeyOfValue>::insert_unique_aux(value_type&& value) {
+    if(root_ == nullptr) {
+        root_ = new_node(true);
+        update_extremes();
+        return mystl::pair<iterator, bool>(insert_leaf(root_, 0, mystl::move(value)), true);
+    }
+    const key_type& key = KeyOfValue()(value);
+    node_ptr x = root_;
+    while(true) {
+        int i = search_in_node(x, key, false);
+        if(i < x->count_ && !key_comp_(key, key_of(x, i))) {
+            return mystl::pair<iterator, bool>(iterator(x, i), false);     // 已经存在
+        }
+        if(x->leaf_) {
+            return mystl::pair<iterator, bool>(insert_leaf(x, i, mystl::move(value)), true);
+        }
+        x = btree_child(x, i);
+    }
+}
+
+// 每一层都找第一个大于key的位置，新元素排在所有相等元素后面
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::iterator
+btree<Key, Value, Compare, KeyOfValue>::insert_equal_aux(value_type&& value) {
+    if(root_ == nullptr) {
+        root_ = new_node(true);
+        update_extremes();
+        return insert_leaf(root_, 0, mystl::move(value));
+    }
+    const key_type& key = KeyOfValue()(value);
+    node_ptr x = root_;
+    while(true) {
+        int i = search_in_node(x, key, true);
+        if(x->leaf_) return insert_leaf(x, i, mystl::move(value));
+        x = btree_child(x, i);
+    }
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::iterator
+btree<Key, Value, Compare, KeyOfValue>::insert_unique(const_iterator hint, const value_type& value) {
+    if(size_ > 0) {
+        const key_type& key = KeyOfValue()(value);
+        if(hint == end() && key_comp_(key_of(rightmost_, rightmost_->count_ - 1), key)) {
+            return insert_leaf(rightmost_, rightmost_->count_, value_type(value));
+        }
+        if(hint == begin() && key_comp_(key, key_of(leftmost_, 0))) {
+            return insert_leaf(leftmost_, 0, value_type(value));
+        }
+    }
+    return insert_unique(value).first;
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::iterator
+btree<Key, Value, Compare, KeyOfValue>::insert_equal(const_iterator hint, const value_type& value) {
+    if(size_ > 0) {
+        const key_type& key = KeyOfValue()(value);
+        if(hint == end() && !key_comp_(key, key_of(rightmost_, rightmost_->count_ - 1))) {
+            return insert_leaf(rightmost_, rightmost_->count_, value_type(value));
+        }
+        if(hint == begin() && key_comp_(key, key_of(leftmost_, 0))) {
+            return insert_leaf(leftmost_, 0, value_type(value));
+        }
+    }
+    return insert_equal(value);
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::iterator
+btree<Key, Value, Compare, KeyOfValue>::insert_leaf(node_ptr x, int i, value_type&& value) {
+    bool split_happened = false;
+    if(x->count_ == N) {
+        mystl::pair<node_ptr, int> pos = split(x, i);
+        x = pos.first;
+        i = pos.second;
+        split_happened = true;
+    }
+    shift_right(x, i);
+    mystl::construct(x->data() + i, mystl::move(value));
+    ++x->count_;
+    ++size_;
+    if(split_happened) update_extremes();
+    return iterator(x, i);
+}
+
+// 先保证父结点有空位（父结点满了就先分裂父结点），再把x的后半部分移到新的右兄弟，中间的元素上移到父结点
+template <class Key, class Value, class Compare, class KeyOfValue>
+mystl::pair<typename btree<Key, Value, Compare, KeyOfValue>::node_ptr, int>
+btree<Key, Value, Compare, KeyOfValue>::split(node_ptr x, int i) {
+    node_ptr parent = x->parent_;
+    if(parent == nullptr) {
+        // 根分裂，树长高一层
+        parent = new_node(false);
+        set_child(parent, 0, x);
+        root_ = parent;
+    }else if(parent->count_ == N) {
+        split(parent, x->position_);
+        parent = x->parent_;
+    }
+    node_ptr right = new_node(x->leaf_);
+
+    // 左边保留的元素个数
+    const int left_count = (i == static_cast<int>(N)) ? N - 1 : (i == 0 ? 0 : N / 2);
+    const int right_count = N - left_count - 1;
+    value_type* p = x->data();
+    for(int j = 0 ; j < right_count ; ++j) {
+        mystl::construct(right->data() + j, mystl::move(p[left_count + 1 + j]));
+        mystl::destroy(p + left_count + 1 + j);
+    }
+    if(!x->leaf_) {
+        for(int j = 0 ; j <= right_count ; ++j) {
+            set_child(right, j, btree_child(x, left_count + 1 + j));
+        }
+    }
+    right->count_ = right_count;
+
+    // 中间的元素放到父结点
+    const int pos = x->position_;
+    shift_right(parent, pos);
+    mystl::construct(parent->data() + pos, mystl::move(p[left_count]));
+    mystl::destroy(p + left_count);
+    for(int j = parent->count_ ; j > pos ; --j) {
+        set_child(parent, j + 1, btree_child(parent, j));
+    }
+    set_child(parent, pos + 1, right);
+    ++parent->count_;
+    x->count_ = left_count;
+
+    if(i <= left_count) return mystl::pair<node_ptr, int>(x, i);
+    return mystl::pair<node_ptr, int>(right, i - left_count - 1);
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::iterator
+btree<Key, Value, Compare, KeyOfValue>::erase(const_iterator pos) {
+    MYSTL_DEBUG(pos != end());
+    node_ptr x = pos.node_;
+    int i = pos.position_;
+    iterator track;
+    if(!x->leaf_) {
+        // 用后继顶替，转为删除后继所在叶子的第一个元素
+        node_ptr leaf = btree_child(x, i + 1);
+        while(!leaf->leaf_) leaf = btree_child(leaf, 0);
+        x->value(i) = mystl::move(leaf->value(0));
+        track = iterator(x, i);
+        x = leaf;
+        i = 0;
+    }else {
+        track = iterator(x, i);
+    }
+    shift_left(x, i);
+    mystl::destroy(x->data() + x->count_ - 1);
+    --x->count_;
+    --size_;
+
+    if(track.node_ == x && i == x->count_) {
+        // 删除的是叶子的最后一个元素，下一个元素在祖先中
+        node_ptr y = x;
+        int k = i;
+        while(k == y->count_ && y->parent_ != nullptr) {
+            k = y->position_;
+            y = y->parent_;
+        }
+        track = (k < y->count_) ? iterator(y, k) : iterator();
+    }
+
+    rebalance_after_erase(x, track);
+    update_extremes();
+    return track.node_ == nullptr ? end() : track;
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::size_type
+btree<Key, Value, Compare, KeyOfValue>::erase(const key_type& key) {
+    size_type n = 0;
+    iterator it = lower_bound(key);
+    while(it != end() && !key_comp_(key, KeyOfValue()(*it))) {
+        it = erase(it);
+        ++n;
+    }
+    return n;
+}
+
+// 删除会移动元素，last可能失效，先数出个数
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::iterator
+btree<Key, Value, Compare, KeyOfValue>::erase(const_iterator first, const_iterator last) {
+    if(first == begin() && last == end()) {
+        clear();
+        return end();
+    }
+    size_type n = mystl::distance(first, last);
+    iterator it(first.node_, first.position_);
+    while(n--) it = erase(it);
+    return it;
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+void btree<Key, Value, Compare, KeyOfValue>::rebalance_after_erase(node_ptr x, iterator& track) {
+    while(x != root_ && x->count_ < kMinValues) {
+        node_ptr parent = x->parent_;
+        const int pos = x->position_;
+        node_ptr left = pos > 0 ? btree_child(parent, pos - 1) : nullptr;
+        node_ptr right = pos < parent->count_ ? btree_child(parent, pos + 1) : nullptr;
+        if(left != nullptr && left->count_ > kMinValues) {
+            rotate_from_left(x, track);
+            return;
+        }
+        if(right != nullptr && right->count_ > kMinValues) {
+            rotate_from_right(x, track);
+            return;
+        }
+        if(left != nullptr) merge_with_right(left, track);
+        else merge_with_right(x, track);
+        x = parent;
+    }
+    if(x == root_ && x->count_ == 0) {
+        // 根空了，树变矮一层，或者整棵树空了
+        if(track.node_ == root_) track = iterator();
+        if(x->leaf_) {
+            root_ = nullptr;
+        }else {
+            root_ = btree_child(x, 0);
+            root_->parent_ = nullptr;
+            root_->position_ = 0;
+        }
+        delete_node(x);
+    }
+}
+
+// 左兄弟的最后一个元素上移到父结点，父结点的分隔元素下移到x的最前面
+template <class Key, class Value, class Compare, class KeyOfValue>
+void btree<Key, Value, Compare, KeyOfValue>::rotate_from_left(node_ptr x, iterator& track) {
+    node_ptr parent = x->parent_;
+    const int sep = x->position_ - 1;
+    node_ptr left = btree_child(parent, sep);
+
+    if(track.node_ == x) ++track.position_;
+    else if(track.node_ == parent && track.position_ == sep) track = iterator(x, 0);
+    else if(track.node_ == left && track.position_ == left->count_ - 1) track = iterator(parent, sep);
+
+    shift_right(x, 0);
+    mystl::construct(x->data(), mystl::move(parent->value(sep)));
+    parent->value(sep) = mystl::move(left->value(left->count_ - 1));
+    mystl::destroy(left->data() + left->count_ - 1);
+    if(!x->leaf_) {
+        for(int j = x->count_ ; j >= 0 ; --j) set_child(x, j + 1, btree_child(x, j));
+        set_child(x, 0, btree_child(left, left->count_));
+    }
+    --left->count_;
+    ++x->count_;
+}
+
+// 父结点的分隔元素下移到x的最后，右兄弟的第一个元素上移到父结点
+template <class Key, class Value, class Compare, class KeyOfValue>
+void btree<Key, Value, Compare, KeyOfValue>::rotate_from_right(node_ptr x, iterator& track) {
+    node_ptr parent = x->parent_;
+    const int sep = x->position_;
+    node_ptr right = btree_child(parent, sep + 1);
+
+    if(track.node_ == parent && track.position_ == sep) track = iterator(x, x->count_);
+    else if(track.node_ == right) {
+        if(track.position_ == 0) track = iterator(parent, sep);
+        else --track.position_;
+    }
+
+    mystl::construct(x->data() + x->count_, mystl::move(parent->value(sep)));
+    parent->value(sep) = mystl::move(right->value(0));
+    if(!x->leaf_) {
+        set_child(x, x->count_ + 1, btree_child(right, 0));
+        for(int j = 0 ; j < right->count_ ; ++j) set_child(right, j, btree_child(right, j + 1));
+    }
+    shift_left(right, 0);
+    mystl::destroy(right->data() + right->count_ - 1);
+    --right->count_;
+    ++x->count_;
+}
+
+// 把left、父结点中的分隔元素和left的右兄弟合并到left，释放右兄弟
+template <class Key, class Value, class Compare, class KeyOfValue>
+void btree<Key, Value, Compare, KeyOfValue>::merge_with_right(node_ptr left, iterator& track) {
+    node_ptr parent = left->parent_;
+    const int sep = left->position_;
+    node_ptr right = btree_child(parent, sep + 1);
+    const int old = left->count_;
+
+    if(track.node_ == parent) {
+        if(track.position_ == sep) track = iterator(left, old);
+        else if(track.position_ > sep) --track.position_;
+    }else if(track.node_ == right) {
+        track = iterator(left, old + 1 + track.position_);
+    }
+
+    mystl::construct(left->data() + old, mystl::move(parent->value(sep)));
+    for(int j = 0 ; j < right->count_ ; ++j) {
+        mystl::construct(left->data() + old + 1 + j, mystl::move(right->value(j)));
+        mystl::destroy(right->data() + j);
+    }
+    if(!left->leaf_) {
+        for(int j = 0 ; j <= right->count_ ; ++j) set_child(left, old + 1 + j, btree_child(right, j));
+    }
+    left->count_ = old + 1 + right->count_;
+
+    // 父结点去掉分隔元素和右孩子
+    shift_left(parent, sep);
+    mystl::destroy(parent->data() + parent->count_ - 1);
+    for(int j = sep + 1 ; j < parent->count_ ; ++j) set_child(parent, j, btree_child(parent, j + 1));
+    --parent->count_;
+    delete_node(right);
+}
+
+// 递归复制，树高只有log_B(n)层
+template <class Key, class Value, class Compare, class KeyOfValue>
+typename btree<Key, Value, Compare, KeyOfValue>::node_ptr
+btree<Key, Value, Compare, KeyOfValue>::copy_from(node_ptr x, node_ptr parent) {
+    node_ptr y = new_node(x->leaf_);
+    y->parent_ = parent;
+    y->position_ = x->position_;
+    // 孩子指针先置空，复制元素时抛出异常，clear_subtree也不会去释放没建好的孩子
+    if(!x->leaf_) {
+        for(int i = 0 ; i <= x->count_ ; ++i) btree_child(y, i) = nullptr;
+    }
+    try {
+        for(int i = 0 ; i < x->count_ ; ++i) {
+            mystl::construct(y->data() + i, x->value(i));
+            ++y->count_;
+        }
+        if(!x->leaf_) {
+            for(int i = 0 ; i <= x->count_ ; ++i) btree_child(y, i) = copy_from(btree_child(x, i), y);
+        }
+    }catch(...) {
+        clear_subtree(y);
+        throw;
+    }
+    return y;
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+void btree<Key, Value, Compare, KeyOfValue>::clear_subtree(node_ptr x) {
+    if(!x->leaf_) {
+        for(int i = 0 ; i <= x->count_ ; ++i) {
+            if(btree_child(x, i) != nullptr) clear_subtree(btree_child(x, i));
+        }
+    }
+    mystl::destroy(x->data(), x->data() + x->count_);
+    delete_node(x);
+}
+
+// 重载比较操作符
+template <class Key, class Value, class Compare, class KeyOfValue>
+bool operator==(const btree<Key, Value, Compare, KeyOfValue>& lhs, const btree<Key, Value, Compare, KeyOfValue>& rhs) {
+    return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class Key, class Value, class Compare, class KeyOfValue>
+bool operator<(const btree<Key, Value, Compare, KeyOfValue>& lhs, const btree<Key, Value, Compare, KeyOfValue>& rhs) {
+    return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+}
+
+#endif
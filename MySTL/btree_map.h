@@ -0,0 +1,432 @@
+#ifndef __BTREE_MAP_H__
+#define __BTREE_MAP_H__
+
+#include <initializer_list>
+
+#include "btree.h"
+#include "functional.h"
+
+// 这个文件定义了btree_map和btree_multimap，接口和map/multimap相同，底层换成B树
+// 注意：插入和删除会移动同一个结点里的其他元素，除了返回的迭代器，之前的迭代器和元素的引用都可能失效
+
+namespace mystl {
+
+template <class Key, class T, class Compare = mystl::less<Key>>
+class btree_map {
+public:
+    typedef     Key                         key_type;
+    typedef     T                           mapped_type;
+    typedef     mystl::pair</* const  */Key, T>   value_type;
+    typedef     Compare                     key_compare;
+
+    class value_compare : public binary_function<value_type, value_type, bool> {
+        friend class btree_map;
+        private:
+            Compare comp;
+            value_compare(Compare c) : comp(c) {}
+        public:
+            bool operator()(const value_type& lhs, const value_type& rhs) const {
+                return comp(lhs.first, rhs.first);
+            }
+    };
+
+private:
+    typedef mystl::btree<key_type, value_type, key_compare, mystl::select1st<value_type>> base_type;
+    base_type  tree_;
+
+public:
+    typedef typename base_type::pointer                pointer;
+    typedef typename base_type::const_pointer          const_pointer;
+    typedef typename base_type::reference              reference;
+    typedef typename base_type::const_reference        const_reference;
+    typedef typename base_type::iterator               iterator;
+    typedef typename base_type::const_iterator         const_iterator;
+    typedef typename base_type::reverse_iterator       reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type              size_type;
+    typedef typename base_type::difference_type        difference_type;
+    typedef typename base_type::allocator_type         allocator_type;
+
+public:
+    btree_map() = default;
+
+    template <class InputIterator>
+    btree_map(InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_unique(first, last);
+    }
+
+    btree_map(std::initializer_list<value_type> ilist) : tree_() {
+        tree_.insert_unique(ilist.begin(), ilist.end());
+    }
+
+    btree_map(const btree_map& rhs) : tree_(rhs.tree_) {}
+
+    btree_map(btree_map&& rhs) : tree_(mystl::move(rhs.tree_)) {}
+
+    btree_map& operator=(const btree_map& rhs) {
+        tree_ = rhs.tree_;
+        return *this;
+    }
+
+    btree_map& operator=(btree_map&& rhs) {
+        tree_ = mystl::move(rhs.tree_);
+        return *this;
+    }
+
+    btree_map& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    key_compare            key_comp()      const { return tree_.key_comp(); }
+    value_compare          value_comp()    const { return value_compare(tree_.key_comp()); }
+    allocator_type         get_allocator() const { return tree_.get_allocator(); }
+
+    // 迭代器
+    iterator               begin()          { return tree_.begin(); }
+    const_iterator         begin()   const  { return tree_.begin(); }
+    iterator               end()            { return tree_.end(); }
+    const_iterator         end()     const  { return tree_.end(); }
+
+    reverse_iterator       rbegin()         { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin()  const  { return const_reverse_iterator(end()); }
+    reverse_iterator       rend()           { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()    const  { return const_reverse_iterator(begin()); }
+
+    const_iterator         cbegin()  const  { return begin(); }
+    const_iterator         cend()    const  { return end(); }
+    const_reverse_iterator crbegin() const  { return rbegin(); }
+    const_reverse_iterator crend()   const  { return rend(); }
+
+    // 容量相关
+    bool        empty()     const   { return tree_.empty(); }
+    size_type   size()      const   { return tree_.size(); }
+    size_type   max_size()  const   { return tree_.max_size(); }
+
+    // 若键值不存在，抛出异常
+    mapped_type&    at(const key_type& key) {
+        iterator it = tree_.find(key);
+        THROW_OUT_OF_RANGE_IF(it == end(), "btree_map no such elements exists.");
+        return it->second;
+    }
+
+    const mapped_type&    at(const key_type& key) const {
+        const_iterator it = tree_.find(key);
+        THROW_OUT_OF_RANGE_IF(it == end(), "btree_map no such elements exists.");
+        return it->second;
+    }
+
+    // 如果不存在元素，插入默认值的mapped_type
+    mapped_type&    operator[] (const key_type& key) {
+        return tree_.insert_unique(value_type(key, mapped_type())).first->second;
+    }
+
+    // insert
+    mystl::pair<iterator, bool> insert(const value_type& value) {
+        return tree_.insert_unique(value);
+    }
+
+    iterator insert(iterator pos, const value_type& value) {
+        return tree_.insert_unique(pos, value);
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        tree_.insert_unique(first, last);
+    }
+
+    template <class ...Args>
+    mystl::pair<iterator, bool> emplace(Args&& ...args) {
+        return tree_.emplace_unique(mystl::forward<Args>(args)...);
+    }
+
+    // erase
+    iterator erase(iterator pos) {
+        return tree_.erase(pos);
+    }
+
+    size_type erase(const key_type& key) {
+        return tree_.erase(key);
+    }
+
+    iterator erase(iterator first, iterator last) {
+        return tree_.erase(first, last);
+    }
+
+    void clear() { tree_.clear(); }
+
+    // 查找
+    iterator find(const key_type& key) { return tree_.find(key); }
+    const_iterator find(const key_type& key) const { return tree_.find(key); }
+
+    size_type count(const key_type& key) const { return tree_.count(key); }
+
+    iterator       lower_bound(const key_type& key)       { return tree_.lower_bound(key); }
+    const_iterator lower_bound(const key_type& key) const { return tree_.lower_bound(key); }
+
+    iterator       upper_bound(const key_type& key)       { return tree_.upper_bound(key); }
+    const_iterator upper_bound(const key_type& key) const { return tree_.upper_bound(key); }
+
+    mystl::pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return tree_.equal_range(key);
+    }
+
+    mystl::pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range(key);
+    }
+
+    // 树高和结点占用的字节数
+    size_type height()     const { return tree_.height(); }
+    size_type bytes_used() const { return tree_.bytes_used(); }
+
+    void swap(btree_map& rhs) { tree_.swap(rhs.tree_); }
+};
+
+template <class Key, class T, class Compare>
+bool operator==(const btree_map<Key, T, Compare>& lhs, const btree_map<Key, T, Compare>& rhs)
+{
+  return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class Key, class T, class Compare>
+bool operator<(const btree_map<Key, T, Compare>& lhs, const btree_map<Key, T, Compare>& rhs)
+{
+  return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class Key, class T, class Compare>
+bool operator!=(const btree_map<Key, T, Compare>& lhs, const btree_map<Key, T, Compare>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare>
+bool operator>(const btree_map<Key, T, Compare>& lhs, const btree_map<Key, T, Compare>& rhs)
+{
+  return rhs < lhs;
+}
+
+template <class Key, class T, class Compare>
+bool operator<=(const btree_map<Key, T, Compare>& lhs, const btree_map<Key, T, Compare>& rhs)
+{
+  return !(rhs < lhs);
+}
+
+template <class Key, class T, class Compare>
+bool operator>=(const btree_map<Key, T, Compare>& lhs, const btree_map<Key, T, Compare>& rhs)
+{
+  return !(lhs < rhs);
+}
+
+template <class Key, class T, class Compare>
+void swap(btree_map<Key, T, Compare>& lhs, btree_map<Key, T, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+
+
+//--------------------btree_multimap-----------------------
+template <class Key, class T, class Compare = mystl::less<Key>>
+class btree_multimap {
+public:
+    typedef     Key                         key_type;
+    typedef     T                           mapped_type;
+    typedef     mystl::pair</* const  */Key, T>   value_type;
+    typedef     Compare                     key_compare;
+
+    class value_compare : public binary_function<value_type, value_type, bool> {
+        friend class btree_multimap;
+        private:
+            Compare comp;
+            value_compare(Compare c) : comp(c) {}
+        public:
+            bool operator()(const value_type& lhs, const value_type& rhs) const {
+                return comp(lhs.first, rhs.first);
+            }
+    };
+
+private:
+    typedef mystl::btree<key_type, value_type, key_compare, mystl::select1st<value_type>> base_type;
+    base_type  tree_;
+
+public:
+    typedef typename base_type::pointer                pointer;
+    typedef typename base_type::const_pointer          const_pointer;
+    typedef typename base_type::reference              reference;
+    typedef typename base_type::const_reference        const_reference;
+    typedef typename base_type::iterator               iterator;
+    typedef typename base_type::const_iterator         const_iterator;
+    typedef typename base_type::reverse_iterator       reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type              size_type;
+    typedef typename base_type::difference_type        difference_type;
+    typedef typename base_type::allocator_type         allocator_type;
+
+public:
+    btree_multimap() = default;
+
+    template <class InputIterator>
+    btree_multimap(InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_equal(first, last);
+    }
+
+    btree_multimap(std::initializer_list<value_type> ilist) : tree_() {
+        tree_.insert_equal(ilist.begin(), ilist.end());
+    }
+
+    btree_multimap(const btree_multimap& rhs) : tree_(rhs.tree_) {}
+
+    btree_multimap(btree_multimap&& rhs) : tree_(mystl::move(rhs.tree_)) {}
+
+    btree_multimap& operator=(const btree_multimap& rhs) {
+        tree_ = rhs.tree_;
+        return *this;
+    }
+
+    btree_multimap& operator=(btree_multimap&& rhs) {
+        tree_ = mystl::move(rhs.tree_);
+        return *this;
+    }
+
+    btree_multimap& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_equal(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    key_compare            key_comp()      const { return tree_.key_comp(); }
+    value_compare          value_comp()    const { return value_compare(tree_.key_comp()); }
+    allocator_type         get_allocator() const { return tree_.get_allocator(); }
+
+    // 迭代器
+    iterator               begin()          { return tree_.begin(); }
+    const_iterator         begin()   const  { return tree_.begin(); }
+    iterator               end()            { return tree_.end(); }
+    const_iterator         end()     const  { return tree_.end(); }
+
+    reverse_iterator       rbegin()         { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin()  const  { return const_reverse_iterator(end()); }
+    reverse_iterator       rend()           { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()    const  { return const_reverse_iterator(begin()); }
+
+    const_iterator         cbegin()  const  { return begin(); }
+    const_iterator         cend()    const  { return end(); }
+    const_reverse_iterator crbegin() const  { return rbegin(); }
+    const_reverse_iterator crend()   const  { return rend(); }
+
+    // 容量相关
+    bool        empty()     const   { return tree_.empty(); }
+    size_type   size()      const   { return tree_.size(); }
+    size_type   max_size()  const   { return tree_.max_size(); }
+
+    // insert
+    iterator insert(const value_type& value) {
+        return tree_.insert_equal(value);
+    }
+
+    iterator insert(iterator pos, const value_type& value) {
+        return tree_.insert_equal(pos, value);
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        tree_.insert_equal(first, last);
+    }
+
+    template <class ...Args>
+    iterator emplace(Args&& ...args) {
+        return tree_.emplace_equal(mystl::forward<Args>(args)...);
+    }
+
+    // erase
+    iterator erase(iterator pos) {
+        return tree_.erase(pos);
+    }
+
+    size_type erase(const key_type& key) {
+        return tree_.erase(key);
+    }
+
+    iterator erase(iterator first, iterator last) {
+        return tree_.erase(first, last);
+    }
+
+    void clear() { tree_.clear(); }
+
+    // 查找
+    iterator find(const key_type& key) { return tree_.find(key); }
+    const_iterator find(const key_type& key) const { return tree_.find(key); }
+
+    size_type count(const key_type& key) const { return tree_.count(key); }
+
+    iterator       lower_bound(const key_type& key)       { return tree_.lower_bound(key); }
+    const_iterator lower_bound(const key_type& key) const { return tree_.lower_bound(key); }
+
+    iterator       upper_bound(const key_type& key)       { return tree_.upper_bound(key); }
+    const_iterator upper_bound(const key_type& key) const { return tree_.upper_bound(key); }
+
+    mystl::pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return tree_.equal_range(key);
+    }
+
+    mystl::pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range(key);
+    }
+
+    size_type height()     const { return tree_.height(); }
+    size_type bytes_used() const { return tree_.bytes_used(); }
+
+    void swap(btree_multimap& rhs) { tree_.swap(rhs.tree_); }
+};
+
+template <class Key, class T, class Compare>
+bool operator==(const btree_multimap<Key, T, Compare>& lhs, const btree_multimap<Key, T, Compare>& rhs)
+{
+  return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class Key, class T, class Compare>
+bool operator<(const btree_multimap<Key, T, Compare>& lhs, const btree_multimap<Key, T, Compare>& rhs)
+{
+  return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class Key, class T, class Compare>
+bool operator!=(const btree_multimap<Key, T, Compare>& lhs, const btree_multimap<Key, T, Compare>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare>
+bool operator>(const btree_multimap<Key, T, Compare>& lhs, const btree_multimap<Key, T, Compare>& rhs)
+{
+  return rhs < lhs;
+}
+
+template <class Key, class T, class Compare>
+bool operator<=(const btree_multimap<Key, T, Compare>& lhs, const btree_multimap<Key, T, Compare>& rhs)
+{
+  return !(rhs < lhs);
+}
+
+template <class Key, class T, class Compare>
+bool operator>=(const btree_multimap<Key, T, Compare>& lhs, const btree_multimap<Key, T, Compare>& rhs)
+{
+  return !(lhs < rhs);
+}
+
+template <class Key, class T, class Compare>
+void swap(btree_multimap<Key, T, Compare>& lhs, btree_multimap<Key, T, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+}
+
+#endif
@@ -0,0 +1,366 @@
+#ifndef __BTREE_SET_H__
+#define __BTREE_SET_H__
+
+#include <initializer_list>
+
+#include "btree.h"
+
+// 这个文件定义了btree_set和btree_multiset，接口和set/multiset相同，底层换成B树
+// 元素连续存放在宽结点里，查找和遍历对cache更友好，内存开销也更小
+// 注意：插入和删除会移动同一个结点里的其他元素，除了返回的迭代器，之前的迭代器都可能失效
+
+namespace mystl {
+
+template <class Key, class Compare = mystl::less<Key>>
+class btree_set {
+public:
+    typedef Key         key_type;
+    typedef Key         value_type;
+    typedef Compare     key_compare;
+    typedef Compare     value_compare;
+
+private:
+    typedef mystl::btree<key_type, value_type, key_compare, mystl::identity<value_type>> base_type;
+    base_type tree_;
+
+public:
+    typedef typename base_type::const_pointer          pointer;
+    typedef typename base_type::const_pointer          const_pointer;
+    typedef typename base_type::const_reference        reference;
+    typedef typename base_type::const_reference        const_reference;
+    typedef typename base_type::const_iterator         iterator;
+    typedef typename base_type::const_iterator         const_iterator;
+    typedef typename base_type::const_reverse_iterator reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type              size_type;
+    typedef typename base_type::difference_type        difference_type;
+    typedef typename base_type::allocator_type         allocator_type;
+
+public:
+    btree_set() = default;
+
+    template <class InputIterator>
+    btree_set(InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_unique(first, last);
+    }
+
+    btree_set(std::initializer_list<value_type> ilist) {
+        tree_.insert_unique(ilist.begin(), ilist.end());
+    }
+
+    btree_set(const btree_set& rhs) : tree_(rhs.tree_) { }
+
+    btree_set(btree_set&& rhs) : tree_(mystl::move(rhs.tree_)) { }
+
+    btree_set& operator=(const btree_set& rhs) {
+        tree_ = rhs.tree_;
+        return *this;
+    }
+
+    btree_set& operator=(btree_set&& rhs) {
+        tree_ = mystl::move(rhs.tree_);
+        return *this;
+    }
+
+    btree_set& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    key_compare         key_comp()      const { return tree_.key_comp(); }
+    value_compare       value_comp()    const { return tree_.key_comp(); }
+    allocator_type      get_allocator() const { return tree_.get_allocator(); }
+
+    // 迭代器
+    iterator               begin()          { return tree_.begin(); }
+    const_iterator         begin()  const   { return tree_.begin(); }
+    iterator               end()            { return tree_.end(); }
+    const_iterator         end()    const   { return tree_.end(); }
+
+    reverse_iterator       rbegin()         { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const   { return const_reverse_iterator(end()); }
+    reverse_iterator       rend()           { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()   const   { return const_reverse_iterator(begin()); }
+
+    const_iterator         cbegin()     const       { return begin(); }
+    const_iterator         cend()       const       { return end(); }
+    const_reverse_iterator crbegin()    const       { return rbegin(); }
+    const_reverse_iterator crend()      const       { return rend(); }
+
+    // 容量
+    bool        empty()     const { return tree_.empty(); }
+    size_type   size()      const { return tree_.size();  }
+    size_type   max_size()  const { return tree_.max_size(); }
+
+    // insert
+    mystl::pair<iterator, bool> insert(const value_type& value) {
+        auto p = tree_.insert_unique(value);
+        return mystl::pair<iterator, bool>(p.first, p.second);
+    }
+    iterator insert(iterator pos, const value_type& value) {
+        return tree_.insert_unique(pos, value);
+    }
+    template <class Iterator>
+    void insert(Iterator first, Iterator last) {
+        tree_.insert_unique(first, last);
+    }
+    template <class ...Args>
+    mystl::pair<iterator, bool> emplace(Args&& ...args) {
+        auto p = tree_.emplace_unique(mystl::forward<Args>(args)...);
+        return mystl::pair<iterator, bool>(p.first, p.second);
+    }
+
+    // erase
+    iterator erase(iterator pos) { return tree_.erase(pos); }
+    size_type erase(const key_type& key) { return tree_.erase(key); }
+    iterator erase(iterator first, iterator last) { return tree_.erase(first, last); }
+
+    void clear() { tree_.clear(); }
+
+    // 查找
+    iterator find(const key_type& key)  { return tree_.find(key); }
+    const_iterator find(const key_type& key)    const { return tree_.find(key); }
+
+    size_type count(const key_type& key) const { return tree_.count(key); }
+
+    iterator       lower_bound(const key_type& key)       { return tree_.lower_bound(key); }
+    const_iterator lower_bound(const key_type& key) const { return tree_.lower_bound(key); }
+
+    iterator       upper_bound(const key_type& key)       { return tree_.upper_bound(key); }
+    const_iterator upper_bound(const key_type& key) const { return tree_.upper_bound(key); }
+
+    mystl::pair<iterator, iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range(key);
+    }
+
+    // 树高和结点占用的字节数
+    size_type height()     const { return tree_.height(); }
+    size_type bytes_used() const { return tree_.bytes_used(); }
+
+    void swap(btree_set& rhs) {
+        tree_.swap(rhs.tree_);
+    }
+};
+
+template <class Key, class Compare>
+bool operator==(const btree_set<Key, Compare>& lhs, const btree_set<Key, Compare>& rhs)
+{
+  return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class Key, class Compare>
+bool operator<(const btree_set<Key, Compare>& lhs, const btree_set<Key, Compare>& rhs)
+{
+  return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class Key, class Compare>
+bool operator!=(const btree_set<Key, Compare>& lhs, const btree_set<Key, Compare>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class Key, class Compare>
+bool operator>(const btree_set<Key, Compare>& lhs, const btree_set<Key, Compare>& rhs)
+{
+  return rhs < lhs;
+}
+
+template <class Key, class Compare>
+bool operator<=(const btree_set<Key, Compare>& lhs, const btree_set<Key, Compare>& rhs)
+{
+  return !(rhs < lhs);
+}
+
+template <class Key, class Compare>
+bool operator>=(const btree_set<Key, Compare>& lhs, const btree_set<Key, Compare>& rhs)
+{
+  return !(lhs < rhs);
+}
+
+template <class Key, class Compare>
+void swap(btree_set<Key, Compare>& lhs, btree_set<Key, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+
+
+//--------------------btree_multiset-----------------------
+template <class Key, class Compare = mystl::less<Key>>
+class btree_multiset {
+public:
+    typedef Key         key_type;
+    typedef Key         value_type;
+    typedef Compare     key_compare;
+    typedef Compare     value_compare;
+
+private:
+    typedef mystl::btree<key_type, value_type, key_compare, mystl::identity<value_type>> base_type;
+    base_type tree_;
+
+public:
+    typedef typename base_type::const_pointer          pointer;
+    typedef typename base_type::const_pointer          const_pointer;
+    typedef typename base_type::const_reference        reference;
+    typedef typename base_type::const_reference        const_reference;
+    typedef typename base_type::const_iterator         iterator;
+    typedef typename base_type::const_iterator         const_iterator;
+    typedef typename base_type::const_reverse_iterator reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type              size_type;
+    typedef typename base_type::difference_type        difference_type;
+    typedef typename base_type::allocator_type         allocator_type;
+
+public:
+    btree_multiset() = default;
+
+    template <class InputIterator>
+    btree_multiset(InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_equal(first, last);
+    }
+
+    btree_multiset(std::initializer_list<value_type> ilist) {
+        tree_.insert_equal(ilist.begin(), ilist.end());
+    }
+
+    btree_multiset(const btree_multiset& rhs) : tree_(rhs.tree_) { }
+
+    btree_multiset(btree_multiset&& rhs) : tree_(mystl::move(rhs.tree_)) { }
+
+    btree_multiset& operator=(const btree_multiset& rhs) {
+        tree_ = rhs.tree_;
+        return *this;
+    }
+
+    btree_multiset& operator=(btree_multiset&& rhs) {
+        tree_ = mystl::move(rhs.tree_);
+        return *this;
+    }
+
+    btree_multiset& operator=(std::initializer_list<value_type> ilist) {
+        tree_.clear();
+        tree_.insert_equal(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    key_compare         key_comp()      const { return tree_.key_comp(); }
+    value_compare       value_comp()    const { return tree_.key_comp(); }
+    allocator_type      get_allocator() const { return tree_.get_allocator(); }
+
+    // 迭代器
+    iterator               begin()          { return tree_.begin(); }
+    const_iterator         begin()  const   { return tree_.begin(); }
+    iterator               end()            { return tree_.end(); }
+    const_iterator         end()    const   { return tree_.end(); }
+
+    reverse_iterator       rbegin()         { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const   { return const_reverse_iterator(end()); }
+    reverse_iterator       rend()           { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()   const   { return const_reverse_iterator(begin()); }
+
+    const_iterator         cbegin()     const       { return begin(); }
+    const_iterator         cend()       const       { return end(); }
+    const_reverse_iterator crbegin()    const       { return rbegin(); }
+    const_reverse_iterator crend()      const       { return rend(); }
+
+    // 容量
+    bool        empty()     const { return tree_.empty(); }
+    size_type   size()      const { return tree_.size();  }
+    size_type   max_size()  const { return tree_.max_size(); }
+
+    // insert
+    iterator insert(const value_type& value) {
+        return tree_.insert_equal(value);
+    }
+    iterator insert(iterator pos, const value_type& value) {
+        return tree_.insert_equal(pos, value);
+    }
+    template <class Iterator>
+    void insert(Iterator first, Iterator last) {
+        tree_.insert_equal(first, last);
+    }
+    template <class ...Args>
+    iterator emplace(Args&& ...args) {
+        return tree_.emplace_equal(mystl::forward<Args>(args)...);
+    }
+
+    // erase
+    iterator erase(iterator pos) { return tree_.erase(pos); }
+    size_type erase(const key_type& key) { return tree_.erase(key); }
+    iterator erase(iterator first, iterator last) { return tree_.erase(first, last); }
+
+    void clear() { tree_.clear(); }
+
+    // 查找
+    iterator find(const key_type& key)  { return tree_.find(key); }
+    const_iterator find(const key_type& key)    const { return tree_.find(key); }
+
+    size_type count(const key_type& key) const { return tree_.count(key); }
+
+    iterator       lower_bound(const key_type& key)       { return tree_.lower_bound(key); }
+    const_iterator lower_bound(const key_type& key) const { return tree_.lower_bound(key); }
+
+    iterator       upper_bound(const key_type& key)       { return tree_.upper_bound(key); }
+    const_iterator upper_bound(const key_type& key) const { return tree_.upper_bound(key); }
+
+    mystl::pair<iterator, iterator>
+    equal_range(const key_type& key) const {
+        return tree_.equal_range(key);
+    }
+
+    size_type height()     const { return tree_.height(); }
+    size_type bytes_used() const { return tree_.bytes_used(); }
+
+    void swap(btree_multiset& rhs) {
+        tree_.swap(rhs.tree_);
+    }
+};
+
+template <class Key, class Compare>
+bool operator==(const btree_multiset<Key, Compare>& lhs, const btree_multiset<Key, Compare>& rhs)
+{
+  return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class Key, class Compare>
+bool operator<(const btree_multiset<Key, Compare>& lhs, const btree_multiset<Key, Compare>& rhs)
+{
+  return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class Key, class Compare>
+bool operator!=(const btree_multiset<Key, Compare>& lhs, const btree_multiset<Key, Compare>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class Key, class Compare>
+bool operator>(const btree_multiset<Key, Compare>& lhs, const btree_multiset<Key, Compare>& rhs)
+{
+  return rhs < lhs;
+}
+
+template <class Key, class Compare>
+bool operator<=(const btree_multiset<Key, Compare>& lhs, const btree_multiset<Key, Compare>& rhs)
+{
+  return !(rhs < lhs);
+}
+
+template <class Key, class Compare>
+bool operator>=(const btree_multiset<Key, Compare>& lhs, const btree_multiset<Key, Compare>& rhs)
+{
+  return !(lhs < rhs);
+}
+
+template <class Key, class Compare>
+void swap(btree_multiset<Key, Compare>& lhs, btree_multiset<Key, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+}
+
+#endif
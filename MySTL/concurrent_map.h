@@ -0,0 +1,520 @@
+#ifndef __CONCURRENT_MAP_H__
+#define __CONCURRENT_MAP_H__
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+
+#include "allocator.h"
+#include "construct.h"
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+#include "atomic_wait.h"
+#include "epoch.h"
+
+// 这个文件定义了读多写少场景下的并发有序表 concurrent_map，用lazy skiplist实现，结点用epoch回收
+
+/*
+* lazy skiplist (Herlihy, Lev, Luchangco, Shavit)：
+*   每个结点带一把自旋锁、marked_（已逻辑删除）和 fully_linked_（所有层都已链好）两个标志
+*   读 : 不加锁，沿着next指针走，跳过marked_或者还没fully_linked_的结点
+*   插入 : 找到每层的前驱，自底向上锁住前驱并检查前驱没被删除、前驱的后继没变，然后链入
+*   删除 : 先锁住目标结点置marked_（逻辑删除），再锁住前驱从上往下摘链（物理删除），最后retire
+*
+* 加锁顺序总是从键大的结点到键小的结点，不会死锁。
+* 摘下的结点自己的next指针不变，正在上面遍历的读者可以继续往后走，因此区间扫描可以和写者并发，
+* 得到的是弱一致的结果：扫描期间插入的元素可能看得到也可能看不到，但是顺序一定是对的。
+*
+* 值和键分开存放：键在结点里，永远不变；值是单独分配的pair，insert_or_assign整体替换指针，
+* 旧值retire，所以读者拿到的引用在guard存活期间一直有效，不会读到写了一半的值。
+*
+* 迭代器内含一个epoch_guard，迭代器存活期间它指向的结点不会被释放；迭代器只能在创建它的线程上使用。
+*/
+
+namespace mystl {
+
+// 最高层数，p = 1/4 时可以很好地支持 4^16 个元素
+#ifndef MYSTL_CONCURRENT_MAP_MAX_LEVEL
+#define MYSTL_CONCURRENT_MAP_MAX_LEVEL 16
+#endif
+
+template <class Key, class T>
+struct concurrent_map_node {
+    typedef mystl::pair<Key, T> value_type;
+
+    std::atomic<value_type*> value_;
+    spin_lock lock_;
+    std::atomic<bool> marked_;
+    std::atomic<bool> fully_linked_;
+    int top_level_;
+    alignas(Key) unsigned char key_[sizeof(Key)];     // 头结点不构造键
+    std::atomic<concurrent_map_node*> next_[1];       // 实际长度为top_level_
+
+    const Key& key() const { return *reinterpret_cast<const Key*>(key_); }
+};
+
+template <class Key, class T, class Compare>
+class concurrent_map;
+
+// 只读的前向迭代器
+template <class Key, class T, class Compare>
+class concurrent_map_const_iterator {
+public:
+    typedef mystl::forward_iterator_tag         iterator_category;
+    typedef mystl::pair<Key, T>                 value_type;
+    typedef const value_type*                   pointer;
+    typedef const value_type&                   reference;
+    typedef ptrdiff_t                           difference_type;
+
+    typedef concurrent_map_node<Key, T>         node;
+
+private:
+    epoch_guard guard_;
+    node* node_;
+    value_type* value_;      // 创建迭代器时读到的值，之后的insert_or_assign不影响它
+
+    friend class concurrent_map<Key, T, Compare>;
+
+    explicit concurrent_map_const_iterator(node* n) : node_(n), value_(nullptr) {
+        if(node_) value_ = node_->value_.load(std::memory_order_acquire);
+    }
+
+public:
+    concurrent_map_const_iterator() : node_(nullptr), value_(nullptr) {}
+
+    reference operator*() const { return *value_; }
+    pointer operator->() const { return value_; }
+
+    concurrent_map_const_iterator& operator++() {
+        node_ = node_->next_[0].load(std::memory_order_acquire);
+        while(node_ && (node_->marked_.load(std::memory_order_acquire)
+                        || !node_->fully_linked_.load(std::memory_order_acquire))) {
+            node_ = node_->next_[0].load(std::memory_order_acquire);
+        }
+        value_ = node_ ? node_->value_.load(std::memory_order_acquire) : nullptr;
+        return *this;
+    }
+    concurrent_map_const_iterator operator++(int) {
+        concurrent_map_const_iterator tmp(*this);
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const concurrent_map_const_iterator& rhs) const { return node_ == rhs.node_; }
+    bool operator!=(const concurrent_map_const_iterator& rhs) const { return node_ != rhs.node_; }
+};
+
+template <class Key, class T, class Compare = mystl::less<Key>>
+class concurrent_map {
+public:
+    typedef Key                                         key_type;
+    typedef T                                           mapped_type;
+    typedef mystl::pair<Key, T>                         value_type;
+    typedef Compare                                     key_compare;
+    typedef size_t                                      size_type;
+    typedef const value_type&                           const_reference;
+
+    typedef concurrent_map_const_iterator<Key, T, Compare>   const_iterator;
+    typedef const_iterator                                   iterator;
+
+private:
+    typedef concurrent_map_node<Key, T>                 node;
+    typedef std::atomic<node*>                          link;
+    typedef mystl::allocator<unsigned char>             byte_allocator;
+    typedef mystl::allocator<value_type>                value_allocator;
+
+    enum { MAX_LEVEL = MYSTL_CONCURRENT_MAP_MAX_LEVEL };
+
+    node* head_;
+    Compare comp_;
+    alignas(MYSTL_CACHE_LINE_SIZE) std::atomic<size_type> size_;
+
+public:
+    concurrent_map() : comp_(), size_(0) { head_ = create_head(); }
+    explicit concurrent_map(const Compare& comp) : comp_(comp), size_(0) { head_ = create_head(); }
+
+    template <class InputIterator>
+    concurrent_map(InputIterator first, InputIterator last) : comp_(), size_(0) {
+        head_ = create_head();
+        for( ; first != last ; ++first) insert(*first);
+    }
+    concurrent_map(std::initializer_list<value_type> ilist) : comp_(), size_(0) {
+        head_ = create_head();
+        for(auto& v : ilist) insert(v);
+    }
+
+    concurrent_map(const concurrent_map&) = delete;
+    concurrent_map& operator=(const concurrent_map&) = delete;
+
+    // 析构时不应该再有其他线程访问，结点直接释放；已经retire的结点由epoch_domain释放
+    ~concurrent_map() {
+        node* x = head_->next_[0].load(std::memory_order_relaxed);
+        while(x) {
+            node* next = x->next_[0].load(std::memory_order_relaxed);
+            destroy_node(x);
+            x = next;
+        }
+        byte_allocator::deallocate(reinterpret_cast<unsigned char*>(head_));
+    }
+
+public:
+    key_compare key_comp() const { return comp_; }
+
+    // 其他线程并发修改时只是一个近似值
+    size_type size() const { return size_.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+    const_iterator begin() const {
+        const_iterator it(nullptr);
+        it.node_ = first_live(head_->next_[0].load(std::memory_order_acquire));
+        it.value_ = it.node_ ? it.node_->value_.load(std::memory_order_acquire) : nullptr;
+        return it;
+    }
+    const_iterator end() const { return const_iterator(nullptr); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+public:
+    // 查找不加锁，只沿next指针往前走
+    // 返回的迭代器自带guard，先建迭代器再查找，保证找到的结点在迭代器存活期间不被释放
+    const_iterator find(const key_type& key) const {
+        const_iterator it(nullptr);
+        node* x = lower_bound_node(key);
+        if(x && !comp_(key, x->key())) {
+            it.node_ = x;
+            it.value_ = x->value_.load(std::memory_order_acquire);
+        }
+        return it;
+    }
+    const_iterator lower_bound(const key_type& key) const {
+        const_iterator it(nullptr);
+        it.node_ = lower_bound_node(key);
+        it.value_ = it.node_ ? it.node_->value_.load(std::memory_order_acquire) : nullptr;
+        return it;
+    }
+    const_iterator upper_bound(const key_type& key) const {
+        const_iterator it(nullptr);
+        it.node_ = upper_bound_node(key);
+        it.value_ = it.node_ ? it.node_->value_.load(std::memory_order_acquire) : nullptr;
+        return it;
+    }
+
+    bool contains(const key_type& key) const {
+        epoch_guard guard;
+        node* x = lower_bound_node(key);
+        return x && !comp_(key, x->key());
+    }
+    size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+    // 把值拷贝出来，不需要持有迭代器
+    bool try_get(const key_type& key, mapped_type& out) const {
+        epoch_guard guard;
+        node* x = lower_bound_node(key);
+        if(x == nullptr || comp_(key, x->key())) return false;
+        out = x->value_.load(std::memory_order_acquire)->second;
+        return true;
+    }
+
+public:
+    // 插入成功返回true，键已经存在返回false
+    bool insert(const value_type& value) {
+        return insert_aux(value.first, value.second, false);
+    }
+    bool insert(const key_type& key, const mapped_type& obj) {
+        return insert_aux(key, obj, false);
+    }
+    // 键已经存在时整体替换值，返回是否是新插入的
+    bool insert_or_assign(const key_type& key, const mapped_type& obj) {
+        return insert_aux(key, obj, true);
+    }
+
+    size_type erase(const key_type& key);
+
+    // 逐个删除，和其他写者并发时不保证结束后为空
+    void clear() {
+        epoch_guard guard;
+        node* x;
+        while((x = first_live(head_->next_[0].load(std::memory_order_acquire))) != nullptr) {
+            erase(x->key());
+        }
+    }
+
+private:
+    static size_type node_bytes(int level) {
+        return sizeof(node) + (level - 1) * sizeof(link);
+    }
+
+    node* create_head() {
+        node* h = reinterpret_cast<node*>(byte_allocator::allocate(node_bytes(MAX_LEVEL)));
+        new (&h->value_) std::atomic<value_type*>(nullptr);
+        new (&h->lock_) spin_lock();
+        new (&h->marked_) std::atomic<bool>(false);
+        new (&h->fully_linked_) std::atomic<bool>(true);
+        h->top_level_ = MAX_LEVEL;
+        for(int i = 0 ; i < MAX_LEVEL ; ++i) new (&h->next_[i]) link(nullptr);
+        return h;
+    }
+
+    node* create_node(const key_type& key, const mapped_type& obj, int level) {
+        value_type* v = value_allocator::allocate(1);
+        try {
+            mystl::construct(v, key, obj);
+        }catch(...) {
+            value_allocator::deallocate(v);
+            throw;
+        }
+        node* x = reinterpret_cast<node*>(byte_allocator::allocate(node_bytes(level)));
+        try {
+            new (x->key_) Key(key);
+        }catch(...) {
+            byte_allocator::deallocate(reinterpret_cast<unsigned char*>(x));
+            destroy_value(v);
+            throw;
+        }
+        new (&x->value_) std::atomic<value_type*>(v);
+        new (&x->lock_) spin_lock();
+        new (&x->marked_) std::atomic<bool>(false);
+        new (&x->fully_linked_) std::atomic<bool>(false);
+        x->top_level_ = level;
+        for(int i = 0 ; i < level ; ++i) new (&x->next_[i]) link(nullptr);
+        return x;
+    }
+
+    static void destroy_value(void* p) {
+        value_type* v = static_cast<value_type*>(p);
+        mystl::destroy(v);
+        value_allocator::deallocate(v);
+    }
+
+    static void destroy_node(void* p) {
+        node* x = static_cast<node*>(p);
+        destroy_value(x->value_.load(std::memory_order_relaxed));
+        reinterpret_cast<const Key*>(x->key_)->~Key();
+        byte_allocator::deallocate(reinterpret_cast<unsigned char*>(x));
+    }
+
+    // 每个线程一个xorshift，每升一层的概率为1/4
+    static int random_level() {
+        static thread_local uint64_t state = 0;
+        if(state == 0) {
+            state = reinterpret_cast<uintptr_t>(&state) * 0x9E3779B97F4A7C15ULL | 1;
+        }
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint64_t r = state;
+        int level = 1;
+        while((r & 3) == 0 && level < MAX_LEVEL) {
+            ++level;
+            r >>= 2;
+        }
+        return level;
+    }
+
+    static bool live(node* x) {
+        return !x->marked_.load(std::memory_order_acquire) && x->fully_linked_.load(std::memory_order_acquire);
+    }
+
+    static node* first_live(node* x) {
+        while(x && !live(x)) x = x->next_[0].load(std::memory_order_acquire);
+        return x;
+    }
+
+    // 第一个键不小于key的有效结点，调用者需要处于epoch临界区中
+    node* lower_bound_node(const key_type& key) const {
+        node* pred = head_;
+        node* curr = nullptr;
+        for(int level = MAX_LEVEL - 1 ; level >= 0 ; --level) {
+            curr = pred->next_[level].load(std::memory_order_acquire);
+            while(curr && comp_(curr->key(), key)) {
+                pred = curr;
+                curr = pred->next_[level].load(std::memory_order_acquire);
+            }
+        }
+        return first_live(curr);
+    }
+
+    node* upper_bound_node(const key_type& key) const {
+        node* pred = head_;
+        node* curr = nullptr;
+        for(int level = MAX_LEVEL - 1 ; level >= 0 ; --level) {
+            curr = pred->next_[level].load(std::memory_order_acquire);
+            while(curr && !comp_(key, curr->key())) {
+                pred = curr;
+                curr = pred->next_[level].load(std::memory_order_acquire);
+            }
+        }
+        return first_live(curr);
+    }
+
+    // 填写每层的前驱和后继，返回找到key的最高层，没找到返回-1
+    int find_position(const key_type& key, node** preds, node** succs) const {
+        int found = -1;
+        node* pred = head_;
+        for(int level = MAX_LEVEL - 1 ; level >= 0 ; --level) {
+            node* curr = pred->next_[level].load(std::memory_order_acquire);
+            while(curr && comp_(curr->key(), key)) {
+                pred = curr;
+                curr = pred->next_[level].load(std::memory_order_acquire);
+            }
+            if(found == -1 && curr && !comp_(key, curr->key())) found = level;
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+        return found;
+    }
+
+    // 解锁第0层到highest层的前驱，相邻层的前驱可能是同一个结点，只解一次
+    static void unlock_preds(node** preds, int highest) {
+        node* prev = nullptr;
+        for(int level = 0 ; level <= highest ; ++level) {
+            if(preds[level] != prev) {
+                preds[level]->lock_.unlock();
+                prev = preds[level];
+            }
+        }
+    }
+
+    void replace_value(node* x, const mapped_type& obj) {
+        value_type* v = value_allocator::allocate(1);
+        try {
+            mystl::construct(v, x->key(), obj);
+        }catch(...) {
+            value_allocator::deallocate(v);
+            throw;
+        }
+        value_type* old = x->value_.exchange(v, std::memory_order_acq_rel);
+        epoch_domain::global().retire(old, &concurrent_map::destroy_value);
+    }
+
+    bool insert_aux(const key_type& key, const mapped_type& obj, bool assign);
+};
+
+/*****************************************************************************************/
+
+template <class Key, class T, class Compare>
+bool concurrent_map<Key, T, Compare>::insert_aux(const key_type& key, const mapped_type& obj, bool assign) {
+    epoch_guard guard;
+    node* preds[MAX_LEVEL];
+    node* succs[MAX_LEVEL];
+    const int top_level = random_level();
+    while(true) {
+        int found = find_position(key, preds, succs);
+        if(found != -1) {
+            node* x = succs[found];
+            if(!x->marked_.load(std::memory_order_acquire)) {
+                // 别的线程正在插入同一个键，等它链完
+                while(!x->fully_linked_.load(std::memory_order_acquire)) cpu_relax();
+                if(assign) replace_value(x, obj);
+                return false;
+            }
+            // 正在被删除，等删除者摘链后重试
+            cpu_relax();
+            continue;
+        }
+
+        int highest = -1;
+        bool valid = true;
+        node* prev = nullptr;
+        for(int level = 0 ; valid && level < top_level ; ++level) {
+            node* pred = preds[level];
+            node* succ = succs[level];
+            if(pred != prev) {
+                pred->lock_.lock();
+                highest = level;
+                prev = pred;
+            }
+            valid = !pred->marked_.load(std::memory_order_acquire)
+                    && (succ == nullptr || !succ->marked_.load(std::memory_order_acquire))
+                    && pred->next_[level].load(std::memory_order_acquire) == succ;
+        }
+        if(!valid) {
+            unlock_preds(preds, highest);
+            continue;
+        }
+
+        node* x;
+        try {
+            x = create_node(key, obj, top_level);
+        }catch(...) {
+            unlock_preds(preds, highest);
+            throw;
+        }
+        for(int level = 0 ; level < top_level ; ++level) {
+            x->next_[level].store(succs[level], std::memory_order_relaxed);
+        }
+        for(int level = 0 ; level < top_level ; ++level) {
+            preds[level]->next_[level].store(x, std::memory_order_release);
+        }
+        x->fully_linked_.store(true, std::memory_order_release);
+        unlock_preds(preds, highest);
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+}
+
+template <class Key, class T, class Compare>
+typename concurrent_map<Key, T, Compare>::size_type
+concurrent_map<Key, T, Compare>::erase(const key_type& key) {
+    epoch_guard guard;
+    node* preds[MAX_LEVEL];
+    node* succs[MAX_LEVEL];
+    node* victim = nullptr;
+    bool is_marked = false;
+    int top_level = -1;
+    while(true) {
+        int found = find_position(key, preds, succs);
+        if(!is_marked) {
+            if(found == -1) return 0;
+            victim = succs[found];
+            // 只删除所有层都已链好的结点，并且要在它的最高层找到它，否则前驱不完整
+            if(!victim->fully_linked_.load(std::memory_order_acquire)
+               || victim->top_level_ - 1 != found
+               || victim->marked_.load(std::memory_order_acquire)) {
+                return 0;
+            }
+            top_level = victim->top_level_;
+            victim->lock_.lock();
+            if(victim->marked_.load(std::memory_order_relaxed)) {
+                victim->lock_.unlock();
+                return 0;
+            }
+            victim->marked_.store(true, std::memory_order_release);
+            is_marked = true;
+        }
+
+        int highest = -1;
+        bool valid = true;
+        node* prev = nullptr;
+        for(int level = 0 ; valid && level < top_level ; ++level) {
+            node* pred = preds[level];
+            if(pred != prev) {
+                pred->lock_.lock();
+                highest = level;
+                prev = pred;
+            }
+            valid = !pred->marked_.load(std::memory_order_acquire)
+                    && pred->next_[level].load(std::memory_order_acquire) == victim;
+        }
+        if(!valid) {
+            unlock_preds(preds, highest);
+            continue;
+        }
+
+        for(int level = top_level - 1 ; level >= 0 ; --level) {
+            preds[level]->next_[level].store(victim->next_[level].load(std::memory_order_relaxed),
+                                             std::memory_order_release);
+        }
+        victim->lock_.unlock();
+        unlock_preds(preds, highest);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        epoch_domain::global().retire(victim, &concurrent_map::destroy_node);
+        return 1;
+    }
+}
+
+}
+
+#endif
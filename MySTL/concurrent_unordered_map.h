@@ -0,0 +1,390 @@
+#ifndef __CONCURRENT_UNORDERED_MAP_H__
+#define __CONCURRENT_UNORDERED_MAP_H__
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+
+#include "allocator.h"
+#include "construct.h"
+#include "functional.h"
+#include "hashtable.h"
+#include "util.h"
+#include "atomic_wait.h"
+
+// 这个文件定义了并发哈希表 concurrent_unordered_map，沿用hashtable的拉链法结点，用分段锁（lock striping）保护
+
+/*
+* 分段锁：
+*   bucket个数N和段数S都是2的幂，N >= S，key的哈希值为h：bucket = h & (N - 1)，段 = h & (S - 1)
+*   所以bucket b总是属于段 b & (S - 1)，N翻倍以后b和b + N也还在同一段，同一个key用的锁永远不变
+*   insert、find、erase只锁key所在的那一段，不同段上的操作完全并行
+*
+* 扩容（和其他操作并发）：
+*   每段各自记录元素个数，某一段的元素个数超过它的bucket个数（N / S）时触发，不需要一个所有线程都去改的计数器
+*   扩容的线程在锁外分配好两倍大的新表，原子地发布成当前表，然后逐段加锁把结点搬过去，
+*   每次只锁一段，没有全局停顿；其他线程拿到某一段的锁时如果发现这一段还在旧表里，也会顺手先搬这一段
+*   每段记录自己的结点在哪张表里，旧表在最后一段搬走时释放。同一时刻最多只有一次扩容在进行
+*   结点里缓存了哈希值，搬迁时不用再调用哈希函数
+*
+* 没有迭代器：元素随时可能被别的线程删除，取值用try_get拷贝出来，或者用visit在锁内访问。
+* insert_or_update、visit和for_each的回调在段锁内执行，要尽量短，也不能再访问同一个表
+*/
+
+namespace mystl {
+
+// 默认的段数，并发线程数远多于它时可以在构造时指定更多的段
+#ifndef MYSTL_CONCURRENT_HASH_STRIPES
+#define MYSTL_CONCURRENT_HASH_STRIPES 64
+#endif
+
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+class concurrent_unordered_map {
+public:
+    typedef Key                         key_type;
+    typedef T                           mapped_type;
+    typedef mystl::pair<Key, T>         value_type;
+    typedef Hash                        hasher;
+    typedef KeyEqual                    key_equal;
+    typedef size_t                      size_type;
+
+private:
+    typedef hashtable_Node<value_type, true>    node;       // 总是缓存哈希值
+    typedef node*                               node_ptr;
+    typedef mystl::allocator<node>              node_allocator;
+    typedef mystl::allocator<node_ptr>          bucket_allocator;
+
+    struct table {
+        size_type               size;       // bucket个数，2的幂
+        node_ptr*               buckets;
+        std::atomic<size_type>  pending;    // 被替换之后还有几段的结点留在这张表里
+    };
+
+    // 一段：锁、这一段的结点所在的表、这一段的元素个数，独占一个缓存行
+    struct alignas(MYSTL_CACHE_LINE_SIZE) stripe {
+        spin_lock               lock;
+        table*                  tab = nullptr;
+        std::atomic<size_type>  count{0};
+    };
+
+    typedef std::lock_guard<spin_lock>          lock_guard;
+
+    hasher                  hash_;
+    key_equal               equals_;
+    stripe*                 stripes_;
+    size_type               stripe_count_;
+    alignas(MYSTL_CACHE_LINE_SIZE) std::atomic<table*>      cur_;           // 当前表
+    std::atomic<size_type>  bucket_count_;  // cur_->size的副本，cur_可能随时被替换并释放
+    std::atomic<bool>       resizing_;
+
+public:
+    concurrent_unordered_map() : concurrent_unordered_map(MYSTL_CONCURRENT_HASH_STRIPES * 16) {}
+
+    // concurrency为段数，会向上取整为2的幂
+    explicit concurrent_unordered_map(size_type bucket_count,
+                                      size_type concurrency = MYSTL_CONCURRENT_HASH_STRIPES,
+                                      const Hash& hash = Hash(),
+                                      const KeyEqual& equal = KeyEqual())
+        : hash_(hash), equals_(equal), resizing_(false) {
+        stripe_count_ = round_up(concurrency);
+        const size_type n = mystl::max(round_up(bucket_count), stripe_count_);
+        table* t = create_table(n);
+        stripes_ = new stripe[stripe_count_];
+        for(size_type i = 0 ; i < stripe_count_ ; ++i) stripes_[i].tab = t;
+        cur_.store(t, std::memory_order_relaxed);
+        bucket_count_.store(n, std::memory_order_relaxed);
+    }
+
+    concurrent_unordered_map(std::initializer_list<value_type> ilist) : concurrent_unordered_map() {
+        for(auto& v : ilist) insert(v);
+    }
+
+    concurrent_unordered_map(const concurrent_unordered_map&) = delete;
+    concurrent_unordered_map& operator=(const concurrent_unordered_map&) = delete;
+
+    // 析构时不应该再有其他线程访问，也没有进行中的扩容，所有结点都在当前表里
+    ~concurrent_unordered_map() {
+        table* t = cur_.load(std::memory_order_relaxed);
+        for(size_type b = 0 ; b < t->size ; ++b) {
+            for(node_ptr p = t->buckets[b] ; p ; ) {
+                node_ptr next = p->next;
+                destroy_node(p);
+                p = next;
+            }
+        }
+        destroy_table(t);
+        delete[] stripes_;
+    }
+
+public:
+    hasher hash_function() const { return hash_; }
+    key_equal key_eq() const { return equals_; }
+
+    // 其他线程并发修改时只是一个近似值
+    size_type size() const {
+        size_type n = 0;
+        for(size_type i = 0 ; i < stripe_count_ ; ++i) n += stripes_[i].count.load(std::memory_order_relaxed);
+        return n;
+    }
+    bool empty() const { return size() == 0; }
+
+    size_type bucket_count() const { return bucket_count_.load(std::memory_order_relaxed); }
+    size_type stripe_count() const { return stripe_count_; }
+
+public:
+    // 查找，找到时把值拷贝到out
+    bool try_get(const key_type& key, mapped_type& out) const {
+        const size_type h = hash_of(key);
+        stripe& s = stripe_of(h);
+        lock_guard guard(s.lock);
+        node_ptr p = find_node(sync(s, h), h, key);
+        if(!p) return false;
+        out = p->value.second;
+        return true;
+    }
+
+    bool contains(const key_type& key) const {
+        const size_type h = hash_of(key);
+        stripe& s = stripe_of(h);
+        lock_guard guard(s.lock);
+        return find_node(sync(s, h), h, key) != nullptr;
+    }
+    size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+    // 找到时在锁内调用fn(const mapped_type&)，返回是否找到
+    template <class Fn>
+    bool visit(const key_type& key, Fn fn) const {
+        const size_type h = hash_of(key);
+        stripe& s = stripe_of(h);
+        lock_guard guard(s.lock);
+        node_ptr p = find_node(sync(s, h), h, key);
+        if(!p) return false;
+        fn(static_cast<const mapped_type&>(p->value.second));
+        return true;
+    }
+
+    // 逐段在锁内调用fn(const value_type&)，和写者并发时只保证每一段内部是一致的
+    template <class Fn>
+    void for_each(Fn fn) const {
+        for(size_type i = 0 ; i < stripe_count_ ; ++i) {
+            lock_guard guard(stripes_[i].lock);
+            table* t = sync(stripes_[i], i);
+            for(size_type b = i ; b < t->size ; b += stripe_count_) {
+                for(node_ptr p = t->buckets[b] ; p ; p = p->next) fn(static_cast<const value_type&>(p->value));
+            }
+        }
+    }
+
+public:
+    // 插入成功返回true，键已经存在返回false
+    bool insert(const value_type& value) { return insert(value.first, value.second); }
+    bool insert(const key_type& key, const mapped_type& obj) {
+        return modify(key, [&](node_ptr p) -> node_ptr {
+            return p ? nullptr : create_node(key, obj);
+        });
+    }
+
+    // 键已经存在时替换值，返回是否是新插入的
+    bool insert_or_assign(const key_type& key, const mapped_type& obj) {
+        return modify(key, [&](node_ptr p) -> node_ptr {
+            if(p) {
+                p->value.second = obj;
+                return nullptr;
+            }
+            return create_node(key, obj);
+        });
+    }
+
+    // 原子的读-改-写：键不存在时先插入mapped_type()，然后在锁内调用fn(mapped_type&)，返回是否是新插入的
+    // 例如计数：m.insert_or_update(k, [](int& v) { ++v; });
+    template <class Fn>
+    bool insert_or_update(const key_type& key, Fn fn) {
+        return modify(key, [&](node_ptr p) -> node_ptr {
+            if(p) {
+                fn(p->value.second);
+                return nullptr;
+            }
+            node_ptr x = create_node(key, mapped_type());
+            try {
+                fn(x->value.second);
+            }catch(...) {
+                destroy_node(x);
+                throw;
+            }
+            return x;
+        });
+    }
+
+    size_type erase(const key_type& key) {
+        const size_type h = hash_of(key);
+        stripe& s = stripe_of(h);
+        lock_guard guard(s.lock);
+        table* t = sync(s, h);
+        for(node_ptr* link = &t->buckets[h & (t->size - 1)] ; *link ; link = &(*link)->next) {
+            node_ptr p = *link;
+            if(p->hash_code == h && equals_(p->value.first, key)) {
+                *link = p->next;
+                destroy_node(p);
+                s.count.fetch_sub(1, std::memory_order_relaxed);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    // 逐段清空，和其他写者并发时不保证结束后为空
+    void clear() {
+        for(size_type i = 0 ; i < stripe_count_ ; ++i) {
+            lock_guard guard(stripes_[i].lock);
+            table* t = sync(stripes_[i], i);
+            for(size_type b = i ; b < t->size ; b += stripe_count_) {
+                for(node_ptr p = t->buckets[b] ; p ; ) {
+                    node_ptr next = p->next;
+                    destroy_node(p);
+                    p = next;
+                }
+                t->buckets[b] = nullptr;
+            }
+            stripes_[i].count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // 预留至少n个bucket，可能需要扩容好几次
+    // 别的线程正在扩容时不空转抢标志，像spin_lock一样先自旋一会儿，再让出CPU等它做完
+    void reserve(size_type n) {
+        for(int spin = 0 ; bucket_count() < n ; ) {
+            if(grow(cur_.load(std::memory_order_acquire))) continue;
+            if(++spin < MYSTL_SPIN_COUNT) cpu_relax();
+            else std::this_thread::yield();
+        }
+    }
+
+private:
+    static size_type round_up(size_type n) {
+        size_type r = 1;
+        while(r < n) r <<= 1;
+        return r;
+    }
+
+    // 用低位选段和bucket，哈希函数没有充分混合时再混合一次
+    size_type hash_of(const key_type& key) const {
+        if(is_avalanching<hasher>::value) return hash_(key);
+        return static_cast<size_type>(hash_int(static_cast<uint64_t>(hash_(key)), 0));
+    }
+
+    stripe& stripe_of(size_type h) const { return stripes_[h & (stripe_count_ - 1)]; }
+
+    static table* create_table(size_type n) {
+        table* t = new table;
+        t->size = n;
+        t->buckets = bucket_allocator::allocate(n);
+        for(size_type i = 0 ; i < n ; ++i) t->buckets[i] = nullptr;
+        t->pending.store(0, std::memory_order_relaxed);
+        return t;
+    }
+
+    static void destroy_table(table* t) {
+        bucket_allocator::deallocate(t->buckets);
+        delete t;
+    }
+
+    node_ptr create_node(const key_type& key, const mapped_type& obj) const {
+        node_ptr x = node_allocator::allocate(1);
+        x->next = nullptr;
+        try {
+            mystl::construct(&x->value, key, obj);
+        }catch(...) {
+            node_allocator::deallocate(x);
+            throw;
+        }
+        return x;
+    }
+
+    static void destroy_node(node_ptr x) {
+        mystl::destroy(&x->value);
+        node_allocator::deallocate(x);
+    }
+
+    node_ptr find_node(table* t, size_type h, const key_type& key) const {
+        for(node_ptr p = t->buckets[h & (t->size - 1)] ; p ; p = p->next) {
+            if(p->hash_code == h && equals_(p->value.first, key)) return p;
+        }
+        return nullptr;
+    }
+
+    // 持有段s的锁时调用，h为这一段里的任意一个哈希值：s的结点还在旧表里就先搬到当前表，返回当前表
+    table* sync(stripe& s, size_type h) const {
+        table* cur = cur_.load(std::memory_order_acquire);
+        if(s.tab != cur) migrate(s, h & (stripe_count_ - 1), cur);
+        return cur;
+    }
+
+    // 把段idx的所有bucket从s.tab搬到to，旧表的最后一段搬走时释放旧表
+    void migrate(stripe& s, size_type idx, table* to) const {
+        table* from = s.tab;
+        for(size_type b = idx ; b < from->size ; b += stripe_count_) {
+            for(node_ptr p = from->buckets[b] ; p ; ) {
+                node_ptr next = p->next;
+                node_ptr& head = to->buckets[p->hash_code & (to->size - 1)];
+                p->next = head;
+                head = p;
+                p = next;
+            }
+            from->buckets[b] = nullptr;
+        }
+        s.tab = to;
+        if(from->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) destroy_table(from);
+    }
+
+    // 在key所在段的锁内调用f(找到的结点或nullptr)，f返回要插入的新结点或nullptr
+    // 插入以后这一段的元素个数超过它的bucket个数就扩容
+    template <class F>
+    bool modify(const key_type& key, F f) {
+        const size_type h = hash_of(key);
+        stripe& s = stripe_of(h);
+        table* t;
+        bool need_grow;
+        {
+            lock_guard guard(s.lock);
+            t = sync(s, h);
+            node_ptr& head = t->buckets[h & (t->size - 1)];
+            node_ptr x = f(find_node(t, h, key));
+            if(!x) return false;
+            x->hash_code = h;
+            x->next = head;
+            head = x;
+            need_grow = s.count.fetch_add(1, std::memory_order_relaxed) + 1 > t->size / stripe_count_;
+        }
+        if(need_grow) grow(t);
+        return true;
+    }
+
+    // seen为调用者看到的当前表，已经被别的线程替换了就不用再扩
+    // 别的线程正在扩容时直接返回false，否则返回true
+    bool grow(table* seen) {
+        bool expected = false;
+        if(!resizing_.compare_exchange_strong(expected, true, std::memory_order_acquire)) return false;
+        table* cur = cur_.load(std::memory_order_acquire);
+        if(cur != seen) {
+            resizing_.store(false, std::memory_order_release);
+            return true;
+        }
+        // 新表在锁外分配和清零，发布之后其他线程就会开始往里搬
+        table* t = create_table(cur->size * 2);
+        cur->pending.store(stripe_count_, std::memory_order_relaxed);
+        cur_.store(t, std::memory_order_release);
+        bucket_count_.store(t->size, std::memory_order_relaxed);
+        // 逐段搬完，其他线程先碰到的段已经由它们搬过了
+        for(size_type i = 0 ; i < stripe_count_ ; ++i) {
+            lock_guard guard(stripes_[i].lock);
+            sync(stripes_[i], i);
+        }
+        resizing_.store(false, std::memory_order_release);
+        return true;
+    }
+};
+
+}
+
+#endif
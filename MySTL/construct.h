@@ -3,6 +3,7 @@
 
 #include "type_traits.h"
 #include "iterator.h"
+#include "util.h"
 
 #include <new>
 
@@ -21,6 +22,12 @@ inline void construct(Tp1* ptr, const Tp2& value){
     ::new((void*)ptr) Tp1(value); // copy和普通ctor皆可
 }
 
+// 完美转发参数，支持移动构造和多参数构造
+template <class Tp, class... Args>
+inline void construct(Tp* ptr, Args&&... args) {
+    ::new((void*)ptr) Tp(mystl::forward<Args>(args)...);
+}
+
 // 显示的调用析构函数，完成对象的析构
 // 这里通过type_traits，分两个支线，一个调用dtor，另一个则不用调用，增加效率
 
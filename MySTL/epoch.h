@@ -0,0 +1,314 @@
+#ifndef __EPOCH_H__
+#define __EPOCH_H__
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "vector.h"
+#include "atomic_wait.h"
+
+// 这个文件定义了基于epoch的内存回收（EBR），供无锁读的并发容器使用
+
+/*
+* 每个domain有一个epoch计数，每个线程在用过的每个domain中有一个记录，读者进入临界区时在自己的记录上登记当前的epoch：
+*   enter  : 登记 (epoch << 1) | 1，seq_cst栅栏后再检查一次全局epoch，变了就重新登记
+*   exit   : 记录清零
+*   retire : 已经从数据结构中摘下、但可能还有读者在访问的对象，放进当前epoch对应的回收袋
+*
+* 只有当所有处于临界区中的线程都登记了当前epoch e时，全局epoch才能前进到 e + 1。
+* 在epoch e摘下的对象，等全局epoch到达 e + 2 时，摘下之前进入的读者一定都已经离开，可以释放。
+* 所以每个线程只需要三个回收袋，按 epoch % 3 轮换使用。
+*
+* 线程退出时把还没释放的对象交给domain的orphans_，由之后的回收者释放。
+* 读者只写自己的记录，不会和其他读者争用同一个缓存行。
+*/
+
+namespace mystl {
+
+// 每次retire多少个对象之后尝试推进epoch并回收
+#ifndef MYSTL_EPOCH_COLLECT_THRESHOLD
+#define MYSTL_EPOCH_COLLECT_THRESHOLD 64
+#endif
+
+// 一个等待回收的对象
+struct epoch_retired {
+    void* ptr;
+    void (*deleter)(void*);
+    uint64_t epoch;
+};
+
+// 每个线程一个记录，记录只会增加不会删除，线程退出后可以被新线程复用
+struct alignas(MYSTL_CACHE_LINE_SIZE) epoch_record {
+    std::atomic<uint64_t> state;       // (epoch << 1) | active
+    std::atomic<bool> in_use;
+    epoch_record* next;
+
+    // 以下只由拥有这个记录的线程访问
+    unsigned nesting;
+    unsigned retired_since_collect;
+    uint64_t bag_epoch[3];
+    mystl::vector<epoch_retired> bags[3];
+
+    epoch_record() : state(0), in_use(true), next(nullptr), nesting(0), retired_since_collect(0) {
+        bag_epoch[0] = bag_epoch[1] = bag_epoch[2] = 0;
+    }
+};
+
+class epoch_domain {
+private:
+    alignas(MYSTL_CACHE_LINE_SIZE) std::atomic<uint64_t> epoch_;
+    alignas(MYSTL_CACHE_LINE_SIZE) std::atomic<epoch_record*> records_;
+    std::mutex orphans_mutex_;
+    mystl::vector<epoch_retired> orphans_;
+
+    uint64_t id_;       // 进程内唯一、不复用，用来区分先后分配在同一地址上的domain
+
+    // 还没有析构的domain的id；线程退出归还记录和domain析构都在这把锁下进行，记录不会还给已经析构的domain
+    struct live_domains {
+        std::mutex mutex;
+        mystl::vector<uint64_t> ids;
+        uint64_t next_id;
+
+        live_domains() : next_id(1) {}
+
+        bool contains(uint64_t id) const {
+            for(size_t i = 0 ; i < ids.size() ; ++i) {
+                if(ids[i] == id) return true;
+            }
+            return false;
+        }
+    };
+
+    static live_domains& live() {
+        static live_domains domains;
+        return domains;
+    }
+
+    // 每个线程在每个用过的domain中各有一个记录，线程退出时归还
+    struct thread_entry {
+        epoch_domain* domain;
+        uint64_t id;
+        epoch_record* record;
+    };
+
+    struct thread_handle {
+        mystl::vector<thread_entry> entries;
+
+        ~thread_handle() {
+            if(entries.empty()) return;
+            live_domains& domains = live();
+            std::lock_guard<std::mutex> lock(domains.mutex);
+            for(size_t i = 0 ; i < entries.size() ; ++i) {
+                if(domains.contains(entries[i].id)) entries[i].domain->release_record(entries[i].record);
+            }
+        }
+    };
+
+    static thread_handle& local_handle() {
+        static thread_local thread_handle handle;
+        return handle;
+    }
+
+public:
+    epoch_domain() : epoch_(1), records_(nullptr) {
+        live_domains& domains = live();
+        std::lock_guard<std::mutex> lock(domains.mutex);
+        id_ = domains.next_id++;
+        domains.ids.push_back(id_);
+    }
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    // 析构时已经没有读者，所有待回收的对象直接释放
+    ~epoch_domain() {
+        {
+            live_domains& domains = live();
+            std::lock_guard<std::mutex> lock(domains.mutex);
+            for(size_t i = 0 ; i < domains.ids.size() ; ++i) {
+                if(domains.ids[i] == id_) {
+                    domains.ids.erase(domains.ids.begin() + i);
+                    break;
+                }
+            }
+        }
+        epoch_record* r = records_.load(std::memory_order_acquire);
+        while(r) {
+            epoch_record* next = r->next;
+            for(int i = 0 ; i < 3 ; ++i) free_bag(r->bags[i]);
+            delete r;
+            r = next;
+        }
+        free_bag(orphans_);
+    }
+
+    // 进程内默认共用一个domain，这样一个线程通常只需要一个记录
+    static epoch_domain& global() {
+        static epoch_domain domain;
+        return domain;
+    }
+
+    uint64_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+
+    // 当前线程在这个domain中的记录，第一次使用时分配
+    epoch_record* local_record() {
+        thread_handle& handle = local_handle();
+        for(size_t i = 0 ; i < handle.entries.size() ; ++i) {
+            if(handle.entries[i].domain == this && handle.entries[i].id == id_) return handle.entries[i].record;
+        }
+        return add_local_record(handle);
+    }
+
+    void enter() { enter(local_record()); }
+    void exit() { exit(local_record()); }
+
+    // 可以嵌套，只有最外层的enter登记epoch
+    void enter(epoch_record* r) {
+        if(r->nesting++ != 0) return;
+        uint64_t e = epoch_.load(std::memory_order_relaxed);
+        while(true) {
+            r->state.store((e << 1) | 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint64_t now = epoch_.load(std::memory_order_relaxed);
+            if(now == e) break;
+            e = now;
+        }
+    }
+
+    void exit(epoch_record* r) {
+        if(--r->nesting == 0) {
+            r->state.store(0, std::memory_order_release);
+        }
+    }
+
+    // ptr已经从数据结构中摘下，等所有可能看到它的读者离开后调用deleter(ptr)
+    void retire(void* ptr, void (*deleter)(void*)) {
+        epoch_record* r = local_record();
+        uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        int idx = static_cast<int>(e % 3);
+        if(r->bag_epoch[idx] != e) {
+            // 这个袋子里是 e - 3 或更早摘下的对象，已经可以释放
+            free_bag(r->bags[idx]);
+            r->bag_epoch[idx] = e;
+        }
+        r->bags[idx].push_back(epoch_retired{ ptr, deleter, e });
+        if(++r->retired_since_collect >= MYSTL_EPOCH_COLLECT_THRESHOLD) {
+            r->retired_since_collect = 0;
+            collect(r);
+        }
+    }
+
+    template <class T>
+    void retire(T* ptr) {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    // 所有活跃的线程都登记了当前epoch时前进一步，返回是否成功
+    bool try_advance() {
+        uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for(epoch_record* r = records_.load(std::memory_order_acquire) ; r ; r = r->next) {
+            uint64_t s = r->state.load(std::memory_order_seq_cst);
+            if((s & 1) && (s >> 1) != e) return false;
+        }
+        return epoch_.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+    }
+
+    // 推进epoch，释放当前线程以及orphans中已经安全的对象
+    void collect() { collect(local_record()); }
+
+private:
+    void collect(epoch_record* r) {
+        try_advance();
+        uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        for(int i = 0 ; i < 3 ; ++i) {
+            if(!r->bags[i].empty() && r->bag_epoch[i] + 2 <= e) free_bag(r->bags[i]);
+        }
+        if(orphans_mutex_.try_lock()) {
+            size_t keep = 0;
+            for(size_t i = 0 ; i < orphans_.size() ; ++i) {
+                if(orphans_[i].epoch + 2 <= e) orphans_[i].deleter(orphans_[i].ptr);
+                else orphans_[keep++] = orphans_[i];
+            }
+            orphans_.erase(orphans_.begin() + keep, orphans_.end());
+            orphans_mutex_.unlock();
+        }
+    }
+
+    static void free_bag(mystl::vector<epoch_retired>& bag) {
+        for(size_t i = 0 ; i < bag.size() ; ++i) bag[i].deleter(bag[i].ptr);
+        bag.clear();
+    }
+
+    // 顺便丢掉已经析构的domain留下的缓存项，它们的记录已经随domain释放
+    epoch_record* add_local_record(thread_handle& handle) {
+        {
+            live_domains& domains = live();
+            std::lock_guard<std::mutex> lock(domains.mutex);
+            size_t keep = 0;
+            for(size_t i = 0 ; i < handle.entries.size() ; ++i) {
+                if(domains.contains(handle.entries[i].id)) handle.entries[keep++] = handle.entries[i];
+            }
+            handle.entries.erase(handle.entries.begin() + keep, handle.entries.end());
+        }
+        epoch_record* r = acquire_record();
+        handle.entries.push_back(thread_entry{ this, id_, r });
+        return r;
+    }
+
+    // 优先复用退出线程留下的记录，没有再新建一个挂到链表头
+    epoch_record* acquire_record() {
+        for(epoch_record* r = records_.load(std::memory_order_acquire) ; r ; r = r->next) {
+            bool expected = false;
+            if(!r->in_use.load(std::memory_order_relaxed)
+                && r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        epoch_record* r = new epoch_record;
+        epoch_record* head = records_.load(std::memory_order_relaxed);
+        do {
+            r->next = head;
+        }while(!records_.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+        return r;
+    }
+
+    void release_record(epoch_record* r) {
+        r->nesting = 0;
+        r->state.store(0, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(orphans_mutex_);
+            for(int i = 0 ; i < 3 ; ++i) {
+                for(size_t j = 0 ; j < r->bags[i].size() ; ++j) orphans_.push_back(r->bags[i][j]);
+                r->bags[i].clear();
+                r->bag_epoch[i] = 0;
+            }
+        }
+        r->retired_since_collect = 0;
+        r->in_use.store(false, std::memory_order_release);
+    }
+};
+
+// RAII的读临界区，在guard存活期间读到的结点不会被释放
+// guard只能在创建它的线程上析构
+class epoch_guard {
+private:
+    epoch_record* record_;
+
+public:
+    epoch_guard() : record_(epoch_domain::global().local_record()) {
+        epoch_domain::global().enter(record_);
+    }
+    epoch_guard(const epoch_guard& rhs) : record_(rhs.record_) {
+        epoch_domain::global().enter(record_);
+    }
+    // 两边都处于临界区中，不需要做什么
+    epoch_guard& operator=(const epoch_guard&) { return *this; }
+    ~epoch_guard() {
+        epoch_domain::global().exit(record_);
+    }
+};
+
+}
+
+#endif
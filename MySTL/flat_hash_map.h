@@ -0,0 +1,226 @@
+#ifndef __FLAT_HASH_MAP_H__
+#define __FLAT_HASH_MAP_H__
+
+#include <initializer_list>
+
+#include "flat_hashtable.h"
+#include "functional.h"
+
+// 这个文件定义了flat_hash_map，接口和unordered_map相同，底层换成开放寻址的flat_hashtable
+// 元素直接存放在槽数组里，查找通常只需要读一组控制字节和一个槽
+// 注意：插入可能触发重新哈希，之前的迭代器、指针和引用都会失效；删除不影响其他元素
+
+namespace mystl {
+
+// 第一个参数为key，第二个参数为value，第三个参数为哈希函数，第四个参数为判断key是否相等
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+class flat_hash_map {
+private:
+    typedef flat_hashtable<Key, mystl::pair<Key, T>, Hash,
+                           mystl::select1st<mystl::pair<Key, T>>, KeyEqual> base_type;
+    base_type ht_;
+
+public:
+    typedef typename base_type::allocator_type       allocator_type;
+    typedef typename base_type::key_type             key_type;
+    typedef          T                               mapped_type;
+    typedef typename base_type::value_type           value_type;
+    typedef typename base_type::hasher               hasher;
+    typedef typename base_type::key_equal            key_equal;
+    typedef mystl::select1st<mystl::pair<Key, T>>    get_key;
+
+    typedef typename base_type::size_type            size_type;
+    typedef typename base_type::difference_type      difference_type;
+    typedef typename base_type::pointer              pointer;
+    typedef typename base_type::const_pointer        const_pointer;
+    typedef typename base_type::reference            reference;
+    typedef typename base_type::const_reference      const_reference;
+
+    typedef typename base_type::iterator             iterator;
+    typedef typename base_type::const_iterator       const_iterator;
+
+    allocator_type get_allocator() const { return ht_.get_allocator(); }
+
+public:
+    // 空表不分配内存
+    flat_hash_map() : ht_() { }
+
+    explicit flat_hash_map(size_type bucket_count,
+                           const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual())
+    : ht_(bucket_count, hash, equal, get_key()) { }
+
+    template <class Iterator>
+    flat_hash_map(Iterator first, Iterator last,
+                  size_type bucket_count = 0,
+                  const Hash& hash = Hash(),
+                  const KeyEqual& equal = KeyEqual())
+    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))),
+          hash, equal, get_key()) {
+        ht_.insert_unique(first, last);
+    }
+
+    flat_hash_map(std::initializer_list<value_type> ilist,
+                  size_type bucket_count = 0,
+                  const Hash& hash = Hash(),
+                  const KeyEqual& equal = KeyEqual())
+    : ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())),
+          hash, equal, get_key()) {
+        ht_.insert_unique(ilist.begin(), ilist.end());
+    }
+
+    flat_hash_map(const flat_hash_map& rhs) : ht_(rhs.ht_) { }
+
+    flat_hash_map(flat_hash_map&& rhs) noexcept : ht_(mystl::move(rhs.ht_)) { }
+
+    flat_hash_map& operator=(const flat_hash_map& rhs) {
+        ht_ = rhs.ht_;
+        return *this;
+    }
+
+    flat_hash_map& operator=(flat_hash_map&& rhs) noexcept {
+        ht_ = mystl::move(rhs.ht_);
+        return *this;
+    }
+
+    flat_hash_map& operator=(std::initializer_list<value_type> ilist) {
+        ht_.clear();
+        ht_.reserve(ilist.size());
+        ht_.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    ~flat_hash_map() = default;
+
+public:
+    // 迭代器
+    iterator        begin()         { return ht_.begin(); }
+    const_iterator  begin() const   { return ht_.begin(); }
+    iterator        end()           { return ht_.end(); }
+    const_iterator  end()   const   { return ht_.end(); }
+
+    const_iterator  cbegin()    const { return ht_.cbegin(); }
+    const_iterator  cend()      const { return ht_.cend(); }
+
+    // 容量相关
+    bool        empty()     const { return ht_.empty(); }
+    size_type   size()      const { return ht_.size(); }
+    size_type   max_size()  const { return ht_.max_size(); }
+
+    // insert
+    pair<iterator, bool> insert(const value_type& value) {
+        return ht_.insert_unique(value);
+    }
+
+    pair<iterator, bool> insert(value_type&& value) {
+        return ht_.insert_unique(mystl::move(value));
+    }
+
+    template <class Iterator>
+    void insert(Iterator first, Iterator last) {
+        ht_.insert_unique(first, last);
+    }
+
+    // key不存在时插入<key, obj>，存在时不做修改
+    pair<iterator, bool> try_emplace(const key_type& key, const mapped_type& obj) {
+        return ht_.try_emplace(key, key, obj);
+    }
+
+    // erase
+    iterator erase(const_iterator it) {
+        return ht_.erase(it);
+    }
+
+    size_type erase(const key_type& key) {
+        return ht_.erase(key);
+    }
+
+    void erase(const_iterator first, const_iterator last) {
+        ht_.erase(first, last);
+    }
+
+    void clear() {
+        ht_.clear();
+    }
+
+    void swap(flat_hash_map& other) {
+        ht_.swap(other.ht_);
+    }
+
+    // 查找相关
+
+    mapped_type& at(const key_type& key) {
+        iterator it = ht_.find(key);
+        THROW_OUT_OF_RANGE_IF(it == ht_.end(), "flat_hash_map<Key, T> no such element.\n");
+        return it->second;
+    }
+
+    const mapped_type& at(const key_type& key) const {
+        const_iterator it = ht_.find(key);
+        THROW_OUT_OF_RANGE_IF(it == ht_.end(), "flat_hash_map<Key, T> no such element.\n");
+        return it->second;
+    }
+
+    // 只哈希、探测一次，key不存在时直接在找到的槽里构造默认值
+    mapped_type& operator[](const key_type& key) {
+        return ht_.try_emplace(key, key, mapped_type()).first->second;
+    }
+
+    size_type count(const key_type& key) const {
+        return ht_.count(key);
+    }
+
+    bool contains(const key_type& key) const {
+        return ht_.find(key) != ht_.end();
+    }
+
+    iterator find(const key_type& key) {
+        return ht_.find(key);
+    }
+
+    const_iterator find(const key_type& key) const {
+        return ht_.find(key);
+    }
+
+    pair<iterator, iterator> equal_range(const key_type& key) {
+        return ht_.equal_range(key);
+    }
+
+    // 异构查找，hasher和key_equal都定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = typename base_type::template if_transparent<K>>
+    iterator find(const K& key) { return ht_.find(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    const_iterator find(const K& key) const { return ht_.find(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    size_type count(const K& key) const { return ht_.count(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    bool contains(const K& key) const { return ht_.find(key) != ht_.end(); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    pair<iterator, iterator> equal_range(const K& key) { return ht_.equal_range(key); }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return ht_.erase(key); }
+
+    // bucket，每个槽就是一个bucket
+    void resize(size_type hint) { ht_.resize(hint); }
+    void reserve(size_type n) { ht_.reserve(n); }
+
+    size_type bucket_count() const { return ht_.bucket_count(); }
+
+    size_type max_bucket_count() const { return ht_.max_bucket_count(); }
+
+    size_type elems_in_bucket(size_type bucket_idx) const {
+        return ht_.elems_in_bucket(bucket_idx);
+    }
+
+    float load_factor() const { return ht_.load_factor(); }
+};
+
+template <class Key, class T, class Hash, class KeyEqual>
+void swap(flat_hash_map<Key, T, Hash, KeyEqual>& lhs,
+          flat_hash_map<Key, T, Hash, KeyEqual>& rhs) {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef __FLAT_HASH_SET_H__
+#define __FLAT_HASH_SET_H__
+
+#include <initializer_list>
+
+#include "flat_hashtable.h"
+#include "functional.h"
+
+// 这个文件定义了flat_hash_set，接口和unordered_set相同，底层换成开放寻址的flat_hashtable
+// 注意：插入可能触发重新哈希，之前的迭代器、指针和引用都会失效；删除不影响其他元素
+
+namespace mystl {
+
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+class flat_hash_set {
+private:
+    // KeyofValue为identity
+    typedef flat_hashtable<Key, Key, Hash, mystl::identity<Key>, KeyEqual> base_type;
+    base_type   ht_;
+
+public:
+    typedef typename base_type::allocator_type      allocator_type;
+    typedef typename base_type::key_type            key_type;
+    typedef typename base_type::value_type          value_type;
+    typedef typename base_type::hasher              hasher;
+    typedef typename base_type::key_equal           key_equal;
+    typedef mystl::identity<Key>                    get_key;
+
+    typedef typename base_type::size_type           size_type;
+    typedef typename base_type::difference_type     difference_type;
+    typedef typename base_type::const_pointer       pointer;
+    typedef typename base_type::const_pointer       const_pointer;
+    typedef typename base_type::const_reference     reference;
+    typedef typename base_type::const_reference     const_reference;
+
+    // set中的元素不能通过迭代器修改
+    typedef typename base_type::const_iterator      iterator;
+    typedef typename base_type::const_iterator      const_iterator;
+
+    allocator_type get_allocator() const { return ht_.get_allocator(); }
+
+public:
+    // 空表不分配内存
+    flat_hash_set() : ht_() {}
+
+    explicit flat_hash_set(size_type bucket_count,
+                           const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual())
+    : ht_(bucket_count, hash, equal, get_key()) { }
+
+    template <class Iterator>
+    flat_hash_set(Iterator first, Iterator last,
+                  const size_type& bucket_count = 0,
+                  const Hash& hash = Hash(),
+                  const KeyEqual& equal = KeyEqual())
+    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))),
+          hash, equal, get_key()) {
+        ht_.insert_unique(first, last);
+    }
+
+    flat_hash_set(std::initializer_list<Key> ilist,
+                  const size_type& bucket_count = 0,
+                  const Hash& hash = Hash(),
+                  const KeyEqual& equal = KeyEqual())
+    : ht_(mystl::max(bucket_count, static_cast<size_type>(ilist.size())),
+          hash, equal, get_key()) {
+        ht_.insert_unique(ilist.begin(), ilist.end());
+    }
+
+    flat_hash_set(const flat_hash_set& rhs) : ht_(rhs.ht_) { }
+
+    flat_hash_set(flat_hash_set&& rhs) noexcept : ht_(mystl::move(rhs.ht_)) { }
+
+    flat_hash_set& operator=(const flat_hash_set& rhs) {
+        ht_ = rhs.ht_;
+        return *this;
+    }
+
+    flat_hash_set& operator=(flat_hash_set&& rhs) noexcept {
+        ht_ = mystl::move(rhs.ht_);
+        return *this;
+    }
+
+    flat_hash_set& operator=(std::initializer_list<value_type> ilist) {
+        ht_.clear();
+        ht_.reserve(ilist.size());
+        ht_.insert_unique(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    ~flat_hash_set() = default;
+
+public:
+    // 迭代器相关
+    iterator        begin()     const   { return ht_.begin(); }
+    iterator        end()       const   { return ht_.end(); }
+
+    const_iterator  cbegin()    const   { return ht_.begin(); }
+    const_iterator  cend()      const   { return ht_.end(); }
+
+    // 容量相关
+    bool        empty()     const { return ht_.empty(); }
+    size_type   size()      const { return ht_.size(); }
+    size_type   max_size()  const { return ht_.max_size(); }
+
+    // insert <iterator, bool> 因为不允许重复
+    pair<iterator, bool> insert(const value_type& value) {
+        auto p = ht_.insert_unique(value);
+        return pair<iterator, bool>(p.first, p.second);
+    }
+
+    pair<iterator, bool> insert(value_type&& value) {
+        auto p = ht_.insert_unique(mystl::move(value));
+        return pair<iterator, bool>(p.first, p.second);
+    }
+
+    template <class Iterator>
+    void insert(Iterator first, Iterator last) {
+        ht_.insert_unique(first, last);
+    }
+
+    // erase
+    size_type erase(const key_type& key) {
+        return ht_.erase(key);
+    }
+
+    iterator erase(const_iterator it) {
+        return ht_.erase(it);
+    }
+
+    void erase(const_iterator first, const_iterator last) {
+        ht_.erase(first, last);
+    }
+
+    iterator find(const key_type& key) const {
+        return ht_.find(key);
+    }
+
+    size_type count(const key_type& key) const {
+        return ht_.count(key);
+    }
+
+    bool contains(const key_type& key) const {
+        return ht_.find(key) != ht_.end();
+    }
+
+    pair<iterator, iterator> equal_range(const key_type& key) {
+        auto p = ht_.equal_range(key);
+        return pair<iterator, iterator>(p.first, p.second);
+    }
+
+    // 异构查找，hasher和key_equal都定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = typename base_type::template if_transparent<K>>
+    iterator find(const K& key) const { return ht_.find(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    size_type count(const K& key) const { return ht_.count(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    bool contains(const K& key) const { return ht_.find(key) != ht_.end(); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    pair<iterator, iterator> equal_range(const K& key) {
+        auto p = ht_.equal_range(key);
+        return pair<iterator, iterator>(p.first, p.second);
+    }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return ht_.erase(key); }
+
+    void swap(flat_hash_set& other) {
+        ht_.swap(other.ht_);
+    }
+
+    void clear() { ht_.clear(); }
+
+public:
+    // 关于buckets的函数，每个槽就是一个bucket
+    void resize(size_type hint) { ht_.resize(hint); }
+    void reserve(size_type n) { ht_.reserve(n); }
+    size_type bucket_count() const { return ht_.bucket_count(); }
+    size_type max_bucket_count() const { return ht_.max_bucket_count(); }
+    size_type elems_in_bucket(size_type bucket_idx) const {
+        return ht_.elems_in_bucket(bucket_idx);
+    }
+    float load_factor() const { return ht_.load_factor(); }
+};
+
+template <class Key, class Hash, class KeyEqual>
+void swap(flat_hash_set<Key, Hash, KeyEqual>& lhs,
+          flat_hash_set<Key, Hash, KeyEqual>& rhs) {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
@@ -0,0 +1,635 @@
+#ifndef __FLAT_HASHTABLE_H__
+#define __FLAT_HASHTABLE_H__
+
+#include <initializer_list>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#if defined(__SSE2__) && !defined(MYSTL_FLAT_HASH_NO_SSE2)
+#include <emmintrin.h>
+#endif
+
+#include "allocator.h"
+#include "construct.h"
+#include "algobase.h"
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+#include "exceptdef.h"
+
+// 这个文件定义了开放寻址的哈希表 flat_hashtable（Swiss table），flat_hash_map和flat_hash_set的底层
+
+/*
+* 元素直接存放在槽数组 slots_ 中，不再为每个元素单独分配结点。每个槽对应一个字节的控制信息 ctrl_：
+*   empty    (-128)  空槽
+*   deleted  (-2)    墓碑，元素被删除，但查找不能在这里停下
+*   sentinel (-1)    ctrl_[capacity_]，迭代器在这里结束
+*   0 ~ 127          有元素，存放哈希值的低7位 H2
+*
+* 查找时用哈希值的其余位 H1 定位起点，一次比较一组（SSE2下16个，否则8个）控制字节：
+* 先用H2筛选候选槽，只有H2相同的槽才去比较key；组内出现empty说明key不存在。
+* 大部分查找只读一组控制字节、比较一次key，而拉链法每走一个结点都是一次cache miss。
+*
+* 容量总是 2^k - 1，控制字节数组末尾再复制开头的 width - 1 个字节，从任意位置都能读出完整的一组。
+* 删除时，如果这个槽前后的组都有空槽，说明没有查找曾经越过它，直接标记为empty而不留墓碑。
+* 插入和扩容会移动元素，迭代器、指针和引用都会失效；删除不会移动其他元素。
+*
+* H1和H2都要求哈希值的每一位分布均匀。哈希函数定义了is_avalanching（例如mystl::hash）时直接使用，
+* 否则（例如直接返回整数本身的哈希函数）先用flat_hash_mix再混合一次。
+*/
+
+namespace mystl {
+
+typedef signed char flat_hash_ctrl_t;
+
+const flat_hash_ctrl_t flat_hash_empty = -128;
+const flat_hash_ctrl_t flat_hash_deleted = -2;
+const flat_hash_ctrl_t flat_hash_sentinel = -1;
+
+inline bool flat_hash_is_full(flat_hash_ctrl_t c) { return c >= 0; }
+inline bool flat_hash_is_empty_or_deleted(flat_hash_ctrl_t c) { return c < flat_hash_sentinel; }
+
+// 容量为0的表指向这一组控制字节，不需要分配内存，查找时直接遇到empty
+alignas(16) inline flat_hash_ctrl_t flat_hash_empty_group[16] = {
+    flat_hash_sentinel, flat_hash_empty, flat_hash_empty, flat_hash_empty,
+    flat_hash_empty,    flat_hash_empty, flat_hash_empty, flat_hash_empty,
+    flat_hash_empty,    flat_hash_empty, flat_hash_empty, flat_hash_empty,
+    flat_hash_empty,    flat_hash_empty, flat_hash_empty, flat_hash_empty
+};
+
+// 把哈希值的每一位都混合到高位和低位
+inline size_t flat_hash_mix(size_t h) {
+#if defined(__SIZEOF_INT128__) && SIZE_MAX == UINT64_MAX
+    __uint128_t m = static_cast<__uint128_t>(h) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(m) ^ static_cast<size_t>(m >> 64);
+#else
+    h ^= h >> 15;
+    h *= 0x2c1b3c6dU;
+    h ^= h >> 12;
+    h *= 0x297a2d39U;
+    h ^= h >> 15;
+    return h;
+#endif
+}
+
+inline int flat_hash_ctz(uint32_t x) { return __builtin_ctz(x); }
+inline int flat_hash_ctz(uint64_t x) { return __builtin_ctzll(x); }
+inline int flat_hash_clz(uint32_t x) { return __builtin_clz(x); }
+inline int flat_hash_clz(uint64_t x) { return __builtin_clzll(x); }
+
+// 一组控制字节的匹配结果，每个槽占 2^Shift 位
+template <class T, int Width, int Shift>
+struct flat_hash_bitmask {
+    T mask;
+
+    explicit flat_hash_bitmask(T m) : mask(m) {}
+    explicit operator bool() const { return mask != 0; }
+
+    // 以下要求mask不为0
+    size_t lowest() const { return static_cast<size_t>(flat_hash_ctz(mask)) >> Shift; }
+    void clear_lowest() { mask &= mask - 1; }
+    size_t trailing_zeros() const { return lowest(); }
+    size_t leading_zeros() const {
+        const int extra = static_cast<int>(sizeof(T) * CHAR_BIT) - (Width << Shift);
+        return static_cast<size_t>(flat_hash_clz(mask) - extra) >> Shift;
+    }
+};
+
+#if defined(__SSE2__) && !defined(MYSTL_FLAT_HASH_NO_SSE2)
+
+// SSE2：一次比较16个控制字节
+struct flat_hash_group {
+    static constexpr size_t width = 16;
+    typedef flat_hash_bitmask<uint32_t, 16, 0> bitmask;
+
+    __m128i ctrl;
+
+    explicit flat_hash_group(const flat_hash_ctrl_t* pos)
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    bitmask match(flat_hash_ctrl_t h2) const {
+        return bitmask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))));
+    }
+    bitmask match_empty() const {
+        return match(flat_hash_empty);
+    }
+    bitmask match_empty_or_deleted() const {
+        return bitmask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(flat_hash_sentinel), ctrl))));
+    }
+    // 从这一组开头起连续的empty或deleted的个数
+    size_t count_leading_empty_or_deleted() const {
+        return static_cast<size_t>(flat_hash_ctz(~match_empty_or_deleted().mask));
+    }
+};
+
+#else
+
+// 没有SSE2时把8个控制字节当作一个uint64_t，用位运算并行比较
+struct flat_hash_group {
+    static constexpr size_t width = 8;
+    typedef flat_hash_bitmask<uint64_t, 8, 3> bitmask;
+
+    static constexpr uint64_t lsbs = 0x0101010101010101ull;
+    static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+    uint64_t ctrl;
+
+    explicit flat_hash_group(const flat_hash_ctrl_t* pos) {
+        std::memcpy(&ctrl, pos, sizeof(ctrl));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        ctrl = __builtin_bswap64(ctrl);
+#endif
+    }
+
+    // 可能有假阳性（只会出现在真正匹配的字节之后），调用方总会再比较key
+    bitmask match(flat_hash_ctrl_t h2) const {
+        uint64_t x = ctrl ^ (lsbs * static_cast<unsigned char>(h2));
+        return bitmask((x - lsbs) & ~x & msbs);
+    }
+    // empty是10000000：最高位为1，第1位为0
+    bitmask match_empty() const {
+        return bitmask((ctrl & ~(ctrl << 6)) & msbs);
+    }
+    // empty和deleted：最高位为1，最低位为0
+    bitmask match_empty_or_deleted() const {
+        return bitmask((ctrl & ~(ctrl << 7)) & msbs);
+    }
+    size_t count_leading_empty_or_deleted() const {
+        const uint64_t gaps = 0x00FEFEFEFEFEFEFEull;
+        return static_cast<size_t>((flat_hash_ctz(((~ctrl & (ctrl >> 7)) | gaps) + 1) + 7) >> 3);
+    }
+};
+
+#endif
+
+// 迭代器同时指向控制字节和槽，V为const value_type时是常量迭代器
+template <class Value, class V>
+struct flat_hashtable_iterator {
+    typedef flat_hashtable_iterator<Value, Value>          iterator;
+    typedef flat_hashtable_iterator<Value, const Value>    const_iterator;
+    typedef flat_hashtable_iterator                        self;
+
+    typedef forward_iterator_tag    iterator_category;
+    typedef Value                   value_type;
+    typedef ptrdiff_t               difference_type;
+    typedef size_t                  size_type;
+    typedef V*                      pointer;
+    typedef V&                      reference;
+
+    flat_hash_ctrl_t*   ctrl;
+    Value*              slot;
+
+    flat_hashtable_iterator() : ctrl(nullptr), slot(nullptr) {}
+    flat_hashtable_iterator(flat_hash_ctrl_t* c, Value* s) : ctrl(c), slot(s) {}
+    flat_hashtable_iterator(const iterator& rhs) : ctrl(rhs.ctrl), slot(rhs.slot) {}
+
+    reference   operator*()     const { return *slot; }
+    pointer     operator->()    const { return slot; }
+
+    self& operator++() {
+        ++ctrl;
+        ++slot;
+        skip_empty_or_deleted();
+        return *this;
+    }
+    self operator++(int) {
+        self tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const { return ctrl == rhs.ctrl; }
+    bool operator!=(const self& rhs) const { return ctrl != rhs.ctrl; }
+
+    // 跳过空槽和墓碑，遇到元素或者sentinel停下
+    void skip_empty_or_deleted() {
+        while(flat_hash_is_empty_or_deleted(*ctrl)) {
+            size_t shift = flat_hash_group(ctrl).count_leading_empty_or_deleted();
+            ctrl += shift;
+            slot += shift;
+        }
+    }
+};
+
+// 哈希表，第一个参数是key，第二个参数是槽中存放的值，第三个参数是对key进行散列函数，第四个参数是对value提取key，第五个参数是判断key是否相等
+// 只支持不重复的key
+template <class Key, class Value, class HashFun = mystl::hash<Key>,
+          class KeyOfValue = mystl::identity<Value>, class EqualKey = mystl::equal_to<Key>>
+class flat_hashtable {
+public:
+    typedef     Key                         key_type;
+    typedef     Value                       value_type;
+    typedef     HashFun                     hasher;
+    typedef     EqualKey                    key_equal;
+
+    typedef     size_t              size_type;
+    typedef     ptrdiff_t           difference_type;
+    typedef     value_type*         pointer;
+    typedef     const value_type*   const_pointer;
+    typedef     value_type&         reference;
+    typedef     const value_type&   const_reference;
+
+    typedef     mystl::allocator<Value>             allocator_type;
+    typedef     mystl::allocator<Value>             data_allocator;
+    typedef     mystl::allocator<flat_hash_ctrl_t>  ctrl_allocator;
+
+    typedef flat_hashtable_iterator<Value, Value>          iterator;
+    typedef flat_hashtable_iterator<Value, const Value>    const_iterator;
+
+    hasher      hash_funct()    const { return  hash_; }
+    key_equal   key_eq()        const { return  equals_; }
+    KeyOfValue  get_key()       const { return  get_key_; }
+
+    allocator_type  get_allocator() const { return allocator_type(); }
+
+private:
+    static constexpr size_type width = flat_hash_group::width;
+
+    hasher              hash_;
+    key_equal           equals_;
+    KeyOfValue          get_key_;
+    flat_hash_ctrl_t*   ctrl_;          // capacity_ + width 个控制字节
+    value_type*         slots_;         // capacity_ 个槽
+    size_type           capacity_;      // 0 或者 2^k - 1
+    size_type           size_;
+    size_type           growth_left_;   // 还能往空槽里插入多少个元素而不用重新哈希
+
+public:
+    flat_hashtable() : hash_(), equals_(), get_key_() {
+        init_empty();
+    }
+
+    // n为预计的元素个数
+    flat_hashtable(size_type n, const hasher& hf, const key_equal& eql, const KeyOfValue& kov)
+        : hash_(hf), equals_(eql), get_key_(kov) {
+        init_empty();
+        reserve(n);
+    }
+
+    flat_hashtable(const flat_hashtable& rhs)
+        : hash_(rhs.hash_), equals_(rhs.equals_), get_key_(rhs.get_key_) {
+        init_empty();
+        copy_from(rhs);
+    }
+
+    flat_hashtable(flat_hashtable&& rhs) noexcept
+        : hash_(rhs.hash_), equals_(rhs.equals_), get_key_(rhs.get_key_),
+          ctrl_(rhs.ctrl_), slots_(rhs.slots_), capacity_(rhs.capacity_),
+          size_(rhs.size_), growth_left_(rhs.growth_left_) {
+        rhs.init_empty();
+    }
+
+    flat_hashtable& operator=(const flat_hashtable& rhs) {
+        if(&rhs != this) {
+            flat_hashtable tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    flat_hashtable& operator=(flat_hashtable&& rhs) noexcept {
+        if(&rhs != this) {
+            destroy_table();
+            hash_ = rhs.hash_;
+            equals_ = rhs.equals_;
+            get_key_ = rhs.get_key_;
+            ctrl_ = rhs.ctrl_;
+            slots_ = rhs.slots_;
+            capacity_ = rhs.capacity_;
+            size_ = rhs.size_;
+            growth_left_ = rhs.growth_left_;
+            rhs.init_empty();
+        }
+        return *this;
+    }
+
+    ~flat_hashtable() { destroy_table(); }
+
+    // 迭代器
+    iterator        begin()         { iterator it(ctrl_, slots_); it.skip_empty_or_deleted(); return it; }
+    const_iterator  begin() const   { return const_cast<flat_hashtable*>(this)->begin(); }
+    iterator        end()           { return iterator(ctrl_ + capacity_, slots_ + capacity_); }
+    const_iterator  end()   const   { return const_cast<flat_hashtable*>(this)->end(); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend()   const { return end(); }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type max_size() const { return static_cast<size_type>(-1) / sizeof(value_type); }
+
+    void swap(flat_hashtable& rhs) noexcept {
+        mystl::swap(hash_, rhs.hash_);
+        mystl::swap(equals_, rhs.equals_);
+        mystl::swap(get_key_, rhs.get_key_);
+        mystl::swap(ctrl_, rhs.ctrl_);
+        mystl::swap(slots_, rhs.slots_);
+        mystl::swap(capacity_, rhs.capacity_);
+        mystl::swap(size_, rhs.size_);
+        mystl::swap(growth_left_, rhs.growth_left_);
+    }
+
+public:
+    // 槽的个数，对应拉链法中bucket的个数
+    size_type bucket_count() const { return capacity_; }
+    size_type max_bucket_count() const { return max_size(); }
+    // 开放寻址每个槽最多一个元素
+    size_type elems_in_bucket(size_type n) const {
+        return n < capacity_ && flat_hash_is_full(ctrl_[n]) ? 1 : 0;
+    }
+    float load_factor() const { return capacity_ ? static_cast<float>(size_) / capacity_ : 0.0f; }
+
+    // 保证插入到n个元素之前不会重新哈希
+    void reserve(size_type n) {
+        if(n <= size_ + growth_left_) return;
+        size_type cap = 1;
+        while(capacity_to_growth(cap) < n) cap = cap * 2 + 1;
+        rehash_to(cap);
+    }
+    void resize(size_type num_elems_hint) { reserve(num_elems_hint); }
+
+    // insert
+    mystl::pair<iterator, bool> insert_unique(const value_type& value) {
+        return try_emplace(get_key_(value), value);
+    }
+    mystl::pair<iterator, bool> insert_unique(value_type&& value) {
+        return try_emplace(get_key_(value), mystl::move(value));
+    }
+
+    template <class Iterator>
+    void insert_unique(Iterator first, Iterator last) {
+        for( ; first != last ; ++first) insert_unique(*first);
+    }
+
+    // key不存在时才用args构造value_type，返回指向key的迭代器和是否插入
+    template <class K, class... Args>
+    mystl::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        const size_t hash = hash_of(key);
+        size_type index = find_index(key, hash);
+        if(index != capacity_) return mystl::pair<iterator, bool>(iterator_at(index), false);
+        index = prepare_insert(hash);
+        try {
+            mystl::construct(slots_ + index, mystl::forward<Args>(args)...);
+        }catch(...) {
+            erase_meta(index);
+            throw;
+        }
+        return mystl::pair<iterator, bool>(iterator_at(index), true);
+    }
+
+    // 异构查找：hasher和key_equal都定义了is_transparent时，查找和删除接受任意K，
+    // 要求hash_(K)和hash_(key_type)对相等的键值给出相同的结果
+    template <class K>
+    using if_transparent = enable_if_transparent_t<hasher, K, enable_if_transparent_t<key_equal, K>>;
+    template <class K>
+    using if_transparent_key = typename std::enable_if<!std::is_convertible<K, iterator>::value &&
+                                                       !std::is_convertible<K, const_iterator>::value,
+                                                       if_transparent<K>>::type;
+
+    // erase，不移动其他元素，返回下一个元素的迭代器
+    iterator erase(const_iterator it) {
+        iterator next(it.ctrl, it.slot);
+        ++next;
+        erase_at(static_cast<size_type>(it.ctrl - ctrl_));
+        return next;
+    }
+    void erase(const_iterator first, const_iterator last) {
+        while(first != last) first = erase(first);
+    }
+    size_type erase(const key_type& key) { return erase_key(key); }
+    template <class K, class = if_transparent_key<K>>
+    size_type erase(const K& key) { return erase_key(key); }
+
+    // find
+    iterator find(const key_type& key) { return iterator_at(find_index(key, hash_of(key))); }
+    const_iterator find(const key_type& key) const { return const_cast<flat_hashtable*>(this)->find(key); }
+    template <class K, class = if_transparent<K>>
+    iterator find(const K& key) { return iterator_at(find_index(key, hash_of(key))); }
+    template <class K, class = if_transparent<K>>
+    const_iterator find(const K& key) const { return const_cast<flat_hashtable*>(this)->find(key); }
+
+    size_type count(const key_type& key) const { return find(key) != end() ? 1 : 0; }
+    template <class K, class = if_transparent<K>>
+    size_type count(const K& key) const { return find(key) != end() ? 1 : 0; }
+
+    mystl::pair<iterator, iterator>
+    equal_range(const key_type& key) { return equal_range_key(key); }
+    template <class K, class = if_transparent<K>>
+    mystl::pair<iterator, iterator>
+    equal_range(const K& key) { return equal_range_key(key); }
+
+    // 析构所有元素，保留容量
+    void clear() {
+        if(capacity_ == 0) return;
+        destroy_slots();
+        reset_ctrl();
+        size_ = 0;
+        growth_left_ = capacity_to_growth(capacity_);
+    }
+
+private:
+    // 容量为capacity时最多放多少个元素，负载因子7/8
+    static size_type capacity_to_growth(size_type capacity) {
+        if(width == 8 && capacity == 7) return 6;   // 否则8个控制字节可能全满，查找停不下来
+        return capacity - capacity / 8;
+    }
+
+    template <class K>
+    size_t hash_of(const K& key) const {
+        if(is_avalanching<hasher>::value) return hash_(key);
+        return flat_hash_mix(hash_(key));
+    }
+
+    static size_t h1(size_t hash) { return hash >> 7; }
+    static flat_hash_ctrl_t h2(size_t hash) { return static_cast<flat_hash_ctrl_t>(hash & 0x7F); }
+
+    void init_empty() {
+        ctrl_ = flat_hash_empty_group;
+        slots_ = nullptr;
+        capacity_ = 0;
+        size_ = 0;
+        growth_left_ = 0;
+    }
+
+    iterator iterator_at(size_type index) { return iterator(ctrl_ + index, slots_ + index); }
+
+    // 设置控制字节，同时更新末尾的副本
+    void set_ctrl(size_type index, flat_hash_ctrl_t h) {
+        ctrl_[index] = h;
+        ctrl_[((index - (width - 1)) & capacity_) + ((width - 1) & capacity_)] = h;
+    }
+
+    void reset_ctrl() {
+        std::memset(ctrl_, static_cast<unsigned char>(flat_hash_empty), capacity_ + width);
+        ctrl_[capacity_] = flat_hash_sentinel;
+    }
+
+    void destroy_slots() {
+        for(size_type i = 0 ; i < capacity_ ; ++i) {
+            if(flat_hash_is_full(ctrl_[i])) mystl::destroy(slots_ + i);
+        }
+    }
+
+    void destroy_table() {
+        if(capacity_ == 0) return;
+        destroy_slots();
+        ctrl_allocator::deallocate(ctrl_);
+        data_allocator::deallocate(slots_);
+        init_empty();
+    }
+
+    // 查找key所在的槽，没有则返回capacity_
+    // 探测序列以组为单位按三角数跳跃：offset, offset + w, offset + 3w, offset + 6w ...，会经过所有的组
+    template <class K>
+    size_type find_index(const K& key, size_t hash) const {
+        const flat_hash_ctrl_t tag = h2(hash);
+        size_type offset = h1(hash) & capacity_;
+        size_type step = 0;
+        while(true) {
+            flat_hash_group g(ctrl_ + offset);
+            for(auto match = g.match(tag) ; match ; match.clear_lowest()) {
+                size_type index = (offset + match.lowest()) & capacity_;
+                if(equals_(get_key_(slots_[index]), key)) return index;
+            }
+            if(g.match_empty()) return capacity_;
+            step += width;
+            offset = (offset + step) & capacity_;
+            MYSTL_DEBUG(step <= capacity_ + width);
+        }
+    }
+
+    // 探测序列上第一个empty或deleted的槽
+    size_type find_first_non_full(size_t hash) const {
+        size_type offset = h1(hash) & capacity_;
+        size_type step = 0;
+        while(true) {
+            auto mask = flat_hash_group(ctrl_ + offset).match_empty_or_deleted();
+            if(mask) return (offset + mask.lowest()) & capacity_;
+            step += width;
+            offset = (offset + step) & capacity_;
+        }
+    }
+
+    // 为一个新元素找到槽并写好控制字节，必要时扩容或者清理墓碑，返回槽的下标
+    size_type prepare_insert(size_t hash) {
+        size_type index = find_first_non_full(hash);
+        if(growth_left_ == 0 && ctrl_[index] != flat_hash_deleted) {
+            rehash_and_grow_if_necessary();
+            index = find_first_non_full(hash);
+        }
+        if(ctrl_[index] == flat_hash_empty) --growth_left_;     // 复用墓碑不占用新的空槽
+        ++size_;
+        set_ctrl(index, h2(hash));
+        return index;
+    }
+
+    // 墓碑很多时原地大小重新哈希就能腾出空槽，否则容量翻倍
+    void rehash_and_grow_if_necessary() {
+        if(capacity_ == 0) rehash_to(1);
+        else if(size_ <= capacity_ / 32 * 25) rehash_to(capacity_);
+        else rehash_to(capacity_ * 2 + 1);
+    }
+
+    // 分配new_capacity个槽，把元素移过去，同时去掉所有墓碑
+    void rehash_to(size_type new_capacity) {
+        flat_hash_ctrl_t* old_ctrl = ctrl_;
+        value_type* old_slots = slots_;
+        const size_type old_capacity = capacity_;
+
+        ctrl_ = ctrl_allocator::allocate(new_capacity + width);
+        try {
+            slots_ = data_allocator::allocate(new_capacity);
+        }catch(...) {
+            ctrl_allocator::deallocate(ctrl_);
+            ctrl_ = old_ctrl;
+            throw;
+        }
+        capacity_ = new_capacity;
+        reset_ctrl();
+        growth_left_ = capacity_to_growth(capacity_) - size_;
+
+        for(size_type i = 0 ; i < old_capacity ; ++i) {
+            if(!flat_hash_is_full(old_ctrl[i])) continue;
+            const size_t hash = hash_of(get_key_(old_slots[i]));
+            size_type index = find_first_non_full(hash);
+            set_ctrl(index, h2(hash));
+            mystl::construct(slots_ + index, mystl::move(old_slots[i]));
+            mystl::destroy(old_slots + i);
+        }
+        if(old_capacity != 0) {
+            ctrl_allocator::deallocate(old_ctrl);
+            data_allocator::deallocate(old_slots);
+        }
+    }
+
+    // 容量相同，控制字节整段复制，元素在相同的槽里拷贝构造
+    void copy_from(const flat_hashtable& rhs) {
+        if(rhs.size_ == 0) return;
+        ctrl_ = ctrl_allocator::allocate(rhs.capacity_ + width);
+        slots_ = data_allocator::allocate(rhs.capacity_);
+        size_type i = 0;
+        try {
+            for( ; i < rhs.capacity_ ; ++i) {
+                if(flat_hash_is_full(rhs.ctrl_[i])) mystl::construct(slots_ + i, rhs.slots_[i]);
+            }
+        }catch(...) {
+            while(i-- > 0) {
+                if(flat_hash_is_full(rhs.ctrl_[i])) mystl::destroy(slots_ + i);
+            }
+            ctrl_allocator::deallocate(ctrl_);
+            data_allocator::deallocate(slots_);
+            init_empty();
+            throw;
+        }
+        std::memcpy(ctrl_, rhs.ctrl_, rhs.capacity_ + width);
+        capacity_ = rhs.capacity_;
+        size_ = rhs.size_;
+        growth_left_ = rhs.growth_left_;
+    }
+
+    // 删除元素后更新控制字节
+    void erase_meta(size_type index) {
+        --size_;
+        // 小表的任意一组都能看到整张表和至少一个空槽，查找不会越过这个槽
+        bool was_never_full = capacity_ < width;
+        if(!was_never_full) {
+            const size_type before = (index - width) & capacity_;
+            auto empty_after = flat_hash_group(ctrl_ + index).match_empty();
+            auto empty_before = flat_hash_group(ctrl_ + before).match_empty();
+            // 包含这个槽的任何一组里都有空槽，说明查找一定在到达这里之前或者同一组里停下
+            was_never_full = empty_before && empty_after &&
+                             empty_after.trailing_zeros() + empty_before.leading_zeros() < width;
+        }
+        if(was_never_full) {
+            set_ctrl(index, flat_hash_empty);
+            ++growth_left_;
+        }else {
+            set_ctrl(index, flat_hash_deleted);
+        }
+    }
+
+    void erase_at(size_type index) {
+        mystl::destroy(slots_ + index);
+        erase_meta(index);
+    }
+
+    template <class K>
+    size_type erase_key(const K& key) {
+        size_type index = find_index(key, hash_of(key));
+        if(index == capacity_) return 0;
+        erase_at(index);
+        return 1;
+    }
+
+    template <class K>
+    mystl::pair<iterator, iterator> equal_range_key(const K& key) {
+        iterator first = find(key);
+        if(first == end()) return mystl::pair<iterator, iterator>(first, first);
+        iterator last = first;
+        return mystl::pair<iterator, iterator>(first, ++last);
+    }
+};
+
+} // !mystl
+
+#endif
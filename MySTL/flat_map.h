@@ -0,0 +1,568 @@
+#ifndef __FLAT_MAP_H__
+#define __FLAT_MAP_H__
+
+#include <initializer_list>
+#include <type_traits>
+
+#include "vector.h"
+#include "algo.h"
+#include "functional.h"
+#include "exceptdef.h"
+#include "util.h"
+
+// 这个文件定义了flat_map和flat_multimap，用两个有序的vector分别存放键和值
+
+/*
+* 键和值分开存放：查找时二分查找只访问键数组，键排得更紧凑，一条cache line能比较更多的键。
+* 因为键和值不在一起，迭代器解引用得到的不是pair的引用，而是一个代理对象flat_map_reference，
+* 它有first和second两个引用成员，it->first、it->second和 for(auto p : m) 的写法都可以使用。
+*
+* 单个插入和删除需要移动后面的元素，是O(n)的，适合一次建好、之后大量查询的场景。
+* 批量插入 insert(first, last) 先把新元素收集起来排序去重，再和原有元素归并一次。
+* 插入和删除会使所有迭代器失效。
+*/
+
+namespace mystl {
+
+// 迭代器解引用得到的代理对象
+template <class Key, class T>
+struct flat_map_reference {
+    typedef typename std::remove_const<T>::type mapped_type;
+
+    const Key& first;
+    T& second;
+
+    flat_map_reference(const Key& k, T& v) : first(k), second(v) {}
+
+    operator mystl::pair<Key, mapped_type>() const { return mystl::pair<Key, mapped_type>(first, second); }
+};
+
+template <class Key, class T>
+std::ostream& operator<<(std::ostream& os, const flat_map_reference<Key, T>& rhs) {
+    os << "(" << rhs.first << ", " << rhs.second << ")";
+    return os;
+}
+
+// 迭代器的pointer：保存一个代理对象，operator->返回它的地址，it->second由此可用
+template <class Reference>
+struct flat_map_arrow_proxy {
+    Reference ref;
+
+    const Reference* operator->() const { return &ref; }
+};
+
+// 迭代器同时指向键数组和值数组中的同一个位置，T为const时是常量迭代器
+template <class Key, class T>
+struct flat_map_iterator {
+    typedef typename std::remove_const<T>::type mapped_type;
+    typedef flat_map_iterator<Key, mapped_type>       iterator;
+    typedef flat_map_iterator<Key, const mapped_type> const_iterator;
+    typedef flat_map_iterator self;
+
+    typedef random_access_iterator_tag          iterator_category;
+    typedef mystl::pair<Key, mapped_type>       value_type;
+    typedef flat_map_reference<Key, T>          reference;
+    typedef flat_map_arrow_proxy<reference>     pointer;
+    typedef ptrdiff_t                           difference_type;
+
+    const Key* key_;
+    T* value_;
+
+    flat_map_iterator() : key_(nullptr), value_(nullptr) {}
+    flat_map_iterator(const Key* k, T* v) : key_(k), value_(v) {}
+    flat_map_iterator(const iterator& rhs) : key_(rhs.key_), value_(rhs.value_) {}
+
+    reference operator*() const { return reference(*key_, *value_); }
+    pointer operator->() const { return pointer{ operator*() }; }
+    reference operator[](difference_type n) const { return reference(key_[n], value_[n]); }
+
+    self& operator++() { ++key_; ++value_; return *this; }
+    self operator++(int) { self tmp = *this; ++*this; return tmp; }
+    self& operator--() { --key_; --value_; return *this; }
+    self operator--(int) { self tmp = *this; --*this; return tmp; }
+
+    self& operator+=(difference_type n) { key_ += n; value_ += n; return *this; }
+    self& operator-=(difference_type n) { key_ -= n; value_ -= n; return *this; }
+    self operator+(difference_type n) const { self tmp = *this; return tmp += n; }
+    self operator-(difference_type n) const { self tmp = *this; return tmp -= n; }
+    difference_type operator-(const self& rhs) const { return key_ - rhs.key_; }
+
+    bool operator==(const self& rhs) const { return key_ == rhs.key_; }
+    bool operator!=(const self& rhs) const { return key_ != rhs.key_; }
+    bool operator<(const self& rhs) const { return key_ < rhs.key_; }
+    bool operator>(const self& rhs) const { return key_ > rhs.key_; }
+    bool operator<=(const self& rhs) const { return key_ <= rhs.key_; }
+    bool operator>=(const self& rhs) const { return key_ >= rhs.key_; }
+};
+
+// flat_map和flat_multimap共用的部分，两者只在插入时是否允许重复键上不同
+template <class Key, class T, class Compare>
+class flat_map_base {
+public:
+    typedef Key                             key_type;
+    typedef T                               mapped_type;
+    typedef mystl::pair<Key, T>             value_type;
+    typedef Compare                         key_compare;
+    typedef mystl::vector<Key>              key_container_type;
+    typedef mystl::vector<T>                mapped_container_type;
+
+    class value_compare : public binary_function<value_type, value_type, bool> {
+        friend class flat_map_base;
+        private:
+            Compare comp;
+            value_compare(Compare c) : comp(c) {}
+        public:
+            bool operator()(const value_type& lhs, const value_type& rhs) const {
+                return comp(lhs.first, rhs.first);
+            }
+    };
+
+    typedef flat_map_iterator<Key, T>                   iterator;
+    typedef flat_map_iterator<Key, const T>             const_iterator;
+    typedef mystl::reverse_iterator<iterator>           reverse_iterator;
+    typedef mystl::reverse_iterator<const_iterator>     const_reverse_iterator;
+    typedef typename iterator::reference                reference;
+    typedef typename const_iterator::reference          const_reference;
+    typedef typename iterator::pointer                  pointer;
+    typedef typename const_iterator::pointer            const_pointer;
+    typedef size_t                                      size_type;
+    typedef ptrdiff_t                                   difference_type;
+    typedef mystl::allocator<value_type>                allocator_type;
+
+protected:
+    key_container_type      keys_;
+    mapped_container_type   values_;
+    key_compare             comp_;
+
+public:
+    key_compare    key_comp()      const { return comp_; }
+    value_compare  value_comp()    const { return value_compare(comp_); }
+    allocator_type get_allocator() const { return allocator_type(); }
+
+    // 迭代器
+    iterator               begin()          { return make_iter(0); }
+    const_iterator         begin()   const  { return make_iter(0); }
+    iterator               end()            { return make_iter(size()); }
+    const_iterator         end()     const  { return make_iter(size()); }
+
+    reverse_iterator       rbegin()         { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin()  const  { return const_reverse_iterator(end()); }
+    reverse_iterator       rend()           { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()    const  { return const_reverse_iterator(begin()); }
+
+    const_iterator         cbegin()  const  { return begin(); }
+    const_iterator         cend()    const  { return end(); }
+    const_reverse_iterator crbegin() const  { return rbegin(); }
+    const_reverse_iterator crend()   const  { return rend(); }
+
+    // 容量
+    bool        empty()     const { return keys_.empty(); }
+    size_type   size()      const { return keys_.size(); }
+    size_type   max_size()  const { return keys_.max_size(); }
+    size_type   capacity()  const { return keys_.capacity(); }
+    void        reserve(size_type n) { keys_.reserve(n); values_.reserve(n); }
+    void        shrink_to_fit() { keys_.shrink_to_fit(); values_.shrink_to_fit(); }
+
+    // 底层的两个数组
+    const key_container_type& keys() const { return keys_; }
+    const mapped_container_type& values() const { return values_; }
+
+    // 查找，只在键数组上二分
+    iterator       lower_bound(const key_type& key)       { return make_iter(lower_index(key)); }
+    const_iterator lower_bound(const key_type& key) const { return make_iter(lower_index(key)); }
+
+    iterator       upper_bound(const key_type& key)       { return make_iter(upper_index(key)); }
+    const_iterator upper_bound(const key_type& key) const { return make_iter(upper_index(key)); }
+
+    iterator find(const key_type& key) {
+        size_type i = lower_index(key);
+        return (i == size() || comp_(key, keys_[i])) ? end() : make_iter(i);
+    }
+    const_iterator find(const key_type& key) const {
+        size_type i = lower_index(key);
+        return (i == size() || comp_(key, keys_[i])) ? end() : make_iter(i);
+    }
+
+    size_type count(const key_type& key) const { return upper_index(key) - lower_index(key); }
+    bool contains(const key_type& key) const { return find(key) != end(); }
+
+    mystl::pair<iterator, iterator>
+    equal_range(const key_type& key) {
+        return mystl::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+    }
+    mystl::pair<const_iterator, const_iterator>
+    equal_range(const key_type& key) const {
+        return mystl::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+    }
+
+    // erase
+    iterator erase(const_iterator pos) {
+        size_type i = index_of(pos);
+        keys_.erase(keys_.begin() + i);
+        values_.erase(values_.begin() + i);
+        return make_iter(i);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        size_type i = index_of(first), j = index_of(last);
+        keys_.erase(keys_.begin() + i, keys_.begin() + j);
+        values_.erase(values_.begin() + i, values_.begin() + j);
+        return make_iter(i);
+    }
+
+    size_type erase(const key_type& key) {
+        size_type i = lower_index(key), j = upper_index(key);
+        erase(make_iter(i), make_iter(j));
+        return j - i;
+    }
+
+    void clear() {
+        keys_.clear();
+        values_.clear();
+    }
+
+protected:
+    flat_map_base() = default;
+
+    // 接管已经有序的两个数组
+    flat_map_base(key_container_type&& keys, mapped_container_type&& values)
+        : keys_(mystl::move(keys)), values_(mystl::move(values)), comp_() {
+        MYSTL_DEBUG(keys_.size() == values_.size());
+    }
+
+    iterator make_iter(size_type i) {
+        return iterator(keys_.data() + i, values_.data() + i);
+    }
+    const_iterator make_iter(size_type i) const {
+        return const_iterator(keys_.data() + i, values_.data() + i);
+    }
+    size_type index_of(const_iterator pos) const {
+        return static_cast<size_type>(pos.key_ - keys_.data());
+    }
+
+    size_type lower_index(const key_type& key) const {
+        return mystl::lower_bound(keys_.begin(), keys_.end(), key, comp_) - keys_.begin();
+    }
+    size_type upper_index(const key_type& key) const {
+        return mystl::upper_bound(keys_.begin(), keys_.end(), key, comp_) - keys_.begin();
+    }
+
+    // 在位置i插入，值插入失败时撤销键的插入
+    iterator insert_at(size_type i, const value_type& value) {
+        keys_.insert(keys_.begin() + i, value.first);
+        try {
+            values_.insert(values_.begin() + i, value.second);
+        }catch(...) {
+            keys_.erase(keys_.begin() + i);
+            throw;
+        }
+        return make_iter(i);
+    }
+
+    // 批量插入：收集、排序、去重，然后和原有元素归并
+    template <class InputIterator>
+    void insert_range(InputIterator first, InputIterator last, bool unique, bool sorted);
+
+    void swap_base(flat_map_base& rhs) {
+        keys_.swap(rhs.keys_);
+        values_.swap(rhs.values_);
+        mystl::swap(comp_, rhs.comp_);
+    }
+};
+
+template <class Key, class T, class Compare>
+template <class InputIterator>
+void flat_map_base<Key, T, Compare>::insert_range(InputIterator first, InputIterator last, bool unique, bool sorted) {
+    typedef typename mystl::vector<value_type>::iterator buf_iterator;
+    mystl::vector<value_type> buf;
+    for(; first != last ; ++first) buf.push_back(*first);
+    if(buf.empty()) return;
+
+    value_compare vcomp(comp_);
+    if(!sorted) {
+        // 输入常常已经有序，先检查一遍
+        for(buf_iterator it = buf.begin() ; it + 1 != buf.end() ; ++it) {
+            if(vcomp(*(it + 1), *it)) {
+                // 稳定排序，重复键保留最先出现的那个，multimap中相等的键保持插入顺序；
+                // 先把元素移动到tmp，buf里留下的移后对象作为归并的临时区
+                mystl::vector<value_type> tmp;
+                tmp.reserve(buf.size());
+                for(buf_iterator cur = buf.begin() ; cur != buf.end() ; ++cur) tmp.push_back(mystl::move(*cur));
+                mystl::stable_sort(tmp.begin(), tmp.end(), buf.begin(), vcomp);
+                buf.swap(tmp);
+                break;
+            }
+        }
+        if(unique) {
+            buf_iterator result = buf.begin();
+            for(buf_iterator cur = result + 1 ; cur != buf.end() ; ++cur) {
+                if(vcomp(*result, *cur)) *++result = mystl::move(*cur);
+            }
+            buf.erase(result + 1, buf.end());
+        }
+    }
+
+    // 新元素都排在原有元素后面，直接追加
+    if(empty() || (unique ? comp_(keys_.back(), buf.front().first) : !comp_(buf.front().first, keys_.back()))) {
+        reserve(size() + buf.size());
+        for(buf_iterator it = buf.begin() ; it != buf.end() ; ++it) {
+            keys_.push_back(mystl::move(it->first));
+            values_.push_back(mystl::move(it->second));
+        }
+        return;
+    }
+
+    // 归并到新数组，键值相同时原有元素在前，unique时丢弃新元素
+    key_container_type nk;
+    mapped_container_type nv;
+    nk.reserve(size() + buf.size());
+    nv.reserve(size() + buf.size());
+    size_type i = 0;
+    buf_iterator j = buf.begin();
+    while(i < size() && j != buf.end()) {
+        if(comp_(j->first, keys_[i])) {
+            nk.push_back(mystl::move(j->first));
+            nv.push_back(mystl::move(j->second));
+            ++j;
+        }else {
+            if(unique && !comp_(keys_[i], j->first)) ++j;
+            nk.push_back(mystl::move(keys_[i]));
+            nv.push_back(mystl::move(values_[i]));
+            ++i;
+        }
+    }
+    for(; i < size() ; ++i) {
+        nk.push_back(mystl::move(keys_[i]));
+        nv.push_back(mystl::move(values_[i]));
+    }
+    for(; j != buf.end() ; ++j) {
+        nk.push_back(mystl::move(j->first));
+        nv.push_back(mystl::move(j->second));
+    }
+    keys_.swap(nk);
+    values_.swap(nv);
+}
+
+
+
+//--------------------flat_map-----------------------
+template <class Key, class T, class Compare = mystl::less<Key>>
+class flat_map : public flat_map_base<Key, T, Compare> {
+    typedef flat_map_base<Key, T, Compare> base_type;
+    using base_type::keys_;
+    using base_type::values_;
+    using base_type::comp_;
+
+public:
+    typedef typename base_type::key_type              key_type;
+    typedef typename base_type::mapped_type           mapped_type;
+    typedef typename base_type::value_type            value_type;
+    typedef typename base_type::key_container_type    key_container_type;
+    typedef typename base_type::mapped_container_type mapped_container_type;
+    typedef typename base_type::iterator              iterator;
+    typedef typename base_type::const_iterator        const_iterator;
+    typedef typename base_type::size_type             size_type;
+
+public:
+    flat_map() = default;
+
+    template <class InputIterator>
+    flat_map(InputIterator first, InputIterator last) {
+        this->insert_range(first, last, true, false);
+    }
+
+    // 区间已经有序且没有重复，不用排序
+    template <class InputIterator>
+    flat_map(mystl::sorted_unique_t, InputIterator first, InputIterator last) {
+        this->insert_range(first, last, true, true);
+    }
+
+    // 接管已经有序且没有重复的键数组和对应的值数组
+    flat_map(mystl::sorted_unique_t, key_container_type&& keys, mapped_container_type&& values)
+        : base_type(mystl::move(keys), mystl::move(values)) {}
+
+    flat_map(std::initializer_list<value_type> ilist) {
+        this->insert_range(ilist.begin(), ilist.end(), true, false);
+    }
+
+    flat_map& operator=(std::initializer_list<value_type> ilist) {
+        this->clear();
+        this->insert_range(ilist.begin(), ilist.end(), true, false);
+        return *this;
+    }
+
+    // 若键值不存在，抛出异常
+    mapped_type& at(const key_type& key) {
+        iterator it = this->find(key);
+        THROW_OUT_OF_RANGE_IF(it == this->end(), "flat_map no such elements exists.");
+        return it->second;
+    }
+
+    const mapped_type& at(const key_type& key) const {
+        const_iterator it = this->find(key);
+        THROW_OUT_OF_RANGE_IF(it == this->end(), "flat_map no such elements exists.");
+        return it->second;
+    }
+
+    // 如果不存在元素，插入默认值的mapped_type
+    mapped_type& operator[](const key_type& key) {
+        size_type i = this->lower_index(key);
+        if(i == this->size() || comp_(key, keys_[i])) {
+            this->insert_at(i, value_type(key, mapped_type()));
+        }
+        return values_[i];
+    }
+
+    // insert
+    mystl::pair<iterator, bool> insert(const value_type& value) {
+        size_type i = this->lower_index(value.first);
+        if(i != this->size() && !comp_(value.first, keys_[i])) {
+            return mystl::pair<iterator, bool>(this->make_iter(i), false);
+        }
+        return mystl::pair<iterator, bool>(this->insert_at(i, value), true);
+    }
+
+    // hint正确时省去查找
+    iterator insert(const_iterator hint, const value_type& value) {
+        size_type i = this->index_of(hint);
+        if((i == this->size() || comp_(value.first, keys_[i])) && (i == 0 || comp_(keys_[i - 1], value.first))) {
+            return this->insert_at(i, value);
+        }
+        return insert(value).first;
+    }
+
+    // 已经存在的键不会被覆盖；区间内部有重复键时保留最先出现的那个
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        this->insert_range(first, last, true, false);
+    }
+
+    template <class InputIterator>
+    void insert(mystl::sorted_unique_t, InputIterator first, InputIterator last) {
+        this->insert_range(first, last, true, true);
+    }
+
+    template <class ...Args>
+    mystl::pair<iterator, bool> emplace(Args&& ...args) {
+        return insert(value_type(mystl::forward<Args>(args)...));
+    }
+
+    void swap(flat_map& rhs) { this->swap_base(rhs); }
+};
+
+template <class Key, class T, class Compare>
+bool operator==(const flat_map<Key, T, Compare>& lhs, const flat_map<Key, T, Compare>& rhs)
+{
+  return lhs.keys() == rhs.keys() && lhs.values() == rhs.values();
+}
+
+template <class Key, class T, class Compare>
+bool operator!=(const flat_map<Key, T, Compare>& lhs, const flat_map<Key, T, Compare>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare>
+void swap(flat_map<Key, T, Compare>& lhs, flat_map<Key, T, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+
+
+//--------------------flat_multimap-----------------------
+template <class Key, class T, class Compare = mystl::less<Key>>
+class flat_multimap : public flat_map_base<Key, T, Compare> {
+    typedef flat_map_base<Key, T, Compare> base_type;
+    using base_type::keys_;
+    using base_type::comp_;
+
+public:
+    typedef typename base_type::key_type              key_type;
+    typedef typename base_type::mapped_type           mapped_type;
+    typedef typename base_type::value_type            value_type;
+    typedef typename base_type::key_container_type    key_container_type;
+    typedef typename base_type::mapped_container_type mapped_container_type;
+    typedef typename base_type::iterator              iterator;
+    typedef typename base_type::const_iterator        const_iterator;
+    typedef typename base_type::size_type             size_type;
+
+public:
+    flat_multimap() = default;
+
+    // 批量插入时相等键值保持输入的先后顺序，并排在已有的相等键值之后
+    template <class InputIterator>
+    flat_multimap(InputIterator first, InputIterator last) {
+        this->insert_range(first, last, false, false);
+    }
+
+    template <class InputIterator>
+    flat_multimap(mystl::sorted_equivalent_t, InputIterator first, InputIterator last) {
+        this->insert_range(first, last, false, true);
+    }
+
+    flat_multimap(mystl::sorted_equivalent_t, key_container_type&& keys, mapped_container_type&& values)
+        : base_type(mystl::move(keys), mystl::move(values)) {}
+
+    flat_multimap(std::initializer_list<value_type> ilist) {
+        this->insert_range(ilist.begin(), ilist.end(), false, false);
+    }
+
+    flat_multimap& operator=(std::initializer_list<value_type> ilist) {
+        this->clear();
+        this->insert_range(ilist.begin(), ilist.end(), false, false);
+        return *this;
+    }
+
+    // 插在所有相等元素的后面
+    iterator insert(const value_type& value) {
+        return this->insert_at(this->upper_index(value.first), value);
+    }
+
+    iterator insert(const_iterator hint, const value_type& value) {
+        size_type i = this->index_of(hint);
+        if((i == this->size() || comp_(value.first, keys_[i])) && (i == 0 || !comp_(value.first, keys_[i - 1]))) {
+            return this->insert_at(i, value);
+        }
+        return insert(value);
+    }
+
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        this->insert_range(first, last, false, false);
+    }
+
+    template <class InputIterator>
+    void insert(mystl::sorted_equivalent_t, InputIterator first, InputIterator last) {
+        this->insert_range(first, last, false, true);
+    }
+
+    template <class ...Args>
+    iterator emplace(Args&& ...args) {
+        return insert(value_type(mystl::forward<Args>(args)...));
+    }
+
+    void swap(flat_multimap& rhs) { this->swap_base(rhs); }
+};
+
+template <class Key, class T, class Compare>
+bool operator==(const flat_multimap<Key, T, Compare>& lhs, const flat_multimap<Key, T, Compare>& rhs)
+{
+  return lhs.keys() == rhs.keys() && lhs.values() == rhs.values();
+}
+
+template <class Key, class T, class Compare>
+bool operator!=(const flat_multimap<Key, T, Compare>& lhs, const flat_multimap<Key, T, Compare>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare>
+void swap(flat_multimap<Key, T, Compare>& lhs, flat_multimap<Key, T, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+}
+
+#endif
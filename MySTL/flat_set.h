@@ -0,0 +1,308 @@
+#ifndef __FLAT_SET_H__
+#define __FLAT_SET_H__
+
+#include <initializer_list>
+
+#include "vector.h"
+#include "algo.h"
+#include "functional.h"
+#include "util.h"
+
+// 这个文件定义了flat_set，用有序的vector存放元素
+
+/*
+* 和set的区别：
+*   元素连续存放，查找是对数组的二分查找，不需要在结点之间跳转，遍历就是顺序访问数组，内存也没有结点的额外开销。
+*   单个插入和删除需要移动后面的元素，是O(n)的，适合一次建好、之后大量查询的场景。
+*   批量插入 insert(first, last) 先把新元素追加到末尾，排序去重后和原有元素归并一次，是O((n + m) + m log m)的。
+*   插入和删除会使所有迭代器失效。
+*/
+
+namespace mystl {
+
+template <class Key, class Compare = mystl::less<Key>>
+class flat_set {
+public:
+    typedef Key         key_type;
+    typedef Key         value_type;
+    typedef Compare     key_compare;
+    typedef Compare     value_compare;
+    typedef mystl::vector<Key> container_type;
+
+    // 元素不能修改，iterator也是常量迭代器
+    typedef typename container_type::const_pointer          pointer;
+    typedef typename container_type::const_pointer          const_pointer;
+    typedef typename container_type::const_reference        reference;
+    typedef typename container_type::const_reference        const_reference;
+    typedef typename container_type::const_iterator         iterator;
+    typedef typename container_type::const_iterator         const_iterator;
+    typedef typename container_type::const_reverse_iterator reverse_iterator;
+    typedef typename container_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename container_type::size_type              size_type;
+    typedef typename container_type::difference_type        difference_type;
+    typedef typename container_type::allocator_type         allocator_type;
+
+private:
+    container_type keys_;
+    key_compare    comp_;
+
+public:
+    flat_set() = default;
+
+    template <class InputIterator>
+    flat_set(InputIterator first, InputIterator last) : keys_(), comp_() {
+        insert(first, last);
+    }
+
+    // 区间已经有序且没有重复，直接拷贝
+    template <class InputIterator>
+    flat_set(mystl::sorted_unique_t, InputIterator first, InputIterator last) : keys_(first, last), comp_() {}
+
+    // 接管一个已经有序且没有重复的vector
+    flat_set(mystl::sorted_unique_t, container_type&& keys) : keys_(mystl::move(keys)), comp_() {}
+
+    flat_set(std::initializer_list<value_type> ilist) : keys_(), comp_() {
+        insert(ilist.begin(), ilist.end());
+    }
+
+    flat_set(const flat_set& rhs) : keys_(rhs.keys_), comp_(rhs.comp_) {}
+
+    flat_set(flat_set&& rhs) : keys_(mystl::move(rhs.keys_)), comp_(rhs.comp_) {}
+
+    flat_set& operator=(const flat_set& rhs) {
+        keys_ = rhs.keys_;
+        comp_ = rhs.comp_;
+        return *this;
+    }
+
+    flat_set& operator=(flat_set&& rhs) {
+        keys_ = mystl::move(rhs.keys_);
+        comp_ = rhs.comp_;
+        return *this;
+    }
+
+    flat_set& operator=(std::initializer_list<value_type> ilist) {
+        keys_.clear();
+        insert(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    key_compare         key_comp()      const { return comp_; }
+    value_compare       value_comp()    const { return comp_; }
+    allocator_type      get_allocator() const { return keys_.get_allocator(); }
+
+    // 迭代器
+    iterator               begin()          { return keys_.begin(); }
+    const_iterator         begin()  const   { return keys_.begin(); }
+    iterator               end()            { return keys_.end(); }
+    const_iterator         end()    const   { return keys_.end(); }
+
+    reverse_iterator       rbegin()         { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const   { return const_reverse_iterator(end()); }
+    reverse_iterator       rend()           { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()   const   { return const_reverse_iterator(begin()); }
+
+    const_iterator         cbegin()     const       { return begin(); }
+    const_iterator         cend()       const       { return end(); }
+    const_reverse_iterator crbegin()    const       { return rbegin(); }
+    const_reverse_iterator crend()      const       { return rend(); }
+
+    // 容量
+    bool        empty()     const { return keys_.empty(); }
+    size_type   size()      const { return keys_.size(); }
+    size_type   max_size()  const { return keys_.max_size(); }
+    size_type   capacity()  const { return keys_.capacity(); }
+    void        reserve(size_type n) { keys_.reserve(n); }
+    void        shrink_to_fit() { keys_.shrink_to_fit(); }
+
+    // 底层的有序数组
+    const container_type& keys() const { return keys_; }
+
+    // insert，单个插入要移动后面的元素
+    mystl::pair<iterator, bool> insert(const value_type& value) {
+        iterator pos = lower_bound(value);
+        if(pos != end() && !comp_(value, *pos)) return mystl::pair<iterator, bool>(pos, false);
+        return mystl::pair<iterator, bool>(insert_at(pos, value), true);
+    }
+
+    // hint正确时省去查找
+    iterator insert(iterator hint, const value_type& value) {
+        if((hint == end() || comp_(value, *hint)) && (hint == begin() || comp_(*(hint - 1), value))) {
+            return insert_at(hint, value);
+        }
+        return insert(value).first;
+    }
+
+    template <class ...Args>
+    mystl::pair<iterator, bool> emplace(Args&& ...args) {
+        return insert(value_type(mystl::forward<Args>(args)...));
+    }
+
+    // 批量插入：追加到末尾，排序去重，再和原有元素归并
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        const size_type old_size = size();
+        for(; first != last ; ++first) keys_.push_back(*first);
+        sort_and_merge(old_size, false);
+    }
+
+    template <class InputIterator>
+    void insert(mystl::sorted_unique_t, InputIterator first, InputIterator last) {
+        const size_type old_size = size();
+        for(; first != last ; ++first) keys_.push_back(*first);
+        sort_and_merge(old_size, true);
+    }
+
+    // erase
+    iterator erase(iterator pos) {
+        return keys_.erase(mutable_iter(pos));
+    }
+    iterator erase(iterator first, iterator last) {
+        return keys_.erase(mutable_iter(first), mutable_iter(last));
+    }
+    size_type erase(const key_type& key) {
+        iterator pos = find(key);
+        if(pos == end()) return 0;
+        erase(pos);
+        return 1;
+    }
+
+    void clear() { keys_.clear(); }
+
+    // 查找
+    iterator       lower_bound(const key_type& key)       { return mystl::lower_bound(begin(), end(), key, comp_); }
+    const_iterator lower_bound(const key_type& key) const { return mystl::lower_bound(begin(), end(), key, comp_); }
+
+    iterator       upper_bound(const key_type& key)       { return mystl::upper_bound(begin(), end(), key, comp_); }
+    const_iterator upper_bound(const key_type& key) const { return mystl::upper_bound(begin(), end(), key, comp_); }
+
+    iterator find(const key_type& key) {
+        iterator pos = lower_bound(key);
+        return (pos == end() || comp_(key, *pos)) ? end() : pos;
+    }
+    const_iterator find(const key_type& key) const {
+        const_iterator pos = lower_bound(key);
+        return (pos == end() || comp_(key, *pos)) ? end() : pos;
+    }
+
+    size_type count(const key_type& key) const { return find(key) != end() ? 1 : 0; }
+    bool contains(const key_type& key) const { return find(key) != end(); }
+
+    mystl::pair<iterator, iterator>
+    equal_range(const key_type& key) const {
+        const_iterator pos = find(key);
+        return mystl::pair<iterator, iterator>(pos, pos == end() ? pos : pos + 1);
+    }
+
+    void swap(flat_set& rhs) {
+        keys_.swap(rhs.keys_);
+        mystl::swap(comp_, rhs.comp_);
+    }
+
+private:
+    typename container_type::iterator mutable_iter(const_iterator pos) {
+        return keys_.begin() + (pos - keys_.begin());
+    }
+
+    iterator insert_at(iterator pos, const value_type& value) {
+        return keys_.insert(mutable_iter(pos), value);
+    }
+
+    // [0, old_size) 是原有的有序元素，[old_size, size()) 是新追加的元素
+    void sort_and_merge(size_type old_size, bool sorted);
+};
+
+template <class Key, class Compare>
+void flat_set<Key, Compare>::sort_and_merge(size_type old_size, bool sorted) {
+    typedef typename container_type::iterator raw_iterator;
+    raw_iterator mid = keys_.begin() + old_size;
+    if(mid == keys_.end()) return;
+
+    if(!sorted) {
+        // 输入常常已经有序，先检查一遍
+        raw_iterator it = mid;
+        for(raw_iterator next = it + 1 ; next != keys_.end() ; it = next++) {
+            if(comp_(*next, *it)) {
+                // 稳定排序，重复键保留最先出现的那个；新元素先移动到tmp，原位置的移后对象作为归并的临时区
+                container_type tmp;
+                tmp.reserve(keys_.end() - mid);
+                for(raw_iterator cur = mid ; cur != keys_.end() ; ++cur) tmp.push_back(mystl::move(*cur));
+                mystl::stable_sort(tmp.begin(), tmp.end(), mid, comp_);
+                mystl::move(tmp.begin(), tmp.end(), mid);
+                break;
+            }
+        }
+        // 新元素内部去重
+        raw_iterator result = mid;
+        for(raw_iterator cur = mid + 1 ; cur != keys_.end() ; ++cur) {
+            if(comp_(*result, *cur)) *++result = mystl::move(*cur);
+        }
+        keys_.erase(result + 1, keys_.end());
+        mid = keys_.begin() + old_size;
+    }
+
+    // 新元素都比原有的大，已经有序
+    if(old_size == 0 || comp_(*(mid - 1), *mid)) return;
+
+    // 归并到新数组，键值相同时保留原有的元素
+    container_type merged;
+    merged.reserve(keys_.size());
+    raw_iterator i = keys_.begin(), j = mid;
+    while(i != mid && j != keys_.end()) {
+        if(comp_(*i, *j)) merged.push_back(mystl::move(*i++));
+        else if(comp_(*j, *i)) merged.push_back(mystl::move(*j++));
+        else {
+            merged.push_back(mystl::move(*i++));
+            ++j;
+        }
+    }
+    for(; i != mid ; ++i) merged.push_back(mystl::move(*i));
+    for(; j != keys_.end() ; ++j) merged.push_back(mystl::move(*j));
+    keys_.swap(merged);
+}
+
+template <class Key, class Compare>
+bool operator==(const flat_set<Key, Compare>& lhs, const flat_set<Key, Compare>& rhs)
+{
+  return lhs.keys() == rhs.keys();
+}
+
+template <class Key, class Compare>
+bool operator<(const flat_set<Key, Compare>& lhs, const flat_set<Key, Compare>& rhs)
+{
+  return lhs.keys() < rhs.keys();
+}
+
+template <class Key, class Compare>
+bool operator!=(const flat_set<Key, Compare>& lhs, const flat_set<Key, Compare>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class Key, class Compare>
+bool operator>(const flat_set<Key, Compare>& lhs, const flat_set<Key, Compare>& rhs)
+{
+  return rhs < lhs;
+}
+
+template <class Key, class Compare>
+bool operator<=(const flat_set<Key, Compare>& lhs, const flat_set<Key, Compare>& rhs)
+{
+  return !(rhs < lhs);
+}
+
+template <class Key, class Compare>
+bool operator>=(const flat_set<Key, Compare>& lhs, const flat_set<Key, Compare>& rhs)
+{
+  return !(lhs < rhs);
+}
+
+template <class Key, class Compare>
+void swap(flat_set<Key, Compare>& lhs, flat_set<Key, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+}
+
+#endif
@@ -0,0 +1,639 @@
+#ifndef __FORWARD_LIST_H__
+#define __FORWARD_LIST_H__
+
+#include <initializer_list>
+
+#include "allocator.h"
+#include "construct.h"
+#include "algobase.h"
+#include "exceptdef.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "functional.h"
+#include "util.h"
+
+// 这个文件定义了单向链表 forward_list（也就是SGI STL中的slist）
+
+/*
+* 每个结点只有一个next_指针，比list的结点少一个prev_，插入时也少写一次指针。
+* 单向链表只能找到后继，所以插入和删除都是 xxx_after 的形式，作用在给定位置的后面。
+*
+* 容器里内嵌一个只有next_的头结点head_，before_begin()指向它，这样在第一个元素前插入也能用insert_after。
+* 最后一个结点的next_为nullptr，end()就是空迭代器。
+* 和std::forward_list一样不记录元素个数，没有size()，需要时用distance。
+*
+* sort是原地的自底向上归并排序（Simon Tatham的链表归并），不需要额外的空间，是稳定的。
+*/
+
+namespace mystl {
+
+// 结点的链接部分，头结点只有这一部分
+struct forward_list_node_base {
+    forward_list_node_base* next_;
+};
+
+template <class T>
+struct forward_list_node : public forward_list_node_base {
+    T data_;
+};
+
+// 迭代器的设计
+template <class T, class Ref, class Ptr>
+struct forward_list_iterator {
+    typedef forward_list_iterator<T, T&, T*> iterator;
+    typedef forward_list_iterator<T, const T&, const T*> const_iterator;
+    typedef forward_list_iterator self;
+
+    typedef forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef Ptr pointer;
+    typedef Ref reference;
+    typedef ptrdiff_t difference_type;
+
+    typedef forward_list_node_base* base_ptr;
+    typedef forward_list_node<T>* node_ptr;
+
+    base_ptr node_;
+
+    forward_list_iterator() : node_(nullptr) {}
+    forward_list_iterator(base_ptr x) : node_(x) {}
+    forward_list_iterator(const iterator& rhs) : node_(rhs.node_) {}
+
+    reference operator*() const { return static_cast<node_ptr>(node_)->data_; }
+    pointer operator->() const { return &(operator*()); }
+
+    self& operator++() {
+        node_ = node_->next_;
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp = *this;
+        node_ = node_->next_;
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const { return node_ == rhs.node_; }
+    bool operator!=(const self& rhs) const { return node_ != rhs.node_; }
+};
+
+// 模板类 forward_list
+template <class T>
+class forward_list {
+public:
+    typedef mystl::allocator<T> allocator_type;
+    typedef mystl::allocator<T> data_allocator;
+    typedef mystl::allocator<forward_list_node<T>> node_allocator;
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    typedef forward_list_iterator<T, T&, T*> iterator;
+    typedef forward_list_iterator<T, const T&, const T*> const_iterator;
+
+    typedef forward_list_node_base* base_ptr;
+    typedef forward_list_node<T>* node_ptr;
+
+private:
+    forward_list_node_base head_;   // 第一个元素之前的头结点
+
+public:
+    // 构造、移动、拷贝、赋值和析构函数
+    forward_list() { head_.next_ = nullptr; }
+
+    explicit forward_list(size_type n) {
+        head_.next_ = nullptr;
+        fill_init(n, value_type());
+    }
+
+    forward_list(size_type n, const value_type& value) {
+        head_.next_ = nullptr;
+        fill_init(n, value);
+    }
+
+    template <class Iterator>
+    forward_list(Iterator first, Iterator last) {
+        typedef typename is_integral<Iterator>::value is_Int;
+        head_.next_ = nullptr;
+        range_init_aux(first, last, is_Int());
+    }
+
+    forward_list(std::initializer_list<T> ilist) {
+        head_.next_ = nullptr;
+        copy_init(ilist.begin(), ilist.end());
+    }
+
+    forward_list(const forward_list& rhs) {
+        head_.next_ = nullptr;
+        copy_init(rhs.begin(), rhs.end());
+    }
+
+    // 头结点在容器内部，移动只需要接过第一个结点
+    forward_list(forward_list&& rhs) noexcept {
+        head_.next_ = rhs.head_.next_;
+        rhs.head_.next_ = nullptr;
+    }
+
+    forward_list& operator=(const forward_list& rhs) {
+        if(this != &rhs) {
+            assign(rhs.begin(), rhs.end());
+        }
+        return *this;
+    }
+
+    forward_list& operator=(forward_list&& rhs) noexcept {
+        if(this != &rhs) {
+            clear();
+            head_.next_ = rhs.head_.next_;
+            rhs.head_.next_ = nullptr;
+        }
+        return *this;
+    }
+
+    forward_list& operator=(std::initializer_list<T> ilist) {
+        assign(ilist.begin(), ilist.end());
+        return *this;
+    }
+
+    ~forward_list() { clear(); }
+
+public:
+    // 迭代器相关操作
+    iterator before_begin() { return &head_; }
+    const_iterator before_begin() const { return const_cast<base_ptr>(&head_); }
+    iterator begin() { return head_.next_; }
+    const_iterator begin() const { return head_.next_; }
+    iterator end() { return nullptr; }
+    const_iterator end() const { return nullptr; }
+
+    const_iterator cbefore_begin() const { return before_begin(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    // 容量相关操作
+    bool empty() const { return head_.next_ == nullptr; }
+    size_type max_size() const { return static_cast<size_type>(-1); }
+
+    // 元素访问相关操作
+    reference front() {
+        MYSTL_DEBUG(!empty());
+        return *begin();
+    }
+
+    const_reference front() const {
+        MYSTL_DEBUG(!empty());
+        return *begin();
+    }
+
+    // assign
+    void assign(size_type n, const value_type& value) { fill_assign(n, value); }
+
+    template <class Iterator>
+    void assign(Iterator first, Iterator last) {
+        typedef typename is_integral<Iterator>::value is_Int;
+        range_assign_aux(first, last, is_Int());
+    }
+
+    void assign(std::initializer_list<T> ilist) { copy_assign(ilist.begin(), ilist.end()); }
+
+    // insert_after，在pos后面插入，返回最后一个插入的元素
+    template <class... Args>
+    iterator emplace_after(iterator pos, Args&&... args) {
+        return link_after(pos.node_, create_node(mystl::forward<Args>(args)...));
+    }
+
+    iterator insert_after(iterator pos, const value_type& value) {
+        return link_after(pos.node_, create_node(value));
+    }
+
+    iterator insert_after(iterator pos, value_type&& value) {
+        return link_after(pos.node_, create_node(mystl::move(value)));
+    }
+
+    iterator insert_after(iterator pos, size_type n, const value_type& value) {
+        for(; n > 0 ; --n) pos = insert_after(pos, value);
+        return pos;
+    }
+
+    template <class Iterator>
+    iterator insert_after(iterator pos, Iterator first, Iterator last) {
+        typedef typename is_integral<Iterator>::value is_Int;
+        return range_insert_aux(pos, first, last, is_Int());
+    }
+
+    iterator insert_after(iterator pos, std::initializer_list<T> ilist) {
+        return copy_insert_after(pos, ilist.begin(), ilist.end());
+    }
+
+    // push_front / pop_front
+    template <class... Args>
+    void emplace_front(Args&&... args) { emplace_after(before_begin(), mystl::forward<Args>(args)...); }
+
+    void push_front(const value_type& value) { insert_after(before_begin(), value); }
+    void push_front(value_type&& value) { insert_after(before_begin(), mystl::move(value)); }
+
+    void pop_front() {
+        MYSTL_DEBUG(!empty());
+        erase_after(before_begin());
+    }
+
+    // erase_after，删除pos后面的一个元素，或者(first, last)之间的元素，返回被删除元素的后一个位置
+    iterator erase_after(iterator pos);
+    iterator erase_after(iterator first, iterator last);
+
+    void clear() { erase_after(before_begin(), end()); }
+
+    // resize
+    void resize(size_type new_size) { resize(new_size, value_type()); }
+    void resize(size_type new_size, const value_type& value);
+
+    // forward_list相关操作 swap splice_after remove unique merge sort reverse
+    void swap(forward_list& rhs) noexcept {
+        mystl::swap(head_.next_, rhs.head_.next_);
+    }
+
+    // 把other的全部元素转移到pos之后
+    void splice_after(iterator pos, forward_list& other);
+    // 把i后面的一个元素转移到pos之后
+    void splice_after(iterator pos, forward_list& other, iterator i);
+    // 把(first, last)之间的元素转移到pos之后
+    void splice_after(iterator pos, forward_list& other, iterator first, iterator last);
+
+    void remove(const value_type& value) {
+        remove_if([&](const value_type& x) { return x == value; });
+    }
+
+    template <class UnaryPredicate>
+    void remove_if(UnaryPredicate pred);
+
+    void unique() { unique(mystl::equal_to<T>()); }
+
+    template <class BinaryPredicate>
+    void unique(BinaryPredicate pred);
+
+    // merge，两个链表都必须有序
+    void merge(forward_list& x) { merge(x, mystl::less<T>()); }
+
+    template <class Compare>
+    void merge(forward_list& x, Compare comp);
+
+    void sort() { sort(mystl::less<T>()); }
+
+    template <class Compare>
+    void sort(Compare comp);
+
+    void reverse();
+
+private:
+    static reference value_of(base_ptr x) { return static_cast<node_ptr>(x)->data_; }
+
+    // 辅助函数，和list一样分配结点并构造对象
+    template <class... Args>
+    node_ptr create_node(Args&&... args) {
+        node_ptr tmp = node_allocator::allocate(1);
+        try {
+            mystl::construct(&tmp->data_, mystl::forward<Args>(args)...);
+        } catch(...) {
+            node_allocator::deallocate(tmp);
+            throw;
+        }
+        tmp->next_ = nullptr;
+        return tmp;
+    }
+
+    void destroy_node(node_ptr x) {
+        mystl::destroy(&x->data_);
+        node_allocator::deallocate(x);
+    }
+
+    // 把x连接到pos之后
+    static iterator link_after(base_ptr pos, base_ptr x) {
+        x->next_ = pos->next_;
+        pos->next_ = x;
+        return x;
+    }
+
+    // 初始化
+    void fill_init(size_type n, const value_type& value) {
+        try {
+            insert_after(before_begin(), n, value);
+        } catch(...) {
+            clear();
+            throw;
+        }
+    }
+
+    template <class Iterator>
+    void copy_init(Iterator first, Iterator last) {
+        try {
+            copy_insert_after(before_begin(), first, last);
+        } catch(...) {
+            clear();
+            throw;
+        }
+    }
+
+    template <class Integer>
+    void range_init_aux(Integer n, Integer value, true_type) {
+        fill_init(n, value);
+    }
+
+    template <class Iterator>
+    void range_init_aux(Iterator first, Iterator last, false_type) {
+        copy_init(first, last);
+    }
+
+    // assign的辅助函数，复用已有的结点
+    void fill_assign(size_type n, const value_type& value);
+
+    template <class Iterator>
+    void copy_assign(Iterator first, Iterator last);
+
+    template <class Integer>
+    void range_assign_aux(Integer n, Integer value, true_type) {
+        fill_assign(n, value);
+    }
+
+    template <class Iterator>
+    void range_assign_aux(Iterator first, Iterator last, false_type) {
+        copy_assign(first, last);
+    }
+
+    // insert_after的辅助函数
+    template <class Iterator>
+    iterator copy_insert_after(iterator pos, Iterator first, Iterator last) {
+        for(; first != last ; ++first) pos = insert_after(pos, *first);
+        return pos;
+    }
+
+    template <class Integer>
+    iterator range_insert_aux(iterator pos, Integer n, Integer value, true_type) {
+        return insert_after(pos, static_cast<size_type>(n), static_cast<value_type>(value));
+    }
+
+    template <class Iterator>
+    iterator range_insert_aux(iterator pos, Iterator first, Iterator last, false_type) {
+        return copy_insert_after(pos, first, last);
+    }
+
+    // 把(first, last]这一段链到pos之后，first之后的结点从原来的链上摘下
+    static void splice_after_aux(base_ptr pos, base_ptr before_first, base_ptr before_last) {
+        if(pos != before_first && pos != before_last) {
+            base_ptr first = before_first->next_;
+            before_first->next_ = before_last->next_;
+            before_last->next_ = pos->next_;
+            pos->next_ = first;
+        }
+    }
+};
+
+template <class T>
+typename forward_list<T>::iterator
+forward_list<T>::erase_after(iterator pos) {
+    node_ptr x = static_cast<node_ptr>(pos.node_->next_);
+    pos.node_->next_ = x->next_;
+    destroy_node(x);
+    return pos.node_->next_;
+}
+
+template <class T>
+typename forward_list<T>::iterator
+forward_list<T>::erase_after(iterator first, iterator last) {
+    base_ptr cur = first.node_->next_;
+    while(cur != last.node_) {
+        base_ptr next = cur->next_;
+        destroy_node(static_cast<node_ptr>(cur));
+        cur = next;
+    }
+    first.node_->next_ = last.node_;
+    return last;
+}
+
+template <class T>
+void forward_list<T>::resize(size_type new_size, const value_type& value) {
+    iterator prev = before_begin();
+    size_type len = 0;
+    for(; prev.node_->next_ != nullptr && len < new_size ; ++prev, ++len);
+    if(len == new_size) {
+        erase_after(prev, end());
+    }else {
+        insert_after(prev, new_size - len, value);
+    }
+}
+
+template <class T>
+void forward_list<T>::fill_assign(size_type n, const value_type& value) {
+    iterator prev = before_begin();
+    for(; prev.node_->next_ != nullptr && n > 0 ; ++prev, --n) {
+        value_of(prev.node_->next_) = value;
+    }
+    if(n > 0) {
+        insert_after(prev, n, value);
+    }else {
+        erase_after(prev, end());
+    }
+}
+
+template <class T>
+template <class Iterator>
+void forward_list<T>::copy_assign(Iterator first, Iterator last) {
+    iterator prev = before_begin();
+    for(; prev.node_->next_ != nullptr && first != last ; ++prev, ++first) {
+        value_of(prev.node_->next_) = *first;
+    }
+    if(first != last) {
+        copy_insert_after(prev, first, last);
+    }else {
+        erase_after(prev, end());
+    }
+}
+
+template <class T>
+void forward_list<T>::splice_after(iterator pos, forward_list& other) {
+    if(!other.empty() && this != &other) {
+        base_ptr last = &other.head_;
+        while(last->next_ != nullptr) last = last->next_;
+        splice_after_aux(pos.node_, &other.head_, last);
+    }
+}
+
+template <class T>
+void forward_list<T>::splice_after(iterator pos, forward_list& /* other */, iterator i) {
+    base_ptr x = i.node_->next_;
+    if(x != nullptr) {
+        splice_after_aux(pos.node_, i.node_, x);
+    }
+}
+
+template <class T>
+void forward_list<T>::splice_after(iterator pos, forward_list& /* other */, iterator first, iterator last) {
+    if(first == last || first.node_->next_ == last.node_) return;
+    // 找到last的前一个结点
+    base_ptr before_last = first.node_;
+    while(before_last->next_ != last.node_) before_last = before_last->next_;
+    splice_after_aux(pos.node_, first.node_, before_last);
+}
+
+template <class T>
+template <class UnaryPredicate>
+void forward_list<T>::remove_if(UnaryPredicate pred) {
+    base_ptr prev = &head_;
+    while(prev->next_ != nullptr) {
+        if(pred(value_of(prev->next_))) {
+            erase_after(prev);
+        }else {
+            prev = prev->next_;
+        }
+    }
+}
+
+template <class T>
+template <class BinaryPredicate>
+void forward_list<T>::unique(BinaryPredicate pred) {
+    base_ptr cur = head_.next_;
+    if(cur == nullptr) return;
+    while(cur->next_ != nullptr) {
+        if(pred(value_of(cur), value_of(cur->next_))) {
+            erase_after(cur);
+        }else {
+            cur = cur->next_;
+        }
+    }
+}
+
+template <class T>
+template <class Compare>
+void forward_list<T>::merge(forward_list& x, Compare comp) {
+    if(this == &x) return;
+    base_ptr prev = &head_;
+    while(prev->next_ != nullptr && x.head_.next_ != nullptr) {
+        if(comp(value_of(x.head_.next_), value_of(prev->next_))) {
+            // x的第一个元素更小，摘下来放到prev之后，相等时保留this的在前
+            base_ptr node = x.head_.next_;
+            x.head_.next_ = node->next_;
+            link_after(prev, node);
+        }
+        prev = prev->next_;
+    }
+    if(x.head_.next_ != nullptr) {
+        prev->next_ = x.head_.next_;
+        x.head_.next_ = nullptr;
+    }
+}
+
+/*
+* 原地的自底向上归并排序：
+* 第k趟把链表看成长度为 2^k 的一段段，相邻两段(p段和q段)归并后接到输出链的尾部tail上，
+* 直到某一趟只做了一次归并为止。只用几个指针，不需要递归也不需要额外的链表。
+* 比较函数抛出异常时，把 输出链 + p段剩下的部分 + q开始的剩余链表 重新接起来，不会丢失结点。
+*/
+template <class T>
+template <class Compare>
+void forward_list<T>::sort(Compare comp) {
+    base_ptr list = head_.next_;
+    if(list == nullptr || list->next_ == nullptr) return;
+
+    size_type insize = 1;
+    while(true) {
+        base_ptr p = list;
+        base_ptr q = nullptr;
+        base_ptr tail = nullptr;
+        size_type psize = 0;
+        size_type merges = 0;
+        list = nullptr;
+        try {
+            while(p != nullptr) {
+                ++merges;
+                // q走到下一段的开头
+                q = p;
+                psize = 0;
+                for(size_type i = 0 ; i < insize && q != nullptr ; ++i) {
+                    ++psize;
+                    q = q->next_;
+                }
+                size_type qsize = insize;
+
+                // 归并p段和q段
+                while(psize > 0 || (qsize > 0 && q != nullptr)) {
+                    base_ptr e;
+                    if(psize == 0) {
+                        e = q; q = q->next_; --qsize;
+                    }else if(qsize == 0 || q == nullptr) {
+                        e = p; p = p->next_; --psize;
+                    }else if(!comp(value_of(q), value_of(p))) {
+                        e = p; p = p->next_; --psize;   // 相等时取p，保证稳定
+                    }else {
+                        e = q; q = q->next_; --qsize;
+                    }
+                    if(tail != nullptr) tail->next_ = e;
+                    else list = e;
+                    tail = e;
+                }
+                p = q;
+            }
+        } catch(...) {
+            // p段剩下的psize个结点之间的链接还是好的，最后一个指向的是原来q段的开头，需要改成当前的q
+            base_ptr rest = q;
+            if(psize > 0) {
+                base_ptr last = p;
+                for(size_type i = 1 ; i < psize ; ++i) last = last->next_;
+                last->next_ = q;
+                rest = p;
+            }
+            if(tail != nullptr) tail->next_ = rest;
+            else list = rest;
+            head_.next_ = list;
+            throw;
+        }
+        tail->next_ = nullptr;
+        if(merges <= 1) break;
+        insize *= 2;
+    }
+    head_.next_ = list;
+}
+
+template <class T>
+void forward_list<T>::reverse() {
+    base_ptr prev = nullptr;
+    base_ptr cur = head_.next_;
+    while(cur != nullptr) {
+        base_ptr next = cur->next_;
+        cur->next_ = prev;
+        prev = cur;
+        cur = next;
+    }
+    head_.next_ = prev;
+}
+
+// 重载比较操作符
+template <class T>
+bool operator==(const forward_list<T>& lhs, const forward_list<T>& rhs) {
+    auto first1 = lhs.begin(), last1 = lhs.end();
+    auto first2 = rhs.begin(), last2 = rhs.end();
+    for(; first1 != last1 && first2 != last2 && *first1 == *first2 ; ++first1, ++first2);
+    return first1 == last1 && first2 == last2;
+}
+
+template <class T>
+bool operator!=(const forward_list<T>& lhs, const forward_list<T>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class T>
+bool operator<(const forward_list<T>& lhs, const forward_list<T>& rhs) {
+    return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T>
+void swap(forward_list<T>& lhs, forward_list<T>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
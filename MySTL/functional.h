@@ -3,6 +3,14 @@
 
 // 这个头文件定义了六大组件之一的Functors
 
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "util.h"
+
 namespace mystl {
 
 // 定义一元函数的模板，所有的Functors必须继承该类型，否则无法被适配
@@ -22,14 +30,14 @@ struct binary_function {
 };
 
 // operator<
-template <class T>
+template <class T = void>
 struct less : public binary_function<T, T, bool> {
     bool operator()(const T& lhs, const T& rhs) const {
         return lhs < rhs;
     }
 };
 
-template <class T>
+template <class T = void>
 struct greater : public binary_function<T, T, bool> {
     bool operator()(const T& lhs, const T& rhs) const {
         return lhs > rhs;
@@ -53,11 +61,44 @@ struct greater_equal : public binary_function<T, T, bool> {
 };
 
 // 函数对象：等于 ==
-template <class T>
+template <class T = void>
 struct equal_to : public binary_function<T, T, bool> {
     bool operator()(const T& x, const T& y) const { return x == y; }
 };
 
+// 透明比较：参数类型由调用时推导，set<std::string, less<>>可以直接用const char*查找，不用构造临时的key
+template <>
+struct less<void> {
+    typedef int is_transparent;
+    template <class T, class U>
+    bool operator()(const T& lhs, const U& rhs) const { return lhs < rhs; }
+};
+
+template <>
+struct greater<void> {
+    typedef int is_transparent;
+    template <class T, class U>
+    bool operator()(const T& lhs, const U& rhs) const { return lhs > rhs; }
+};
+
+template <>
+struct equal_to<void> {
+    typedef int is_transparent;
+    template <class T, class U>
+    bool operator()(const T& x, const U& y) const { return x == y; }
+};
+
+// 函数对象定义了is_transparent时，容器的查找函数才接受key_type以外的类型
+template <class F, class = void>
+struct is_transparent : std::false_type {};
+
+template <class F>
+struct is_transparent<F, std::void_t<typename F::is_transparent>> : std::true_type {};
+
+// 异构查找的重载用它做约束，K参与推导，不满足时只是不参与重载
+template <class F, class K, class R = void>
+using enable_if_transparent_t = typename std::enable_if<is_transparent<F>::value && !std::is_void<K>::value, R>::type;
+
 // !=
 template <class T>
 struct not_equal_to : public binary_function<T, T, bool> {
@@ -95,26 +136,210 @@ struct project2nd : public binary_function<Arg1, Arg2, Arg2> {
 
 
 // 哈希函数对象
-// 对于大部分基本类型，就返回类型本身
+// 整数、指针、浮点数、字符串和pair都先混合成分布均匀的64位值，连续的、按8对齐的key也能均匀散开
+// 混合方式参考wyhash：64位乘64位得到128位积，高低两半异或，每一位输入都会影响大部分输出位
+// 每个hash对象带一个种子，默认为MYSTL_HASH_SEED，可以在构造容器时传入 hash<Key>(seed) 来换种子
+
+#ifndef MYSTL_HASH_SEED
+#define MYSTL_HASH_SEED 0
+#endif
+
+// wyhash的常数
+constexpr uint64_t hash_secret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
+
+// 128位积，低64位放回a，高64位放回b
+inline void hash_mum(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#else
+    const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    const uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+    hash_mum(a, b);
+    return a ^ b;
+}
+
+// 一个64位整数，两次乘法：只做一次时，输入的高位几乎影响不到输出的某些低位
+inline size_t hash_int(uint64_t x, uint64_t seed = MYSTL_HASH_SEED) {
+    uint64_t a = x ^ hash_secret[0], b = seed ^ hash_secret[1];
+    hash_mum(a, b);
+    return static_cast<size_t>(hash_mix(a ^ hash_secret[2], b ^ hash_secret[3]));
+}
+
+inline uint64_t hash_read8(const unsigned char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+inline uint64_t hash_read4(const unsigned char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+// 1到3个字节
+inline uint64_t hash_read3(const unsigned char* p, size_t k) {
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+// 任意一段字节，结构与wyhash相同：短输入读两次重叠的4或8字节，长输入每次并行处理48字节
+inline size_t hash_bytes(const void* key, size_t len, uint64_t seed = MYSTL_HASH_SEED) {
+    const unsigned char* p = static_cast<const unsigned char*>(key);
+    seed ^= hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+    uint64_t a, b;
+    if(len <= 16) {
+        if(len >= 4) {
+            a = (hash_read4(p) << 32) | hash_read4(p + ((len >> 3) << 2));
+            b = (hash_read4(p + len - 4) << 32) | hash_read4(p + len - 4 - ((len >> 3) << 2));
+        }else if(len > 0) {
+            a = hash_read3(p, len);
+            b = 0;
+        }else {
+            a = b = 0;
+        }
+    }else {
+        size_t i = len;
+        if(i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = hash_mix(hash_read8(p) ^ hash_secret[1], hash_read8(p + 8) ^ seed);
+                see1 = hash_mix(hash_read8(p + 16) ^ hash_secret[2], hash_read8(p + 24) ^ see1);
+                see2 = hash_mix(hash_read8(p + 32) ^ hash_secret[3], hash_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }while(i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while(i > 16) {
+            seed = hash_mix(hash_read8(p) ^ hash_secret[1], hash_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = hash_read8(p + i - 16);
+        b = hash_read8(p + i - 8);
+    }
+    a ^= hash_secret[1];
+    b ^= seed;
+    hash_mum(a, b);
+    return static_cast<size_t>(hash_mix(a ^ hash_secret[0] ^ len, b ^ hash_secret[1]));
+}
+
+// 把一个哈希值合并进已有的哈希值，顺序不同结果不同
+inline size_t hash_combine(size_t h, size_t v) {
+    return static_cast<size_t>(hash_mix(static_cast<uint64_t>(h) ^ hash_secret[2], static_cast<uint64_t>(v) ^ hash_secret[3]));
+}
+
+// 哈希函数定义了is_avalanching时，说明结果已经充分混合，开放寻址的表可以直接使用而不用再混合一次
+template <class F, class = void>
+struct is_avalanching : std::false_type {};
+
+template <class F>
+struct is_avalanching<F, std::void_t<typename F::is_avalanching>> : std::true_type {};
+
+// 哈希函数定义了is_fast_hash时，说明算一次哈希值比比较一次key还便宜（整数、指针、浮点数），
+// 拉链法的hashtable据此决定要不要在结点里缓存哈希值；没有定义的一律当作昂贵的哈希
+template <class F, class = void>
+struct is_fast_hash : std::false_type {};
+
+template <class F>
+struct is_fast_hash<F, std::void_t<typename F::is_fast_hash>> : std::true_type {};
+
+// 整数、枚举、字符类型
 template <class Key>
 struct hash {
+    typedef int is_avalanching;
+    typedef int is_fast_hash;
+    uint64_t seed;
+
+    explicit hash(uint64_t s = MYSTL_HASH_SEED) : seed(s) {}
+
     size_t operator()(const Key& k) const {
-        return k;
+        return hash_int(static_cast<uint64_t>(k), seed);
     }
 };
 
-// 指针偏特化
+// 指针偏特化：地址按对齐，低几位总是0
 template <class T>
 struct hash<T*> {
+    typedef int is_avalanching;
+    typedef int is_fast_hash;
+    uint64_t seed;
+
+    explicit hash(uint64_t s = MYSTL_HASH_SEED) : seed(s) {}
+
     size_t operator()(T* ptr) const {
-        return reinterpret_cast<size_t>(ptr);
+        return hash_int(reinterpret_cast<uintptr_t>(ptr), seed);
     }
 };
 
 template <class T>
 struct hash<const T*> {
+    typedef int is_avalanching;
+    typedef int is_fast_hash;
+    uint64_t seed;
+
+    explicit hash(uint64_t s = MYSTL_HASH_SEED) : seed(s) {}
+
     size_t operator()(const T* ptr) const {
-        return reinterpret_cast<size_t>(ptr);
+        return hash_int(reinterpret_cast<uintptr_t>(ptr), seed);
+    }
+};
+
+// 浮点数按位哈希，+0.0和-0.0相等，哈希值也要相同
+template <>
+struct hash<double> {
+    typedef int is_avalanching;
+    typedef int is_fast_hash;
+    uint64_t seed;
+
+    explicit hash(uint64_t s = MYSTL_HASH_SEED) : seed(s) {}
+
+    size_t operator()(double d) const {
+        if(d == 0.0) d = 0.0;
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        return hash_int(bits, seed);
+    }
+};
+
+template <>
+struct hash<float> : public hash<double> {
+    using hash<double>::hash;
+};
+
+// 字符串：透明的，std::string、string_view、const char*都按字节哈希，结果一致
+template <>
+struct hash<std::string_view> {
+    typedef int is_transparent;
+    typedef int is_avalanching;
+    uint64_t seed;
+
+    explicit hash(uint64_t s = MYSTL_HASH_SEED) : seed(s) {}
+
+    size_t operator()(std::string_view str) const {
+        return hash_bytes(str.data(), str.size(), seed);
+    }
+};
+
+template <>
+struct hash<std::string> : public hash<std::string_view> {
+    using hash<std::string_view>::hash;
+};
+
+// pair：两个成员分别哈希后合并
+template <class T1, class T2>
+struct hash<mystl::pair<T1, T2>> {
+    typedef int is_avalanching;
+    uint64_t seed;
+
+    explicit hash(uint64_t s = MYSTL_HASH_SEED) : seed(s) {}
+
+    size_t operator()(const mystl::pair<T1, T2>& p) const {
+        return hash_combine(hash<T1>(seed)(p.first), hash<T2>(seed)(p.second));
     }
 };
 
@@ -2,6 +2,7 @@
 #define __HASHTABLE_H__
 
 #include <initializer_list>
+#include <cstdint>
 
 #include "algo.h"
 #include "functional.h"
@@ -13,35 +14,54 @@
 
 namespace mystl {
 
-template <class T>
-struct hashtable_Node {
+// 是否在结点里缓存key的哈希值，hashtable和迭代器都由HashFun得到这个值
+// 缓存之后resize和迭代器++不用再对每个结点重新哈希，沿链比较时也先比哈希值，不相等就不用调用equals_
+// 默认只对昂贵的哈希函数（没有定义is_fast_hash的，例如字符串）缓存，可以对自己的哈希函数特化
+template <class HashFun>
+struct hashtable_cache_hash_code : std::integral_constant<bool, !is_fast_hash<HashFun>::value> {};
+
+// 结点的哈希值部分，不缓存时是空的基类，结点大小不变
+template <bool Cache>
+struct hashtable_node_hash {
+    void set_hash_code(size_t) {}
+};
+
+template <>
+struct hashtable_node_hash<true> {
+    size_t hash_code;           // key的哈希值，还没有映射到bucket
+
+    void set_hash_code(size_t code) { hash_code = code; }
+};
+
+template <class T, bool Cache = false>
+struct hashtable_Node : public hashtable_node_hash<Cache> {
     hashtable_Node* next;       // 下一个结点指针
     T               value;      // 值域
 
     hashtable_Node() = default;
     hashtable_Node(const T& n) : next(nullptr), value(n) {}
-    hashtable_Node(const hashtable_Node& node) : next(node.next), value(node.value) {}
-    hashtable_Node(hashtable_Node&& node) : next(node.next), value(mystl::move(node.value)) {
+    hashtable_Node(const hashtable_Node& node) : hashtable_node_hash<Cache>(node), next(node.next), value(node.value) {}
+    hashtable_Node(hashtable_Node&& node) : hashtable_node_hash<Cache>(node), next(node.next), value(mystl::move(node.value)) {
         node.next = nullptr;
     }
 };
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
 class hashtable;
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
 struct hashtable_iterator;
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
 struct hashtable_const_iterator;
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
 struct hashtable_iterator {
-    typedef hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>                    Hashtable;
-    typedef hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>           iterator;
-    typedef hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>     const_iterator;
-    typedef hashtable_Node<Value>                                                   Node;
-    typedef hashtable_Node<Value>*                                                  node_ptr;
+    typedef hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>                    Hashtable;
+    typedef hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>           iterator;
+    typedef hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>     const_iterator;
+    typedef hashtable_Node<Value, hashtable_cache_hash_code<HashFun>::value>       Node;
+    typedef Node*                                                                   node_ptr;
     typedef Hashtable*                                                              table_ptr;      // 指向哈希表buckets的指针，也就是vector*
 
     typedef forward_iterator_tag    iterator_category;
@@ -76,13 +96,13 @@ struct hashtable_iterator {
 };
 
 // const_iterator
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
 struct hashtable_const_iterator {
-    typedef hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>                    Hashtable;
-    typedef hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>           iterator;
-    typedef hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>     const_iterator;
-    typedef hashtable_Node<Value>                                                   Node;
-    typedef hashtable_Node<Value>*                                                  node_ptr;
+    typedef hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>                    Hashtable;
+    typedef hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>           iterator;
+    typedef hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>     const_iterator;
+    typedef hashtable_Node<Value, hashtable_cache_hash_code<HashFun>::value>       Node;
+    typedef Node*                                                                   node_ptr;
     typedef Hashtable*                                                              table_ptr;      // 指向哈希表buckets的指针，也就是vector*
 
     typedef forward_iterator_tag    iterator_category;
@@ -118,9 +138,9 @@ struct hashtable_const_iterator {
 
 
 // 质数表
-const int num_primes = 28;
+constexpr int num_primes = 28;
 
-static const unsigned long ht_prime_list[num_primes] =
+static constexpr unsigned long ht_prime_list[num_primes] =
 {
   53ul,         97ul,         193ul,       389ul,       769ul,
   1543ul,       3079ul,       6151ul,      12289ul,     24593ul,
@@ -137,19 +157,105 @@ unsigned long next_prime(unsigned long n) {
     const unsigned long* pos = mystl::lower_bound(first, last, n);
     return pos == last ? *(last - 1) : *pos;     // pos == last 就说明n比最大的还要大了
 }
- 
+
+
+// 把哈希值映射到bucket下标的策略，hashtable的第六个参数：
+//   policy(n)          bucket个数为n，n由next_size得到
+//   next_size(n)       不小于n的bucket个数
+//   max_size()         最大的bucket个数
+//   operator()(hash)   hash对应的下标，在[0, n)中
+// 每次查找、插入、删除以及resize时的每个结点都要算一次下标，所以这一步要足够快
+
+// 质数个bucket，直接取模：每次都是一次几十个周期的64位除法
+struct hashtable_prime_policy {
+    size_t n_;
+
+    explicit hashtable_prime_policy(size_t n = ht_prime_list[0]) : n_(n) {}
+
+    static size_t next_size(size_t n) { return next_prime(n); }
+    static size_t max_size() { return ht_prime_list[num_primes - 1]; }
+
+    size_t operator()(size_t hash) const { return hash % n_; }
+};
+
+// Lemire的fastmod：d < 2^32，M = ceil(2^64 / d)，对32位的h有 h mod d = ((M * h mod 2^64) * d) >> 64
+// 两次乘法代替一次除法，M在编译期为质数表中的每个质数算好
+struct ht_fastmod_table {
+    uint64_t magic[num_primes];
+
+    constexpr ht_fastmod_table() : magic() {
+        for(int i = 0 ; i < num_primes ; ++i) magic[i] = UINT64_MAX / ht_prime_list[i] + 1;
+    }
+};
+
+static constexpr ht_fastmod_table ht_fastmod_magic{};
+
+// 仍然是质数个bucket，下标用fastmod计算
+// fastmod要求32位的h，64位的哈希值先乘以 2^64 / φ 把所有位混合到高位，再取高32位。
+// 直接把高低32位异或会让高低两半相同的哈希值都落到bucket 0，不做混合的哈希函数很容易遇到
+struct hashtable_fastmod_policy {
+#if defined(__SIZEOF_INT128__)
+    uint64_t magic_;
+#endif
+    uint32_t d_;
+
+    explicit hashtable_fastmod_policy(size_t n = ht_prime_list[0]) : d_(static_cast<uint32_t>(n)) {
+#if defined(__SIZEOF_INT128__)
+        const unsigned long* pos = mystl::lower_bound(ht_prime_list, ht_prime_list + num_primes, n);
+        magic_ = pos != ht_prime_list + num_primes && *pos == n ? ht_fastmod_magic.magic[pos - ht_prime_list]
+                                                                 : UINT64_MAX / n + 1;
+#endif
+    }
+
+    static size_t next_size(size_t n) { return next_prime(n); }
+    static size_t max_size() { return ht_prime_list[num_primes - 1]; }
+
+    size_t operator()(size_t hash) const {
+        const uint32_t h = static_cast<uint32_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> 32);
+#if defined(__SIZEOF_INT128__)
+        const uint64_t low = magic_ * h;
+        return static_cast<size_t>((static_cast<__uint128_t>(low) * d_) >> 64);
+#else
+        return h % d_;
+#endif
+    }
+};
+
+// 2的幂个bucket，斐波那契散列：乘以 2^64 / φ 把所有位混合到高位，再取最高的log2(n)位
+// 不需要除法，也不怕只返回key本身的哈希函数；n最小为8
+struct hashtable_pow2_policy {
+    unsigned shift_;
+
+    explicit hashtable_pow2_policy(size_t n = 8) : shift_(64) {
+        for(size_t s = 1 ; s < n ; s <<= 1) --shift_;
+    }
+
+    static size_t next_size(size_t n) {
+        size_t s = 8;
+        while(s < n && s < max_size()) s <<= 1;
+        return s;
+    }
+    static size_t max_size() { return static_cast<size_t>(1) << (sizeof(size_t) * 8 - 2); }
+
+    size_t operator()(size_t hash) const {
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+};
+
 
 // 哈希表，第一个参数是key，第二个参数是node存放的真正的值，第三个参数是对key进行散列函数，第四个参数是对value提取key，第五个参数是判断key是否相等
+// 第六个参数是把哈希值映射到bucket下标的策略
 template <class Key, class Value, class HashFun = mystl::hash<Key>, 
-          class KeyOfValue = mystl::identity<Value>, class EqualKey = mystl::equal_to<Key>>
+          class KeyOfValue = mystl::identity<Value>, class EqualKey = mystl::equal_to<Key>,
+          class RangePolicy = hashtable_fastmod_policy>
 class hashtable {
 public:
     typedef     Key                         key_type;
     typedef     Value                       value_type;
     typedef     HashFun                     hasher;         // 用来对key进行hash的
     typedef     EqualKey                    key_equal;
-    typedef     hashtable_Node<Value>       Node;
-    typedef     hashtable_Node<Value>*      node_ptr;
+    typedef     hashtable_Node<Value, hashtable_cache_hash_code<HashFun>::value>   Node;
+    typedef     Node*                       node_ptr;
 
     typedef     size_t              size_type;
     typedef     ptrdiff_t           difference_type;
@@ -162,8 +268,8 @@ public:
     typedef     mystl::allocator<Value>     data_allocator;
     typedef     mystl::allocator<Node>      node_allocator;
 
-    typedef hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>           iterator;
-    typedef hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>     const_iterator;     
+    typedef hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>           iterator;
+    typedef hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>     const_iterator;     
 
     hasher      hash_funct()    const { return  hash_; }
     key_equal   key_eq()        const { return  equals_; }
@@ -172,16 +278,29 @@ public:
     allocator_type  get_allocator() const { return allocator_type(); }
 
     // 一定要声明有元，否则访问不了
-    friend struct hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>;
-    friend struct hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>;
+    friend struct hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>;
+    friend struct hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>;
 
 private:
-    // 用六个参数来表现hashtable
+    // 用七个参数来表现hashtable
     hasher                      hash_;      // 对key进行hash的仿函数
     key_equal                   equals_;    // 判断key是否相等的仿函数
     KeyOfValue                  get_key_;   // 从value中提取出来key的仿函数
     mystl::vector<node_ptr>     buckets_;   // 哈希表，存放node指针，采用拉链法
     size_type                   num_elems_; // 有多少个哈希node
+    RangePolicy                 range_;     // 当前bucket个数下，哈希值到下标的映射
+
+    // 渐进式rehash分两步，都分摊到之后的每次插入里：
+    // 1. 准备：新表只reserve不初始化，每次插入清零一段，几百MB的新表也不会在一次插入里清零
+    // 2. 搬迁：新表成为buckets_，旧的buckets留在old_buckets_，每次插入搬几个旧bucket
+    // 搬迁期间的不变式：key在旧表里对应的bucket不为空，当且仅当这个key的结点还在旧表里
+    // 插入前先把key对应的旧bucket整个搬走，所以相等的key总在同一张表的同一条链上，查找只需要看一张表
+    mystl::vector<node_ptr>     new_buckets_;       // 正在清零的新表
+    size_type                   new_size_ = 0;      // 新表的大小，为0说明没有在准备
+    mystl::vector<node_ptr>     old_buckets_;       // 正在搬迁的旧表，为空说明没有在搬迁
+    RangePolicy                 old_range_;         // 旧表的映射
+    size_type                   migrate_pos_ = 0;   // 旧表中这个下标之前的bucket都已经搬走了
+    bool                        incremental_ = false;   // 是否使用渐进式rehash
 
 public:
     // 构造、拷贝、移动和析构函数
@@ -196,22 +315,29 @@ public:
         init_buckets(n);    // 将bucket设置为next n的大小，同时num_elems设为0
     }
 
-    hashtable(const hashtable& ht) : hash_(ht.hash_), equals_(ht.equals_), get_key_(ht.get_key_), num_elems_(0) {
+    hashtable(const hashtable& ht) : hash_(ht.hash_), equals_(ht.equals_), get_key_(ht.get_key_), num_elems_(0),
+                                     incremental_(ht.incremental_) {
         copy_from(ht);  // 包括buckets的内存分配, 以及num的设置
     }
 
     // 将另一个资源掠夺，并置空另一个ht
     hashtable(hashtable&& rhs) : hash_(rhs.hash_), equals_(rhs.equals_), get_key_(rhs.get_key_),
-                                buckets_(mystl::move(rhs.buckets_)) , num_elems_(rhs.num_elems_) {
+                                buckets_(mystl::move(rhs.buckets_)) , num_elems_(rhs.num_elems_), range_(rhs.range_),
+                                new_buckets_(mystl::move(rhs.new_buckets_)), new_size_(rhs.new_size_),
+                                old_buckets_(mystl::move(rhs.old_buckets_)), old_range_(rhs.old_range_),
+                                migrate_pos_(rhs.migrate_pos_), incremental_(rhs.incremental_) {
+        rhs.new_size_ = 0;
         rhs.num_elems_ = 0; // 由于rhs.buckets已经经由move copy掠夺了，所以不用置空另一个的vector
     }
 
     hashtable& operator=(const hashtable& rhs) {
         if(&rhs != this) {
             clear();        // 清空自身资源
+            finish_rehash();    // 丢掉正在准备的新表，否则之后的grow会换成按原来大小准备的表
             hash_ = rhs.hash_;
             equals_ = rhs.equals_;
             get_key_ = rhs.get_key_;
+            incremental_ = rhs.incremental_;
             copy_from(rhs);
         }
         return *this;
@@ -225,8 +351,16 @@ public:
         get_key_ = rhs.get_key_;
         buckets_ = mystl::move(rhs.buckets_);
         num_elems_ = rhs.num_elems_;
+        range_ = rhs.range_;
+        new_buckets_ = mystl::move(rhs.new_buckets_);
+        new_size_ = rhs.new_size_;
+        old_buckets_ = mystl::move(rhs.old_buckets_);
+        old_range_ = rhs.old_range_;
+        migrate_pos_ = rhs.migrate_pos_;
+        incremental_ = rhs.incremental_;
 
         rhs.num_elems_ = 0;
+        rhs.new_size_ = 0;
         return *this;
     }
 
@@ -252,16 +386,31 @@ public:
             mystl::swap(equals_, rhs.equals_);
             mystl::swap(get_key_, rhs.get_key_);
             mystl::swap(num_elems_, rhs.num_elems_);
+            mystl::swap(range_, rhs.range_);
+            new_buckets_.swap(rhs.new_buckets_);
+            mystl::swap(new_size_, rhs.new_size_);
+            old_buckets_.swap(rhs.old_buckets_);
+            mystl::swap(old_range_, rhs.old_range_);
+            mystl::swap(migrate_pos_, rhs.migrate_pos_);
+            mystl::swap(incremental_, rhs.incremental_);
         }
     }
 
+    // 打开后扩容不再一次搬完所有结点，而是分摊到之后的插入里，单次插入的最坏延迟从O(n)降到O(1)
+    // 代价是搬迁期间查找多一次判断，begin()和迭代器++要多看一张表；关闭时会先把正在搬的搬完
+    void set_incremental_rehash(bool on) {
+        if(!on) finish_rehash();
+        incremental_ = on;
+    }
+    bool incremental_rehash() const { return incremental_; }
+
 public:
-    // 返回buckets的大小
+    // 返回buckets的大小，渐进式rehash期间是新表的大小
     size_type bucket_count() const { return buckets_.size(); }
 
-    size_type max_bucket_count() const { return ht_prime_list[num_primes - 1]; }
+    size_type max_bucket_count() const { return RangePolicy::max_size(); }
 
-    // 返回当前散列的个数
+    // 返回当前散列的个数，渐进式rehash期间只统计新表
     size_type elems_in_bucket(size_type bucket_idx) const {
         size_type result = 0;
         for(node_ptr cur = buckets_[bucket_idx] ; cur ; cur = cur->next) {
@@ -272,11 +421,11 @@ public:
 
     // insert
     mystl::pair<iterator, bool> insert_unique(const value_type& value) {
-        resize(num_elems_ + 1);
+        grow(num_elems_ + 1);
         return insert_unique_noresize(value);
     }
     iterator insert_equal(const value_type& value) {
-        resize(num_elems_ + 1);
+        grow(num_elems_ + 1);
         return insert_equal_noresize(value);
     }
 
@@ -299,67 +448,90 @@ public:
     }
 
     
+    // 异构查找：hasher和key_equal都定义了is_transparent时，查找和删除接受任意K，
+    // 要求hash_(K)和hash_(key_type)对相等的键值给出相同的结果
+    template <class K>
+    using if_transparent = enable_if_transparent_t<hasher, K, enable_if_transparent_t<key_equal, K>>;
+    template <class K>
+    using if_transparent_key = typename std::enable_if<!std::is_convertible<K, iterator>::value &&
+                                                       !std::is_convertible<K, const_iterator>::value,
+                                                       if_transparent<K>>::type;
+
     // erase
-    size_type erase(const key_type& key);
+    size_type erase(const key_type& key) { return erase_key(key); }
+    template <class K, class = if_transparent_key<K>>
+    size_type erase(const K& key) { return erase_key(key); }
     iterator erase(const iterator& it);
     void erase(iterator first, iterator last);
 
 
     // 传入的参数是新的结点个数，如果结点个数大于bucket的个数，则会重构哈希表，否则什么都不干
     // 所以在插入之类的，让结点数量增加的地方，可以用这个来试图重构
+    // 总是一次做完，正在渐进式rehash的话先搬完
     void resize(size_type num_elems_hint); 
 
     // find
-    iterator find(const key_type& key) {
-        const size_type n = bkt_num_key(key);
-        node_ptr first;
-        // 找到相等的
-        for(first = buckets_[n] ; first && !equals_(get_key_(first->value), key) ; first = first->next) { }
+    iterator find(const key_type& key) { return iterator(find_node(key), this); }
+    template <class K, class = if_transparent<K>>
+    iterator find(const K& key) { return iterator(find_node(key), this); }
 
-        return iterator(first, this);   // 有可能最后找不到，first 为nullptr，也就是end
-    }
-
-    size_type count(const key_type& key) const {
-        const size_type n = bkt_num_key(key);
-        size_type result = 0;
-        for(node_ptr cur = buckets_[n] ; cur ; cur = cur->next) {
-            if(equals_(get_key_(cur->value), key)) {
-                ++result;
-            }
-        }
-        return result;
-    }
+    size_type count(const key_type& key) const { return count_key(key); }
+    template <class K, class = if_transparent<K>>
+    size_type count(const K& key) const { return count_key(key); }
 
     pair<iterator, iterator>
-    equal_range(const key_type& key);
+    equal_range(const key_type& key) { return equal_range_key(key); }
+    template <class K, class = if_transparent<K>>
+    pair<iterator, iterator>
+    equal_range(const K& key) { return equal_range_key(key); }
 
 
     // 将所有node清空释放，vector不用管，这个会自动释放
     void clear() {
-        erase(begin(), end());
+        if(rehashing()) {
+            clear_buckets(old_buckets_);
+            mystl::vector<node_ptr>().swap(old_buckets_);
+        }
+        clear_buckets(buckets_);
+        num_elems_ = 0;
     }  
 
 private:
     // 辅助函数
 
     // 找到哈希表的第一个元素的辅助函数
+    // 渐进式rehash期间先遍历旧表再遍历新表
     iterator begin_aux() {
-        for(size_type n = 0 ; n < buckets_.size() ; ++n) {
-            if(buckets_[n]) {
-                // 找到了不为空的第一个元素
-                return iterator(buckets_[n], this);     // node* hashtable* 构造函数
-            }
-        }
-        return iterator(nullptr, this);     // end
+        return iterator(first_node(0, true), this);     // node* hashtable* 构造函数，nullptr就是end
     }
 
     const_iterator begin_aux() const {
-        for(size_type n = 0 ; n < buckets_.size() ; ++n) {
-            if(buckets_[n]) {
-                return const_iterator(buckets_[n], this);     
+        return const_iterator(first_node(0, true), const_cast<hashtable*>(this));
+    }
+
+    // 从bucket n开始第一个不为空的结点，in_old表示从旧表开始找，旧表找完接着找新表
+    node_ptr first_node(size_type n, bool in_old) const {
+        if(in_old && rehashing()) {
+            for(; n < old_buckets_.size() ; ++n) {
+                if(old_buckets_[n]) return old_buckets_[n];
             }
+            n = 0;
+        }
+        for(; n < buckets_.size() ; ++n) {
+            if(buckets_[n]) return buckets_[n];
+        }
+        return nullptr;
+    }
+
+    // 迭代器++：链表没走完就是next，否则找下一个不为空的bucket
+    node_ptr next_node(node_ptr p) const {
+        if(p->next) return p->next;
+        const size_type code = node_hash_code(p);
+        if(rehashing()) {
+            const size_type old_n = old_range_(code);
+            if(old_buckets_[old_n]) return first_node(old_n + 1, true);   // p还在旧表里
         }
-        return const_iterator(nullptr, this); 
+        return first_node(range_(code) + 1, false);
     }
 
     // 初始化n个元素的buckets，当然长度由prime决定
@@ -367,6 +539,7 @@ private:
         const size_type size = next_size(n);
         buckets_.reserve(size);        // 预留n个空间
         buckets_.insert(buckets_.end(), size, nullptr);     // 全部初始化为nullptr
+        range_ = RangePolicy(size);
         num_elems_ = 0;     // 结点数量设置为0
     }
 
@@ -380,6 +553,7 @@ private:
             return node;
         }catch(...) {
             node_allocator::deallocate(node);
+            throw;
         }
     }
 
@@ -393,23 +567,95 @@ private:
     }
 
     // 返回key所属的hashtable下标(vector)
-    // hash是为了得到size_t的hash_code, 下标映射就是取模
-    size_type bkt_num_key(const key_type& key, size_t size) const {
-        return hash_(key) % size;  
+    // hash是为了得到size_t的hash_code, 下标映射由RangePolicy决定
+    // K为key_type，或者异构查找时的其他类型
+    template <class K>
+    size_type bkt_num_key(const K& key, const RangePolicy& range) const {
+        return range(hash_(key));
+    }
+
+    template <class K>
+    size_type bkt_num_key(const K& key) const {
+        return bkt_num_key(key, range_);
+    }
+
+    // 结点里是否缓存了哈希值，下面的函数按它做标签分派
+    typedef std::integral_constant<bool, hashtable_cache_hash_code<HashFun>::value> cache_hash_code;
+
+    // 结点key的哈希值和所在的bucket，缓存了哈希值就不用再哈希一次
+    size_type node_hash_code(node_ptr p, std::true_type) const { return p->hash_code; }
+    size_type node_hash_code(node_ptr p, std::false_type) const { return hash_(get_key_(p->value)); }
+    size_type node_hash_code(node_ptr p) const { return node_hash_code(p, cache_hash_code()); }
+
+    void copy_hash_code(node_ptr to, node_ptr from, std::true_type) const { to->hash_code = from->hash_code; }
+    void copy_hash_code(node_ptr, node_ptr, std::false_type) const { }
+
+    size_type bkt_num_node(node_ptr p, const RangePolicy& range) const { return range(node_hash_code(p)); }
+    size_type bkt_num_node(node_ptr p) const { return bkt_num_node(p, range_); }
+
+    bool rehashing() const { return !old_buckets_.empty(); }
+
+    // 哈希值为code的key所在的链表头，渐进式rehash期间可能在旧表里
+    node_ptr& bucket_of(size_type code) {
+        if(rehashing()) {
+            node_ptr& old = old_buckets_[old_range_(code)];
+            if(old) return old;
+        }
+        return buckets_[range_(code)];
+    }
+    node_ptr bucket_of(size_type code) const {
+        return const_cast<hashtable*>(this)->bucket_of(code);
     }
 
-    size_type bkt_num_key(const key_type& key) const {
-        return bkt_num_key(key, buckets_.size());
+    // 结点的key是否等于key，code为key的哈希值，缓存了哈希值时先比较哈希值
+    template <class K>
+    bool node_equals(node_ptr p, size_type code, const K& key, std::true_type) const {
+        return p->hash_code == code && equals_(get_key_(p->value), key);
+    }
+    template <class K>
+    bool node_equals(node_ptr p, size_type, const K& key, std::false_type) const {
+        return equals_(get_key_(p->value), key);
+    }
+    template <class K>
+    bool node_equals(node_ptr p, size_type code, const K& key) const {
+        return node_equals(p, code, key, cache_hash_code());
+    }
+
+    // 查找的实现，没找到返回nullptr，也就是end
+    template <class K>
+    node_ptr find_node(const K& key) const {
+        const size_type code = hash_(key);
+        node_ptr first;
+        // 找到相等的
+        for(first = bucket_of(code) ; first && !node_equals(first, code, key) ; first = first->next) { }
+        return first;
+    }
+
+    template <class K>
+    size_type count_key(const K& key) const {
+        const size_type code = hash_(key);
+        size_type result = 0;
+        for(node_ptr cur = bucket_of(code) ; cur ; cur = cur->next) {
+            if(node_equals(cur, code, key)) {
+                ++result;
+            }
+        }
+        return result;
     }
 
+    template <class K>
+    pair<iterator, iterator> equal_range_key(const K& key);
+    template <class K>
+    size_type erase_key(const K& key);
+
     /* // 设置带value的映射
     size_type bkt_num_key(const value_type& value) const {
         return bkt_num_key(get_key_(value));
     } */
 
-    // 靠近n的下一个质数
+    // 不小于n的bucket个数，默认的策略为下一个质数
     size_type next_size(size_type n) const {
-        return next_prime(n);
+        return RangePolicy::next_size(n);
     }
 
 
@@ -417,6 +663,20 @@ private:
     pair<iterator, bool> insert_unique_noresize(const value_type& value);
     iterator insert_equal_noresize(const value_type& value);
 
+    // 单个插入前调用：没有打开渐进式rehash时就是resize，否则只开始搬迁，或者继续搬几个bucket
+    void grow(size_type num_elems_hint);
+    // 把旧表的bucket n整个搬到新表
+    void migrate_bucket(size_type n);
+    // 把旧表剩下的全部搬完，还在准备新表的话放弃准备
+    void finish_rehash();
+    // 释放一张表的所有结点
+    void clear_buckets(mystl::vector<node_ptr>& buckets);
+
+    // 每次插入清零新表的多少个bucket（一页），以及搬几个旧bucket
+    // 新表大约是旧表的两倍，下一次扩容前至少还有旧表大小那么多次插入，两步都来得及做完
+    static constexpr size_type zero_step = 512;
+    static constexpr size_type migrate_step = 8;
+
 
     // 从另一个哈希表中复制到这里来
     void copy_from(const hashtable& ht);
@@ -427,68 +687,54 @@ private:
 
 // 重载迭代器++
 // 这里是通过value的值，找到buckets的下标(通过散列)，然后顺着这个下标找，如果都找不到那就是nullptr
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-typename hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>::iterator& 
-hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>::operator++() {
-    const node_ptr old = cur;
-    cur = cur->next;
-    if(!cur) {
-        // cur移动到当前链表的末尾了
-        size_type bucket_idx = ht->bkt_num_key(ht->get_key_(old->value));
-        while(!cur && ++bucket_idx < ht->buckets_.size()) {
-            cur = ht->buckets_[bucket_idx];
-        }
-    }
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+typename hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::iterator& 
+hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::operator++() {
+    cur = ht->next_node(cur);
     return *this;
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-typename hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>::iterator 
-hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>::operator++(int) {
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+typename hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::iterator 
+hashtable_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::operator++(int) {
     iterator tmp = *this;
     ++*this;
     return tmp;
 }
 
 // const_iterator
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-typename hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>::const_iterator& 
-hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>::operator++() {
-    const node_ptr old = cur;
-    cur = cur->next;
-    if(!cur) {
-        // cur移动到当前链表的末尾了
-        size_type bucket_idx = ht->bkt_num_key(ht->get_key_(old->value));
-        while(!cur && ++bucket_idx < ht->buckets_.size()) {
-            cur = ht->buckets_[bucket_idx];
-        }
-    }
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+typename hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::const_iterator& 
+hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::operator++() {
+    cur = ht->next_node(cur);
     return *this;
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-typename hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>::const_iterator
-hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey>::operator++(int) {
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+typename hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::const_iterator
+hashtable_const_iterator<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::operator++(int) {
     const_iterator tmp = *this;
     ++*this;
     return tmp;
 }
 
 // hashtable
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::resize(size_type num_elems_hint) {
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::resize(size_type num_elems_hint) {
     //std::cout << "resize begin" << std::endl; 
+    finish_rehash();
     const size_type old_n = buckets_.size();
     if(num_elems_hint > old_n) {
         // 需要重构了
         const size_type n = next_size(num_elems_hint);  // 下一个质数
         if(n > old_n) {
             mystl::vector<node_ptr> tmp(n, nullptr);
+            const RangePolicy range(n);
             // 将原来的node移动到新的hash表
             for(size_type bucket = 0 ; bucket < old_n ; ++ bucket) {
                 node_ptr first = buckets_[bucket];
                 while(first) {
-                    size_type new_bucket = bkt_num_key(get_key_(first->value), n);    // 这里要用n，否则用旧的size哈希了
+                    size_type new_bucket = bkt_num_node(first, range);    // 这里要用新的映射，否则用旧的size哈希了
                     buckets_[bucket] = first->next;
                     first->next = tmp[new_bucket];
                     tmp[new_bucket] = first;
@@ -496,42 +742,49 @@ void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::resize(size_type num_
                 }
             }
             buckets_.swap(tmp); // 这里完成旧hash表的内存释放
+            range_ = range;
         }
         // else 否则不需要在扩容
     }
     //std::cout << "resize end" << std::endl; 
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-pair<typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::iterator, bool> 
-hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::insert_unique_noresize(const value_type& value) {
-    const size_type n = bkt_num_key(get_key_(value));
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+pair<typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::iterator, bool> 
+hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::insert_unique_noresize(const value_type& value) {
+    const size_type code = hash_(get_key_(value));
+    if(rehashing()) migrate_bucket(old_range_(code));   // 保证这个key只可能在新表里
+    const size_type n = range_(code);
     node_ptr first = buckets_[n];
 
     for(node_ptr cur = first ; cur ; cur = cur->next) {
-        if(equals_(get_key_(cur->value), get_key_(value))) {
+        if(node_equals(cur, code, get_key_(value))) {
             // 说明有重复key
             return pair<iterator, bool>(iterator(cur, this), false);
         }
     }
 
     node_ptr tmp = create_node(value);
+    tmp->set_hash_code(code);
     tmp->next = first;
     buckets_[n] = tmp;
     ++num_elems_;
     return pair<iterator, bool>(iterator(tmp, this), true);
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::iterator 
-hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::insert_equal_noresize(const value_type& value) {
-    const size_type n = bkt_num_key(get_key_(value));
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::iterator 
+hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::insert_equal_noresize(const value_type& value) {
+    const size_type code = hash_(get_key_(value));
+    if(rehashing()) migrate_bucket(old_range_(code));
+    const size_type n = range_(code);
     node_ptr first = buckets_[n];
 
     for(node_ptr cur = first ; cur ; cur = cur->next) {
-        if(equals_(get_key_(cur->value), get_key_(value))) {
+        if(node_equals(cur, code, get_key_(value))) {
             // 说明有重复key, 在第一个key后面插入，不能保证稳定性
             node_ptr tmp = create_node(value);
+            tmp->set_hash_code(code);
             tmp->next = cur->next;
             cur->next = tmp;
             ++num_elems_;
@@ -540,47 +793,46 @@ hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::insert_equal_noresize(cons
     }
 
     node_ptr tmp = create_node(value);
+    tmp->set_hash_code(code);
     tmp->next = first;
     buckets_[n] = tmp;
     ++num_elems_;
     return iterator(tmp, this);
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-pair<typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::iterator, 
-     typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::iterator>
-hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::equal_range(const key_type& key) {
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+template <class K>
+pair<typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::iterator, 
+     typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::iterator>
+hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::equal_range_key(const K& key) {
     typedef pair<iterator, iterator> Pair;
-    const size_type n = bkt_num_key(key);
+    const size_type code = hash_(key);
 
-    for(node_ptr first = buckets_[n] ; first ; first = first->next) {
-        if(equals_(get_key_(first->value), key)) {
+    for(node_ptr first = bucket_of(code) ; first ; first = first->next) {
+        if(node_equals(first, code, key)) {
             // 找到了第一个key
-            for(node_ptr cur = first->next ; cur ; cur = cur->next) {
-                if(!equals_(get_key_(cur->value), key)) {
+            node_ptr cur = first;
+            for(; cur->next ; cur = cur->next) {
+                if(!node_equals(cur->next, code, key)) {
                     // 找到了第一个不为key的，且不为空
-                    return Pair(iterator(first, this), iterator(cur, this));
+                    return Pair(iterator(first, this), iterator(cur->next, this));
                 }
             }
-            // 该bucket没找到，非空的last，去下一个
-            for(size_type m = n + 1 ; m < buckets_.size() ; ++m) {
-                if(buckets_[m]) {
-                    // 非空就是last
-                    return Pair(iterator(first, this), iterator(buckets_[m], this));
-                }
-            }
-            return Pair(iterator(first, this), iterator(end()));
+            // 该bucket没找到，非空的last，去下一个（可能在另一张表）
+            return Pair(iterator(first, this), iterator(next_node(cur), this));
         }
     }
 
     return Pair(end(), end());  // 没找到
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::size_type 
-hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase(const key_type& key) {
-    const size_type n = bkt_num_key(key);
-    node_ptr first = buckets_[n];
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+template <class K>
+typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::size_type 
+hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::erase_key(const K& key) {
+    const size_type code = hash_(key);
+    node_ptr& head = bucket_of(code);
+    node_ptr first = head;
     size_type erased_num = 0;
 
     // first不为空，说明可能在这里
@@ -589,7 +841,7 @@ hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase(const key_type& key)
         node_ptr next = first->next;
         // 要删除的是next，最后再考虑第一个结点的问题
         while(next) {
-            if(equals_(get_key_(next->value), key)) {
+            if(node_equals(next, code, key)) {
                 // 删除next
                 cur->next = next->next;
                 destroy_node(next);
@@ -603,8 +855,8 @@ hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase(const key_type& key)
             }
         }
         // 除了第一个结点，都被删除了，这下考虑第一个
-        if(equals_(get_key_(first->value), key)) {
-            buckets_[n] = first->next;
+        if(node_equals(first, code, key)) {
+            head = first->next;
             destroy_node(first);
             --num_elems_;
             ++erased_num;
@@ -614,28 +866,29 @@ hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase(const key_type& key)
     return erased_num;
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::iterator  
-hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase(const iterator& it) {
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+typename hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::iterator  
+hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::erase(const iterator& it) {
     node_ptr p = it.cur;
     if(p) {
-        const size_type n = bkt_num_key(get_key_(p->value));
-        node_ptr cur = buckets_[n];
+        node_ptr& head = bucket_of(node_hash_code(p));
+        node_ptr cur = head;
 
         if(cur == p) {
             // 在第一结点
-            buckets_[n] = cur->next;
+            const node_ptr next = next_node(p);
+            head = cur->next;
             destroy_node(cur);
             --num_elems_;
-            return iterator(buckets_[n], this);
+            return iterator(next, this);
         }else{
             // 不在第一个结点
             node_ptr next = cur->next;
             while(next) {
                 if(next == p) {
-                    cur->next = next->next;
+                    next = next_node(p);     // p是链表最后一个时，下一个在后面的bucket里
+                    cur->next = p->next;
                     destroy_node(p);
-                    next = cur->next;
                     --num_elems_;
                     return iterator(next, this);
                 }else {
@@ -649,10 +902,15 @@ hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase(const iterator& it)
     return end();   // 如果没有这个it的话
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase(iterator first, iterator last) {
-    size_type f_bucket = first.cur ? bkt_num_key(get_key_(first.cur->value)) : buckets_.size();     // 空说明是end
-    size_type l_bucket = last.cur ? bkt_num_key(get_key_(last.cur->value)) : buckets_.size();
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::erase(iterator first, iterator last) {
+    if(rehashing()) {
+        // 区间可能跨两张表，逐个删除
+        while(first != last) first = erase(first);
+        return;
+    }
+    size_type f_bucket = first.cur ? bkt_num_node(first.cur) : buckets_.size();     // 空说明是end
+    size_type l_bucket = last.cur ? bkt_num_node(last.cur) : buckets_.size();
 
     if(first.cur == last.cur) 
         return;
@@ -671,8 +929,8 @@ void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase(iterator first,
     }
 }
 
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase_bucket(const size_type& n, node_ptr first, node_ptr last) {
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::erase_bucket(const size_type& n, node_ptr first, node_ptr last) {
     if(first == last) return;       // 排除空链表
     node_ptr cur = buckets_[n];
     if(cur == first) {
@@ -702,28 +960,124 @@ void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::erase_bucket(const si
 }
 
 // copy_from 深拷贝
-template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey>
-void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey>::copy_from(const hashtable& ht) {
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::copy_from(const hashtable& ht) {
     buckets_.clear();       // 先清空自己，预留空间
     buckets_.reserve(ht.buckets_.size());
     buckets_.insert(buckets_.end(), ht.buckets_.size(), nullptr);
+    range_ = ht.range_;
+
+    if(ht.rehashing()) {
+        // ht正在渐进式rehash，拷贝时顺便搬完：每条链按顺序插到新表对应bucket的头部，相等的key仍然相邻
+        for(const mystl::vector<node_ptr>* tab : { &ht.old_buckets_, &ht.buckets_ }) {
+            for(node_ptr cur : *tab) {
+                for(; cur ; cur = cur->next) {
+                    node_ptr copy = create_node(cur->value);
+                    copy_hash_code(copy, cur, cache_hash_code());
+                    node_ptr& head = buckets_[range_(node_hash_code(cur))];
+                    copy->next = head;
+                    head = copy;
+                }
+            }
+        }
+        num_elems_ = ht.num_elems_;
+        return;
+    }
 
     // 开始一个node一个的深拷贝
     for(size_type i = 0 ; i < ht.buckets_.size() ; i++) {
         node_ptr cur = ht.buckets_[i];
         if(cur) {
             node_ptr copy = create_node(cur->value);
+            copy_hash_code(copy, cur, cache_hash_code());
             buckets_[i] = copy;     // 第一个node
 
             for(node_ptr next = cur->next ; next ; cur = next, next = next->next) {
                 copy->next = create_node(next->value);
                 copy = copy->next;
+                copy_hash_code(copy, next, cache_hash_code());
             }
         }
     }
     num_elems_ = ht.num_elems_;
 }
 
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::grow(size_type num_elems_hint) {
+    if(!incremental_) {
+        resize(num_elems_hint);
+        return;
+    }
+    if(new_size_) {
+        // 准备阶段，清零新表的一段，这期间插入还是进旧表
+        const size_type k = mystl::min(zero_step, new_size_ - new_buckets_.size());
+        new_buckets_.insert(new_buckets_.end(), k, nullptr);   // 已经reserve过，不会重新分配
+        if(new_buckets_.size() < new_size_) return;
+        // 新表准备好了，开始搬迁
+        old_buckets_.swap(buckets_);
+        buckets_.swap(new_buckets_);
+        mystl::vector<node_ptr>().swap(new_buckets_);
+        old_range_ = range_;
+        range_ = RangePolicy(new_size_);
+        new_size_ = 0;
+        migrate_pos_ = 0;
+        return;
+    }
+    if(rehashing()) {
+        // 搬migrate_step个旧bucket，空的也算，跳过空bucket很便宜
+        const size_type stop = mystl::min(migrate_pos_ + migrate_step, old_buckets_.size());
+        for(; migrate_pos_ < stop ; ++migrate_pos_) migrate_bucket(migrate_pos_);
+        if(migrate_pos_ == old_buckets_.size()) mystl::vector<node_ptr>().swap(old_buckets_);    // 搬完了，释放旧表
+        else return;
+    }
+    const size_type old_n = buckets_.size();
+    if(num_elems_hint > old_n) {
+        const size_type n = next_size(num_elems_hint);
+        if(n > old_n) {
+            // 只分配新表，不初始化，之后的插入里再慢慢清零
+            new_buckets_.reserve(n);
+            new_size_ = n;
+        }
+    }
+}
+
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::migrate_bucket(size_type n) {
+    node_ptr first = old_buckets_[n];
+    // 逐个插到新表的头部，同一条链上相等的key在新表里仍然相邻
+    while(first) {
+        node_ptr next = first->next;
+        node_ptr& head = buckets_[bkt_num_node(first)];
+        first->next = head;
+        head = first;
+        first = next;
+    }
+    old_buckets_[n] = nullptr;
+}
+
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::finish_rehash() {
+    if(new_size_) {
+        // 还在准备新表，直接放弃，需要的话调用者会一次性resize
+        mystl::vector<node_ptr>().swap(new_buckets_);
+        new_size_ = 0;
+    }
+    if(!rehashing()) return;
+    for(; migrate_pos_ < old_buckets_.size() ; ++migrate_pos_) migrate_bucket(migrate_pos_);
+    mystl::vector<node_ptr>().swap(old_buckets_);
+}
+
+template <class Key, class Value, class HashFun, class KeyOfValue, class EqualKey, class RangePolicy>
+void hashtable<Key, Value, HashFun, KeyOfValue, EqualKey, RangePolicy>::clear_buckets(mystl::vector<node_ptr>& buckets) {
+    for(node_ptr& head : buckets) {
+        while(head) {
+            node_ptr next = head->next;
+            destroy_node(head);
+            head = next;
+        }
+    }
+}
+
 
 
 } // !mystl
@@ -0,0 +1,246 @@
+#ifndef __INTERVAL_MAP_H__
+#define __INTERVAL_MAP_H__
+
+#include <initializer_list>
+#include <type_traits>
+
+#include "rb_tree.h"
+#include "functional.h"
+#include "util.h"
+#include "exceptdef.h"
+
+// 这个文件定义了区间映射 interval_map，键是半开区间[lo, hi)，用增强的红黑树（interval tree）实现
+
+/*
+* 结点按 (lo, hi) 的字典序排列，每个结点额外记录子树中所有区间右端点的最大值 max_hi_，
+* 由rb_tree在旋转、插入、删除时通过Augment策略维护。
+*
+* 查询与[lo, hi)重叠的区间时，按中序遍历并剪枝：
+*   子树的 max_hi_ <= lo   : 子树中所有区间都在查询区间左边，整棵跳过
+*   结点的 lo >= hi        : 这个结点以及中序在它之后的结点都在查询区间右边，结束
+* 找到第一个重叠区间是O(log n)，枚举全部k个重叠区间是O(min(n, k log n))，
+* 而用lower_bound找到起点再往后线性扫描，遇到很长的区间时要扫过所有左端点更小的区间。
+*
+* 同一个区间可以出现多次（类似multimap），端点类型需要可平凡拷贝（整数、指针、时间戳等），
+* 因为rb_tree只构造结点中的值，max_hi_由增强策略直接赋值。
+*/
+
+namespace mystl {
+
+// 按 (lo, hi) 字典序比较区间
+template <class K, class Compare>
+struct interval_less {
+    Compare comp;
+
+    bool operator()(const mystl::pair<K, K>& lhs, const mystl::pair<K, K>& rhs) const {
+        if(comp(lhs.first, rhs.first)) return true;
+        if(comp(rhs.first, lhs.first)) return false;
+        return comp(lhs.second, rhs.second);
+    }
+};
+
+template <class T, class K>
+struct rb_tree_interval_node : public rb_tree_node<T> {
+    K max_hi_;      // 以该结点为根的子树中区间右端点的最大值
+};
+
+// 维护子树最大右端点的增强策略，T为 pair<pair<K, K>, V>
+template <class K, class Compare>
+struct rb_tree_interval_augment {
+    static_assert(std::is_trivially_copyable<K>::value, "interval endpoints must be trivially copyable");
+
+    template <class T>
+    using node_type = rb_tree_interval_node<T, K>;
+
+    template <class T>
+    void operator()(rb_tree_node_base<T>* x) const {
+        typedef rb_tree_interval_node<T, K>* node_ptr;
+        node_ptr node = static_cast<node_ptr>(x);
+        const K* m = &node->value_.first.second;
+        if(x->left_ != nullptr && Compare()(*m, static_cast<node_ptr>(x->left_)->max_hi_)) {
+            m = &static_cast<node_ptr>(x->left_)->max_hi_;
+        }
+        if(x->right_ != nullptr && Compare()(*m, static_cast<node_ptr>(x->right_)->max_hi_)) {
+            m = &static_cast<node_ptr>(x->right_)->max_hi_;
+        }
+        node->max_hi_ = *m;
+    }
+
+    template <class Node>
+    static void copy(Node* dst, const Node* src) {
+        dst->max_hi_ = src->max_hi_;
+    }
+};
+
+// 参数一为区间端点的类型，参数二为映射值的类型，Compare比较端点
+template <class K, class T, class Compare = mystl::less<K>>
+class interval_map {
+public:
+    typedef K                                   endpoint_type;
+    typedef mystl::pair<K, K>                   key_type;       // [first, second)
+    typedef T                                   mapped_type;
+    typedef mystl::pair<key_type, T>            value_type;
+    typedef interval_less<K, Compare>           key_compare;
+
+private:
+    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::select1st<value_type>,
+                           rb_tree_interval_augment<K, Compare>> base_type;
+    typedef typename base_type::node_ptr        node_ptr;
+    base_type  tree_;
+    Compare    comp_;
+
+public:
+    typedef typename base_type::pointer                pointer;
+    typedef typename base_type::const_pointer          const_pointer;
+    typedef typename base_type::reference              reference;
+    typedef typename base_type::const_reference        const_reference;
+    typedef typename base_type::iterator               iterator;
+    typedef typename base_type::const_iterator         const_iterator;
+    typedef typename base_type::reverse_iterator       reverse_iterator;
+    typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+    typedef typename base_type::size_type              size_type;
+    typedef typename base_type::difference_type        difference_type;
+
+public:
+    interval_map() = default;
+
+    template <class InputIterator>
+    interval_map(InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_equal(first, last);
+    }
+
+    interval_map(std::initializer_list<value_type> ilist) : tree_() {
+        tree_.insert_equal(ilist.begin(), ilist.end());
+    }
+
+    interval_map(const interval_map& rhs) : tree_(rhs.tree_) {}
+    interval_map(interval_map&& rhs) : tree_(mystl::move(rhs.tree_)) {}
+
+    interval_map& operator=(const interval_map& rhs) {
+        tree_ = rhs.tree_;
+        return *this;
+    }
+    interval_map& operator=(interval_map&& rhs) {
+        tree_ = mystl::move(rhs.tree_);
+        return *this;
+    }
+
+    key_compare            key_comp()       const { return tree_.key_comp(); }
+
+    // 迭代器，按 (lo, hi) 的顺序
+    iterator               begin()                { return tree_.begin(); }
+    const_iterator         begin()          const { return tree_.begin(); }
+    iterator               end()                  { return tree_.end(); }
+    const_iterator         end()            const { return tree_.end(); }
+    reverse_iterator       rbegin()               { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin()         const { return const_reverse_iterator(end()); }
+    reverse_iterator       rend()                 { return reverse_iterator(begin()); }
+    const_reverse_iterator rend()           const { return const_reverse_iterator(begin()); }
+
+    bool        empty()     const   { return tree_.empty(); }
+    size_type   size()      const   { return tree_.size(); }
+    size_type   max_size()  const   { return tree_.max_size(); }
+
+public:
+    // 插入区间[lo, hi)，允许重复
+    iterator insert(const value_type& value) {
+        MYSTL_DEBUG(!comp_(value.first.second, value.first.first));
+        return tree_.insert_equal(value);
+    }
+    iterator insert(const K& lo, const K& hi, const T& obj) {
+        return insert(value_type(key_type(lo, hi), obj));
+    }
+    template <class InputIterator>
+    void insert(InputIterator first, InputIterator last) {
+        for( ; first != last ; ++first) insert(*first);
+    }
+
+    iterator  erase(iterator position) { return tree_.erase(position); }
+    // 删除所有等于[lo, hi)的区间，返回删除的个数
+    size_type erase(const K& lo, const K& hi) { return tree_.erase(key_type(lo, hi)); }
+    void      erase(iterator first, iterator last) { tree_.erase(first, last); }
+
+    void clear() { tree_.clear(); }
+    void swap(interval_map& rhs) { tree_.swap(rhs.tree_); }
+
+    // 按区间精确查找
+    iterator       find(const K& lo, const K& hi)       { return tree_.find(key_type(lo, hi)); }
+    const_iterator find(const K& lo, const K& hi) const { return tree_.find(key_type(lo, hi)); }
+    size_type      count(const K& lo, const K& hi) const { return tree_.count(key_type(lo, hi)); }
+
+public:
+    // 对每个与[lo, hi)重叠的区间按顺序调用visit(iterator)，非const版本可以通过迭代器修改映射值
+    template <class Visitor>
+    void find_overlapping(const K& lo, const K& hi, Visitor visit) {
+        query(lo, [&](const K& start) { return comp_(start, hi); },
+              [&](node_ptr x) { visit(iterator(x)); return true; });
+    }
+    template <class Visitor>
+    void find_overlapping(const K& lo, const K& hi, Visitor visit) const {
+        query(lo, [&](const K& start) { return comp_(start, hi); },
+              [&](node_ptr x) { visit(const_iterator(x)); return true; });
+    }
+
+    // 对每个包含point的区间（lo <= point < hi）按顺序调用visit(iterator)
+    template <class Visitor>
+    void find_containing(const K& point, Visitor visit) {
+        query(point, [&](const K& start) { return !comp_(point, start); },
+              [&](node_ptr x) { visit(iterator(x)); return true; });
+    }
+    template <class Visitor>
+    void find_containing(const K& point, Visitor visit) const {
+        query(point, [&](const K& start) { return !comp_(point, start); },
+              [&](node_ptr x) { visit(const_iterator(x)); return true; });
+    }
+
+    // 第一个与[lo, hi)重叠的区间，没有则返回end()，O(log n)
+    iterator find_first_overlapping(const K& lo, const K& hi) {
+        node_ptr found = first_overlapping(lo, hi);
+        return found ? iterator(found) : tree_.end();
+    }
+    const_iterator find_first_overlapping(const K& lo, const K& hi) const {
+        node_ptr found = first_overlapping(lo, hi);
+        return found ? const_iterator(found) : tree_.end();
+    }
+
+    bool overlaps(const K& lo, const K& hi) const {
+        return first_overlapping(lo, hi) != nullptr;
+    }
+
+    // 与[lo, hi)重叠的区间个数
+    size_type count_overlapping(const K& lo, const K& hi) const {
+        size_type n = 0;
+        find_overlapping(lo, hi, [&](const_iterator) { ++n; });
+        return n;
+    }
+
+private:
+    node_ptr first_overlapping(const K& lo, const K& hi) const {
+        node_ptr found = nullptr;
+        query(lo, [&](const K& start) { return comp_(start, hi); },
+              [&](node_ptr x) { found = x; return false; });
+        return found;
+    }
+
+    // 区间[start, end)满足 lo < end 并且 starts_before(start) 时调用report(x)，report返回false时停止
+    template <class StartsBefore, class Report>
+    void query(const K& lo, StartsBefore starts_before, Report report) const {
+        tree_.visit_pruned(
+            [&](node_ptr x) { return comp_(lo, x->max_hi_); },
+            [&](node_ptr x) {
+                const key_type& key = x->value_.first;
+                if(!starts_before(key.first)) return false;     // 之后的区间起点都更大
+                if(comp_(lo, key.second)) return report(x);
+                return true;
+            });
+    }
+};
+
+template <class K, class T, class Compare>
+void swap(interval_map<K, T, Compare>& lhs, interval_map<K, T, Compare>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
@@ -0,0 +1,284 @@
+#ifndef __INTRUSIVE_LIST_H__
+#define __INTRUSIVE_LIST_H__
+
+#include "iterator.h"
+#include "exceptdef.h"
+#include "util.h"
+#include "list.h"
+
+// 这个文件定义了侵入式双向链表 intrusive_list
+
+/*
+* 普通的list会为每个元素分配一个结点，把元素拷贝进去。侵入式容器不分配任何内存，
+* 对象自己内嵌一个hook（prev_和next_），容器只负责把这些hook串起来：
+*
+*   struct connection {
+*       int fd;
+*       mystl::intrusive_list_hook lru_hook;
+*       mystl::intrusive_list_hook idle_hook;    // 同一个对象可以同时在多个链表中
+*   };
+*   mystl::intrusive_list<connection, &connection::lru_hook> lru;
+*
+* 容器不拥有对象，对象的生命周期由使用者管理：对象销毁之前必须先从容器中移除，容器析构时只是把所有hook断开。
+* 从hook找回对象要用到hook在对象中的偏移（见util.h的member_offset），所以对象必须是标准布局并且可以默认构造。
+* 因为知道对象的地址，从容器中删除某个对象是O(1)的，不需要查找。
+* 链接操作和list共用list_transfer。
+*/
+
+namespace mystl {
+
+// 对象内嵌的hook，不在任何链表中时两个指针都为空
+struct intrusive_list_hook {
+    intrusive_list_hook* prev_;
+    intrusive_list_hook* next_;
+
+    intrusive_list_hook() : prev_(nullptr), next_(nullptr) {}
+
+    // hook不能跟着对象一起拷贝，拷贝出来的对象不在任何链表中
+    intrusive_list_hook(const intrusive_list_hook&) : prev_(nullptr), next_(nullptr) {}
+    intrusive_list_hook& operator=(const intrusive_list_hook&) { return *this; }
+
+    bool is_linked() const { return next_ != nullptr; }
+};
+
+template <class T, intrusive_list_hook T::*Hook, class Ref, class Ptr>
+struct intrusive_list_iterator {
+    typedef intrusive_list_iterator<T, Hook, T&, T*> iterator;
+    typedef intrusive_list_iterator<T, Hook, const T&, const T*> const_iterator;
+    typedef intrusive_list_iterator self;
+
+    typedef bidirectional_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef Ptr pointer;
+    typedef Ref reference;
+    typedef ptrdiff_t difference_type;
+
+    typedef intrusive_list_hook* hook_ptr;
+
+    hook_ptr node_;
+
+    intrusive_list_iterator() : node_(nullptr) {}
+    explicit intrusive_list_iterator(hook_ptr x) : node_(x) {}
+    intrusive_list_iterator(const iterator& rhs) : node_(rhs.node_) {}
+
+    reference operator*() const { return *mystl::owner_of<T, intrusive_list_hook, Hook>(node_); }
+    pointer operator->() const { return &(operator*()); }
+
+    self& operator++() {
+        node_ = node_->next_;
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp = *this;
+        node_ = node_->next_;
+        return tmp;
+    }
+
+    self& operator--() {
+        node_ = node_->prev_;
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp = *this;
+        node_ = node_->prev_;
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const { return node_ == rhs.node_; }
+    bool operator!=(const self& rhs) const { return node_ != rhs.node_; }
+};
+
+// 模板参数Hook为对象中hook成员的成员指针
+template <class T, intrusive_list_hook T::*Hook>
+class intrusive_list {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    typedef intrusive_list_iterator<T, Hook, T&, T*> iterator;
+    typedef intrusive_list_iterator<T, Hook, const T&, const T*> const_iterator;
+    typedef mystl::reverse_iterator<iterator> reverse_iterator;
+    typedef mystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    typedef intrusive_list_hook* hook_ptr;
+
+private:
+    intrusive_list_hook header_;    // 头结点直接放在容器里，环形链表
+    size_type size_;
+
+public:
+    intrusive_list() : size_(0) {
+        header_.prev_ = header_.next_ = &header_;
+    }
+
+    // 对象只能属于一个容器，不能拷贝
+    intrusive_list(const intrusive_list&) = delete;
+    intrusive_list& operator=(const intrusive_list&) = delete;
+
+    intrusive_list(intrusive_list&& rhs) noexcept : size_(0) {
+        header_.prev_ = header_.next_ = &header_;
+        splice(end(), rhs);
+    }
+
+    intrusive_list& operator=(intrusive_list&& rhs) noexcept {
+        if(this != &rhs) {
+            clear();
+            splice(end(), rhs);
+        }
+        return *this;
+    }
+
+    ~intrusive_list() { clear(); }
+
+public:
+    // 迭代器相关操作
+    iterator begin() { return iterator(header_.next_); }
+    const_iterator begin() const { return const_iterator(header_.next_); }
+    iterator end() { return iterator(&header_); }
+    const_iterator end() const { return const_iterator(const_cast<hook_ptr>(&header_)); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    // 由对象得到迭代器，对象必须在这个链表中
+    iterator iterator_to(reference value) { return iterator(&(value.*Hook)); }
+    const_iterator iterator_to(const_reference value) const {
+        return const_iterator(const_cast<hook_ptr>(&(value.*Hook)));
+    }
+
+    // 容量相关操作
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+
+    // 元素访问相关操作
+    reference front() {
+        MYSTL_DEBUG(!empty());
+        return *begin();
+    }
+
+    const_reference front() const {
+        MYSTL_DEBUG(!empty());
+        return *begin();
+    }
+
+    reference back() {
+        MYSTL_DEBUG(!empty());
+        return *(--end());
+    }
+
+    const_reference back() const {
+        MYSTL_DEBUG(!empty());
+        return *(--end());
+    }
+
+    // 把value链接到pos之前，value不能已经在某个链表中
+    iterator insert(iterator pos, reference value) {
+        hook_ptr x = &(value.*Hook);
+        MYSTL_DEBUG(!x->is_linked());
+        x->next_ = pos.node_;
+        x->prev_ = pos.node_->prev_;
+        pos.node_->prev_->next_ = x;
+        pos.node_->prev_ = x;
+        ++size_;
+        return iterator(x);
+    }
+
+    void push_back(reference value) { insert(end(), value); }
+    void push_front(reference value) { insert(begin(), value); }
+
+    void pop_front() {
+        MYSTL_DEBUG(!empty());
+        erase(begin());
+    }
+
+    void pop_back() {
+        MYSTL_DEBUG(!empty());
+        erase(--end());
+    }
+
+    // 断开pos，对象本身不会被销毁，返回下一个位置
+    iterator erase(iterator pos) {
+        hook_ptr x = pos.node_;
+        hook_ptr next = x->next_;
+        x->prev_->next_ = next;
+        next->prev_ = x->prev_;
+        x->prev_ = x->next_ = nullptr;
+        --size_;
+        return iterator(next);
+    }
+
+    iterator erase(iterator first, iterator last) {
+        while(first != last) first = erase(first);
+        return last;
+    }
+
+    // 把对象从链表中移除，O(1)
+    void remove(reference value) { erase(iterator_to(value)); }
+
+    // 断开所有对象
+    void clear() {
+        hook_ptr cur = header_.next_;
+        while(cur != &header_) {
+            hook_ptr next = cur->next_;
+            cur->prev_ = cur->next_ = nullptr;
+            cur = next;
+        }
+        header_.prev_ = header_.next_ = &header_;
+        size_ = 0;
+    }
+
+    // splice，和list一样
+    void splice(iterator pos, intrusive_list& other) {
+        if(!other.empty()) {
+            list_transfer(pos.node_, other.header_.next_, &other.header_);
+            size_ += other.size_;
+            other.size_ = 0;
+        }
+    }
+
+    void splice(iterator pos, intrusive_list& other, iterator i) {
+        iterator j = i;
+        ++j;
+        if(pos == i || pos == j) return;
+        list_transfer(pos.node_, i.node_, j.node_);
+        ++size_;
+        --other.size_;
+    }
+
+    void splice(iterator pos, intrusive_list& other, iterator first, iterator last) {
+        if(first != last) {
+            if(this != &other) {
+                size_type n = mystl::distance(first, last);
+                size_ += n;
+                other.size_ -= n;
+            }
+            list_transfer(pos.node_, first.node_, last.node_);
+        }
+    }
+
+    // 头结点在容器内部，交换需要重新链接
+    void swap(intrusive_list& rhs) {
+        intrusive_list tmp;
+        tmp.splice(tmp.end(), rhs);
+        rhs.splice(rhs.end(), *this);
+        splice(end(), tmp);
+    }
+};
+
+template <class T, intrusive_list_hook T::*Hook>
+void swap(intrusive_list<T, Hook>& lhs, intrusive_list<T, Hook>& rhs) {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
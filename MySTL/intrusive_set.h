@@ -0,0 +1,337 @@
+#ifndef __INTRUSIVE_SET_H__
+#define __INTRUSIVE_SET_H__
+
+#include "functional.h"
+#include "iterator.h"
+#include "exceptdef.h"
+#include "util.h"
+#include "rb_tree.h"
+
+// 这个文件定义了侵入式的红黑树容器 intrusive_set 和 intrusive_multiset
+
+/*
+* 和intrusive_list一样，对象内嵌一个hook，hook就是红黑树的结点（rb_tree_node_base<void>），容器不分配任何内存：
+*
+*   struct timer {
+*       long deadline;
+*       mystl::intrusive_set_hook by_deadline;
+*       mystl::intrusive_list_hook in_wheel;
+*   };
+*   struct timer_less { bool operator()(const timer& a, const timer& b) const { return a.deadline < b.deadline; } };
+*   mystl::intrusive_multiset<timer, &timer::by_deadline, timer_less> timers;
+*
+* 结构和rb_tree完全一样：header_和根节点互为父节点，header_->left_为最小结点，header_->right_为最大结点，
+* 迭代器的前进后退直接用rb_tree_iterator_base，插入删除后的平衡直接用rb_tree_insert_rebalance和rb_tree_erase_rebalance。
+*
+* Compare比较的是两个对象。对象在容器中时，不能修改参与比较的成员。
+*/
+
+namespace mystl {
+
+// 对象内嵌的hook，不在任何树中时parent_为空
+struct intrusive_set_hook : public rb_tree_node_base<void> {
+    intrusive_set_hook() {
+        this->parent_ = this->left_ = this->right_ = nullptr;
+        this->set_color(rb_tree_red);
+    }
+
+    // hook不能跟着对象一起拷贝
+    intrusive_set_hook(const intrusive_set_hook&) : intrusive_set_hook() {}
+    intrusive_set_hook& operator=(const intrusive_set_hook&) { return *this; }
+
+    bool is_linked() const { return this->parent() != nullptr; }
+};
+
+template <class T, intrusive_set_hook T::*Hook, class Ref, class Ptr>
+struct intrusive_set_iterator : public rb_tree_iterator_base<void> {
+    typedef intrusive_set_iterator<T, Hook, T&, T*> iterator;
+    typedef intrusive_set_iterator<T, Hook, const T&, const T*> const_iterator;
+    typedef intrusive_set_iterator self;
+
+    typedef T value_type;
+    typedef Ref reference;
+    typedef Ptr pointer;
+
+    intrusive_set_iterator() { this->node_ = nullptr; }
+    explicit intrusive_set_iterator(base_ptr x) { this->node_ = x; }
+    intrusive_set_iterator(const iterator& rhs) { this->node_ = rhs.node_; }
+
+    reference operator*() const {
+        return *mystl::owner_of<T, intrusive_set_hook, Hook>(static_cast<intrusive_set_hook*>(this->node_));
+    }
+    pointer operator->() const { return &(operator*()); }
+
+    self& operator++() {
+        this->increment();
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp(*this);
+        this->increment();
+        return tmp;
+    }
+
+    self& operator--() {
+        this->decrement();
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp(*this);
+        this->decrement();
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const { return this->node_ == rhs.node_; }
+    bool operator!=(const self& rhs) const { return this->node_ != rhs.node_; }
+};
+
+// intrusive_rb_tree，Unique为true时键值不能重复
+template <class T, intrusive_set_hook T::*Hook, class Compare, bool Unique>
+class intrusive_rb_tree {
+public:
+    typedef T value_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    typedef Compare key_compare;
+    typedef Compare value_compare;
+
+    typedef intrusive_set_iterator<T, Hook, T&, T*> iterator;
+    typedef intrusive_set_iterator<T, Hook, const T&, const T*> const_iterator;
+    typedef mystl::reverse_iterator<iterator> reverse_iterator;
+    typedef mystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    typedef rb_tree_node_base<void>* base_ptr;
+
+private:
+    rb_tree_node_base<void> header_;    // 头结点放在容器里
+    size_type size_;
+    Compare comp_;
+
+    base_ptr& root()      { return header_.parent_; }
+    base_ptr& leftmost()  { return header_.left_; }
+    base_ptr& rightmost() { return header_.right_; }
+    base_ptr root() const { return header_.parent_; }
+    base_ptr header() const { return const_cast<base_ptr>(&header_); }
+
+    static base_ptr hook_of(const_reference value) {
+        return const_cast<intrusive_set_hook*>(&(value.*Hook));
+    }
+
+    static const_reference value_of(base_ptr x) {
+        return *mystl::owner_of<T, intrusive_set_hook, Hook>(static_cast<intrusive_set_hook*>(x));
+    }
+
+public:
+    explicit intrusive_rb_tree(const Compare& comp = Compare()) : size_(0), comp_(comp) {
+        reset();
+    }
+
+    intrusive_rb_tree(const intrusive_rb_tree&) = delete;
+    intrusive_rb_tree& operator=(const intrusive_rb_tree&) = delete;
+
+    ~intrusive_rb_tree() { clear(); }
+
+public:
+    iterator begin() { return iterator(header_.left_); }
+    const_iterator begin() const { return const_iterator(header_.left_); }
+    iterator end() { return iterator(&header_); }
+    const_iterator end() const { return const_iterator(header()); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    iterator iterator_to(reference value) { return iterator(hook_of(value)); }
+    const_iterator iterator_to(const_reference value) const { return const_iterator(hook_of(value)); }
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+
+    key_compare key_comp() const { return comp_; }
+
+    // 插入，Unique时如果已经有相等的对象，返回已有对象的迭代器和false
+    mystl::pair<iterator, bool> insert(reference value);
+
+    // 断开pos，返回下一个位置
+    iterator erase(iterator pos);
+
+    iterator erase(iterator first, iterator last) {
+        while(first != last) first = erase(first);
+        return last;
+    }
+
+    // 把对象从树中移除，不需要查找
+    void remove(reference value) { erase(iterator_to(value)); }
+
+    // 断开所有对象
+    void clear() {
+        if(root() != nullptr) unlink_subtree(root());
+        reset();
+    }
+
+    // 查找相关操作，参数是一个用来比较的对象
+    iterator find(const_reference value) {
+        iterator j = lower_bound(value);
+        return (j == end() || comp_(value, *j)) ? end() : j;
+    }
+
+    const_iterator find(const_reference value) const {
+        const_iterator j = lower_bound(value);
+        return (j == end() || comp_(value, *j)) ? end() : j;
+    }
+
+    size_type count(const_reference value) const {
+        size_type n = 0;
+        for(const_iterator first = lower_bound(value), last = upper_bound(value) ; first != last ; ++first) ++n;
+        return n;
+    }
+
+    iterator lower_bound(const_reference value) { return iterator(lower_bound_aux(value)); }
+    const_iterator lower_bound(const_reference value) const { return const_iterator(lower_bound_aux(value)); }
+    iterator upper_bound(const_reference value) { return iterator(upper_bound_aux(value)); }
+    const_iterator upper_bound(const_reference value) const { return const_iterator(upper_bound_aux(value)); }
+
+private:
+    void reset() {
+        header_.parent_ = nullptr;
+        header_.set_color(rb_tree_red);
+        header_.left_ = header_.right_ = &header_;
+        size_ = 0;
+    }
+
+    // 第一个不小于value的结点
+    base_ptr lower_bound_aux(const_reference value) const {
+        base_ptr y = header();
+        base_ptr x = root();
+        while(x != nullptr) {
+            if(!comp_(value_of(x), value)) {
+                y = x;
+                x = x->left_;
+            }else {
+                x = x->right_;
+            }
+        }
+        return y;
+    }
+
+    // 第一个大于value的结点
+    base_ptr upper_bound_aux(const_reference value) const {
+        base_ptr y = header();
+        base_ptr x = root();
+        while(x != nullptr) {
+            if(comp_(value, value_of(x))) {
+                y = x;
+                x = x->left_;
+            }else {
+                x = x->right_;
+            }
+        }
+        return y;
+    }
+
+    // 把z作为y的孩子连接进去并平衡，和rb_tree::insert_aux相同
+    void link(base_ptr z, base_ptr y, bool insert_left);
+
+    // 迭代地断开一棵子树的所有hook，不用递归
+    static void unlink_subtree(base_ptr x) {
+        while(x != nullptr) {
+            if(x->left_ != nullptr) {
+                // 右旋把左子树提上来，树退化成一条向右的链
+                base_ptr l = x->left_;
+                x->left_ = l->right_;
+                l->right_ = x;
+                x = l;
+            }else {
+                base_ptr r = x->right_;
+                x->parent_ = x->left_ = x->right_ = nullptr;
+                x = r;
+            }
+        }
+    }
+};
+
+template <class T, intrusive_set_hook T::*Hook, class Compare, bool Unique>
+void intrusive_rb_tree<T, Hook, Compare, Unique>::link(base_ptr z, base_ptr y, bool insert_left) {
+    z->set_parent(y);
+    z->left_ = z->right_ = nullptr;
+    if(insert_left) {
+        y->left_ = z;   // y为header时，header的left也就是leftmost
+        if(y == &header_) {
+            root() = z;
+            rightmost() = z;
+        }else if(y == leftmost()) {
+            leftmost() = z;
+        }
+    }else {
+        y->right_ = z;
+        if(y == rightmost()) {
+            rightmost() = z;
+        }
+    }
+    rb_tree_insert_rebalance(z, root());
+    ++size_;
+}
+
+template <class T, intrusive_set_hook T::*Hook, class Compare, bool Unique>
+mystl::pair<typename intrusive_rb_tree<T, Hook, Compare, Unique>::iterator, bool>
+intrusive_rb_tree<T, Hook, Compare, Unique>::insert(reference value) {
+    base_ptr z = hook_of(value);
+    MYSTL_DEBUG(!static_cast<intrusive_set_hook*>(z)->is_linked());
+
+    base_ptr y = &header_;
+    base_ptr x = root();
+    bool go_left = true;
+    while(x != nullptr) {
+        y = x;
+        go_left = comp_(value, value_of(x));
+        x = go_left ? x->left_ : x->right_;
+    }
+
+    if(Unique) {
+        // 和rb_tree::insert_unique一样，检查前一个结点是否和value相等
+        iterator j(y);
+        if(go_left) {
+            if(j == begin()) {
+                link(z, y, true);
+                return mystl::pair<iterator, bool>(iterator(z), true);
+            }
+            --j;
+        }
+        if(!comp_(*j, value)) {
+            return mystl::pair<iterator, bool>(j, false);
+        }
+    }
+    link(z, y, y == &header_ || go_left);
+    return mystl::pair<iterator, bool>(iterator(z), true);
+}
+
+template <class T, intrusive_set_hook T::*Hook, class Compare, bool Unique>
+typename intrusive_rb_tree<T, Hook, Compare, Unique>::iterator
+intrusive_rb_tree<T, Hook, Compare, Unique>::erase(iterator pos) {
+    MYSTL_DEBUG(pos != end());
+    iterator next = pos;
+    ++next;
+    base_ptr z = rb_tree_erase_rebalance(pos.node_, root(), leftmost(), rightmost());
+    z->parent_ = z->left_ = z->right_ = nullptr;
+    --size_;
+    return next;
+}
+
+// 键值不重复的侵入式集合
+template <class T, intrusive_set_hook T::*Hook, class Compare = mystl::less<T>>
+using intrusive_set = intrusive_rb_tree<T, Hook, Compare, true>;
+
+// 键值可以重复的侵入式集合，相等的对象按插入顺序排列
+template <class T, intrusive_set_hook T::*Hook, class Compare = mystl::less<T>>
+using intrusive_multiset = intrusive_rb_tree<T, Hook, Compare, false>;
+
+}
+
+#endif
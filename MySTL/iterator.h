@@ -159,6 +159,11 @@ public:
 
 private:
     iterator_type current;
+
+    template <class I>
+    static auto arrow(const I& it, int) -> decltype(it.operator->()) { return it.operator->(); }
+    template <class I>
+    static pointer arrow(const I& it, long) { return &*it; }
 public:
     // 构造 析构函数
     reverse_iterator() {}
@@ -173,7 +178,11 @@ public:
         return *--tmp;
     }
 
-    pointer operator->() const { return &(operator*()); }
+    // 正向迭代器有operator->就用它（代理迭代器的pointer不是真正的指针），否则取解引用结果的地址
+    pointer operator->() const {
+        iterator_type tmp = current;
+        return arrow(--tmp, 0);
+    }
 
     // 指针操作
     self& operator++() {
@@ -15,14 +15,36 @@
 
 namespace mystl {
 
-// 定义list的结点，双向链表，采用单层设计
+// 定义list的结点，双向链表。链接部分单独作为基类，头结点用不到T，sort的临时头结点也只需要这一部分
 template <class T>
-struct list_node {
-    list_node<T>* prev_;
-    list_node<T>* next_;
+struct list_node_base {
+    list_node_base<T>* prev_;
+    list_node_base<T>* next_;
+};
+
+template <class T>
+struct list_node : public list_node_base<T> {
     T data_;
 };
 
+// 将[first, last)转移到pos之前，只用到结点的prev_和next_，intrusive_list也用这个函数
+template <class NodePtr>
+void list_transfer(NodePtr pos, NodePtr first, NodePtr last) {
+    // pos == last 相当于不操作
+    if(pos != last) {
+        // 将原来的链上的[first, last)去除
+        NodePtr tmp = last->prev_; //记录last的前一个结点
+        first->prev_->next_ = last;
+        last->prev_ = first->prev_;
+
+        // 连接到新的位置
+        tmp->next_ = pos;
+        first->prev_ = pos->prev_;
+        pos->prev_->next_ = first;
+        pos->prev_ = tmp;
+    }
+}
+
 // 迭代器的设计
 template <class T>
 struct list_iterator {
@@ -35,22 +57,23 @@ struct list_iterator {
 
     typedef size_t size_type;
     typedef list_node<T> Node;          //结点型别定义
+    typedef list_node_base<T>* base_ptr;
 
     typedef list_iterator<T> iterator;
     typedef list_iterator<const T> const_iterator;
     typedef list_iterator<T> self;
 
-    Node* node_;          
+    base_ptr node_;          
 
     // 迭代器的构造函数，支持默认，传入node指针，和拷贝构造
     list_iterator() = default;
-    list_iterator(Node* x) : node_(x) {}
+    list_iterator(base_ptr x) : node_(x) {}
     list_iterator(const iterator& x) : node_(x.node_) {}
 
     void incr() { node_ = node_->next_; } // 移动到下一个node
     void decr() { node_ = node_->prev_; } // 移动到上一个node
 
-    reference operator*() const { return node_->data_; }  
+    reference operator*() const { return static_cast<Node*>(node_)->data_; }  
     pointer operator->() const { return &(operator*()); }
 
     self& operator++() {
@@ -112,11 +135,13 @@ public:
     // 结点
     typedef list_node<T> Node;
     typedef list_node<T>* node_ptr;
+    typedef list_node_base<T>* base_ptr;
     typedef list_node<const T>* const_node_ptr;
 
 private:
     // 成员变量
     node_ptr node_; //指向一个node结点，整体结构为环形链表，这个有点像虚拟结点
+    size_type size_; //元素个数，所有增删结点的操作都要维护它，这样size()是O(1)的
 
 public:
     // 构造、移动、拷贝、赋值和析构函数
@@ -147,8 +172,9 @@ public:
     }
 
     // 抢夺资源，并把原对象置空
-    list(list&& rhs) noexcept : node_(rhs.node_) {
+    list(list&& rhs) noexcept : node_(rhs.node_), size_(rhs.size_) {
         rhs.node_ = nullptr;
+        rhs.size_ = 0;
     }
 
     list& operator=(const list& rhs) {
@@ -203,8 +229,7 @@ public:
     }
 
     size_type size() const {
-        size_type result = distance(begin(), end());
-        return result;
+        return size_;
     }
 
     size_type max_size() const {
@@ -298,6 +323,7 @@ public:
     // list相关操作 swap splice remove unique merge sort reverse
     void swap(list& rhs) {
         mystl::swap(node_, rhs.node_);
+        mystl::swap(size_, rhs.size_);
     }
 
     void splice(iterator pos, list& other);
@@ -400,9 +426,13 @@ private:
     // transfer 将[first, last)转移到pos之前
     void transfer(iterator pos, iterator first, iterator last);
 
-    // 归并排序sort的辅助函数
+    // 把以y为头结点的有序链归并到以x为头结点的有序链中，相等时x的元素在前，保证稳定
     template <class Compare>
-    iterator sort_aux(iterator first1, iterator last2, size_type n, Compare comp);
+    void merge_aux(base_ptr x, base_ptr y, Compare comp);
+
+    // 自底向上的归并排序
+    template <class Compare>
+    void sort_aux(Compare comp);
 };
 
 // 创造一个结点，并构造对象，返回其指针
@@ -414,6 +444,7 @@ list<T>::create_node(const value_type& value) {
         mystl::construct(&tmp->data_, value); //构造对象
     } catch(...) {
         node_allocator::deallocate(tmp);
+        throw;
     }
     
     return tmp;
@@ -432,11 +463,13 @@ void list<T>::fill_init(size_type n, const value_type& value) {
     node_ = create_node(value_type(0)); //值随意
     node_->next_ = node_;    //都指向自己
     node_->prev_ = node_;
+    size_ = 0;
 
     try{
         for(; n > 0 ; --n) {
             node_ptr new_node = create_node(value);
             link_nodes_at_back(new_node, new_node); // 把该结点连接到back
+            ++size_;
         }
     }catch(...) {
         // 初始化失败
@@ -453,12 +486,14 @@ void list<T>::copy_init(Iterator first, Iterator last) {
     node_ = create_node(value_type(0)); //值随意
     node_->next_ = node_;    //都指向自己
     node_->prev_ = node_;
+    size_ = 0;
 
     size_type n = mystl::distance(first, last);
     try{
         for(; n > 0 ; --n, ++first) {
             node_ptr new_node = create_node(*first);
             link_nodes_at_back(new_node, new_node);
+            ++size_;
         }
     }catch(...) {
         clear();
@@ -519,6 +554,7 @@ list<T>::insert(iterator pos, const value_type& value) {
     // 将前后指针指向new_node
     pos.node_->prev_->next_ = new_node;
     pos.node_->prev_ = new_node;
+    ++size_;
     return new_node;
 }
 
@@ -546,7 +582,8 @@ list<T>::erase(iterator pos) {
     pos.node_->next_->prev_ = pos.node_->prev_;
     /* mystl::destroy(&(pos.node_->data_));
     node_allocator::deallocate(pos.node_); */
-    destroy_node(pos.node_); //传入node_ptr
+    destroy_node(static_cast<node_ptr>(pos.node_)); //传入node_ptr
+    --size_;
     return tmp;
 }
 
@@ -561,14 +598,15 @@ list<T>::erase(iterator first, iterator last) {
 
 template <class T>
 void list<T>::clear() {
-    if(size() != 0) {
-        node_ptr cur = node_->next_; //第一个结点
-        for(node_ptr next = cur->next_ ; cur != node_ ; 
+    if(size_ != 0) {
+        base_ptr cur = node_->next_; //第一个结点
+        for(base_ptr next = cur->next_ ; cur != node_ ; 
             cur = next, next = cur->next_) {
-            destroy_node(cur);
+            destroy_node(static_cast<node_ptr>(cur));
         }
         node_->next_ = node_;
         node_->prev_ = node_;
+        size_ = 0;
     }
 }
 
@@ -588,19 +626,7 @@ void list<T>::resize(size_type new_size, const value_type& value) {
 
 template <class T>
 void list<T>::transfer(iterator pos, iterator first, iterator last) {
-    // pos == last 相当于不操作
-    if(pos != last) {
-        // 将原来的链上的[first, last)去除
-        node_ptr tmp = last.node_->prev_; //记录last的前一个结点
-        first.node_->prev_->next_ = last.node_;
-        last.node_->prev_ = first.node_->prev_;
-
-        // 连接到新的位置
-        tmp->next_ = pos.node_;
-        first.node_->prev_ = pos.node_->prev_;
-        pos.node_->prev_->next_ = first.node_;
-        pos.node_->prev_ = tmp;
-    }
+    list_transfer(pos.node_, first.node_, last.node_);
 }
 
 // 都是在list内部进行操作的
@@ -609,21 +635,30 @@ void list<T>::splice(iterator pos, list& other) {
     if(!other.empty()) {
         // 非空才操作
         transfer(pos, other.begin(), other.end());
+        size_ += other.size_;
+        other.size_ = 0;
     }
 }
 
 template <class T>
-void list<T>::splice(iterator pos, list& /* other */, iterator i) {
+void list<T>::splice(iterator pos, list& other, iterator i) {
     iterator j = i;
     ++j;
     if(pos == i || pos == j) return; //这两个都是不移动的
     transfer(pos, i, j);
+    ++size_;
+    --other.size_;  // other就是自己时一加一减，不变
 }
 
 template <class T>
-void list<T>::splice(iterator pos, list& /* other */, iterator first, iterator last) {
+void list<T>::splice(iterator pos, list& other, iterator first, iterator last) {
     if(first != last) {
-        // 非空
+        // 非空，在不同的list之间移动时需要数一下区间的长度
+        if(this != &other) {
+            size_type n = mystl::distance(first, last);
+            size_ += n;
+            other.size_ -= n;
+        }
         transfer(pos, first, last);
     }
 }
@@ -690,126 +725,120 @@ void list<T>::unique(BinaryPredicate pred) {
 
 template <class T>
 void list<T>::merge(list& x) {
-    iterator first1 = begin();
-    iterator last1 = end();
-    iterator first2 = x.begin();
-    iterator last2 = x.end();
-
-    while(first1 != last1 && first2 != last2) {
-        if(*first2 < *first1) {
-            iterator next = first2;  //将first2移动到first1之前
-            transfer(first1, first2, ++next);
-            first2 = next; //防止迭代器失效
-        }else {
-            // *first1 < *first2 没有到插入的位置
-            ++first1;
-        }
-    }
-    // 如果first2 != last2 说明后面的数都大于last1 则整体搬到后面去
-    if(first2 !=last2) transfer(last1, first2, last2);
+    if(this == &x) return;
+    merge_aux(node_, x.node_, mystl::less<T>());
+    size_ += x.size_;
+    x.size_ = 0;
 }
 
 template <class T>
 template <class BinaryPredicate>
 void list<T>::merge(list& x, BinaryPredicate comp) {
-    iterator first1 = begin();
-    iterator last1 = end();
-    iterator first2 = x.begin();
-    iterator last2 = x.end();
+    if(this == &x) return;
+    merge_aux(node_, x.node_, comp);
+    size_ += x.size_;
+    x.size_ = 0;
+}
+
+template <class T>
+template <class Compare>
+void list<T>::merge_aux(base_ptr x, base_ptr y, Compare comp) {
+    iterator first1 = x->next_;
+    iterator last1 = x;
+    iterator first2 = y->next_;
+    iterator last2 = y;
 
     while(first1 != last1 && first2 != last2) {
         if(comp(*first2, *first1)) {
+            // *first2 < *first1，将first2移动到first1之前
             iterator next = first2;
             transfer(first1, first2, ++next);
-            first2 = next;
+            first2 = next; //防止迭代器失效
         }else {
+            // 没有到插入的位置
             ++first1;
         }
     }
-    if(first2 !=last2) transfer(last1, first2, last2);
+    // 如果first2 != last2 说明后面的数都大于last1 则整体搬到后面去
+    if(first2 != last2) transfer(last1, first2, last2);
 }
 
 // 双链表直接交换prev和next指针即可，但是单链表不能这样做，因为找不到前驱结点
 template <class T>
 void list<T>::reverse() {
-    node_ptr cur = node_;
+    base_ptr cur = node_;
     do{
         mystl::swap(cur->next_, cur->prev_);
         cur = cur->prev_; //移动到下一个结点
     } while(cur != node_);
 }
 
-// 将长度为n的[first1, last2)区间排序，并返回最小值的结点iterator
-// 因为还要将[first1, last2) 分割为[first1, last1) [first1, last2),所以这样命名
+/*
+* 自底向上的归并排序，和SGI STL的做法一样：
+* counter[i] 存放已经排好序的、长度为2^i的一段（或者为空），carry用来搬运。
+* 每次从原链表取下第一个结点放到carry，然后像二进制加法进位一样，
+* 和counter[0], counter[1]...依次归并，直到遇到空的counter[i]，把carry放进去。
+* 最后把所有的counter从低到高归并起来。
+* 整个过程只有transfer和比较，不需要像自顶向下那样每一层都走到中点去分割。
+* 所有结点最后都回到原链表，size_不变。
+*
+* counter和carry只用到结点里的prev_和next_，头结点直接用栈上的65个list_node_base，不分配内存也不涉及T
+*/
 template <class T>
 template <class Compare>
-typename list<T>::iterator 
-list<T>::sort_aux(iterator first1, iterator last2, size_type n, Compare comp) {
-    if(n == 1) return first1; //长度为1直接返回
-   
-    size_type len = n / 2;
-    iterator last1 = first1;
-    mystl::advance(last1, len); //last1移动到中间
-    iterator first2 = last1;
-
-    // 递归排序
-    first1 = sort_aux(first1, last1, len, comp);
-    first2 = sort_aux(first2, last2, n - len, comp);
-
-    // 开始归并left和right，连续的两段，由于在同一个list内，可能迭代器失效
-    // 和merge函数不一样
-    last1 = first2;
-    last2  = first2;
-    mystl::advance(last2, n - len);
-
-    /* std::cout << "left: ";
-    iterator cur1 = first1;
-    while(cur1 != last1) {
-        std::cout << *cur1 << " ";
-        ++cur1;
-    }
-
-    std::cout << "right: ";
-    iterator cur2 = first2;
-    while(cur2 != last2) {
-        std::cout << *cur2 << " ";
-        ++cur2;
-    }
-    std::cout << std::endl; */
-
-    iterator head = comp(*first2, *first1) ? first2 : first1;
+void list<T>::sort_aux(Compare comp) {
+    // 0个或者1个元素不需要排序
+    if(node_->next_ == node_ || node_->next_->next_ == node_) return;
+
+    const int max_level = 64;  // 2^64个元素，足够了
+    list_node_base<T> heads[max_level + 1];
+    base_ptr carry = heads + max_level;
+    base_ptr counter = heads;
+    for(int i = 0 ; i <= max_level ; ++i) {
+        heads[i].next_ = heads[i].prev_ = heads + i;
+    }
+
+    int fill = 0;  // 用到的counter个数
+    try {
+        while(!empty()) {
+            // 取下第一个结点
+            iterator first = begin();
+            iterator next = first;
+            transfer(carry, first, ++next);
+
+            int i = 0;
+            while(i < fill && counter[i].next_ != counter + i) {
+                // counter[i]中的元素先于carry进入，放在前面保证稳定
+                merge_aux(counter + i, carry, comp);
+                transfer(carry, counter[i].next_, counter + i);
+                ++i;
+            }
+            transfer(counter + i, carry->next_, carry);
+            if(i == fill) ++fill;
+        }
 
-    while(first1 != last1 && first2 != last2) {
-        if(comp(*first2, *first1)) {
-            // *first2 < *first1
-            iterator next = first2;
-            transfer(first1, first2, ++next);
-            first2 = next;
-            last1 = next; //last1 == first2 因此也需要变 
-        }else{
-            ++first1;
+        for(int i = 1 ; i < fill ; ++i) {
+            merge_aux(counter + i, counter + i - 1, comp);
         }
+        transfer(end(), counter[fill - 1].next_, counter + fill - 1);
+    } catch(...) {
+        // 比较函数抛出异常，把所有结点放回去，顺序不保证
+        for(int i = 0 ; i <= max_level ; ++i) {
+            if(heads[i].next_ != heads + i) transfer(end(), heads[i].next_, heads + i);
+        }
+        throw;
     }
-    /* std::cout << "after sort : ";
-    iterator cur = head;
-    while(cur != last2) {
-        std::cout << *cur << " ";
-        ++cur;
-    }
-    std::cout << std::endl; */
-
-    return head;
 }
 
 template <class T>
 void list<T>::sort() {
-    sort_aux(begin(), end(), size(), mystl::less<T>());
+    sort_aux(mystl::less<T>());
 }
 
 template <class T>
 template <class Compare>
 void list<T>::sort(Compare comp) {
-    sort_aux(begin(), end(), size(), comp);
+    sort_aux(comp);
 }
 
 
@@ -8,8 +8,12 @@
 
 namespace mystl {
 
+template <class Key, class T, class Compare, class Augment>
+class multimap;
+
 // 参数一代表key的类型，参数二代表value的类型， <key, value>，与rb_tree的value不一样
-template<class Key, class T, class Compare = mystl::less<Key>>
+// Augment为红黑树的结点增强策略，见rb_tree.h
+template<class Key, class T, class Compare = mystl::less<Key>, class Augment = rb_tree_no_augment>
 class map {
 public:
     typedef     Key                         key_type;
@@ -19,7 +23,7 @@ public:
 
     // 定义一个内部functor，来进行pair的比较
     class value_compare : public binary_function<value_type, value_type, bool> {
-        friend class map<Key, T, Compare>;
+        friend class map;
         private:
             Compare comp;
             value_compare(Compare c) : comp(c) {}
@@ -31,9 +35,11 @@ public:
 
 private:
     // 红黑树的keyOfValue为select1st
-    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::select1st<value_type>> base_type; 
+    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::select1st<value_type>, Augment> base_type; 
     base_type  tree_;
 
+    template <class, class, class, class> friend class multimap;
+
 public:
     // 使用 rb_tree 的型别
     typedef typename base_type::node_type              node_type;
@@ -48,6 +54,8 @@ public:
     typedef typename base_type::size_type              size_type;
     typedef typename base_type::difference_type        difference_type;
     typedef typename base_type::allocator_type         allocator_type;
+    typedef typename base_type::node_handle            node_handle;
+    typedef typename base_type::insert_return_type     insert_return_type;
 
 public:
     map() = default;
@@ -57,6 +65,12 @@ public:
         tree_.insert_unique(first, last);
     }
 
+    // 区间已经有序，直接建树
+    template <class InputIterator>
+    map(mystl::sorted_unique_t, InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_unique(mystl::sorted_unique, first, last);
+    }
+
     map(std::initializer_list<value_type> ilist) : tree_() {
         tree_.insert_unique(ilist.begin(), ilist.end());
     }
@@ -148,6 +162,10 @@ public:
     void insert(InputIterator first, InputIterator last) {
         tree_.insert_unique(first, last);
     }
+    template <class InputIterator>
+    void insert(mystl::sorted_unique_t, InputIterator first, InputIterator last) {
+        tree_.insert_unique(mystl::sorted_unique, first, last);
+    }
 
     // erase
     iterator erase(iterator pos) {
@@ -168,7 +186,7 @@ public:
     iterator find(const key_type& key) { return tree_.find(key); }
     const_iterator find(const key_type& key) const { return tree_.find(key); }
 
-    size_type count(const key_type& key) { return tree_.count(key); }
+    size_type count(const key_type& key) const { return tree_.count(key); }
 
     iterator       lower_bound(const key_type& key)       { return tree_.lower_bound(key); }
     const_iterator lower_bound(const key_type& key) const { return tree_.lower_bound(key); }
@@ -180,62 +198,121 @@ public:
     equal_range(const key_type& key) {
         return tree_.equal_range(key);
     }
+
+    // 异构查找，key_compare定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator find(const K& key) { return tree_.find(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator find(const K& key) const { return tree_.find(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    size_type count(const K& key) const { return tree_.count(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator lower_bound(const K& key) { return tree_.lower_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator lower_bound(const K& key) const { return tree_.lower_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator upper_bound(const K& key) { return tree_.upper_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator upper_bound(const K& key) const { return tree_.upper_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    mystl::pair<iterator, iterator> equal_range(const K& key) { return tree_.equal_range(key); }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return tree_.erase(key); }
+
+    // node handle，结点在容器之间移动，不重新分配。结点在句柄中时可以修改键值
+    node_handle extract(iterator pos) { return tree_.extract(pos); }
+    node_handle extract(const key_type& key) { return tree_.extract(key); }
+    insert_return_type insert(node_handle&& nh) { return tree_.insert_unique(mystl::move(nh)); }
+
+    // 把other中本容器没有的键值移动过来
+    void merge(map& other) { tree_.merge_unique(other.tree_); }
+    void merge(multimap<Key, T, Compare, Augment>& other) { tree_.merge_unique(other.tree_); }
+
+    // 基于join/split的集合操作，本容器变为结果，较小一方为m个元素时是O(m log(n/m + 1))的
+    // 右值版本直接移动other的结点，键值重复时保留本容器的元素
+    void union_with(const map& other, bool parallel = false) { tree_.union_with(other.tree_, parallel); }
+    void union_with(map&& other, bool parallel = false) { tree_.union_with(other.tree_, parallel); }
+    void intersect_with(const map& other, bool parallel = false) { tree_.intersect_with(other.tree_, parallel); }
+    void difference_with(const map& other, bool parallel = false) { tree_.difference_with(other.tree_, parallel); }
+    // other的键值都大于本容器时，O(log n)拼接
+    void join(map& other) { tree_.join(other.tree_); }
+    // 键值不小于key的元素移到返回的容器中，Augment为rb_tree_size_augment时是O(log n)的
+    map split(const key_type& key) {
+        map right;
+        tree_.split(key, right.tree_);
+        return right;
+    }
+    // 调用者已知键值不小于key的元素个数时，不需要子树大小也是O(log n)
+    map split(const key_type& key, size_type right_count) {
+        map right;
+        tree_.split(key, right.tree_, right_count);
+        return right;
+    }
     
+    // order statistic，Augment为rb_tree_size_augment时可用，O(log n)
+    iterator nth(size_type k) const { return tree_.nth(k); }
+    size_type rank(const key_type& key) const { return tree_.rank(key); }
+    size_type index_of(const_iterator pos) const { return tree_.index_of(pos); }
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return tree_.distance(first, last);
+    }
+
     void swap(map& rhs) {
         tree_.swap(rhs.tree_);
     }
 };
 
 // 重载比较操作符
-template <class Key, class T, class Compare>
-bool operator==(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator==(const map<Key, T, Compare, Augment>& lhs, const map<Key, T, Compare, Augment>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator<(const map<Key, T, Compare, Augment>& lhs, const map<Key, T, Compare, Augment>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator!=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator!=(const map<Key, T, Compare, Augment>& lhs, const map<Key, T, Compare, Augment>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator>(const map<Key, T, Compare, Augment>& lhs, const map<Key, T, Compare, Augment>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator<=(const map<Key, T, Compare, Augment>& lhs, const map<Key, T, Compare, Augment>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator>=(const map<Key, T, Compare, Augment>& lhs, const map<Key, T, Compare, Augment>& rhs)
 {
   return !(lhs < rhs);
 }
 
 
 // multimap
-template<class Key, class T, class Compare = mystl::less<Key>>
+// Augment为红黑树的结点增强策略，见rb_tree.h
+template<class Key, class T, class Compare = mystl::less<Key>, class Augment = rb_tree_no_augment>
 class multimap {
 public:
     typedef     Key                         key_type;
     typedef     T                           mapped_type;    // 被映射的量
-    typedef     mystl::pair<const Key, T>   value_type;
+    typedef     mystl::pair</* const  */Key, T>   value_type;
     typedef     Compare                     key_compare;
 
     // 定义一个内部functor，来进行pair的比较
     class value_compare : public binary_function<value_type, value_type, bool> {
-        friend class multimap<Key, T, Compare>;
+        friend class multimap;
         private:
             Compare comp;
             value_compare(Compare c) : comp(c) {}
@@ -247,9 +324,11 @@ public:
 
 private:
     // 红黑树的keyOfValue为select1st
-    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::select1st<value_type>> base_type; 
+    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::select1st<value_type>, Augment> base_type; 
     base_type  tree_;
 
+    template <class, class, class, class> friend class map;
+
 public:
     // 使用 rb_tree 的型别
     typedef typename base_type::node_type              node_type;
@@ -264,6 +343,7 @@ public:
     typedef typename base_type::size_type              size_type;
     typedef typename base_type::difference_type        difference_type;
     typedef typename base_type::allocator_type         allocator_type;
+    typedef typename base_type::node_handle            node_handle;
 
 public:
     multimap() = default;
@@ -273,6 +353,12 @@ public:
         tree_.insert_equal(first, last);
     }
 
+    // 区间已经有序，直接建树
+    template <class InputIterator>
+    multimap(mystl::sorted_equivalent_t, InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_equal(mystl::sorted_equivalent, first, last);
+    }
+
     multimap(std::initializer_list<value_type> ilist) : tree_() {
         tree_.insert_equal(ilist.begin(), ilist.end());
     }
@@ -364,6 +450,10 @@ public:
     void insert(InputIterator first, InputIterator last) {
         tree_.insert_equal(first, last);
     }
+    template <class InputIterator>
+    void insert(mystl::sorted_equivalent_t, InputIterator first, InputIterator last) {
+        tree_.insert_equal(mystl::sorted_equivalent, first, last);
+    }
 
     // erase
     iterator erase(iterator pos) {
@@ -384,7 +474,7 @@ public:
     iterator find(const key_type& key) { return tree_.find(key); }
     const_iterator find(const key_type& key) const { return tree_.find(key); }
 
-    size_type count(const key_type& key) { return tree_.count(key); }
+    size_type count(const key_type& key) const { return tree_.count(key); }
 
     iterator       lower_bound(const key_type& key)       { return tree_.lower_bound(key); }
     const_iterator lower_bound(const key_type& key) const { return tree_.lower_bound(key); }
@@ -396,50 +486,94 @@ public:
     equal_range(const key_type& key) {
         return tree_.equal_range(key);
     }
+
+    // 异构查找，key_compare定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator find(const K& key) { return tree_.find(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator find(const K& key) const { return tree_.find(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    size_type count(const K& key) const { return tree_.count(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator lower_bound(const K& key) { return tree_.lower_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator lower_bound(const K& key) const { return tree_.lower_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator upper_bound(const K& key) { return tree_.upper_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator upper_bound(const K& key) const { return tree_.upper_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    mystl::pair<iterator, iterator> equal_range(const K& key) { return tree_.equal_range(key); }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return tree_.erase(key); }
+
+    // node handle，结点在容器之间移动，不重新分配。结点在句柄中时可以修改键值
+    node_handle extract(iterator pos) { return tree_.extract(pos); }
+    node_handle extract(const key_type& key) { return tree_.extract(key); }
+    iterator insert(node_handle&& nh) { return tree_.insert_equal(mystl::move(nh)); }
+
+    // 把other中所有元素移动过来
+    void merge(multimap& other) { tree_.merge_equal(other.tree_); }
+    void merge(map<Key, T, Compare, Augment>& other) { tree_.merge_equal(other.tree_); }
     
+    // order statistic，Augment为rb_tree_size_augment时可用，O(log n)
+    iterator nth(size_type k) const { return tree_.nth(k); }
+    size_type rank(const key_type& key) const { return tree_.rank(key); }
+    size_type index_of(const_iterator pos) const { return tree_.index_of(pos); }
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return tree_.distance(first, last);
+    }
+
     void swap(multimap& rhs) {
         tree_.swap(rhs.tree_);
     }
 };
 
 // 重载比较操作符
-template <class Key, class T, class Compare>
-bool operator==(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator==(const multimap<Key, T, Compare, Augment>& lhs, const multimap<Key, T, Compare, Augment>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator<(const multimap<Key, T, Compare, Augment>& lhs, const multimap<Key, T, Compare, Augment>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator!=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator!=(const multimap<Key, T, Compare, Augment>& lhs, const multimap<Key, T, Compare, Augment>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator>(const multimap<Key, T, Compare, Augment>& lhs, const multimap<Key, T, Compare, Augment>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator<=(const multimap<Key, T, Compare, Augment>& lhs, const multimap<Key, T, Compare, Augment>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, class Augment>
+bool operator>=(const multimap<Key, T, Compare, Augment>& lhs, const multimap<Key, T, Compare, Augment>& rhs)
 {
   return !(lhs < rhs);
 }
 
 
+// 维护子树大小的map，支持O(log n)的nth、rank和distance
+template <class Key, class T, class Compare = mystl::less<Key>>
+using order_statistic_map = map<Key, T, Compare, rb_tree_size_augment>;
+
+template <class Key, class T, class Compare = mystl::less<Key>>
+using order_statistic_multimap = multimap<Key, T, Compare, rb_tree_size_augment>;
+
 }
 
 #endif
\ No newline at end of file
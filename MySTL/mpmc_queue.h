@@ -0,0 +1,278 @@
+#ifndef __MPMC_QUEUE_H__
+#define __MPMC_QUEUE_H__
+
+#include <atomic>
+#include <cstdint>
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "util.h"
+#include "atomic_wait.h"
+
+// 这个文件定义了有界的多生产者多消费者无锁队列 mpmc_queue，算法来自Dmitry Vyukov的bounded MPMC queue
+
+/*
+* 环形缓冲区的每个cell带一个序号seq，容量为2的幂，pos为单调递增的计数：
+*   seq == pos          : cell为空，可以被位置为pos的生产者写入
+*   seq == pos + 1      : cell已写入，可以被位置为pos的消费者读出
+*   读出后 seq = pos + capacity，留给下一圈的生产者
+*
+* 生产者通过CAS enqueue_pos_ 抢到一个位置，消费者通过CAS dequeue_pos_ 抢到一个位置，
+* 抢到位置以后对cell的读写只有自己一个线程，完成后用release写seq发布。
+* 生产者和消费者之间只通过cell的seq同步，两个计数放在不同的缓存行上。
+*
+* 批量操作一次CAS抢下连续的k个cell，再逐个写入/读出并发布。
+*/
+
+namespace mystl {
+
+// 队列中的一个槽位
+template <class T>
+struct mpmc_queue_cell {
+    std::atomic<size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];   // 未初始化的内存，对象由队列构造和析构
+
+    T* value_ptr() { return reinterpret_cast<T*>(storage); }
+};
+
+template <class T>
+class mpmc_queue {
+public:
+    typedef T           value_type;
+    typedef size_t      size_type;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+
+    typedef mpmc_queue_cell<T>             cell_type;
+    typedef mystl::allocator<cell_type>     cell_allocator;
+
+private:
+    alignas(MYSTL_CACHE_LINE_SIZE) std::atomic<size_type> enqueue_pos_;   // 生产者竞争
+    alignas(MYSTL_CACHE_LINE_SIZE) std::atomic<size_type> dequeue_pos_;   // 消费者竞争
+    alignas(MYSTL_CACHE_LINE_SIZE) cell_type* cells_;                     // 构造后只读
+    size_type mask_;
+
+    // 阻塞等待用
+    alignas(MYSTL_CACHE_LINE_SIZE) wait_point not_empty_;
+    wait_point not_full_;
+
+public:
+    // 容量会向上取整到2的幂，至少为2
+    explicit mpmc_queue(size_type capacity = 1024) : enqueue_pos_(0), dequeue_pos_(0) {
+        THROW_LENGTH_ERROR_IF(capacity == 0, "mpmc_queue<T> capacity must be positive.\n");
+        size_type n = 2;
+        while(n < capacity) n <<= 1;
+        cells_ = cell_allocator::allocate(n);
+        for(size_type i = 0 ; i < n ; ++i) {
+            ::new((void*)&cells_[i].seq) std::atomic<size_type>(i);
+        }
+        mask_ = n - 1;
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    ~mpmc_queue() {
+        clear();
+        cell_allocator::deallocate(cells_);
+    }
+
+public:
+    // 并发时只是瞬时的近似值
+    size_type size() const {
+        size_type tail = enqueue_pos_.load(std::memory_order_acquire);
+        size_type head = dequeue_pos_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_type capacity() const { return mask_ + 1; }
+
+    // ---------------------------非阻塞接口---------------------------
+
+    bool try_push(const value_type& value) { return try_emplace(value); }
+    bool try_push(value_type&& value) { return try_emplace(mystl::move(value)); }
+
+    template <class... Args>
+    bool try_emplace(Args&&... args);
+
+    bool try_pop(value_type& value);
+
+    // 批量push，最多n个，返回实际个数
+    template <class Iterator>
+    size_type try_push_bulk(Iterator first, size_type n);
+
+    // 批量pop到result，最多n个，返回实际个数
+    template <class OutputIterator>
+    size_type try_pop_bulk(OutputIterator result, size_type n);
+
+    // ---------------------------阻塞接口---------------------------
+
+    void push(const value_type& value) { emplace(value); }
+    void push(value_type&& value) { emplace(mystl::move(value)); }
+
+    template <class... Args>
+    void emplace(Args&&... args) {
+        while(!try_emplace(mystl::forward<Args>(args)...)) {
+            wait_not_full();
+        }
+    }
+
+    void wait_pop(value_type& value) {
+        while(!try_pop(value)) {
+            wait_not_empty();
+        }
+    }
+
+    template <class Iterator>
+    void push_bulk(Iterator first, size_type n) {
+        while(n > 0) {
+            size_type pushed = try_push_bulk(first, n);
+            mystl::advance(first, pushed);
+            n -= pushed;
+            if(n > 0 && pushed == 0) wait_not_full();
+        }
+    }
+
+    // 阻塞直到至少pop出一个元素
+    template <class OutputIterator>
+    size_type wait_pop_bulk(OutputIterator result, size_type n) {
+        size_type popped;
+        while((popped = try_pop_bulk(result, n)) == 0 && n > 0) {
+            wait_not_empty();
+        }
+        return popped;
+    }
+
+    // 只能在没有其他线程访问时调用
+    void clear() {
+        size_type head = dequeue_pos_.load(std::memory_order_relaxed);
+        const size_type tail = enqueue_pos_.load(std::memory_order_relaxed);
+        for(; head != tail ; ++head) {
+            cell_type& c = cells_[head & mask_];
+            mystl::destroy(c.value_ptr());
+            c.seq.store(head + mask_ + 1, std::memory_order_relaxed);
+        }
+        dequeue_pos_.store(head, std::memory_order_relaxed);
+    }
+
+private:
+    // 从pos开始最多n个cell中，连续满足 seq == pos + i + offset 的个数
+    size_type ready_run(size_type pos, size_type n, size_type offset) const {
+        size_type k = 0;
+        while(k < n) {
+            const cell_type& c = cells_[(pos + k) & mask_];
+            if(c.seq.load(std::memory_order_acquire) != pos + k + offset) break;
+            ++k;
+        }
+        return k;
+    }
+
+    // 抢占[pos, pos + k) 的位置，offset为0时是生产者，为1时是消费者。返回抢到的个数，pos为起点
+    size_type claim(std::atomic<size_type>& counter, size_type& pos, size_type n, size_type offset);
+
+    void wait_not_full() {
+        not_full_.wait_until([this] {
+            size_type pos = enqueue_pos_.load(std::memory_order_relaxed);
+            return ready_run(pos, 1, 0) == 1;
+        });
+    }
+
+    void wait_not_empty() {
+        not_empty_.wait_until([this] {
+            size_type pos = dequeue_pos_.load(std::memory_order_relaxed);
+            return ready_run(pos, 1, 1) == 1;
+        });
+    }
+};
+
+template <class T>
+typename mpmc_queue<T>::size_type
+mpmc_queue<T>::claim(std::atomic<size_type>& counter, size_type& pos, size_type n, size_type offset) {
+    pos = counter.load(std::memory_order_relaxed);
+    while(true) {
+        const size_type seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+        const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + offset);
+        if(dif == 0) {
+            // 第一个cell可用，看看后面还有多少个连续可用
+            size_type k = n == 1 ? 1 : ready_run(pos, n, offset);
+            if(counter.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                return k;
+            }
+            // CAS失败时pos已经被更新为最新值
+        }else if(dif < 0) {
+            // 生产者：这一圈的cell还没被读走，队列满；消费者：cell还没写入，队列空
+            return 0;
+        }else {
+            // 被其他线程抢先了，重新读取计数
+            pos = counter.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class T>
+template <class... Args>
+bool mpmc_queue<T>::try_emplace(Args&&... args) {
+    size_type pos;
+    if(claim(enqueue_pos_, pos, 1, 0) == 0) {
+        return false;
+    }
+    cell_type& c = cells_[pos & mask_];
+    mystl::construct(c.value_ptr(), mystl::forward<Args>(args)...);
+    c.seq.store(pos + 1, std::memory_order_release);
+    not_empty_.notify();
+    return true;
+}
+
+template <class T>
+bool mpmc_queue<T>::try_pop(value_type& value) {
+    size_type pos;
+    if(claim(dequeue_pos_, pos, 1, 1) == 0) {
+        return false;
+    }
+    cell_type& c = cells_[pos & mask_];
+    value = mystl::move(*c.value_ptr());
+    mystl::destroy(c.value_ptr());
+    c.seq.store(pos + mask_ + 1, std::memory_order_release);
+    not_full_.notify();
+    return true;
+}
+
+template <class T>
+template <class Iterator>
+typename mpmc_queue<T>::size_type
+mpmc_queue<T>::try_push_bulk(Iterator first, size_type n) {
+    if(n == 0) return 0;
+    size_type pos;
+    size_type k = claim(enqueue_pos_, pos, n, 0);
+    for(size_type i = 0 ; i < k ; ++i, ++first) {
+        cell_type& c = cells_[(pos + i) & mask_];
+        mystl::construct(c.value_ptr(), *first);
+        c.seq.store(pos + i + 1, std::memory_order_release);
+    }
+    if(k > 0) not_empty_.notify();
+    return k;
+}
+
+template <class T>
+template <class OutputIterator>
+typename mpmc_queue<T>::size_type
+mpmc_queue<T>::try_pop_bulk(OutputIterator result, size_type n) {
+    if(n == 0) return 0;
+    size_type pos;
+    size_type k = claim(dequeue_pos_, pos, n, 1);
+    for(size_type i = 0 ; i < k ; ++i, ++result) {
+        cell_type& c = cells_[(pos + i) & mask_];
+        *result = mystl::move(*c.value_ptr());
+        mystl::destroy(c.value_ptr());
+        c.seq.store(pos + i + mask_ + 1, std::memory_order_release);
+    }
+    if(k > 0) not_full_.notify();
+    return k;
+}
+
+}
+
+#endif
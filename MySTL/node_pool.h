@@ -0,0 +1,212 @@
+#ifndef __NODE_POOL_H__
+#define __NODE_POOL_H__
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+// 这个文件定义了定长结点的内存池 node_pool，以及按结点类型使用它的 pool_allocator
+
+/*
+* 每种 (结点大小, 对齐) 共用一个池：
+*   每个线程有自己的空闲链表和一段可以顺序切分的内存（bump区），分配和释放都不加锁
+*   空闲链表和bump区都用完时，加锁从全局取回其他线程退出时留下的空闲结点，或者向系统申请一整块新内存
+*   线程退出时把自己的空闲结点交还给全局
+*
+* 结点可以在一个线程分配、在另一个线程释放，只是进入了释放线程的空闲链表。
+* 内存块一直保留到进程结束，不会还给系统，所以适合结点数量反复增减的场景。
+*
+* 批量接口：
+*   reserve(n)              保证接下来的n次分配不再申请内存，不够时一次申请一整块
+*   deallocate_chain(...)   把已经串成链表的一批结点一次挂回空闲链表
+*/
+
+namespace mystl {
+
+// 一次向系统申请的结点数，按已经申请的总量增长，上限为 MYSTL_NODE_POOL_MAX_CHUNK
+#ifndef MYSTL_NODE_POOL_MIN_CHUNK
+#define MYSTL_NODE_POOL_MIN_CHUNK 64
+#endif
+
+#ifndef MYSTL_NODE_POOL_MAX_CHUNK
+#define MYSTL_NODE_POOL_MAX_CHUNK 65536
+#endif
+
+// 空闲结点的第一个字作为链表指针
+struct node_pool_link {
+    node_pool_link* next;
+};
+
+template <size_t Size, size_t Align>
+class node_pool {
+public:
+    static constexpr size_t align = Align > alignof(node_pool_link) ? Align : alignof(node_pool_link);
+    static constexpr size_t block_size = ((Size > sizeof(node_pool_link) ? Size : sizeof(node_pool_link)) + align - 1)
+                                         / align * align;
+
+private:
+    // 向系统申请的一整块内存，块头之后是结点
+    struct chunk {
+        chunk* next;
+    };
+    static constexpr size_t chunk_header = (sizeof(chunk) + align - 1) / align * align;
+
+    // 全局状态：所有内存块，以及退出的线程留下的空闲结点
+    struct global_state {
+        std::mutex mutex;
+        chunk* chunks = nullptr;
+        node_pool_link* free_head = nullptr;
+        node_pool_link* free_tail = nullptr;
+        size_t free_count = 0;
+        size_t allocated = 0;       // 已经申请的结点总数
+
+        ~global_state() {
+            while(chunks != nullptr) {
+                chunk* next = chunks->next;
+                ::operator delete(static_cast<void*>(chunks));
+                chunks = next;
+            }
+        }
+    };
+
+    struct local_state {
+        node_pool_link* free_head = nullptr;
+        node_pool_link* free_tail = nullptr;
+        size_t free_count = 0;
+        char* bump = nullptr;
+        char* bump_end = nullptr;
+
+        size_t available() const {
+            return free_count + static_cast<size_t>(bump_end - bump) / block_size;
+        }
+
+        void push(node_pool_link* head, node_pool_link* tail, size_t n) {
+            if(free_head == nullptr) free_tail = tail;
+            tail->next = free_head;
+            free_head = head;
+            free_count += n;
+        }
+
+        // bump区剩下的部分切成空闲结点
+        void flush_bump() {
+            while(bump != bump_end) {
+                node_pool_link* p = reinterpret_cast<node_pool_link*>(bump);
+                p->next = nullptr;
+                push(p, p, 1);
+                bump += block_size;
+            }
+        }
+
+        ~local_state() {
+            flush_bump();
+            if(free_head == nullptr) return;
+            global_state& g = global();
+            std::lock_guard<std::mutex> lock(g.mutex);
+            if(g.free_head == nullptr) g.free_tail = free_tail;
+            free_tail->next = g.free_head;
+            g.free_head = free_head;
+            g.free_count += free_count;
+        }
+    };
+
+    static global_state& global() {
+        static global_state state;
+        return state;
+    }
+
+    static local_state& local() {
+        static thread_local local_state state;
+        return state;
+    }
+
+    // 让本线程至少有n个可用结点
+    static void refill(local_state& l, size_t n) {
+        global_state& g = global();
+        std::lock_guard<std::mutex> lock(g.mutex);
+        if(g.free_head != nullptr) {
+            l.push(g.free_head, g.free_tail, g.free_count);
+            g.free_head = g.free_tail = nullptr;
+            g.free_count = 0;
+            if(l.available() >= n) return;
+        }
+        size_t want = n - l.available();
+        size_t grow = g.allocated / 4;
+        if(grow < MYSTL_NODE_POOL_MIN_CHUNK) grow = MYSTL_NODE_POOL_MIN_CHUNK;
+        if(grow > MYSTL_NODE_POOL_MAX_CHUNK) grow = MYSTL_NODE_POOL_MAX_CHUNK;
+        if(want < grow) want = grow;
+
+        char* mem = static_cast<char*>(::operator new(chunk_header + want * block_size));
+        chunk* c = reinterpret_cast<chunk*>(mem);
+        c->next = g.chunks;
+        g.chunks = c;
+        g.allocated += want;
+
+        l.flush_bump();
+        l.bump = mem + chunk_header;
+        l.bump_end = l.bump + want * block_size;
+    }
+
+public:
+    static void* allocate() {
+        local_state& l = local();
+        if(l.free_head == nullptr && l.bump == l.bump_end) refill(l, 1);
+        if(l.free_head != nullptr) {
+            node_pool_link* p = l.free_head;
+            l.free_head = p->next;
+            --l.free_count;
+            return p;
+        }
+        void* p = l.bump;
+        l.bump += block_size;
+        return p;
+    }
+
+    static void deallocate(void* p) {
+        node_pool_link* x = static_cast<node_pool_link*>(p);
+        local().push(x, x, 1);
+    }
+
+    static void reserve(size_t n) {
+        local_state& l = local();
+        if(l.available() < n) refill(l, n);
+    }
+
+    // [head, tail]是用next串起来的n个结点
+    static void deallocate_chain(node_pool_link* head, node_pool_link* tail, size_t n) {
+        if(n != 0) local().push(head, tail, n);
+    }
+};
+
+// 只能一次分配一个对象的allocator，接口与mystl::allocator的静态函数一致
+template <class T>
+class pool_allocator {
+public:
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef size_t      size_type;
+
+    typedef node_pool<sizeof(T), alignof(T)> pool_type;
+
+    static T* allocate() { return static_cast<T*>(pool_type::allocate()); }
+    static T* allocate(size_type n) {
+        return n == 1 ? allocate() : static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    static void deallocate(T* ptr) {
+        if(ptr != nullptr) pool_type::deallocate(ptr);
+    }
+    static void deallocate(T* ptr, size_type n) {
+        if(ptr == nullptr) return;
+        if(n == 1) pool_type::deallocate(ptr);
+        else ::operator delete(ptr);
+    }
+
+    static void reserve(size_type n) { pool_type::reserve(n); }
+    static void deallocate_chain(node_pool_link* head, node_pool_link* tail, size_type n) {
+        pool_type::deallocate_chain(head, tail, n);
+    }
+};
+
+}
+
+#endif
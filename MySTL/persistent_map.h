@@ -0,0 +1,525 @@
+#ifndef __PERSISTENT_MAP_H__
+#define __PERSISTENT_MAP_H__
+
+#include <atomic>
+#include <initializer_list>
+
+#include "functional.h"
+#include "iterator.h"
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "util.h"
+
+// 这个文件定义了persistent_map，一个不可变的、结点共享的有序map
+
+/*
+* 和map的区别：
+*   每个版本都不可修改，insert/insert_or_assign/erase不改动当前版本，而是返回一个新版本。
+*   新版本只复制从根到被修改位置的一条路径（O(log n)个结点），其余子树和旧版本共享，
+*   结点用引用计数管理，最后一个引用它的版本析构时才释放。
+*   拷贝一个版本只是根结点的引用计数加一，是O(1)的，适合做时间点快照：
+*   写者不断产生新版本并发布，读者拿到的快照在读期间保持一致，不需要加锁，也不会被写者改动。
+*
+*   引用计数是原子的，不同线程可以各自持有、拷贝、析构共享结点的版本。
+*   但同一个persistent_map对象的赋值和读取之间仍然需要同步（比如发布时用互斥量保护“当前版本”这个变量）。
+*
+*   平衡用红黑树：插入用Okasaki的balance，删除用Kahrs的算法，都是纯函数式的，
+*   只创建新结点，从不修改已有结点。
+*   结点没有父指针（一个结点可能属于多个版本），迭代器的++/--从根重新查找后继，是O(log n)的；
+*   整体遍历用for_each，是O(n)的。
+*/
+
+namespace mystl {
+
+template <class Value>
+struct persistent_map_node;
+
+// 侵入式的引用计数指针，持有一个结点的一份引用
+template <class Value>
+class persistent_node_ref {
+public:
+    typedef persistent_map_node<Value>  node_type;
+    typedef mystl::allocator<node_type> node_allocator;
+
+private:
+    node_type* node_;
+
+public:
+    persistent_node_ref() : node_(nullptr) {}
+    // 接管一个新建结点的初始引用
+    explicit persistent_node_ref(node_type* node) : node_(node) {}
+
+    persistent_node_ref(const persistent_node_ref& rhs) : node_(rhs.node_) {
+        retain(node_);
+    }
+    persistent_node_ref(persistent_node_ref&& rhs) noexcept : node_(rhs.node_) {
+        rhs.node_ = nullptr;
+    }
+
+    persistent_node_ref& operator=(const persistent_node_ref& rhs) {
+        retain(rhs.node_);
+        release(node_);
+        node_ = rhs.node_;
+        return *this;
+    }
+    persistent_node_ref& operator=(persistent_node_ref&& rhs) noexcept {
+        if(this != &rhs) {
+            release(node_);
+            node_ = rhs.node_;
+            rhs.node_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~persistent_node_ref() { release(node_); }
+
+    node_type*  get()           const { return node_; }
+    node_type*  operator->()    const { return node_; }
+    explicit operator bool()    const { return node_ != nullptr; }
+
+    void swap(persistent_node_ref& rhs) noexcept { mystl::swap(node_, rhs.node_); }
+
+private:
+    static void retain(node_type* node) {
+        if(node != nullptr) node->refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    // 最后一个引用释放时销毁结点，结点中孩子的引用随之释放
+    static void release(node_type* node) {
+        if(node != nullptr && node->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            mystl::destroy(node);
+            node_allocator::deallocate(node);
+        }
+    }
+};
+
+template <class Value>
+struct persistent_map_node {
+    typedef persistent_node_ref<Value> ref;
+
+    std::atomic<size_t> refs_;
+    ref                 left_;
+    ref                 right_;
+    bool                red_;
+    Value               value_;
+
+    persistent_map_node(bool red, ref&& left, const Value& value, ref&& right)
+        : refs_(1), left_(mystl::move(left)), right_(mystl::move(right)), red_(red), value_(value) {}
+};
+
+template <class Key, class T, class Compare>
+class persistent_map;
+
+// 只读的双向迭代器，保存所属版本的根和当前结点，end()的结点为nullptr
+// 根是共享所有权的引用，迭代器始终在创建它的那个版本上移动，map之后被修改或者销毁都不影响它
+template <class Key, class T, class Compare>
+struct persistent_map_iterator {
+    typedef mystl::bidirectional_iterator_tag   iterator_category;
+    typedef mystl::pair<Key, T>                 value_type;
+    typedef ptrdiff_t                           difference_type;
+    typedef const value_type*                   pointer;
+    typedef const value_type&                   reference;
+
+    typedef persistent_map<Key, T, Compare>     map_type;
+    typedef persistent_map_node<value_type>     node_type;
+    typedef persistent_node_ref<value_type>     node_ref;
+
+    node_ref         root_;
+    const node_type* node_;
+    Compare          comp_;
+
+    persistent_map_iterator() : root_(), node_(nullptr), comp_() {}
+    persistent_map_iterator(const node_ref& root, const node_type* node, const Compare& comp)
+        : root_(root), node_(node), comp_(comp) {}
+
+    reference operator*()  const { return node_->value_; }
+    pointer   operator->() const { return &(operator*()); }
+
+    persistent_map_iterator& operator++() {
+        node_ = map_type::successor(root_.get(), node_->value_.first, comp_);
+        return *this;
+    }
+    persistent_map_iterator operator++(int) {
+        persistent_map_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+    // end()退一步到最大元素
+    persistent_map_iterator& operator--() {
+        node_ = node_ == nullptr ? map_type::max_node(root_.get())
+                                 : map_type::predecessor(root_.get(), node_->value_.first, comp_);
+        return *this;
+    }
+    persistent_map_iterator operator--(int) {
+        persistent_map_iterator tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    bool operator==(const persistent_map_iterator& rhs) const { return node_ == rhs.node_; }
+    bool operator!=(const persistent_map_iterator& rhs) const { return node_ != rhs.node_; }
+};
+
+template <class Key, class T, class Compare = mystl::less<Key>>
+class persistent_map {
+public:
+    typedef Key                                 key_type;
+    typedef T                                   mapped_type;
+    typedef mystl::pair<Key, T>                 value_type;
+    typedef Compare                             key_compare;
+    typedef size_t                              size_type;
+    typedef ptrdiff_t                           difference_type;
+    typedef const value_type&                   reference;
+    typedef const value_type&                   const_reference;
+    typedef const value_type*                   pointer;
+    typedef const value_type*                   const_pointer;
+
+    typedef persistent_map_iterator<Key, T, Compare>    iterator;
+    typedef persistent_map_iterator<Key, T, Compare>    const_iterator;
+    typedef mystl::reverse_iterator<const_iterator>     reverse_iterator;
+    typedef mystl::reverse_iterator<const_iterator>     const_reverse_iterator;
+
+    typedef persistent_map_node<value_type>     node_type;
+    typedef persistent_node_ref<value_type>     node_ref;
+    typedef mystl::allocator<node_type>         node_allocator;
+
+    friend struct persistent_map_iterator<Key, T, Compare>;
+
+private:
+    node_ref    root_;
+    size_type   size_;
+    key_compare comp_;
+
+public:
+    persistent_map() : root_(), size_(0), comp_() {}
+
+    template <class InputIterator>
+    persistent_map(InputIterator first, InputIterator last) : root_(), size_(0), comp_() {
+        for(; first != last ; ++first) insert_aux(*first, false);
+    }
+
+    persistent_map(std::initializer_list<value_type> ilist) : root_(), size_(0), comp_() {
+        for(auto& value : ilist) insert_aux(value, false);
+    }
+
+    // 拷贝就是快照，只增加根结点的引用计数
+    persistent_map(const persistent_map& rhs) = default;
+    persistent_map(persistent_map&& rhs) noexcept
+        : root_(mystl::move(rhs.root_)), size_(rhs.size_), comp_(rhs.comp_) {
+        rhs.size_ = 0;
+    }
+    persistent_map& operator=(const persistent_map& rhs) = default;
+    persistent_map& operator=(persistent_map&& rhs) noexcept {
+        root_ = mystl::move(rhs.root_);
+        size_ = rhs.size_;
+        comp_ = rhs.comp_;
+        rhs.size_ = 0;
+        return *this;
+    }
+
+    // 和拷贝一样，写出来让发布的地方意图更清楚
+    persistent_map snapshot() const { return *this; }
+
+    key_compare key_comp() const { return comp_; }
+
+    // 迭代器，都是只读的
+    const_iterator begin() const { return const_iterator(root_, min_node(), comp_); }
+    const_iterator end()   const { return const_iterator(root_, nullptr, comp_); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend()   const { return const_reverse_iterator(begin()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend()   const { return end(); }
+
+    bool      empty()    const { return size_ == 0; }
+    size_type size()     const { return size_; }
+    size_type max_size() const { return static_cast<size_type>(-1); }
+
+    // 查找
+    const_iterator find(const key_type& key) const { return const_iterator(root_, find_node(key), comp_); }
+    size_type count(const key_type& key) const { return find_node(key) != nullptr ? 1 : 0; }
+    bool contains(const key_type& key) const { return find_node(key) != nullptr; }
+
+    const mapped_type& at(const key_type& key) const {
+        const node_type* x = find_node(key);
+        THROW_OUT_OF_RANGE_IF(x == nullptr, "persistent_map<Key, T> no such element.\n");
+        return x->value_.second;
+    }
+    const mapped_type& operator[](const key_type& key) const { return at(key); }
+
+    const_iterator lower_bound(const key_type& key) const {
+        const node_type* y = nullptr;
+        for(const node_type* x = root_.get() ; x != nullptr ; ) {
+            if(!comp_(x->value_.first, key)) {
+                y = x;
+                x = x->left_.get();
+            }else {
+                x = x->right_.get();
+            }
+        }
+        return const_iterator(root_, y, comp_);
+    }
+    const_iterator upper_bound(const key_type& key) const { return const_iterator(root_, successor(root_.get(), key, comp_), comp_); }
+
+    // 修改操作都返回新版本，当前版本不变
+    // insert：键值已存在时返回和当前版本共享全部结点的副本
+    persistent_map insert(const value_type& value) const {
+        persistent_map result(*this);
+        if(!contains(value.first)) result.insert_aux(value, false);
+        return result;
+    }
+    persistent_map insert(const key_type& key, const mapped_type& obj) const {
+        return insert(value_type(key, obj));
+    }
+    template <class InputIterator>
+    persistent_map insert(InputIterator first, InputIterator last) const {
+        persistent_map result(*this);
+        for(; first != last ; ++first) {
+            if(!result.contains(first->first)) result.insert_aux(*first, false);
+        }
+        return result;
+    }
+
+    // 键值已存在时替换value，同样只复制一条路径
+    persistent_map insert_or_assign(const key_type& key, const mapped_type& obj) const {
+        persistent_map result(*this);
+        result.insert_aux(value_type(key, obj), true);
+        return result;
+    }
+
+    // 键值不存在时返回当前版本的副本
+    persistent_map erase(const key_type& key) const {
+        persistent_map result(*this);
+        if(contains(key)) {
+            node_ref r = result.del(result.root_, key);
+            result.root_ = blacken(mystl::move(r));
+            --result.size_;
+        }
+        return result;
+    }
+
+    persistent_map clear() const { return persistent_map(); }
+
+    // 中序遍历，O(n)，比迭代器快
+    template <class Function>
+    void for_each(Function f) const { for_each_aux(root_.get(), f); }
+
+    // 两个版本是否是同一棵树（快照之后没有修改过）
+    bool same_version(const persistent_map& rhs) const { return root_.get() == rhs.root_.get(); }
+
+    void swap(persistent_map& rhs) noexcept {
+        root_.swap(rhs.root_);
+        mystl::swap(size_, rhs.size_);
+        mystl::swap(comp_, rhs.comp_);
+    }
+
+private:
+    const node_type* find_node(const key_type& key) const {
+        const node_type* x = root_.get();
+        while(x != nullptr) {
+            if(comp_(key, x->value_.first)) x = x->left_.get();
+            else if(comp_(x->value_.first, key)) x = x->right_.get();
+            else return x;
+        }
+        return nullptr;
+    }
+    const node_type* min_node() const {
+        const node_type* x = root_.get();
+        if(x != nullptr) while(x->left_) x = x->left_.get();
+        return x;
+    }
+    // 下面三个从给定的根开始查找，迭代器用自己保存的根调用
+    static const node_type* max_node(const node_type* x) {
+        if(x != nullptr) while(x->right_) x = x->right_.get();
+        return x;
+    }
+    // 第一个大于key的结点
+    static const node_type* successor(const node_type* x, const key_type& key, const key_compare& comp) {
+        const node_type* y = nullptr;
+        while(x != nullptr) {
+            if(comp(key, x->value_.first)) {
+                y = x;
+                x = x->left_.get();
+            }else {
+                x = x->right_.get();
+            }
+        }
+        return y;
+    }
+    // 最后一个小于key的结点
+    static const node_type* predecessor(const node_type* x, const key_type& key, const key_compare& comp) {
+        const node_type* y = nullptr;
+        while(x != nullptr) {
+            if(comp(x->value_.first, key)) {
+                y = x;
+                x = x->right_.get();
+            }else {
+                x = x->left_.get();
+            }
+        }
+        return y;
+    }
+
+    template <class Function>
+    static void for_each_aux(const node_type* x, Function& f) {
+        while(x != nullptr) {
+            for_each_aux(x->left_.get(), f);
+            f(x->value_);
+            x = x->right_.get();
+        }
+    }
+
+    // 以下都是纯函数，参数中的结点只读，结果总是新建的结点（或者原样共享的子树）
+    static bool is_red(const node_ref& x)   { return x && x->red_; }
+    static bool is_black(const node_ref& x) { return x && !x->red_; }
+
+    static node_ref make(bool red, node_ref left, const value_type& value, node_ref right) {
+        node_type* node = node_allocator::allocate(1);
+        try {
+            mystl::construct(node, red, mystl::move(left), value, mystl::move(right));
+        }catch(...) {
+            node_allocator::deallocate(node);
+            throw;
+        }
+        return node_ref(node);
+    }
+    static node_ref red(node_ref left, const value_type& value, node_ref right) {
+        return make(true, mystl::move(left), value, mystl::move(right));
+    }
+    static node_ref black(node_ref left, const value_type& value, node_ref right) {
+        return make(false, mystl::move(left), value, mystl::move(right));
+    }
+    static node_ref blacken(node_ref x) {
+        if(!is_red(x)) return x;
+        return black(x->left_, x->value_, x->right_);
+    }
+    // 黑结点涂红，删除时调整黑高用
+    static node_ref redden(const node_ref& x) {
+        return red(x->left_, x->value_, x->right_);
+    }
+
+    // 消除红结点的红孩子，四种形状都变成红根两个黑孩子；l和r都是红时直接把两边涂黑
+    static node_ref balance(const node_ref& l, const value_type& value, const node_ref& r) {
+        if(is_red(l) && is_red(r)) {
+            return red(blacken(l), value, blacken(r));
+        }
+        if(is_red(l)) {
+            if(is_red(l->left_)) {
+                return red(blacken(l->left_), l->value_, black(l->right_, value, r));
+            }
+            if(is_red(l->right_)) {
+                return red(black(l->left_, l->value_, l->right_->left_), l->right_->value_,
+                           black(l->right_->right_, value, r));
+            }
+        }
+        if(is_red(r)) {
+            if(is_red(r->right_)) {
+                return red(black(l, value, r->left_), r->value_, blacken(r->right_));
+            }
+            if(is_red(r->left_)) {
+                return red(black(l, value, r->left_->left_), r->left_->value_,
+                           black(r->left_->right_, r->value_, r->right_));
+            }
+        }
+        return black(l, value, r);
+    }
+
+    void insert_aux(const value_type& value, bool assign) {
+        bool inserted = false;
+        node_ref r = ins(root_, value, assign, inserted);
+        root_ = blacken(mystl::move(r));
+        if(inserted) ++size_;
+    }
+
+    node_ref ins(const node_ref& x, const value_type& value, bool assign, bool& inserted) const {
+        if(!x) {
+            inserted = true;
+            return red(node_ref(), value, node_ref());
+        }
+        if(comp_(value.first, x->value_.first)) {
+            node_ref l = ins(x->left_, value, assign, inserted);
+            return x->red_ ? red(mystl::move(l), x->value_, x->right_) : balance(l, x->value_, x->right_);
+        }
+        if(comp_(x->value_.first, value.first)) {
+            node_ref r = ins(x->right_, value, assign, inserted);
+            return x->red_ ? red(x->left_, x->value_, mystl::move(r)) : balance(x->left_, x->value_, r);
+        }
+        return assign ? make(x->red_, x->left_, value, x->right_) : x;
+    }
+
+    // 删除：key一定存在。删除黑结点会让这一侧的黑高减一，由balleft/balright补回来
+    node_ref del(const node_ref& x, const key_type& key) const {
+        if(comp_(key, x->value_.first)) {
+            if(is_black(x->left_)) return balleft(del(x->left_, key), x->value_, x->right_);
+            return red(del(x->left_, key), x->value_, x->right_);
+        }
+        if(comp_(x->value_.first, key)) {
+            if(is_black(x->right_)) return balright(x->left_, x->value_, del(x->right_, key));
+            return red(x->left_, x->value_, del(x->right_, key));
+        }
+        return app(x->left_, x->right_);
+    }
+
+    // 左子树黑高比右边少一
+    static node_ref balleft(const node_ref& l, const value_type& value, const node_ref& r) {
+        if(is_red(l)) return red(blacken(l), value, r);
+        if(is_black(r)) return balance(l, value, redden(r));
+        // r为红，r的左孩子为黑
+        return red(black(l, value, r->left_->left_), r->left_->value_,
+                   balance(r->left_->right_, r->value_, redden(r->right_)));
+    }
+
+    // 右子树黑高比左边少一
+    static node_ref balright(const node_ref& l, const value_type& value, const node_ref& r) {
+        if(is_red(r)) return red(l, value, blacken(r));
+        if(is_black(l)) return balance(redden(l), value, r);
+        // l为红，l的右孩子为黑
+        return red(balance(redden(l->left_), l->value_, l->right_->left_), l->right_->value_,
+                   black(l->right_->right_, value, r));
+    }
+
+    // 把删除结点的左右子树拼起来，a中的键值都小于b
+    static node_ref app(const node_ref& a, const node_ref& b) {
+        if(!a) return b;
+        if(!b) return a;
+        if(is_red(a) && is_red(b)) {
+            node_ref bc = app(a->right_, b->left_);
+            if(is_red(bc)) {
+                return red(red(a->left_, a->value_, bc->left_), bc->value_, red(bc->right_, b->value_, b->right_));
+            }
+            return red(a->left_, a->value_, red(bc, b->value_, b->right_));
+        }
+        if(is_black(a) && is_black(b)) {
+            node_ref bc = app(a->right_, b->left_);
+            if(is_red(bc)) {
+                return red(black(a->left_, a->value_, bc->left_), bc->value_, black(bc->right_, b->value_, b->right_));
+            }
+            return balleft(a->left_, a->value_, black(bc, b->value_, b->right_));
+        }
+        if(is_red(b)) return red(app(a, b->left_), b->value_, b->right_);
+        return red(a->left_, a->value_, app(a->right_, b));
+    }
+};
+
+template <class Key, class T, class Compare>
+bool operator==(const persistent_map<Key, T, Compare>& lhs, const persistent_map<Key, T, Compare>& rhs) {
+    if(lhs.same_version(rhs)) return true;
+    if(lhs.size() != rhs.size()) return false;
+    for(auto i = lhs.begin(), j = rhs.begin() ; i != lhs.end() ; ++i, ++j) {
+        if(!(i->first == j->first && i->second == j->second)) return false;
+    }
+    return true;
+}
+
+template <class Key, class T, class Compare>
+bool operator!=(const persistent_map<Key, T, Compare>& lhs, const persistent_map<Key, T, Compare>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class Key, class T, class Compare>
+void swap(persistent_map<Key, T, Compare>& lhs, persistent_map<Key, T, Compare>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
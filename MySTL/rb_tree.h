@@ -2,14 +2,26 @@
 #define __RB_TREE_H__
 
 #include <initializer_list>
+#include <iterator>
 #include <cassert>
+#include <cstdint>
+// 集合操作的并行版本需要线程库，默认不编译：定义了MYSTL_RB_TREE_PARALLEL时parallel参数才生效，否则总是顺序执行
+#ifdef MYSTL_RB_TREE_PARALLEL
+#include <future>
+#include <thread>
+#endif
 
+#include "algobase.h"
 #include "functional.h"
 #include "iterator.h"
 #include "memory.h"
 #include "type_traits.h"
 #include "exceptdef.h"
 #include "allocator.h"
+#include "util.h"
+#ifdef MYSTL_RB_TREE_NODE_POOL
+#include "node_pool.h"
+#endif
 
 
 namespace mystl {
@@ -28,17 +40,44 @@ static constexpr rb_tree_color_type rb_tree_black = true;
 template <class T>
 struct rb_tree_node;
 
+// 定义MYSTL_RB_TREE_COMPACT_NODE时，颜色存放在parent_的最低位（结点至少按指针对齐，最低位总是0），
+// 结点基类从32字节缩小到24字节。红色为0，header总是红色，所以header的parent_就是根结点指针，可以直接引用
+// 无论哪种布局，parent和颜色都只能通过下面的访问函数读写
 template <class T>
 struct rb_tree_node_base {
     typedef rb_tree_color_type color_type;
     typedef rb_tree_node_base<T>*   base_ptr;  // node基类指针
     typedef rb_tree_node<T>*        node_ptr;
 
+#ifdef MYSTL_RB_TREE_COMPACT_NODE
+    base_ptr    parent_;    // 父节点 | 结点颜色
+    base_ptr    left_;      // 左子节点
+    base_ptr    right_;     // 右子节点
+
+    base_ptr parent() const {
+        return reinterpret_cast<base_ptr>(reinterpret_cast<uintptr_t>(parent_) & ~uintptr_t(1));
+    }
+    void set_parent(base_ptr p) {
+        parent_ = reinterpret_cast<base_ptr>(reinterpret_cast<uintptr_t>(p) | (reinterpret_cast<uintptr_t>(parent_) & 1));
+    }
+    color_type color() const {
+        return (reinterpret_cast<uintptr_t>(parent_) & 1) != 0;
+    }
+    void set_color(color_type c) {
+        parent_ = reinterpret_cast<base_ptr>((reinterpret_cast<uintptr_t>(parent_) & ~uintptr_t(1)) | uintptr_t(c));
+    }
+#else
     base_ptr    parent_;    // 父节点
     base_ptr    left_;      // 左子节点
     base_ptr    right_;     // 右子节点
     color_type  color_;     // 结点颜色
 
+    base_ptr parent() const { return parent_; }
+    void set_parent(base_ptr p) { parent_ = p; }
+    color_type color() const { return color_; }
+    void set_color(color_type c) { color_ = c; }
+#endif
+
     // 本对象的地址
     base_ptr get_base_ptr() {
         return &*this;
@@ -91,10 +130,10 @@ struct rb_tree_iterator_base {
             }
         }else {
             // 右节点为空，说明当前子树已经被访问完，需要上溯到，node不为右节点为止
-            base_ptr y = node_->parent_;
+            base_ptr y = node_->parent();
             while(node_ == y->right_) {
                 node_ = y;
-                y = y->parent_;
+                y = y->parent();
             }
             
             // 这里是防止node走到header，如果为header返回的就是node本身
@@ -110,7 +149,7 @@ struct rb_tree_iterator_base {
     // 使迭代器后退
     void decrement() {
         // node为header，header为红色的，root为黑色，两者区别在这里，后一个条件都满足
-        if(node_->color_ == rb_tree_red && node_->parent_->parent_ == node_) {
+        if(node_->color() == rb_tree_red && node_->parent()->parent() == node_) {
             node_ = node_->right_;  //head->right连接最大的值
         }else if(node_->left_ != nullptr) {
             // 找左子树的最右节点
@@ -120,10 +159,10 @@ struct rb_tree_iterator_base {
             }
         }else {
             // 非header，也无左结点
-            base_ptr y = node_->parent_;
+            base_ptr y = node_->parent();
             while(node_ == y->left_) {
                 node_ = y;
-                y = y->parent_;
+                y = y->parent();
             }
             node_ = y;  //如果node本身为root，且为最小元素，node就回到了自己
         }
@@ -207,34 +246,34 @@ NodePtr rb_tree_max(NodePtr x) {
 // 判断当前node是否为其parent的左孩子
 template <class NodePtr>
 bool rb_tree_is_lchild(NodePtr node) {
-    return node == node->parent_->left_;
+    return node == node->parent()->left_;
 }
 
 template <class NodePtr>
 bool rb_tree_is_rchild(NodePtr node) {
-    return node == node->parent_->right_;
+    return node == node->parent()->right_;
 }
 
 template <class NodePtr>
 bool rb_tree_is_red(NodePtr node) {
-    return node->color_ == rb_tree_red;
+    return node->color() == rb_tree_red;
 }
 
 template <class NodePtr>
 bool rb_tree_is_black(NodePtr node) {
-    return node->color_ == rb_tree_black;
+    return node->color() == rb_tree_black;
 }
 
 template <class NodePtr>
-void rb_tree_set_black(NodePtr& node) noexcept
+void rb_tree_set_black(NodePtr node) noexcept
 {
-  node->color_ = rb_tree_black;
+  node->set_color(rb_tree_black);
 }
 
 template <class NodePtr>
-void rb_tree_set_red(NodePtr& node) noexcept
+void rb_tree_set_red(NodePtr node) noexcept
 {
-  node->color_ = rb_tree_red;
+  node->set_color(rb_tree_red);
 }
 
 template <class NodePtr>
@@ -244,12 +283,71 @@ NodePtr rb_tree_next(NodePtr node) {
     }
     // 找到第一个作为左孩子的结点
     while(rb_tree_is_rchild(node)) {
-        node = node->parent_;
+        node = node->parent();
     }
-    return node->parent_;
+    return node->parent();
 }
 
 // 这里的例子只是举例左旋而已，并不是真正的平衡
+// 结点增强策略 Augment
+// 可以在每个结点上额外维护一份由子树决定的数据（比如子树大小），策略需要提供：
+//   template <class T> using node_type         结点类型，必须派生自 rb_tree_node<T>
+//   void operator()(base_ptr x) const          孩子的数据正确时，重新计算x的数据
+//   template <class Node> static void copy(Node* dst, const Node* src)  复制结点时拷贝数据
+// 旋转只改变两个结点的子树，插入删除改变一条到根的路径，这些地方都会调用operator()
+
+// 默认策略，不维护任何数据
+struct rb_tree_no_augment {
+    template <class T>
+    using node_type = rb_tree_node<T>;
+
+    template <class NodePtr>
+    void operator()(NodePtr) const {}
+
+    template <class Node>
+    static void copy(Node*, const Node*) {}
+};
+
+// 维护子树大小的策略，提供O(log n)的第k小、排名和迭代器距离
+template <class T>
+struct rb_tree_size_node : public rb_tree_node<T> {
+    size_t size_;   // 以该结点为根的子树的结点数
+};
+
+struct rb_tree_size_augment {
+    template <class T>
+    using node_type = rb_tree_size_node<T>;
+
+    template <class T>
+    static size_t size(rb_tree_node_base<T>* x) {
+        return x == nullptr ? 0 : static_cast<rb_tree_size_node<T>*>(x)->size_;
+    }
+
+    template <class T>
+    void operator()(rb_tree_node_base<T>* x) const {
+        static_cast<rb_tree_size_node<T>*>(x)->size_ = 1 + size(x->left_) + size(x->right_);
+    }
+
+    template <class Node>
+    static void copy(Node* dst, const Node* src) {
+        dst->size_ = src->size_;
+    }
+};
+
+// 从x开始向上更新到根节点
+template <class NodePtr, class Augment>
+void rb_tree_update_path(NodePtr x, NodePtr root, Augment update) {
+    while(true) {
+        update(x);
+        if(x == root) break;
+        x = x->parent();
+    }
+}
+
+// 默认策略什么都不用做，连路径也不用走
+template <class NodePtr>
+void rb_tree_update_path(NodePtr, NodePtr, rb_tree_no_augment) {}
+
 /*---------------------------------------*\
 |       p                         p       |
 |      / \                       / \      |
@@ -261,15 +359,15 @@ NodePtr rb_tree_next(NodePtr node) {
 \*---------------------------------------*/
 
 // 左旋红黑树，参数一为左旋点，参数二为根节点。x为要左旋的子树根节点，root为整个红黑树的root
-template <class NodePtr>
-void rb_tree_rotate_left(NodePtr x, NodePtr& root) {    // root为指针引用是可能要动root的值
+template <class NodePtr, class Augment>
+void rb_tree_rotate_left(NodePtr x, NodePtr& root, Augment update) {    // root为指针引用是可能要动root的值
     NodePtr y = x->right_;  // y为x的右子节点
     x->right_ = y->left_;
     if(y->left_ != nullptr) {
         // 如果为空，就不用设置左孩子的parent了
-        y->left_->parent_ = x;
+        y->left_->set_parent(x);
     }
-    y->parent_ = x->parent_;    // 把y的parent指向p
+    y->set_parent(x->parent());    // 把y的parent指向p
 
     // 令y完全顶替x的地位
     if(x == root) {
@@ -277,14 +375,23 @@ void rb_tree_rotate_left(NodePtr x, NodePtr& root) {    // root为指针引用
         root = y;
     }else if(rb_tree_is_lchild(x)) {
         // x为左孩子
-        x->parent_->left_ = y;  // 将p的left连接到y，至此p的连接已经完成
+        x->parent()->left_ = y;  // 将p的left连接到y，至此p的连接已经完成
     }else {
-        x->parent_->right_ = y;
+        x->parent()->right_ = y;
     }
 
     // 调整x和y的关系
     y->left_ = x;
-    x->parent_ = y;
+    x->set_parent(y);
+
+    // x成为y的孩子，先更新x
+    update(x);
+    update(y);
+}
+
+template <class NodePtr>
+void rb_tree_rotate_left(NodePtr x, NodePtr& root) {
+    rb_tree_rotate_left(x, root, rb_tree_no_augment());
 }
 
 
@@ -297,26 +404,34 @@ void rb_tree_rotate_left(NodePtr x, NodePtr& root) {    // root为指针引用
 |    / \                           / \     |
 |   b   c                         c   a    |
 \*----------------------------------------*/
-template <class NodePtr>
-void rb_tree_rotate_right(NodePtr x, NodePtr& root) {
+template <class NodePtr, class Augment>
+void rb_tree_rotate_right(NodePtr x, NodePtr& root, Augment update) {
     NodePtr y = x->left_;
     x->left_ = y->right_;
     if(y->right_ != nullptr) {
-        y->right_->parent_ = x;
+        y->right_->set_parent(x);
     }
-    y->parent_ = x->parent_;
+    y->set_parent(x->parent());
 
     if(x == root) {
         root = y;
     }else if(rb_tree_is_lchild(x)) {
-        x->parent_->left_ = y;
+        x->parent()->left_ = y;
     }else {
-        x->parent_->right_ = y;
+        x->parent()->right_ = y;
     }
 
     // 调整x和y
     y->right_ = x;
-    x->parent_ = y;
+    x->set_parent(y);
+
+    update(x);
+    update(y);
+}
+
+template <class NodePtr>
+void rb_tree_rotate_right(NodePtr x, NodePtr& root) {
+    rb_tree_rotate_right(x, root, rb_tree_no_augment());
 }
 
 
@@ -334,91 +449,102 @@ void rb_tree_rotate_right(NodePtr x, NodePtr& root) {
 // case5 : 父节点为红，叔叔节点为nullptr或者黑色，父节点为左(右孩子)，当前结点为左(右)孩子，
 //         do: 让父节点变为黑色，祖父结点变为红色，以祖父结点为支点右(左)旋。
 
-template <class NodePtr>
-void rb_tree_insert_rebalance(NodePtr x, NodePtr& root) {
+// 返回值表示整棵树的黑高是否加了一（红色一直传到根，根重新涂黑）
+template <class NodePtr, class Augment>
+bool rb_tree_insert_rebalance(NodePtr x, NodePtr& root, Augment update) {
+    // 新结点到根的路径上每个子树都多了一个结点，先更新，之后的旋转各自维护
+    rb_tree_update_path(x, root, update);
     rb_tree_set_red(x);     //新增结点一定是红色
 
     // 如果当前结点为根，或者父节点为黑色，直接结束即可，把root设置为黑
     // 这个循环主要是case3 --> case5 的过程
-    while(x != root && rb_tree_is_red(x->parent_)) {
-        if(rb_tree_is_lchild(x->parent_)) {
+    while(x != root && rb_tree_is_red(x->parent())) {
+        if(rb_tree_is_lchild(x->parent())) {
             // 父节点是左子节点
-            NodePtr uncle = x->parent_->parent_->right_;
+            NodePtr uncle = x->parent()->parent()->right_;
             if(uncle && rb_tree_is_red(uncle)) {
                 // case3 : 父节点和叔叔节点都为红，父节点为左孩子
-                rb_tree_set_black(x->parent_);  // 父节点和叔叔节点涂黑
+                rb_tree_set_black(x->parent());  // 父节点和叔叔节点涂黑
                 rb_tree_set_black(uncle);
-                x = x->parent_->parent_;
+                x = x->parent()->parent();
                 rb_tree_set_red(x);     // 祖父涂红
             }else {
                 // 无叔叔节点或者叔叔节点为黑，case4 和 case5，区分两者的条件则是先后顺序，一定会先case4再case5
                 if(rb_tree_is_rchild(x)) {
                     // case4 当前结点为右孩子
-                    x = x->parent_;
-                    rb_tree_rotate_left(x, root);
+                    x = x->parent();
+                    rb_tree_rotate_left(x, root, update);
                 }
                 // case5, 都转化为了case5,当前结点为左孩子
-                rb_tree_set_black(x->parent_);
-                rb_tree_set_red(x->parent_->parent_);
-                rb_tree_rotate_right(x->parent_->parent_, root);
+                rb_tree_set_black(x->parent());
+                rb_tree_set_red(x->parent()->parent());
+                rb_tree_rotate_right(x->parent()->parent(), root, update);
                 
                 break;  //结束状态转移
             }
         }
         else {
             // 父节点是右子节点，对称处理
-            NodePtr uncle = x->parent_->parent_->left_;
+            NodePtr uncle = x->parent()->parent()->left_;
             if(uncle && rb_tree_is_red(uncle)) {
                 // case3, 父节点和叔叔节点都为红
-                rb_tree_set_black(x->parent_);
+                rb_tree_set_black(x->parent());
                 rb_tree_set_black(uncle);
-                x = x->parent_->parent_;
+                x = x->parent()->parent();
                 rb_tree_set_red(x);
             }else {
                 if(rb_tree_is_lchild(x)) {
                     // case4 : 当前为左孩子
-                    x = x->parent_;
-                    rb_tree_rotate_right(x, root);
+                    x = x->parent();
+                    rb_tree_rotate_right(x, root, update);
                 }
                 // case5, 当前结点为右子节点
-                rb_tree_set_black(x->parent_);
-                rb_tree_set_red(x->parent_->parent_);
-                rb_tree_rotate_left(x->parent_->parent_, root);
+                rb_tree_set_black(x->parent());
+                rb_tree_set_red(x->parent()->parent());
+                rb_tree_rotate_left(x->parent()->parent(), root, update);
                 break;
             }
         }
     }
     rb_tree_set_black(root);
+    return x == root;
+}
+
+template <class NodePtr>
+bool rb_tree_insert_rebalance(NodePtr x, NodePtr& root) {
+    return rb_tree_insert_rebalance(x, root, rb_tree_no_augment());
 }
 
 // rb_tree_erase_rebalance
 // 删除节点后使 rb tree 重新平衡，参数一为要删除的节点，参数二为根节点，参数三为最小节点，参数四为最大节点
-template <class NodePtr>
-NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, NodePtr& rightmost) {
+template <class NodePtr, class Augment>
+NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, NodePtr& rightmost, Augment update) {
     // y 是可能的替换节点，指向最终要删除的节点
   auto y = (z->left_ == nullptr || z->right_ == nullptr) ? z : rb_tree_next(z);
   // x 是 y 的一个独子节点或 NIL 节点
   auto x = y->left_ != nullptr ? y->left_ : y->right_;
   // xp 为 x 的父节点
   NodePtr xp = nullptr;
+  // 删除的是没有孩子或只有一个孩子的根节点时，xp为header，不用更新
+  const bool xp_is_header = (y == z && root == z);
 
   // y != z 说明 z 有两个非空子节点，此时 y 指向 z 右子树的最左节点，x 指向 y 的右子节点。
   // 用 y 顶替 z 的位置，用 x 顶替 y 的位置，最后用 y 指向 z
   if (y != z)
   {
-    z->left_->parent_ = y;
+    z->left_->set_parent(y);
     y->left_ = z->left_;
 
     // 如果 y 不是 z 的右子节点，那么 z 的右子节点一定有左孩子
     if (y != z->right_)
     { // x 替换 y 的位置
-      xp = y->parent_;
+      xp = y->parent();
       if (x != nullptr)
-        x->parent_ = y->parent_;
+        x->set_parent(y->parent());
 
-      y->parent_->left_ = x;
+      y->parent()->left_ = x;
       y->right_ = z->right_;
-      z->right_->parent_ = y;
+      z->right_->set_parent(y);
     }
     else
     {
@@ -429,27 +555,29 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
     if (root == z)
       root = y;
     else if (rb_tree_is_lchild(z))
-      z->parent_->left_ = y;
+      z->parent()->left_ = y;
     else
-      z->parent_->right_ = y;
-    y->parent_ = z->parent_;
-    mystl::swap(y->color_, z->color_);
+      z->parent()->right_ = y;
+    y->set_parent(z->parent());
+    auto color = y->color();
+    y->set_color(z->color());
+    z->set_color(color);
     y = z;
   }
   // y == z 说明 z 至多只有一个孩子
   else
   { 
-    xp = y->parent_;
+    xp = y->parent();
     if (x)  
-      x->parent_ = y->parent_;
+      x->set_parent(y->parent());
 
     // 连接 x 与 z 的父节点
     if (root == z)
       root = x;
     else if (rb_tree_is_lchild(z))
-      z->parent_->left_ = x;
+      z->parent()->left_ = x;
     else
-      z->parent_->right_ = x;
+      z->parent()->right_ = x;
 
     // 此时 z 有可能是最左节点或最右节点，更新数据
     if (leftmost == z)
@@ -458,6 +586,10 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
       rightmost = x == nullptr ? xp : rb_tree_max(x);
   }
 
+  // 结构已经调整完，xp 到根的路径上子树都少了一个结点
+  if (!xp_is_header)
+    rb_tree_update_path(xp, root, update);
+
   // 此时，y 指向要删除的节点，x 为替代节点，从 x 节点开始调整。
   // 如果删除的节点为红色，树的性质没有被破坏，否则按照以下情况调整（x 为左子节点为例）：
   // case 1: 兄弟节点为红色，令父节点为红，兄弟节点为黑，进行左（右）旋，继续处理
@@ -477,7 +609,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         { // case 1
           rb_tree_set_black(brother);
           rb_tree_set_red(xp);
-          rb_tree_rotate_left(xp, root);
+          rb_tree_rotate_left(xp, root, update);
           brother = xp->right_;
         }
         // case 1 转为为了 case 2、3、4 中的一种
@@ -486,7 +618,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         { // case 2
           rb_tree_set_red(brother);
           x = xp;
-          xp = xp->parent_;
+          xp = xp->parent();
         }
         else
         { 
@@ -495,15 +627,15 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
             if (brother->left_ != nullptr)
               rb_tree_set_black(brother->left_);
             rb_tree_set_red(brother);
-            rb_tree_rotate_right(brother, root);
+            rb_tree_rotate_right(brother, root, update);
             brother = xp->right_;
           }
           // 转为 case 4
-          brother->color_ = xp->color_;
+          brother->set_color(xp->color());
           rb_tree_set_black(xp);
           if (brother->right_ != nullptr)  
             rb_tree_set_black(brother->right_);
-          rb_tree_rotate_left(xp, root);
+          rb_tree_rotate_left(xp, root, update);
           break;
         }
       }
@@ -514,7 +646,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         { // case 1
           rb_tree_set_black(brother);
           rb_tree_set_red(xp);
-          rb_tree_rotate_right(xp, root);
+          rb_tree_rotate_right(xp, root, update);
           brother = xp->left_;
         }
         if ((brother->left_ == nullptr || !rb_tree_is_red(brother->left_)) &&
@@ -522,7 +654,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         { // case 2
           rb_tree_set_red(brother);
           x = xp;
-          xp = xp->parent_;
+          xp = xp->parent();
         }
         else
         {
@@ -531,15 +663,15 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
             if (brother->right_ != nullptr)
               rb_tree_set_black(brother->right_);
             rb_tree_set_red(brother);
-            rb_tree_rotate_left(brother, root);
+            rb_tree_rotate_left(brother, root, update);
             brother = xp->left_;
           }
           // 转为 case 4
-          brother->color_ = xp->color_;
+          brother->set_color(xp->color());
           rb_tree_set_black(xp);
           if (brother->left_ != nullptr)  
             rb_tree_set_black(brother->left_);
-          rb_tree_rotate_right(xp, root);
+          rb_tree_rotate_right(xp, root, update);
           break;
         }
       }
@@ -550,16 +682,113 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
   return y;
 }
 
+template <class NodePtr>
+NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, NodePtr& rightmost) {
+    return rb_tree_erase_rebalance(z, root, leftmost, rightmost, rb_tree_no_augment());
+}
+
+
+// 结点的分配器。定义MYSTL_RB_TREE_NODE_POOL时从按线程缓存的结点池分配（见node_pool.h），
+// 拷贝整棵树时一次申请所有结点，clear时把所有结点串起来一次还给池
+#ifdef MYSTL_RB_TREE_NODE_POOL
+template <class Node>
+using rb_tree_node_allocator = mystl::pool_allocator<Node>;
+#else
+template <class Node>
+using rb_tree_node_allocator = mystl::allocator<Node>;
+#endif
+
+// rb_tree_node_handle
+// 持有一个从树中摘下来的结点，只能移动不能拷贝。结点可以原样插入另一棵树，不用重新分配内存和拷贝元素
+// 析构时如果还持有结点，就销毁它
+template <class T, class Node = rb_tree_node<T>>
+class rb_tree_node_handle {
+public:
+    typedef T                       value_type;
+    typedef Node*                   node_ptr;
+    typedef rb_tree_node_allocator<Node>  node_allocator;
+
+    rb_tree_node_handle() noexcept : node_(nullptr) {}
+
+    rb_tree_node_handle(const rb_tree_node_handle&) = delete;
+    rb_tree_node_handle& operator=(const rb_tree_node_handle&) = delete;
+
+    rb_tree_node_handle(rb_tree_node_handle&& rhs) noexcept : node_(rhs.node_) {
+        rhs.node_ = nullptr;
+    }
+
+    rb_tree_node_handle& operator=(rb_tree_node_handle&& rhs) noexcept {
+        if(this != &rhs) {
+            destroy();
+            node_ = rhs.node_;
+            rhs.node_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~rb_tree_node_handle() { destroy(); }
+
+    bool empty() const noexcept { return node_ == nullptr; }
+    explicit operator bool() const noexcept { return node_ != nullptr; }
+
+    // 结点在句柄中时，可以修改键值，再插入回树中
+    value_type& value() const {
+        MYSTL_DEBUG(!empty());
+        return node_->value_;
+    }
+
+    void swap(rb_tree_node_handle& rhs) noexcept {
+        mystl::swap(node_, rhs.node_);
+    }
+
+private:
+    template <class, class, class, class, class> friend class rb_tree;
+
+    explicit rb_tree_node_handle(node_ptr node) noexcept : node_(node) {}
+
+    // 交出结点的所有权
+    node_ptr release() noexcept {
+        node_ptr tmp = node_;
+        node_ = nullptr;
+        return tmp;
+    }
+
+    void destroy() {
+        if(node_ != nullptr) {
+            mystl::destroy(&node_->value_);
+            node_allocator::deallocate(node_);
+            node_ = nullptr;
+        }
+    }
+
+private:
+    node_ptr node_;
+};
+
+// 插入node handle的返回值，插入失败时node仍然持有原来的结点，position指向已有的重复元素
+template <class Iterator, class NodeHandle>
+struct rb_tree_insert_return {
+    Iterator    position;
+    bool        inserted;
+    NodeHandle  node;
+};
 
 // 红黑树Compare为键值比较函数，默认为less，最好自己传入比较key方法的函数
-template <class Key, class T, class Compare = mystl::less<Key>, class KeyofValue = mystl::identity<T>>
+// Augment为结点增强策略，默认不维护额外数据
+// 集合操作中两边都至少有这么多元素时，才考虑并行
+#ifndef MYSTL_RB_TREE_PARALLEL_CUTOFF
+#define MYSTL_RB_TREE_PARALLEL_CUTOFF 65536
+#endif
+
+template <class Key, class T, class Compare = mystl::less<Key>, class KeyofValue = mystl::identity<T>,
+          class Augment = rb_tree_no_augment>
 class rb_tree {
 public:
     // typedef
     typedef rb_tree_node_base<T>  base_type;
     typedef rb_tree_node_base<T>* base_ptr;
-    typedef rb_tree_node<T>*      node_ptr;
-    typedef rb_tree_node<T>       node_type;
+    typedef typename Augment::template node_type<T>  node_type;
+    typedef node_type*                                node_ptr;
     
     typedef T                   value_type;
     typedef Key                 key_type;       // 将返回值类型定义为key       
@@ -568,7 +797,7 @@ public:
     typedef mystl::allocator<T>         allocator_type;
     typedef mystl::allocator<T>         data_allocator;
     typedef mystl::allocator<base_type> base_allocator;
-    typedef mystl::allocator<node_type> node_allocator;
+    typedef rb_tree_node_allocator<node_type> node_allocator;
 
     typedef T*          pointer;
     typedef const T*    const_pointer;
@@ -582,7 +811,10 @@ public:
     typedef mystl::reverse_iterator<iterator>       reverse_iterator;
     typedef mystl::reverse_iterator<const_iterator> const_reverse_iterator;
 
-    allocator_type get_allocator() const { return node_allocator(); }
+    typedef rb_tree_node_handle<T, node_type>                   node_handle;
+    typedef rb_tree_insert_return<iterator, node_handle>        insert_return_type;
+
+    allocator_type get_allocator() const { return allocator_type(); }
     key_compare    key_comp()      const { return key_comp_; }
 
 private:
@@ -593,7 +825,7 @@ private:
 
 private:
     // 以下三个函数返回root，最小值结点和最大值结点的引用
-    base_ptr& root()        const { return header_->parent_; }
+    base_ptr& root()        const { return header_->parent_; }     // header为红色，紧凑布局下也是干净的指针
     base_ptr& leftmost()    const { return header_->left_; }
     base_ptr& rightmost()   const { return header_->right_; }
 
@@ -606,7 +838,10 @@ public:
     rb_tree& operator=(const rb_tree& rhs);
     rb_tree& operator=(rb_tree&& rhs);
 
-    ~rb_tree() { clear(); }
+    ~rb_tree() {
+        clear();
+        if(header_ != nullptr) node_allocator::deallocate(static_cast<node_ptr>(header_));
+    }
 
 public:
     iterator begin() { return leftmost(); }     // 隐式转化
@@ -639,26 +874,84 @@ public:
     iterator insert_unique(iterator pos, const value_type& value);
     iterator insert_equal(iterator pos, const value_type& value);
 
+    // 区间插入：空树且输入已经有序时，直接O(n)建树；否则每个元素都以end()为提示插入，
+    // 输入基本有序时大部分元素只需要和rightmost比较一次，不用从根结点查找
     template <class Iterator>
     void insert_unique(Iterator first, Iterator last) {
-        for(; first != last ; ++first) {
-            insert_unique(*first);
-        }
+        insert_range(first, last, true, range_category(first));
     }
 
     template <class Iterator>
     void insert_equal(Iterator first, Iterator last) {
-        for(; first != last ; ++first) {
-            insert_equal(*first);
-        }
+        insert_range(first, last, false, range_category(first));
+    }
+
+    // 调用者保证区间有序（unique要求严格递增），不再检查
+    template <class Iterator>
+    void insert_unique(sorted_unique_t, Iterator first, Iterator last) {
+        insert_sorted(first, last, true, range_category(first));
+    }
+
+    template <class Iterator>
+    void insert_equal(sorted_equivalent_t, Iterator first, Iterator last) {
+        insert_sorted(first, last, false, range_category(first));
+    }
+
+
+    // node handle
+    // extract把结点从树中摘下来交给node_handle，不释放结点；insert把node_handle中的结点直接链接进树
+    node_handle extract(iterator pos);
+    node_handle extract(const key_type& key) {
+        iterator it = find(key);
+        return it == end() ? node_handle() : extract(it);
     }
 
+    insert_return_type insert_unique(node_handle&& nh);
+    iterator insert_equal(node_handle&& nh);
+
+    // 把other中的结点移动到本树，merge_unique时本树中已有的键值留在other中
+    void merge_unique(rb_tree& other);
+    void merge_equal(rb_tree& other);
+
+    // 基于join的集合操作，要求键值唯一（set/map），都不分配新结点
+    // join    : other的键值都大于本树，把other接到本树后面，other变空，O(log n)
+    // split   : 把键值不小于key的元素移到right（right原有元素被清除），O(log n)。
+    //           两边的元素个数：Augment维护子树大小时直接读根结点；否则由调用者传入right_count，
+    //           不传时只能两边同时往后数，代价为O(较小一边的元素个数)
+    // union_with/intersect_with/difference_with : 本树变为并、交、差集，m为较小一方的大小，
+    //           O(m log(n/m + 1))，大集合合并小集合时只访问O(m log n)个结点。
+    //           union_with(rb_tree&)移动other的结点，other变空，键值重复时保留本树的元素；
+    //           intersect_with/difference_with只读other，释放本树中被去掉的结点。
+    //           定义了MYSTL_RB_TREE_PARALLEL、parallel为true且两边都足够大时，左右子问题用std::async并行
+    void join(rb_tree& other);
+    void split(const key_type& key, rb_tree& right);
+    void split(const key_type& key, rb_tree& right, size_type right_count);
+    void union_with(rb_tree& other, bool parallel = false);
+    void union_with(const rb_tree& other, bool parallel = false) {
+        if(this == &other) return;
+        rb_tree tmp(other);     // 先复制，合并过程中不再分配，异常安全
+        union_with(tmp, parallel);
+    }
+    void intersect_with(const rb_tree& other, bool parallel = false);
+    void difference_with(const rb_tree& other, bool parallel = false);
 
     // erase
     iterator erase(iterator pos);
-    size_type erase(const key_type& key);   //返回删除的数量
+    size_type erase(const key_type& key) { return erase_key(key); }   //返回删除的数量
     void erase(iterator first, iterator last);
 
+    // 异构查找：Compare定义了is_transparent时，下面的查找和删除还接受任意能和key比较的类型K，
+    // 比如set<std::string, less<>>直接用const char*查找，不构造临时的key。
+    // 参数正好是key_type时仍然匹配非模板的版本；erase的K不能是迭代器，以免抢了erase(pos)
+    template <class K>
+    using if_transparent = enable_if_transparent_t<Compare, K>;
+    template <class K>
+    using if_transparent_key = typename std::enable_if<!std::is_convertible<K, iterator>::value &&
+                                                       !std::is_convertible<K, const_iterator>::value,
+                                                       if_transparent<K>>::type;
+
+    template <class K, class = if_transparent_key<K>>
+    size_type erase(const K& key) { return erase_key(key); }
 
     // clear
     void clear();
@@ -666,17 +959,32 @@ public:
     // rb_tree 独有的操作
 
     // find 如果有key重复，返回首先入红黑树的，也就是第一个重复元素
-    iterator find (const key_type& key);
-    const_iterator find(const key_type& key) const;
-
-    size_type count(const key_type& key) const; // 返回key的元素的数量
+    iterator find(const key_type& key) { return iterator(find_node(key)); }
+    const_iterator find(const key_type& key) const { return const_iterator(find_node(key)); }
+    template <class K, class = if_transparent<K>>
+    iterator find(const K& key) { return iterator(find_node(key)); }
+    template <class K, class = if_transparent<K>>
+    const_iterator find(const K& key) const { return const_iterator(find_node(key)); }
+
+    // 返回key的元素的数量
+    size_type count(const key_type& key) const { return count_key(key); }
+    template <class K, class = if_transparent<K>>
+    size_type count(const K& key) const { return count_key(key); }
 
     // 二分查找，同全局的算法库结果一样
-    iterator lower_bound(const key_type& key);
-    const_iterator lower_bound(const key_type& key) const;
-
-    iterator upper_bound(const key_type& key);
-    const_iterator upper_bound(const key_type& key) const;
+    iterator lower_bound(const key_type& key) { return iterator(lower_bound_node(key)); }
+    const_iterator lower_bound(const key_type& key) const { return const_iterator(lower_bound_node(key)); }
+    template <class K, class = if_transparent<K>>
+    iterator lower_bound(const K& key) { return iterator(lower_bound_node(key)); }
+    template <class K, class = if_transparent<K>>
+    const_iterator lower_bound(const K& key) const { return const_iterator(lower_bound_node(key)); }
+
+    iterator upper_bound(const key_type& key) { return iterator(upper_bound_node(key)); }
+    const_iterator upper_bound(const key_type& key) const { return const_iterator(upper_bound_node(key)); }
+    template <class K, class = if_transparent<K>>
+    iterator upper_bound(const K& key) { return iterator(upper_bound_node(key)); }
+    template <class K, class = if_transparent<K>>
+    const_iterator upper_bound(const K& key) const { return const_iterator(upper_bound_node(key)); }
 
     // 返回key值的范围，[first, last)区间
     mystl::pair<iterator,iterator> equal_range(const key_type& x) {
@@ -685,6 +993,32 @@ public:
     mystl::pair<const_iterator, const_iterator> equal_range(const key_type& x) const {
         return mystl::pair<const_iterator, const_iterator>(lower_bound(x), upper_bound(x));
     }
+    template <class K, class = if_transparent<K>>
+    mystl::pair<iterator,iterator> equal_range(const K& x) {
+        return mystl::pair<iterator,iterator>(lower_bound(x), upper_bound(x));
+    }
+    template <class K, class = if_transparent<K>>
+    mystl::pair<const_iterator, const_iterator> equal_range(const K& x) const {
+        return mystl::pair<const_iterator, const_iterator>(lower_bound(x), upper_bound(x));
+    }
+
+    // order statistic，要求Augment维护子树大小（rb_tree_size_augment），都是O(log n)
+    // nth返回第k个元素（从0开始），k >= size()时返回end()
+    iterator nth(size_type k) const;
+    // 小于key的元素个数
+    size_type rank(const key_type& key) const;
+    // pos之前的元素个数，end()返回size()
+    size_type index_of(const_iterator pos) const;
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return static_cast<difference_type>(index_of(last)) - static_cast<difference_type>(index_of(first));
+    }
+
+    // 供其他增强策略做剪枝查询（比如interval_map的重叠查询），按中序访问结点，参数都是node_ptr
+    // descend(x)为false时跳过以x为根的整棵子树，visit(x)返回false时结束整个遍历
+    template <class Descend, class Visit>
+    void visit_pruned(Descend descend, Visit visit) const {
+        visit_pruned_aux(root(), descend, visit);
+    }
 
     // swap
     void swap(rb_tree& rhs) {
@@ -698,6 +1032,24 @@ public:
 private:
     // helper func
 
+    // 查找的实现，K为key_type或者透明比较时的任意类型。没找到时find_node返回header_
+    template <class K>
+    base_ptr lower_bound_node(const K& key) const;
+    template <class K>
+    base_ptr upper_bound_node(const K& key) const;
+    template <class K>
+    base_ptr find_node(const K& key) const {
+        base_ptr y = lower_bound_node(key);
+        return (y == header_ || key_comp_(key, KeyofValue()(y->get_node_ptr()->value_))) ? header_ : y;
+    }
+    template <class K>
+    size_type count_key(const K& key) const {
+        auto p = equal_range(key);
+        return mystl::distance(p.first, p.second);
+    }
+    template <class K>
+    size_type erase_key(const K& key);
+
     // 初始化
     void rb_tree_init();    
     void reset() {
@@ -717,13 +1069,23 @@ private:
         return tmp;
     }
 
+    // 为接下来的n次create_node预留内存，使用结点池时一次申请一整块
+    static void reserve_nodes(size_type n) {
+#ifdef MYSTL_RB_TREE_NODE_POOL
+        node_allocator::reserve(n);
+#else
+        (void)n;
+#endif
+    }
+
     // 仅仅clone颜色和value
     node_ptr clone_node(node_ptr p) {
         node_ptr node = create_node(p->value_);
-        node->color_ = p->color_;
+        node->set_color(p->color());
+        Augment::copy(node, p);
         node->left_ = nullptr;
         node->right_ = nullptr;
-        node->parent_ = nullptr;
+        node->set_parent(nullptr);
         return node;
     }
 
@@ -733,33 +1095,269 @@ private:
     }
 
     // 在x出插入value，y为x的父节点
-    iterator insert_aux(base_ptr x, base_ptr y, const value_type& value);
+    iterator insert_aux(base_ptr x, base_ptr y, const value_type& value) {
+        return link_node(x, y, create_node(value));
+    }
+
+    // 把已经构造好的结点z连接为y的孩子并平衡，x非空或者z的键值小于y时连在左边
+    iterator link_node(base_ptr x, base_ptr y, node_ptr z);
+
+    // 查找插入位置，返回插入位置的父节点。unique时second为false表示已有重复元素，first为该元素
+    mystl::pair<base_ptr, bool> get_insert_unique_pos(const key_type& key);
+    base_ptr get_insert_equal_pos(const key_type& key);
 
     // copy / erase tree
 
     node_ptr copy_from(node_ptr x, node_ptr p);
-    node_ptr copy_from1(node_ptr x, node_ptr p);
 
     // 以x为根，递归删除结点
     void erase_since(base_ptr x);
+
+    // 区间插入相关
+    // std的迭代器标签不在mystl的继承体系里，单独判断std::forward_iterator_tag，其余当作input迭代器处理
+    template <class Iterator>
+    static typename std::conditional<
+        std::is_convertible<typename iterator_traits<Iterator>::iterator_category, forward_iterator_tag>::value ||
+        std::is_convertible<typename iterator_traits<Iterator>::iterator_category, std::forward_iterator_tag>::value,
+        forward_iterator_tag, input_iterator_tag>::type
+    range_category(const Iterator&) {
+        return {};
+    }
+
+    template <class Iterator>
+    void insert_range(Iterator first, Iterator last, bool unique, input_iterator_tag) {
+        insert_hint_end(first, last, unique);
+    }
+
+    template <class Iterator>
+    void insert_range(Iterator first, Iterator last, bool unique, forward_iterator_tag);
+
+    // 已知有序的区间：input迭代器只能走一遍，逐个插入；forward迭代器在空树时先数出个数再直接建树
+    template <class Iterator>
+    void insert_sorted(Iterator first, Iterator last, bool unique, input_iterator_tag) {
+        insert_hint_end(first, last, unique);
+    }
+
+    template <class Iterator>
+    void insert_sorted(Iterator first, Iterator last, bool unique, forward_iterator_tag) {
+        if(!empty()) {
+            insert_hint_end(first, last, unique);
+            return;
+        }
+        size_type n = 0;
+        for(Iterator it = first ; it != last ; ++it) ++n;
+        build_from_sorted(first, n);
+    }
+
+    template <class Iterator>
+    void insert_hint_end(Iterator first, Iterator last, bool unique) {
+        for(; first != last ; ++first) {
+            if(unique) insert_unique(end(), *first);
+            else       insert_equal(end(), *first);
+        }
+    }
+
+    // 由有序区间[first, first + n)直接建一棵平衡的红黑树，树必须为空
+    template <class Iterator>
+    void build_from_sorted(Iterator first, size_type n);
+
+    template <class Iterator>
+    base_ptr build_subtree(Iterator& first, size_type n, int level, int red_level);
+
+    template <class Descend, class Visit>
+    bool visit_pruned_aux(base_ptr x, Descend& descend, Visit& visit) const {
+        if(x == nullptr || !descend(static_cast<node_ptr>(x))) return true;
+        return visit_pruned_aux(x->left_, descend, visit)
+               && visit(static_cast<node_ptr>(x))
+               && visit_pruned_aux(x->right_, descend, visit);
+    }
+
+    // join/split相关，操作的都是脱离header的子树：根为黑色，根的parent_为nullptr
+    const key_type& key_of(base_ptr x) const { return KeyofValue()(static_cast<node_ptr>(x)->value_); }
+    // 黑高按根到叶子路径上的黑结点数计，包括根
+    static int black_height(base_ptr x) {
+        int h = 0;
+        for(; x != nullptr ; x = x->left_) h += rb_tree_is_black(x);
+        return h;
+    }
+    static base_ptr detach_root(base_ptr x) {
+        if(x != nullptr) {
+            x->set_parent(nullptr);
+            rb_tree_set_black(x);
+        }
+        return x;
+    }
+    // 摘下黑高为h的黑结点的孩子，红孩子涂黑后黑高加一
+    static base_ptr detach_child(base_ptr c, int h, int& ch) {
+        ch = h - 1 + (c != nullptr && rb_tree_is_red(c));
+        return detach_root(c);
+    }
+    // 把子树挂到本树的header上，重新设置最小最大结点和元素个数
+    void attach_root(base_ptr t, size_type n);
+
+    // Augment是否维护子树大小
+    template <class A, class = void>
+    struct has_subtree_size : std::false_type {};
+    template <class A>
+    struct has_subtree_size<A, decltype(void(A::size(base_ptr())))> : std::true_type {};
+
+    // split拆完、两边都接好以后，修正两边的元素个数
+    void split_count(rb_tree& right, size_type n, std::true_type) {
+        node_count_ = Augment::size(root());
+        right.node_count_ = n - node_count_;
+    }
+    void split_count(rb_tree& right, size_type n, std::false_type);
+    void split_detach(const key_type& key, rb_tree& right);
+
+    // 下面的函数都带着子树的黑高（hl、hr等），结果的黑高由h返回，join时不用再从头数
+    // l中的键值 < k < r中的键值，返回合并后的子树
+    static base_ptr join_aux(base_ptr l, int hl, base_ptr k, base_ptr r, int hr, int& h);
+    // 没有中间结点时，先从l中取出最大结点
+    static base_ptr join2(base_ptr l, int hl, base_ptr r, int hr, int& h);
+    static base_ptr split_last(base_ptr x, int hx, base_ptr& last, int& h);
+    // 按key把子树x分成 l（小于key）、m（等于key的结点或nullptr）、r（大于key）
+    void split_aux(base_ptr x, int hx, const key_type& key,
+                   base_ptr& l, int& hl, base_ptr& m, base_ptr& r, int& hr) const;
+
+    // t1是本树的子树，union_aux中t2的结点也被接管，intersect_aux和difference_aux中t2只读
+    base_ptr union_aux(base_ptr t1, int h1, base_ptr t2, int h2, int& h, size_type& removed, int depth);
+    base_ptr intersect_aux(base_ptr t1, int h1, base_ptr t2, int& h, size_type& removed, int depth);
+    base_ptr difference_aux(base_ptr t1, int h1, base_ptr t2, int& h, size_type& removed, int depth);
+    size_type erase_count(base_ptr x);
+
+    // depth > 0时左边的子问题交给另一个线程，线程起不来就顺序执行
+    template <class F1, class F2>
+    static void fork_join(int depth, F1 left, F2 right) {
+#ifdef MYSTL_RB_TREE_PARALLEL
+        if(depth > 0) {
+            std::future<void> fut;
+            try {
+                fut = std::async(std::launch::async, left);
+            }catch(...) {
+                left();
+                right();
+                return;
+            }
+            right();
+            fut.get();
+            return;
+        }
+#endif
+        left();
+        right();
+    }
+    static int parallel_depth(bool parallel, size_type n, size_type m) {
+        int depth = 0;
+#ifdef MYSTL_RB_TREE_PARALLEL
+        if(!parallel || n < MYSTL_RB_TREE_PARALLEL_CUTOFF || m < MYSTL_RB_TREE_PARALLEL_CUTOFF) return 0;
+        for(unsigned t = std::thread::hardware_concurrency() ; t > 1 ; t >>= 1) ++depth;
+#endif
+        return depth;
+    }
 };
 
+// 空树时先扫描一遍检查是否有序，有序则直接建树，扫描的代价远小于逐个插入
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+template <class Iterator>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::insert_range(Iterator first, Iterator last, bool unique, forward_iterator_tag) {
+    if(!empty() || first == last) {
+        insert_hint_end(first, last, unique);
+        return;
+    }
+    size_type n = 1;
+    Iterator prev = first;
+    Iterator cur = first;
+    for(++cur ; cur != last ; ++cur, ++prev, ++n) {
+        // unique要求 prev < cur，equal要求 !(cur < prev)
+        bool sorted = unique ? key_comp_(KeyofValue()(*prev), KeyofValue()(*cur))
+                             : !key_comp_(KeyofValue()(*cur), KeyofValue()(*prev));
+        if(!sorted) break;
+    }
+    if(cur == last) {
+        build_from_sorted(first, n);
+    }else {
+        insert_hint_end(first, last, unique);
+    }
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+template <class Iterator>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::build_from_sorted(Iterator first, size_type n) {
+    MYSTL_DEBUG(empty());
+    if(n == 0) return;
+    // 除了最底下一层，其余各层都是满的，把最底下一层（可能不满）染成红色，其余全黑，每条路径的黑高相同
+    int red_level = 0;
+    for(long long m = static_cast<long long>(n) - 1 ; m >= 0 ; m = m / 2 - 1) {
+        ++red_level;
+    }
+    reserve_nodes(n);
+    base_ptr top = build_subtree(first, n, 0, red_level);
+    top->set_parent(header_);
+    root() = top;
+    leftmost() = rb_tree_min(top);
+    rightmost() = rb_tree_max(top);
+    node_count_ = n;
+}
+
+// 中序建树：先建左子树，再取当前元素作为根，最后建右子树，first随之前进
+// 左子树 (n - 1) / 2 个结点，右子树 n - 1 - (n - 1) / 2 个结点。出现异常时释放已经建好的部分
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+template <class Iterator>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::build_subtree(Iterator& first, size_type n, int level, int red_level) {
+    if(n == 0) return nullptr;
+    size_type left_n = (n - 1) / 2;
+    base_ptr left = build_subtree(first, left_n, level + 1, red_level);
+
+    node_ptr z;
+    try {
+        z = create_node(*first);
+    }catch(...) {
+        if(left) erase_since(left);
+        throw;
+    }
+    ++first;
+    z->set_color((level == red_level) ? rb_tree_red : rb_tree_black);
+    z->set_parent(nullptr);
+    z->left_ = left;
+    z->right_ = nullptr;
+    if(left) left->set_parent(z);
+
+    base_ptr right;
+    try {
+        right = build_subtree(first, n - 1 - left_n, level + 1, red_level);
+    }catch(...) {
+        erase_since(z);
+        throw;
+    }
+    z->right_ = right;
+    if(right) right->set_parent(z);
+    Augment()(static_cast<base_ptr>(z));
+    return z;
+}
+
 // header初始情况，结点为红，parent == nullptr, left和right指向自己
-template <class Key, class T, class Compare, class KeyofValue>
-void rb_tree<Key, T, Compare, KeyofValue>::rb_tree_init() {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::rb_tree_init() {
     header_ = node_allocator::allocate(1);
-    header_->color_ = rb_tree_red;
+    header_->set_color(rb_tree_red);
     root() = nullptr;
     leftmost() = header_;
     rightmost() = header_;
     node_count_ = 0;
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-rb_tree<Key, T, Compare, KeyofValue>::rb_tree(const rb_tree& rhs) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+rb_tree<Key, T, Compare, KeyofValue, Augment>::rb_tree(const rb_tree& rhs) {
     rb_tree_init();     //初始化header
     if(rhs.node_count_ != 0) {
-        root() = copy_from(reinterpret_cast<node_ptr>(rhs.root()), reinterpret_cast<node_ptr>(header_));  // 由于这个函数传入的指针必须非空，所以要判定
+        reserve_nodes(rhs.node_count_);
+        try {
+            root() = copy_from(reinterpret_cast<node_ptr>(rhs.root()), reinterpret_cast<node_ptr>(header_));  // 由于这个函数传入的指针必须非空，所以要判定
+        }catch(...) {
+            node_allocator::deallocate(static_cast<node_ptr>(header_));
+            throw;
+        }
         leftmost() = rb_tree_min(root());
         rightmost() = rb_tree_max(root());
     }
@@ -767,21 +1365,22 @@ rb_tree<Key, T, Compare, KeyofValue>::rb_tree(const rb_tree& rhs) {
     key_comp_ = rhs.key_comp_;
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-rb_tree<Key, T, Compare, KeyofValue>::rb_tree(rb_tree&& rhs) : 
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+rb_tree<Key, T, Compare, KeyofValue, Augment>::rb_tree(rb_tree&& rhs) : 
         header_(mystl::move(rhs.header_)), 
         node_count_(rhs.node_count_),
         key_comp_(rhs.key_comp_) {
     rhs.reset();
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-rb_tree<Key, T, Compare, KeyofValue>& 
-rb_tree<Key, T, Compare, KeyofValue>::operator=(const rb_tree& rhs) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+rb_tree<Key, T, Compare, KeyofValue, Augment>& 
+rb_tree<Key, T, Compare, KeyofValue, Augment>::operator=(const rb_tree& rhs) {
     if(this != &rhs) {
         clear();    //首先清空本身
 
         if(rhs.node_count_ != 0) {
+            reserve_nodes(rhs.node_count_);
             root() = copy_from(reinterpret_cast<node_ptr>(rhs.root()), reinterpret_cast<node_ptr>(header_));
             leftmost() = rb_tree_min(root());
             rightmost() = rb_tree_max(root());
@@ -792,10 +1391,11 @@ rb_tree<Key, T, Compare, KeyofValue>::operator=(const rb_tree& rhs) {
     return *this;
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-rb_tree<Key, T, Compare, KeyofValue>& 
-rb_tree<Key, T, Compare, KeyofValue>::operator=(rb_tree&& rhs) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+rb_tree<Key, T, Compare, KeyofValue, Augment>& 
+rb_tree<Key, T, Compare, KeyofValue, Augment>::operator=(rb_tree&& rhs) {
     clear();
+    if(header_ != nullptr) node_allocator::deallocate(static_cast<node_ptr>(header_));
     header_ = mystl::move(rhs.header_);
     node_count_ = rhs.node_count_;
     key_comp_ = rhs.key_comp_;
@@ -806,16 +1406,13 @@ rb_tree<Key, T, Compare, KeyofValue>::operator=(rb_tree&& rhs) {
 
 // 当y == header满足，那么size == 0,否则不可能y == header
 // 当插入到一个node的左边时，x == y，直接进第一个分支
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::iterator 
-rb_tree<Key, T, Compare, KeyofValue>::insert_aux(base_ptr x_, base_ptr y_, const value_type& value) {
-    node_ptr x = reinterpret_cast<node_ptr>(x_);
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::iterator 
+rb_tree<Key, T, Compare, KeyofValue, Augment>::link_node(base_ptr x, base_ptr y_, node_ptr z) {
     node_ptr y = reinterpret_cast<node_ptr>(y_);
-    node_ptr z;  // 表示新增结点
     // x == nullptr 是一定的
-    if(y == header_ || x || key_comp_(KeyofValue()(value), KeyofValue()(y->value_))) {
+    if(y == header_ || x || key_comp_(KeyofValue()(z->value_), KeyofValue()(y->value_))) {
         // 3种情况
-        z = create_node(value);
         // x 为 y的左孩子
         y->left_ = z;
         if(header_ == y){
@@ -827,7 +1424,6 @@ rb_tree<Key, T, Compare, KeyofValue>::insert_aux(base_ptr x_, base_ptr y_, const
         }
     }else {
         // x为y的右孩子
-        z = create_node(value);
         y->right_ = z;
         if(y == rightmost()) {
             rightmost() = z;
@@ -835,68 +1431,85 @@ rb_tree<Key, T, Compare, KeyofValue>::insert_aux(base_ptr x_, base_ptr y_, const
     }
 
     // 设置z的指针
-    z->parent_ = y;
+    z->set_parent(y);
     z->left_ = nullptr;
     z->right_ = nullptr;
     // x新节点的设置color == red, 是在rebalance函数中的
 
-    rb_tree_insert_rebalance(static_cast<base_ptr>(z), header_->parent_);
+    rb_tree_insert_rebalance(static_cast<base_ptr>(z), root(), Augment());
     ++node_count_;
     return iterator(z);
 }
 
-
-template <class Key, class T, class Compare, class KeyofValue>
-mystl::pair<typename rb_tree<Key, T, Compare, KeyofValue>::iterator, bool> 
-rb_tree<Key, T, Compare, KeyofValue>::insert_unique(const value_type& value) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+mystl::pair<typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr, bool>
+rb_tree<Key, T, Compare, KeyofValue, Augment>::get_insert_unique_pos(const key_type& key) {
     base_ptr y = header_;
     base_ptr x = root();
     bool comp = true;
     while(x) {
         y = x;
-        comp = key_comp_(KeyofValue()(value), KeyofValue()(x->get_node_ptr()->value_));
+        comp = key_comp_(key, KeyofValue()(x->get_node_ptr()->value_));
         x = comp ? x->left_ : x->right_;    // true表示最后一次往左边走
     }
     iterator j = iterator(y);   // 把j作为插入结点的父节点
 
     if(comp) {
         if(j == begin()) {
-            // 插入结点的父节点是最左结点
-            return mystl::pair<iterator, bool>(insert_aux(x, y, value), true);  // 一定可以插入成功
+            // 插入结点的父节点是最左结点，一定可以插入成功
+            return mystl::pair<base_ptr, bool>(y, true);
         }else {
             --j;    // j倒退一个，因为不是第一个结点的左边，而是中间结点的左边，所以--，找到*j <= value,为了后面判断重复元素.  此时是j自减，y并没有动
         }
     }
-    if(key_comp_(KeyofValue()(*j), KeyofValue()(value))) {
-        return  mystl::pair<iterator, bool>(insert_aux(x, y, value), true);  // *j < value 
+    if(key_comp_(KeyofValue()(*j), key)) {
+        return mystl::pair<base_ptr, bool>(y, true);  // *j < value 
     }
 
     // 第一个if(false)， value >= *j. 第二个if(false),  value <= *j。
     // 则走到这个分支，一定有， value == *j。结点重复，返回重复值的结点
-    return mystl::pair<iterator, bool>(j, false);
+    return mystl::pair<base_ptr, bool>(j.node_, false);
 }
 
-
-
-// 允许插入的值key重复，且稳定，因为相等的情况，会走向右边
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::iterator
-rb_tree<Key, T, Compare, KeyofValue>::insert_equal(const value_type& value) {
+// 相等的情况走向右边，保证稳定
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::get_insert_equal_pos(const key_type& key) {
     base_ptr y = header_;
     base_ptr x = root();     //y为x的父亲
     while(x) {
         y = x;
-        x = key_comp_(KeyofValue()(value), KeyofValue()(x->get_node_ptr()->value_)) 
+        x = key_comp_(key, KeyofValue()(x->get_node_ptr()->value_)) 
                 ? x->left_ : x->right_; // 比较value与x->value大小，小则去左边
     }
-    return insert_aux(x, y, value);
+    return y;
+}
+
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+mystl::pair<typename rb_tree<Key, T, Compare, KeyofValue, Augment>::iterator, bool> 
+rb_tree<Key, T, Compare, KeyofValue, Augment>::insert_unique(const value_type& value) {
+    mystl::pair<base_ptr, bool> pos = get_insert_unique_pos(KeyofValue()(value));
+    if(pos.second) {
+        return mystl::pair<iterator, bool>(insert_aux(nullptr, pos.first, value), true);
+    }
+    return mystl::pair<iterator, bool>(iterator(pos.first), false);
+}
+
+
+
+// 允许插入的值key重复，且稳定，因为相等的情况，会走向右边
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::iterator
+rb_tree<Key, T, Compare, KeyofValue, Augment>::insert_equal(const value_type& value) {
+    return insert_aux(nullptr, get_insert_equal_pos(KeyofValue()(value)), value);
 }
 
 
 // 这样分类讨论，是为了让查找次数减少，如果pos正确，直接调用insert_aux，是O(1)的复杂度
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::iterator 
-rb_tree<Key, T, Compare, KeyofValue>::insert_unique(iterator pos, const value_type& value) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::iterator 
+rb_tree<Key, T, Compare, KeyofValue, Augment>::insert_unique(iterator pos, const value_type& value) {
     if(pos.node_ == header_->left_) {   // begin()
         if(size() > 0 && key_comp_(KeyofValue()(value), KeyofValue()(*pos))) {
             // 保证有根节点，插入到最左侧结点的左侧，size > 0保证比较合法
@@ -932,9 +1545,9 @@ rb_tree<Key, T, Compare, KeyofValue>::insert_unique(iterator pos, const value_ty
     }
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::iterator 
-rb_tree<Key, T, Compare, KeyofValue>::insert_equal(iterator pos, const value_type& value) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::iterator 
+rb_tree<Key, T, Compare, KeyofValue, Augment>::insert_equal(iterator pos, const value_type& value) {
     if(pos.node_ == header_->left_) {
         if(size() > 0 && key_comp_(KeyofValue()(value), KeyofValue()(*pos))) {   // v < *pos, v == *pos ：调用equal，否则不稳定
             return insert_aux(pos.node_, pos.node_, value);   //相等的情况，不在里面，否则不能保持稳定
@@ -967,158 +1580,498 @@ rb_tree<Key, T, Compare, KeyofValue>::insert_equal(iterator pos, const value_typ
 
 
 
-// 递归复制一棵树，被复制的树当前结点为x，当前树的当前结点的父节点为p。 不是x的parent
-// 这里所有的右节点采用递归复制，而左节点采用循环复制
-// 之所以要传入p，是因为红黑树还要设置parent，如果是单纯的二叉树，不用这么麻烦
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::node_ptr 
-rb_tree<Key, T, Compare, KeyofValue>::copy_from(node_ptr x, node_ptr p) {
-    node_ptr top = clone_node(x);
-    top->parent_ = p;   //设置当前的parent
-
-    // x右子树非空
-    if(x->right_) {
-        top->right_ = copy_from(reinterpret_cast<node_ptr>(x->right_), reinterpret_cast<node_ptr>(top));
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::iterator
+rb_tree<Key, T, Compare, KeyofValue, Augment>::nth(size_type k) const {
+    base_ptr x = root();
+    while(x != nullptr) {
+        size_type left_size = Augment::size(x->left_);
+        if(k < left_size) {
+            x = x->left_;
+        }else if(k == left_size) {
+            return iterator(x);
+        }else {
+            k -= left_size + 1;
+            x = x->right_;
+        }
     }
+    return iterator(header_);
+}
 
-    p = top;    // parent下沉
-    x = reinterpret_cast<node_ptr>(x->left_);   // 轮到复制左子树了
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::size_type
+rb_tree<Key, T, Compare, KeyofValue, Augment>::rank(const key_type& key) const {
+    size_type r = 0;
+    base_ptr x = root();
     while(x != nullptr) {
-        node_ptr y = clone_node(x);
-        p->left_ = y;
-        y->parent_ = p;
-        if(x->right_) {
-            y->right_ = copy_from(reinterpret_cast<node_ptr>(x->right_), reinterpret_cast<node_ptr>(y));    // 右节点递归，左结点循环
+        if(key_comp_(KeyofValue()(x->get_node_ptr()->value_), key)) {
+            // x < key，x和它的左子树都排在key前面
+            r += Augment::size(x->left_) + 1;
+            x = x->right_;
+        }else {
+            x = x->left_;
         }
-        p = y;
-        x = reinterpret_cast<node_ptr>(x->left_);
     }
-    return top;
+    return r;
 }
 
-// 左右子树届递归处理
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::node_ptr 
-rb_tree<Key, T, Compare, KeyofValue>::copy_from1(node_ptr x, node_ptr p) {
-    node_ptr top = clone_node(x);
-    top->parent_ = p;   //设置当前的parent
+// 从pos向上走到根，每次从右孩子走上去，父节点和它的左子树都排在前面
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::size_type
+rb_tree<Key, T, Compare, KeyofValue, Augment>::index_of(const_iterator pos) const {
+    base_ptr x = pos.node_;
+    if(x == header_) return node_count_;
+    size_type r = Augment::size(x->left_);
+    while(x != root()) {
+        base_ptr p = x->parent();
+        if(x == p->right_) {
+            r += Augment::size(p->left_) + 1;
+        }
+        x = p;
+    }
+    return r;
+}
 
-    if(x->right_) {
-        top->right_ = copy_from1(reinterpret_cast<node_ptr>(x->right_), top);
+// 只是把结点从树上断开，结点和其中的元素都原样交给node_handle
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::node_handle
+rb_tree<Key, T, Compare, KeyofValue, Augment>::extract(iterator pos) {
+    MYSTL_DEBUG(pos != end());
+    base_ptr y = rb_tree_erase_rebalance(pos.node_, root(), leftmost(), rightmost(), Augment());
+    --node_count_;
+    return node_handle(static_cast<node_ptr>(y));
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::insert_return_type
+rb_tree<Key, T, Compare, KeyofValue, Augment>::insert_unique(node_handle&& nh) {
+    if(nh.empty()) {
+        return insert_return_type{ end(), false, node_handle() };
     }
-    if(x->left_) {
-        top->left_ = copy_from1(reinterpret_cast<node_ptr>(x->left_), top);
+    mystl::pair<base_ptr, bool> pos = get_insert_unique_pos(KeyofValue()(nh.value()));
+    if(pos.second) {
+        iterator it = link_node(nullptr, pos.first, nh.release());
+        return insert_return_type{ it, true, node_handle() };
     }
-    return top;
+    // 插入失败，结点仍然留在句柄中
+    return insert_return_type{ iterator(pos.first), false, mystl::move(nh) };
 }
 
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::iterator
+rb_tree<Key, T, Compare, KeyofValue, Augment>::insert_equal(node_handle&& nh) {
+    if(nh.empty()) return end();
+    base_ptr y = get_insert_equal_pos(KeyofValue()(nh.value()));
+    return link_node(nullptr, y, nh.release());
+}
 
-// find 如果有key重复，返回首先入红黑树的，也就是第一个重复元素
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::iterator 
-rb_tree<Key, T, Compare, KeyofValue>::find (const key_type& key) {
-    base_ptr y = header_;
-    base_ptr x = root();
-
-    while(x != nullptr) {
-        if(!key_comp_(KeyofValue()(x->get_node_ptr()->value_), key) ) {
-            // x >= k ，往左走， == 也是往左走，找到第一个
-            y = x;
-            x = x->left_;
-        }else{
-            x = x->right_;  // x < k 往右走
+// 逐个把other的结点断开，再链接到本树，全程没有分配和释放
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::merge_unique(rb_tree& other) {
+    if(this == &other || other.empty()) return;
+    for(iterator it = other.begin() ; it != other.end() ; ) {
+        iterator next = it;
+        ++next;
+        mystl::pair<base_ptr, bool> pos = get_insert_unique_pos(KeyofValue()(*it));
+        if(pos.second) {
+            base_ptr z = rb_tree_erase_rebalance(it.node_, other.root(), other.leftmost(), other.rightmost(), Augment());
+            --other.node_count_;
+            link_node(nullptr, pos.first, static_cast<node_ptr>(z));
         }
+        it = next;
     }
-    iterator j = iterator(y);   // j应该为找到的结点
+}
 
-    // 没找到有两种情况，就是j==end()，说明元素为空。另一种情况就是，没有这个元素，j指向本该插入的位置，k < *j
-    return (j == end() || key_comp_(key, KeyofValue()(*j))) ? end() : j;
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::merge_equal(rb_tree& other) {
+    if(this == &other || other.empty()) return;
+    for(iterator it = other.begin() ; it != other.end() ; ) {
+        iterator next = it;
+        ++next;
+        base_ptr y = get_insert_equal_pos(KeyofValue()(*it));
+        base_ptr z = rb_tree_erase_rebalance(it.node_, other.root(), other.leftmost(), other.rightmost(), Augment());
+        --other.node_count_;
+        link_node(nullptr, y, static_cast<node_ptr>(z));
+        it = next;
+    }
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::const_iterator 
-rb_tree<Key, T, Compare, KeyofValue>::find(const key_type& key) const {
-    base_ptr y = header_;
-    base_ptr x = root();
 
-    while(x != nullptr) {
-        if(!key_comp_(KeyofValue()(x->get_node_ptr()->value_), key) ) {
-            // x >= k ，往左走， == 也是往左走，找到第一个
-            // 如果往左走，说明x为一个>=key的值，所以用y记录住
-            y = x;
-            x = x->left_;
-        }else{
-            x = x->right_;  // x < k 往右走
-        }
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::attach_root(base_ptr t, size_type n) {
+    root() = t;
+    if(t != nullptr) {
+        t->set_parent(header_);
+        leftmost() = rb_tree_min(t);
+        rightmost() = rb_tree_max(t);
+    }else {
+        leftmost() = header_;
+        rightmost() = header_;
     }
-    const_iterator j = const_iterator(y);   // j应该为找到的结点
+    node_count_ = n;
+}
 
-    return (j == end() || key_comp_(key, KeyofValue()(*j))) ? end() : j;
+// 黑高大的一边沿着靠近另一边的边界往下走，找到黑高相等的黑结点c，k作为红结点顶替c的位置，
+// c和另一棵树成为k的孩子，之后和插入一个红结点一样向上修复
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::join_aux(base_ptr l, int hl, base_ptr k, base_ptr r, int hr, int& h) {
+    if(hl == hr) {
+        k->left_ = l;
+        k->right_ = r;
+        if(l != nullptr) l->set_parent(k);
+        if(r != nullptr) r->set_parent(k);
+        k->set_parent(nullptr);
+        rb_tree_set_black(k);
+        Augment()(k);
+        h = hl + 1;
+        return k;
+    }
+    base_ptr root = hl > hr ? l : r;
+    base_ptr p = nullptr, c = root;
+    h = hl > hr ? hl : hr;
+    const int target = hl > hr ? hr : hl;
+    int ch = h;
+    while(!((c == nullptr || rb_tree_is_black(c)) && ch == target)) {
+        if(rb_tree_is_black(c)) --ch;
+        p = c;
+        c = hl > hr ? c->right_ : c->left_;
+    }
+    if(hl > hr) {
+        k->left_ = c;
+        k->right_ = r;
+        if(r != nullptr) r->set_parent(k);
+        p->right_ = k;
+    }else {
+        k->left_ = l;
+        k->right_ = c;
+        if(l != nullptr) l->set_parent(k);
+        p->left_ = k;
+    }
+    if(c != nullptr) c->set_parent(k);
+    k->set_parent(p);
+    h += rb_tree_insert_rebalance(k, root, Augment());
+    return root;
 }
 
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::split_last(base_ptr x, int hx, base_ptr& last, int& h) {
+    int hl, hr;
+    base_ptr l = detach_child(x->left_, hx, hl);
+    if(x->right_ == nullptr) {
+        last = x;
+        h = hl;
+        return l;
+    }
+    base_ptr r = detach_child(x->right_, hx, hr);
+    r = split_last(r, hr, last, hr);
+    return join_aux(l, hl, x, r, hr, h);
+}
 
-// lower_bound算法和find一样
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::iterator 
-rb_tree<Key, T, Compare, KeyofValue>::lower_bound(const key_type& key) {
-    base_ptr y = header_;
-    base_ptr x = root();
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::join2(base_ptr l, int hl, base_ptr r, int hr, int& h) {
+    if(l == nullptr) {
+        h = hr;
+        return r;
+    }
+    if(r == nullptr) {
+        h = hl;
+        return l;
+    }
+    base_ptr k;
+    l = split_last(l, hl, k, hl);
+    return join_aux(l, hl, k, r, hr, h);
+}
 
-    while(x != nullptr) {
-        if(!key_comp_(KeyofValue()(x->get_node_ptr()->value_), key) ) {
-            // x >= k ，往左走， == 也是往左走，找到第一个
-            y = x;
-            x = x->left_;
-        }else{
-            x = x->right_;  // x < k 往右走
-        }
+// 沿查找路径往下拆，回来时把路径两侧的子树分别join起来，黑高逐层递增，总共O(log n)
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::split_aux(base_ptr x, int hx, const key_type& key,
+                                                              base_ptr& l, int& hl, base_ptr& m, base_ptr& r, int& hr) const {
+    if(x == nullptr) {
+        l = m = r = nullptr;
+        hl = hr = 0;
+        return;
+    }
+    int hxl, hxr;
+    base_ptr xl = detach_child(x->left_, hx, hxl), xr = detach_child(x->right_, hx, hxr);
+    if(key_comp_(key, key_of(x))) {
+        base_ptr rl;
+        int hrl;
+        split_aux(xl, hxl, key, l, hl, m, rl, hrl);
+        r = join_aux(rl, hrl, x, xr, hxr, hr);
+    }else if(key_comp_(key_of(x), key)) {
+        base_ptr lr;
+        int hlr;
+        split_aux(xr, hxr, key, lr, hlr, m, r, hr);
+        l = join_aux(xl, hxl, x, lr, hlr, hl);
+    }else {
+        l = xl;
+        hl = hxl;
+        m = x;
+        r = xr;
+        hr = hxr;
     }
-    
-    return iterator(y);     // 没找到正好返回该插入的位置
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::const_iterator 
-rb_tree<Key, T, Compare, KeyofValue>::lower_bound(const key_type& key) const {
-    base_ptr y = header_;
-    base_ptr x = root();
+// 用t2的根把t1分开，左右两边分别递归，再用根join回来
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::union_aux(base_ptr t1, int h1, base_ptr t2, int h2, int& h, size_type& removed, int depth) {
+    if(t2 == nullptr) {
+        h = h1;
+        return t1;
+    }
+    if(t1 == nullptr) {
+        h = h2;
+        return t2;
+    }
+    int hl2, hr2, hl1, hr1;
+    base_ptr l2 = detach_child(t2->left_, h2, hl2), r2 = detach_child(t2->right_, h2, hr2);
+    base_ptr l1, m, r1;
+    split_aux(t1, h1, key_of(t2), l1, hl1, m, r1, hr1);
+    base_ptr l, r;
+    int hl, hr;
+    size_type rl = 0, rr = 0;
+    fork_join(depth, [&] { l = union_aux(l1, hl1, l2, hl2, hl, rl, depth - 1); },
+                     [&] { r = union_aux(r1, hr1, r2, hr2, hr, rr, depth - 1); });
+    removed += rl + rr;
+    if(m != nullptr) {
+        // 重复的键值保留本树的结点
+        destroy_node(static_cast<node_ptr>(t2));
+        ++removed;
+        t2 = m;
+    }
+    return join_aux(l, hl, t2, r, hr, h);
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::intersect_aux(base_ptr t1, int h1, base_ptr t2, int& h, size_type& removed, int depth) {
+    h = 0;
+    if(t1 == nullptr) return nullptr;
+    if(t2 == nullptr) {
+        removed += erase_count(t1);
+        return nullptr;
+    }
+    int hl1, hr1;
+    base_ptr l1, m, r1;
+    split_aux(t1, h1, key_of(t2), l1, hl1, m, r1, hr1);
+    base_ptr l, r;
+    int hl, hr;
+    size_type rl = 0, rr = 0;
+    fork_join(depth, [&] { l = intersect_aux(l1, hl1, t2->left_, hl, rl, depth - 1); },
+                     [&] { r = intersect_aux(r1, hr1, t2->right_, hr, rr, depth - 1); });
+    removed += rl + rr;
+    return m != nullptr ? join_aux(l, hl, m, r, hr, h) : join2(l, hl, r, hr, h);
+}
 
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::difference_aux(base_ptr t1, int h1, base_ptr t2, int& h, size_type& removed, int depth) {
+    h = h1;
+    if(t1 == nullptr || t2 == nullptr) return t1;
+    int hl1, hr1;
+    base_ptr l1, m, r1;
+    split_aux(t1, h1, key_of(t2), l1, hl1, m, r1, hr1);
+    base_ptr l, r;
+    int hl, hr;
+    size_type rl = 0, rr = 0;
+    fork_join(depth, [&] { l = difference_aux(l1, hl1, t2->left_, hl, rl, depth - 1); },
+                     [&] { r = difference_aux(r1, hr1, t2->right_, hr, rr, depth - 1); });
+    removed += rl + rr;
+    if(m != nullptr) {
+        destroy_node(static_cast<node_ptr>(m));
+        ++removed;
+    }
+    return join2(l, hl, r, hr, h);
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::size_type
+rb_tree<Key, T, Compare, KeyofValue, Augment>::erase_count(base_ptr x) {
+    size_type n = 0;
     while(x != nullptr) {
-        if(!key_comp_(KeyofValue()(x->get_node_ptr()->value_), key) ) {
-            // x >= k ，往左走， == 也是往左走，找到第一个
-            y = x;
-            x = x->left_;
-        }else{
-            x = x->right_;  // x < k 往右走
+        n += erase_count(x->right_);
+        base_ptr y = x->left_;
+        destroy_node(static_cast<node_ptr>(x));
+        ++n;
+        x = y;
+    }
+    return n;
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::join(rb_tree& other) {
+    if(this == &other || other.empty()) return;
+    if(empty()) {
+        swap(other);
+        return;
+    }
+    MYSTL_DEBUG(key_comp_(key_of(rightmost()), key_of(other.leftmost())));
+    const size_type n = node_count_ + other.node_count_;
+    base_ptr k;
+    int hl, h;
+    base_ptr l = split_last(detach_root(root()), black_height(root()), k, hl);
+    base_ptr t = join_aux(l, hl, k, detach_root(other.root()), black_height(other.root()), h);
+    other.attach_root(nullptr, 0);
+    attach_root(t, n);
+}
+
+// 拆开以后左边留在本树，右边接到right上，两边的元素个数由调用者修正
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::split_detach(const key_type& key, rb_tree& right) {
+    base_ptr l, m, r;
+    int hl, hr;
+    split_aux(detach_root(root()), black_height(root()), key, l, hl, m, r, hr);
+    if(m != nullptr) r = join_aux(nullptr, 0, m, r, hr, hr);
+    attach_root(l, 0);
+    right.attach_root(r, 0);
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::split(const key_type& key, rb_tree& right) {
+    if(this == &right) return;
+    right.clear();
+    if(empty()) return;
+    const size_type n = node_count_;
+    split_detach(key, right);
+    split_count(right, n, has_subtree_size<Augment>());
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::split(const key_type& key, rb_tree& right, size_type right_count) {
+    if(this == &right) return;
+    right.clear();
+    if(empty()) return;
+    MYSTL_DEBUG(right_count <= node_count_);
+    const size_type n = node_count_;
+    split_detach(key, right);
+    node_count_ = n - right_count;
+    right.node_count_ = right_count;
+}
+
+// 没有子树大小可用时，两边同时往后数，先数完的一边就是较小的一边，代价为O(较小一边的元素个数)
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::split_count(rb_tree& right, size_type n, std::false_type) {
+    size_type count = 0;
+    iterator i = begin(), j = right.begin();
+    while(i != end() && j != right.end()) {
+        ++i;
+        ++j;
+        ++count;
+    }
+    if(i == end()) {
+        node_count_ = count;
+    }else {
+        node_count_ = n - count;
+    }
+    right.node_count_ = n - node_count_;
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::union_with(rb_tree& other, bool parallel) {
+    if(this == &other || other.empty()) return;
+    const size_type n = node_count_ + other.node_count_;
+    const int depth = parallel_depth(parallel, node_count_, other.node_count_);
+    const int h2 = black_height(other.root());
+    base_ptr t2 = detach_root(other.root());
+    other.attach_root(nullptr, 0);
+    size_type removed = 0;
+    int h;
+    base_ptr t = union_aux(detach_root(root()), black_height(root()), t2, h2, h, removed, depth);
+    attach_root(t, n - removed);
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::intersect_with(const rb_tree& other, bool parallel) {
+    if(this == &other || empty()) return;
+    const int depth = parallel_depth(parallel, node_count_, other.node_count_);
+    size_type removed = 0;
+    int h;
+    base_ptr t = intersect_aux(detach_root(root()), black_height(root()), other.root(), h, removed, depth);
+    attach_root(t, node_count_ - removed);
+}
+
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::difference_with(const rb_tree& other, bool parallel) {
+    if(this == &other) {
+        clear();
+        return;
+    }
+    if(empty() || other.empty()) return;
+    const int depth = parallel_depth(parallel, node_count_, other.node_count_);
+    size_type removed = 0;
+    int h;
+    base_ptr t = difference_aux(detach_root(root()), black_height(root()), other.root(), h, removed, depth);
+    attach_root(t, node_count_ - removed);
+}
+
+// 复制以x为根的子树，新子树的根的parent为p
+// 不用递归：沿着被复制的树往下走，同时在新树上走到对应的位置，先复制左孩子，再复制右孩子，
+// 两个孩子都复制好以后两边一起回到父节点。被复制的树自带parent，所以不需要栈
+// 出现异常时释放已经复制的部分
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::node_ptr 
+rb_tree<Key, T, Compare, KeyofValue, Augment>::copy_from(node_ptr x, node_ptr p) {
+    node_ptr top = clone_node(x);
+    top->set_parent(p);
+    try {
+        base_ptr src = x;
+        base_ptr dst = top;
+        while(true) {
+            if(src->left_ != nullptr && dst->left_ == nullptr) {
+                src = src->left_;
+                node_ptr y = clone_node(static_cast<node_ptr>(src));
+                y->set_parent(dst);
+                dst->left_ = y;
+                dst = y;
+            }else if(src->right_ != nullptr && dst->right_ == nullptr) {
+                src = src->right_;
+                node_ptr y = clone_node(static_cast<node_ptr>(src));
+                y->set_parent(dst);
+                dst->right_ = y;
+                dst = y;
+            }else {
+                if(src == x) break;
+                src = src->parent();
+                dst = dst->parent();
+            }
         }
+    }catch(...) {
+        erase_since(top);
+        throw;
     }
-    
-    return const_iterator(y);
+    return top;
 }
 
-// upper_bound在比较的时候把==的情况，往右走即可
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::iterator 
-rb_tree<Key, T, Compare, KeyofValue>::upper_bound(const key_type& key) {
+
+// lower_bound：x >= key 往左走并记录x，== 也往左走，找到第一个。没找到正好是该插入的位置
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+template <class K>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::lower_bound_node(const K& key) const {
     base_ptr y = header_;
     base_ptr x = root();
 
     while(x != nullptr) {
-        if(key_comp_(key, KeyofValue()(x->get_node_ptr()->value_)) ) {
-            // k < x ，往左走， 
+        if(!key_comp_(KeyofValue()(x->get_node_ptr()->value_), key) ) {
+            // x >= k ，往左走， == 也是往左走，找到第一个
             y = x;
             x = x->left_;
         }else{
-            x = x->right_;  // x < k 往右走, == 也是往右走，找到右侧开区间
+            x = x->right_;  // x < k 往右走
         }
     }
-    
-    return iterator(y);     // 没找到正好返回该插入的位置
+    return y;
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::const_iterator 
-rb_tree<Key, T, Compare, KeyofValue>::upper_bound(const key_type& key) const {
+// upper_bound在比较的时候把==的情况，往右走即可
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+template <class K>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::base_ptr
+rb_tree<Key, T, Compare, KeyofValue, Augment>::upper_bound_node(const K& key) const {
     base_ptr y = header_;
     base_ptr x = root();
 
@@ -1131,41 +2084,34 @@ rb_tree<Key, T, Compare, KeyofValue>::upper_bound(const key_type& key) const {
             x = x->right_;  // x < k 往右走, == 也是往右走，找到右侧开区间
         }
     }
-    
-    return const_iterator(y);     // 没找到正好返回该插入的位置
+    return y;
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::size_type 
-rb_tree<Key, T, Compare, KeyofValue>::count(const key_type& key) const {
-    auto p = equal_range(key);
-    return mystl::distance(p.first, p.second);
-}
-
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::iterator 
-rb_tree<Key, T, Compare, KeyofValue>::erase(iterator pos) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::iterator 
+rb_tree<Key, T, Compare, KeyofValue, Augment>::erase(iterator pos) {
     iterator next(pos);
     ++next;
     
-    base_ptr y = rb_tree_erase_rebalance(pos.node_, root(), leftmost(), rightmost());
-    destroy_node(y->get_node_ptr());    // 销毁该node
+    base_ptr y = rb_tree_erase_rebalance(pos.node_, root(), leftmost(), rightmost(), Augment());
+    destroy_node(static_cast<node_ptr>(y));    // 销毁该node
     --node_count_;
     return next;
 }
 
 
-template <class Key, class T, class Compare, class KeyofValue>
-typename rb_tree<Key, T, Compare, KeyofValue>::size_type  
-rb_tree<Key, T, Compare, KeyofValue>::erase(const key_type& key) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+template <class K>
+typename rb_tree<Key, T, Compare, KeyofValue, Augment>::size_type  
+rb_tree<Key, T, Compare, KeyofValue, Augment>::erase_key(const K& key) {
     auto p = equal_range(key);
     size_type n = mystl::distance(p.first, p.second);
     erase(p.first, p.second);
     return n;
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-void  rb_tree<Key, T, Compare, KeyofValue>::erase(iterator first, iterator last) {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void  rb_tree<Key, T, Compare, KeyofValue, Augment>::erase(iterator first, iterator last) {
     if(first == begin() && last == end()) {
         clear();
     }else {
@@ -1175,8 +2121,8 @@ void  rb_tree<Key, T, Compare, KeyofValue>::erase(iterator first, iterator last)
     }  
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-void rb_tree<Key, T, Compare, KeyofValue>::clear() {
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::clear() {
     // 仅剩下header
     if(node_count_ != 0) {
         erase_since(root());
@@ -1187,15 +2133,39 @@ void rb_tree<Key, T, Compare, KeyofValue>::clear() {
     }
 }
 
-template <class Key, class T, class Compare, class KeyofValue>
-void rb_tree<Key, T, Compare, KeyofValue>::erase_since(base_ptr x) {
+// 不用递归：有左孩子时右旋把左子树提上来，树逐渐变成一条向右的链，沿着链逐个销毁
+// 使用结点池时先把结点串起来，最后一次还给池
+template <class Key, class T, class Compare, class KeyofValue, class Augment>
+void rb_tree<Key, T, Compare, KeyofValue, Augment>::erase_since(base_ptr x) {
+#ifdef MYSTL_RB_TREE_NODE_POOL
+    node_pool_link* head = nullptr;
+    node_pool_link* tail = nullptr;
+    size_type n = 0;
+#endif
     while(x != nullptr) {
-        erase_since(x->right_); // 删除右子树
-
-        base_ptr y = x->left_;
-        destroy_node(x->get_node_ptr());    // 删除当前结点
-        x = y;  // 循环删除左子树
+        if(x->left_ != nullptr) {
+            base_ptr l = x->left_;
+            x->left_ = l->right_;
+            l->right_ = x;
+            x = l;
+        }else {
+            base_ptr r = x->right_;
+#ifdef MYSTL_RB_TREE_NODE_POOL
+            mystl::destroy(&static_cast<node_ptr>(x)->value_);
+            node_pool_link* link = reinterpret_cast<node_pool_link*>(static_cast<node_ptr>(x));
+            link->next = head;
+            head = link;
+            if(tail == nullptr) tail = link;
+            ++n;
+#else
+            destroy_node(static_cast<node_ptr>(x));    // 删除当前结点
+#endif
+            x = r;
+        }
     }
+#ifdef MYSTL_RB_TREE_NODE_POOL
+    node_allocator::deallocate_chain(head, tail, n);
+#endif
 }
 
 
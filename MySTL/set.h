@@ -8,7 +8,11 @@
 
 namespace mystl {
 
-template <class Key, class Compare = mystl::less<Key>>
+template <class Key, class Compare, class Augment>
+class multiset;
+
+// Augment为红黑树的结点增强策略，见rb_tree.h
+template <class Key, class Compare = mystl::less<Key>, class Augment = rb_tree_no_augment>
 class set {
 public:
     typedef Key         key_type;
@@ -18,9 +22,11 @@ public:
 
 private:
     // 内部含有红黑树, 采用identity作为KeyOfValue
-    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::identity<value_type>>  base_type;
+    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::identity<value_type>, Augment>  base_type;
     base_type tree_;
 
+    template <class, class, class> friend class multiset;
+
 public:
     // 类型全部来自底层红黑树
     typedef typename base_type::node_type              node_type;
@@ -35,6 +41,8 @@ public:
     typedef typename base_type::size_type              size_type;
     typedef typename base_type::difference_type        difference_type;
     typedef typename base_type::allocator_type         allocator_type;
+    typedef typename base_type::node_handle            node_handle;
+    typedef typename base_type::insert_return_type     insert_return_type;
 
 public:
     set() = default;
@@ -44,6 +52,12 @@ public:
         tree_.insert_unique(first, last);
     }
 
+    // 区间已经有序，直接建树
+    template <class InputIterator>
+    set(mystl::sorted_unique_t, InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_unique(mystl::sorted_unique, first, last);
+    }
+
     set(std::initializer_list<value_type> ilist) {
         tree_.insert_unique(ilist.begin(), ilist.end());
     }
@@ -105,6 +119,10 @@ public:
     void insert(Iterator first, Iterator last) {
         tree_.insert_unique(first, last);
     }
+    template <class Iterator>
+    void insert(mystl::sorted_unique_t, Iterator first, Iterator last) {
+        tree_.insert_unique(mystl::sorted_unique, first, last);
+    }
 
     // erase
     iterator erase(iterator pos) { return tree_.erase(pos); } 
@@ -131,50 +149,108 @@ public:
         return tree_.equal_range(key);
     }
 
+    // 异构查找，key_compare定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator find(const K& key) { return tree_.find(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator find(const K& key) const { return tree_.find(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    size_type count(const K& key) const { return tree_.count(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator lower_bound(const K& key) { return tree_.lower_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator lower_bound(const K& key) const { return tree_.lower_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator upper_bound(const K& key) { return tree_.upper_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator upper_bound(const K& key) const { return tree_.upper_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    mystl::pair<iterator, iterator> equal_range(const K& key) { return tree_.equal_range(key); }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return tree_.erase(key); }
+
+    // node handle，结点在容器之间移动，不重新分配
+    node_handle extract(iterator pos) { return tree_.extract(pos); }
+    node_handle extract(const key_type& key) { return tree_.extract(key); }
+    insert_return_type insert(node_handle&& nh) { return tree_.insert_unique(mystl::move(nh)); }
+
+    // 把other中本容器没有的元素移动过来
+    void merge(set& other) { tree_.merge_unique(other.tree_); }
+    void merge(multiset<Key, Compare, Augment>& other) { tree_.merge_unique(other.tree_); }
+
+    // 基于join/split的集合操作，本容器变为结果，较小一方为m个元素时是O(m log(n/m + 1))的
+    // 右值版本直接移动other的结点，键值重复时保留本容器的元素
+    void union_with(const set& other, bool parallel = false) { tree_.union_with(other.tree_, parallel); }
+    void union_with(set&& other, bool parallel = false) { tree_.union_with(other.tree_, parallel); }
+    void intersect_with(const set& other, bool parallel = false) { tree_.intersect_with(other.tree_, parallel); }
+    void difference_with(const set& other, bool parallel = false) { tree_.difference_with(other.tree_, parallel); }
+    // other的键值都大于本容器时，O(log n)拼接
+    void join(set& other) { tree_.join(other.tree_); }
+    // 键值不小于key的元素移到返回的容器中，Augment为rb_tree_size_augment时是O(log n)的
+    set split(const key_type& key) {
+        set right;
+        tree_.split(key, right.tree_);
+        return right;
+    }
+    // 调用者已知键值不小于key的元素个数时，不需要子树大小也是O(log n)
+    set split(const key_type& key, size_type right_count) {
+        set right;
+        tree_.split(key, right.tree_, right_count);
+        return right;
+    }
+
+    // order statistic，Augment为rb_tree_size_augment时可用，O(log n)
+    iterator nth(size_type k) const { return tree_.nth(k); }
+    size_type rank(const key_type& key) const { return tree_.rank(key); }
+    size_type index_of(const_iterator pos) const { return tree_.index_of(pos); }
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return tree_.distance(first, last);
+    }
+
     void swap(set& rhs) {
         tree_.swap(rhs.tree_);
     }
 };
 
-template <class Key, class Compare>
-bool operator==(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator==(const set<Key, Compare, Augment>& lhs, const set<Key, Compare, Augment>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class Compare>
-bool operator<(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator<(const set<Key, Compare, Augment>& lhs, const set<Key, Compare, Augment>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class Compare>
-bool operator!=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator!=(const set<Key, Compare, Augment>& lhs, const set<Key, Compare, Augment>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class Compare>
-bool operator>(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator>(const set<Key, Compare, Augment>& lhs, const set<Key, Compare, Augment>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class Compare>
-bool operator<=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator<=(const set<Key, Compare, Augment>& lhs, const set<Key, Compare, Augment>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class Compare>
-bool operator>=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator>=(const set<Key, Compare, Augment>& lhs, const set<Key, Compare, Augment>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class Key, class Compare>
-void swap(set<Key, Compare>& lhs, set<Key, Compare>& rhs) noexcept
+template <class Key, class Compare, class Augment>
+void swap(set<Key, Compare, Augment>& lhs, set<Key, Compare, Augment>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
@@ -182,7 +258,8 @@ void swap(set<Key, Compare>& lhs, set<Key, Compare>& rhs) noexcept
 
 
 //--------------------multiset-----------------------
-template <class Key, class Compare = mystl::less<Key>>
+// Augment为红黑树的结点增强策略，见rb_tree.h
+template <class Key, class Compare = mystl::less<Key>, class Augment = rb_tree_no_augment>
 class multiset {
 public:
     typedef Key         key_type;
@@ -192,9 +269,11 @@ public:
 
 private:
     // 内部含有红黑树, 采用identity作为KeyOfValue
-    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::identity<value_type>>  base_type;
+    typedef mystl::rb_tree<key_type, value_type, key_compare, mystl::identity<value_type>, Augment>  base_type;
     base_type tree_;
 
+    template <class, class, class> friend class set;
+
 public:
     // 类型全部来自底层红黑树
     typedef typename base_type::node_type              node_type;
@@ -209,6 +288,7 @@ public:
     typedef typename base_type::size_type              size_type;
     typedef typename base_type::difference_type        difference_type;
     typedef typename base_type::allocator_type         allocator_type;
+    typedef typename base_type::node_handle            node_handle;
 
 public:
     multiset() = default;
@@ -218,6 +298,12 @@ public:
         tree_.insert_equal(first, last);
     }
 
+    // 区间已经有序，直接建树
+    template <class InputIterator>
+    multiset(mystl::sorted_equivalent_t, InputIterator first, InputIterator last) : tree_() {
+        tree_.insert_equal(mystl::sorted_equivalent, first, last);
+    }
+
     multiset(std::initializer_list<value_type> ilist) {
         tree_.insert_equal(ilist.begin(), ilist.end());
     }
@@ -279,6 +365,10 @@ public:
     void insert(Iterator first, Iterator last) {
         tree_.insert_equal(first, last);
     }
+    template <class Iterator>
+    void insert(mystl::sorted_equivalent_t, Iterator first, Iterator last) {
+        tree_.insert_equal(mystl::sorted_equivalent, first, last);
+    }
 
     // erase
     iterator erase(iterator pos) { return tree_.erase(pos); } 
@@ -305,55 +395,99 @@ public:
         return tree_.equal_range(key);
     }
 
+    // 异构查找，key_compare定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator find(const K& key) { return tree_.find(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator find(const K& key) const { return tree_.find(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    size_type count(const K& key) const { return tree_.count(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator lower_bound(const K& key) { return tree_.lower_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator lower_bound(const K& key) const { return tree_.lower_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    iterator upper_bound(const K& key) { return tree_.upper_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    const_iterator upper_bound(const K& key) const { return tree_.upper_bound(key); }
+    template <class K, class = mystl::enable_if_transparent_t<key_compare, K>>
+    mystl::pair<iterator, iterator> equal_range(const K& key) { return tree_.equal_range(key); }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return tree_.erase(key); }
+
+    // node handle，结点在容器之间移动，不重新分配
+    node_handle extract(iterator pos) { return tree_.extract(pos); }
+    node_handle extract(const key_type& key) { return tree_.extract(key); }
+    iterator insert(node_handle&& nh) { return tree_.insert_equal(mystl::move(nh)); }
+
+    // 把other中所有元素移动过来
+    void merge(multiset& other) { tree_.merge_equal(other.tree_); }
+    void merge(set<Key, Compare, Augment>& other) { tree_.merge_equal(other.tree_); }
+
+    // order statistic，Augment为rb_tree_size_augment时可用，O(log n)
+    iterator nth(size_type k) const { return tree_.nth(k); }
+    size_type rank(const key_type& key) const { return tree_.rank(key); }
+    size_type index_of(const_iterator pos) const { return tree_.index_of(pos); }
+    difference_type distance(const_iterator first, const_iterator last) const {
+        return tree_.distance(first, last);
+    }
+
     void swap(multiset& rhs) {
         tree_.swap(rhs.tree_);
     }
 };
 
-template <class Key, class Compare>
-bool operator==(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator==(const multiset<Key, Compare, Augment>& lhs, const multiset<Key, Compare, Augment>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class Compare>
-bool operator<(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator<(const multiset<Key, Compare, Augment>& lhs, const multiset<Key, Compare, Augment>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class Compare>
-bool operator!=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator!=(const multiset<Key, Compare, Augment>& lhs, const multiset<Key, Compare, Augment>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class Compare>
-bool operator>(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator>(const multiset<Key, Compare, Augment>& lhs, const multiset<Key, Compare, Augment>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class Compare>
-bool operator<=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator<=(const multiset<Key, Compare, Augment>& lhs, const multiset<Key, Compare, Augment>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class Compare>
-bool operator>=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, class Augment>
+bool operator>=(const multiset<Key, Compare, Augment>& lhs, const multiset<Key, Compare, Augment>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class Key, class Compare>
-void swap(multiset<Key, Compare>& lhs, multiset<Key, Compare>& rhs) noexcept
+template <class Key, class Compare, class Augment>
+void swap(multiset<Key, Compare, Augment>& lhs, multiset<Key, Compare, Augment>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
 
 
+// 维护子树大小的set，支持O(log n)的nth、rank和distance
+template <class Key, class Compare = mystl::less<Key>>
+using order_statistic_set = set<Key, Compare, rb_tree_size_augment>;
+
+template <class Key, class Compare = mystl::less<Key>>
+using order_statistic_multiset = multiset<Key, Compare, rb_tree_size_augment>;
+
 }
 
 #endif
\ No newline at end of file
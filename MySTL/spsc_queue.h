@@ -0,0 +1,285 @@
+#ifndef __SPSC_QUEUE_H__
+#define __SPSC_QUEUE_H__
+
+#include <atomic>
+#include <cstdint>
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "util.h"
+#include "atomic_wait.h"
+
+// 这个文件定义了单生产者单消费者的无锁队列 spsc_queue
+// 只允许一个线程push，一个线程pop，两边各自只写自己的下标，所以try_push/try_pop都是wait-free的
+
+/*
+* 环形缓冲区的容量取2的幂，head_和tail_都是单调递增的计数，下标用 & mask_ 得到，
+* tail_ - head_ 就是元素个数，不需要额外留一个空位来区分空和满。
+*
+* head_ 只有消费者写，tail_ 只有生产者写，两者放在不同的缓存行上。
+* 另外生产者缓存了一份head（head_cache_），只有在看起来满了的时候才去读真正的head_，
+* 消费者同理缓存了tail_cache_，这样大部分操作都不会去碰对方的缓存行。
+*
+* 阻塞版本的push / wait_pop 先自旋，再通过futex睡眠，对方修改下标后负责唤醒。
+*/
+
+namespace mystl {
+
+template <class T>
+class spsc_queue {
+public:
+    typedef T           value_type;
+    typedef size_t      size_type;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+
+    typedef mystl::allocator<T> allocator_type;
+    typedef mystl::allocator<T> data_allocator;
+
+private:
+    // 消费者独占的缓存行
+    alignas(MYSTL_CACHE_LINE_SIZE) std::atomic<size_type> head_;   // 下一个要读出的位置
+    size_type tail_cache_;                                          // 消费者看到的tail
+
+    // 生产者独占的缓存行
+    alignas(MYSTL_CACHE_LINE_SIZE) std::atomic<size_type> tail_;   // 下一个要写入的位置
+    size_type head_cache_;                                          // 生产者看到的head
+
+    // 构造以后只读的数据
+    alignas(MYSTL_CACHE_LINE_SIZE) T* buffer_;
+    size_type mask_;
+
+    // 阻塞等待用
+    alignas(MYSTL_CACHE_LINE_SIZE) wait_point not_empty_;   // 消费者等数据
+    wait_point not_full_;                                   // 生产者等空位
+
+public:
+    // 容量会向上取整到2的幂
+    explicit spsc_queue(size_type capacity = 1024)
+        : head_(0), tail_cache_(0), tail_(0), head_cache_(0) {
+        THROW_LENGTH_ERROR_IF(capacity == 0, "spsc_queue<T> capacity must be positive.\n");
+        size_type n = 1;
+        while(n < capacity) n <<= 1;
+        buffer_ = data_allocator::allocate(n);
+        mask_ = n - 1;
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    ~spsc_queue() {
+        clear();
+        data_allocator::deallocate(buffer_);
+    }
+
+public:
+    // 容量相关，在并发时empty和size只是一个瞬时的近似值
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_type size() const {
+        size_type head = head_.load(std::memory_order_acquire);
+        size_type tail = tail_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_type capacity() const { return mask_ + 1; }
+
+    // 元素访问，只能由消费者调用，且队列不为空
+    reference front() {
+        MYSTL_DEBUG(!empty());
+        return buffer_[head_.load(std::memory_order_relaxed) & mask_];
+    }
+
+    const_reference front() const {
+        MYSTL_DEBUG(!empty());
+        return buffer_[head_.load(std::memory_order_relaxed) & mask_];
+    }
+
+    // ---------------------------生产者接口---------------------------
+
+    // 非阻塞，队列满返回false
+    bool try_push(const value_type& value) { return try_emplace(value); }
+    bool try_push(value_type&& value) { return try_emplace(mystl::move(value)); }
+
+    template <class... Args>
+    bool try_emplace(Args&&... args);
+
+    // 阻塞直到有空位，和queue::push一样总是成功
+    void push(const value_type& value) { emplace(value); }
+    void push(value_type&& value) { emplace(mystl::move(value)); }
+
+    template <class... Args>
+    void emplace(Args&&... args) {
+        while(!try_emplace(mystl::forward<Args>(args)...)) {
+            wait_not_full();
+        }
+    }
+
+    // 批量push [first, first + n)，只做一次发布和一次唤醒，返回实际push的个数
+    template <class Iterator>
+    size_type try_push_bulk(Iterator first, size_type n);
+
+    // 阻塞直到n个元素全部push
+    template <class Iterator>
+    void push_bulk(Iterator first, size_type n) {
+        while(n > 0) {
+            size_type pushed = try_push_bulk(first, n);
+            mystl::advance(first, pushed);
+            n -= pushed;
+            if(n > 0 && pushed == 0) wait_not_full();
+        }
+    }
+
+    // ---------------------------消费者接口---------------------------
+
+    // 非阻塞，队列空返回false
+    bool try_pop(value_type& value);
+
+    // 阻塞直到取出一个元素
+    void wait_pop(value_type& value) {
+        while(!try_pop(value)) {
+            wait_not_empty();
+        }
+    }
+
+    // 弹出队头，和queue::pop一样要求队列非空
+    void pop();
+
+    // 批量pop最多n个元素到result，返回实际个数
+    template <class OutputIterator>
+    size_type try_pop_bulk(OutputIterator result, size_type n);
+
+    // 阻塞直到至少有一个元素，然后最多pop n个
+    template <class OutputIterator>
+    size_type wait_pop_bulk(OutputIterator result, size_type n) {
+        size_type popped;
+        while((popped = try_pop_bulk(result, n)) == 0 && n > 0) {
+            wait_not_empty();
+        }
+        return popped;
+    }
+
+    // 只能在没有其他线程访问时调用
+    void clear() {
+        size_type head = head_.load(std::memory_order_relaxed);
+        size_type tail = tail_.load(std::memory_order_relaxed);
+        for(; head != tail ; ++head) {
+            mystl::destroy(buffer_ + (head & mask_));
+        }
+        head_.store(head, std::memory_order_relaxed);
+        tail_cache_ = head_cache_ = head;
+    }
+
+private:
+    // 生产者还能写入的空位，只在缓存的head不够时才去读真正的head_
+    size_type free_slots(size_type tail, size_type want) {
+        size_type free = capacity() - (tail - head_cache_);
+        if(free < want) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            free = capacity() - (tail - head_cache_);
+        }
+        return free;
+    }
+
+    // 消费者可以读出的元素个数
+    size_type ready_slots(size_type head, size_type want) {
+        size_type ready = tail_cache_ - head;
+        if(ready < want) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            ready = tail_cache_ - head;
+        }
+        return ready;
+    }
+
+    void wait_not_full() {
+        not_full_.wait_until([this] {
+            return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) < capacity();
+        });
+    }
+
+    void wait_not_empty() {
+        not_empty_.wait_until([this] {
+            return tail_.load(std::memory_order_acquire) != head_.load(std::memory_order_relaxed);
+        });
+    }
+};
+
+template <class T>
+template <class... Args>
+bool spsc_queue<T>::try_emplace(Args&&... args) {
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    if(free_slots(tail, 1) == 0) {
+        return false;
+    }
+    mystl::construct(buffer_ + (tail & mask_), mystl::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);  // 发布，消费者acquire以后一定能看到构造好的对象
+    not_empty_.notify();
+    return true;
+}
+
+template <class T>
+template <class Iterator>
+typename spsc_queue<T>::size_type
+spsc_queue<T>::try_push_bulk(Iterator first, size_type n) {
+    const size_type tail = tail_.load(std::memory_order_relaxed);
+    size_type free = free_slots(tail, n);
+    if(n > free) n = free;
+    if(n == 0) return 0;
+
+    for(size_type i = 0 ; i < n ; ++i, ++first) {
+        mystl::construct(buffer_ + ((tail + i) & mask_), *first);
+    }
+    tail_.store(tail + n, std::memory_order_release);
+    not_empty_.notify();
+    return n;
+}
+
+template <class T>
+bool spsc_queue<T>::try_pop(value_type& value) {
+    const size_type head = head_.load(std::memory_order_relaxed);
+    if(ready_slots(head, 1) == 0) {
+        return false;
+    }
+    T* slot = buffer_ + (head & mask_);
+    value = mystl::move(*slot);
+    mystl::destroy(slot);
+    head_.store(head + 1, std::memory_order_release);  // 归还空位
+    not_full_.notify();
+    return true;
+}
+
+template <class T>
+void spsc_queue<T>::pop() {
+    MYSTL_DEBUG(!empty());
+    const size_type head = head_.load(std::memory_order_relaxed);
+    ready_slots(head, 1);   // 保证 tail_cache_ 不会落后于新的head
+    mystl::destroy(buffer_ + (head & mask_));
+    head_.store(head + 1, std::memory_order_release);
+    not_full_.notify();
+}
+
+template <class T>
+template <class OutputIterator>
+typename spsc_queue<T>::size_type
+spsc_queue<T>::try_pop_bulk(OutputIterator result, size_type n) {
+    const size_type head = head_.load(std::memory_order_relaxed);
+    size_type ready = ready_slots(head, n);
+    if(n > ready) n = ready;
+    if(n == 0) return 0;
+
+    for(size_type i = 0 ; i < n ; ++i, ++result) {
+        T* slot = buffer_ + ((head + i) & mask_);
+        *result = mystl::move(*slot);
+        mystl::destroy(slot);
+    }
+    head_.store(head + n, std::memory_order_release);
+    not_full_.notify();
+    return n;
+}
+
+}
+
+#endif
@@ -73,6 +73,7 @@ void uninitialized_fill_aux(ForwardIterator first, ForwardIterator last, const T
     }catch(...) {
         std::cerr << "uninitialized_fill error!" << std::endl;
         mystl::destroy(first, cur);
+        throw;
     }
 }
 
@@ -99,6 +100,7 @@ ForwardIterator uninitialized_fill_n_aux(ForwardIterator first, Size n, const Tp
     }catch(...) {
         std::cerr << "uninitialized_fill_n error!" << std::endl;
         mystl::destroy(first, cur);
+        throw;
     }
 }
 
@@ -125,6 +127,7 @@ ForwardIterator uninitialized_move_aux(InputIterator first, InputIterator last,
         return cur;
     }catch(...) {
         mystl::destroy(result, cur);
+        throw;
     }
 }
 
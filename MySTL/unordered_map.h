@@ -7,11 +7,12 @@
 namespace mystl {
 
 // 第一个参数为key，第二个参数为value，第三个参数为哈希函数，第四个参数为判断key是否相等
-template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class RangePolicy = hashtable_fastmod_policy>
 class unordered_map {
 private:
     typedef hashtable<Key, mystl::pair</* const */Key, T>, Hash, 
-                    mystl::select1st<mystl::pair</* const */Key, T>>, KeyEqual> base_type;
+                    mystl::select1st<mystl::pair</* const */Key, T>>, KeyEqual, RangePolicy> base_type;
     base_type ht_;
 
 public:
@@ -186,6 +187,16 @@ public:
         return ht_.equal_range(key);
     }
 
+    // 异构查找，hasher和key_equal都定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = typename base_type::template if_transparent<K>>
+    iterator find(const K& key) { return ht_.find(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    size_type count(const K& key) const { return ht_.count(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    pair<iterator, iterator> equal_range(const K& key) { return ht_.equal_range(key); }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return ht_.erase(key); }
+
 
     // bucket
     void resize(size_type hint) { ht_.resize(); }
@@ -198,6 +209,10 @@ public:
         return ht_.elems_in_bucket(bucket_idx);
     }
 
+    // 扩容时把搬迁结点分摊到之后的插入里，避免单次插入卡住，见hashtable::set_incremental_rehash
+    void set_incremental_rehash(bool on) { ht_.set_incremental_rehash(on); }
+    bool incremental_rehash() const { return ht_.incremental_rehash(); }
+
 };
 
 }
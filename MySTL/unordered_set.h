@@ -5,11 +5,12 @@
 
 namespace mystl {
 
-template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class RangePolicy = hashtable_fastmod_policy>
 class unordered_set {
 private:
     // 用一个哈希表作为成员，KeyofValue为identity
-    typedef hashtable<Key, Key, Hash, mystl::identity<Key>, KeyEqual> base_type;
+    typedef hashtable<Key, Key, Hash, mystl::identity<Key>, KeyEqual, RangePolicy> base_type;
     base_type   ht_;
 
 public:
@@ -142,6 +143,16 @@ public:
         return ht_.equal_range(key);
     }  
 
+    // 异构查找，hasher和key_equal都定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = typename base_type::template if_transparent<K>>
+    iterator find(const K& key) { return ht_.find(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    size_type count(const K& key) const { return ht_.count(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    pair<iterator, iterator> equal_range(const K& key) { return ht_.equal_range(key); }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return ht_.erase(key); }
+
     void swap(unordered_set& other) {
         ht_.swap(other.ht_);
     }
@@ -158,23 +169,28 @@ public:
     size_type elems_in_bucket(size_type bucket_idx) const {
         return ht_.elems_in_bucket(bucket_idx);
     }
+
+    // 扩容时把搬迁结点分摊到之后的插入里，避免单次插入卡住，见hashtable::set_incremental_rehash
+    void set_incremental_rehash(bool on) { ht_.set_incremental_rehash(on); }
+    bool incremental_rehash() const { return ht_.incremental_rehash(); }
 };
 // hashtable不提供operator==，因为是无序关联式容器
 // 重载swap
-template <class Key, class Hash, class KeyEqual>
-void swap(unordered_set<Key, Hash, KeyEqual>& lhs, 
-          unordered_set<Key, Hash, KeyEqual>& rhs) {
+template <class Key, class Hash, class KeyEqual, class RangePolicy>
+void swap(unordered_set<Key, Hash, KeyEqual, RangePolicy>& lhs, 
+          unordered_set<Key, Hash, KeyEqual, RangePolicy>& rhs) {
     lhs.swap(rhs);
 }
 
 
 // unordered_multiset 区别就是在与insert_equal
 
-template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class RangePolicy = hashtable_fastmod_policy>
 class unordered_multiset {
 private:
     // 用一个哈希表作为成员，KeyofValue为identity
-    typedef hashtable<Key, Key, Hash, mystl::identity<Key>, KeyEqual> base_type;
+    typedef hashtable<Key, Key, Hash, mystl::identity<Key>, KeyEqual, RangePolicy> base_type;
     base_type   ht_;
 
 public:
@@ -307,6 +323,16 @@ public:
         return ht_.equal_range(key);
     }
 
+    // 异构查找，hasher和key_equal都定义了is_transparent时可用，不用构造临时的key
+    template <class K, class = typename base_type::template if_transparent<K>>
+    iterator find(const K& key) { return ht_.find(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    size_type count(const K& key) const { return ht_.count(key); }
+    template <class K, class = typename base_type::template if_transparent<K>>
+    pair<iterator, iterator> equal_range(const K& key) { return ht_.equal_range(key); }
+    template <class K, class = typename base_type::template if_transparent_key<K>>
+    size_type erase(const K& key) { return ht_.erase(key); }
+
     void swap(unordered_multiset& other) {
         ht_.swap(other.ht_);
     }
@@ -323,12 +349,16 @@ public:
     size_type elems_in_bucket(size_type bucket_idx) const {
         return ht_.elems_in_bucket(bucket_idx);
     }
+
+    // 扩容时把搬迁结点分摊到之后的插入里，避免单次插入卡住，见hashtable::set_incremental_rehash
+    void set_incremental_rehash(bool on) { ht_.set_incremental_rehash(on); }
+    bool incremental_rehash() const { return ht_.incremental_rehash(); }
 };
 
 // 重载swap
-template <class Key, class Hash, class KeyEqual>
-void swap(unordered_multiset<Key, Hash, KeyEqual>& lhs, 
-          unordered_multiset<Key, Hash, KeyEqual>& rhs) {
+template <class Key, class Hash, class KeyEqual, class RangePolicy>
+void swap(unordered_multiset<Key, Hash, KeyEqual, RangePolicy>& lhs, 
+          unordered_multiset<Key, Hash, KeyEqual, RangePolicy>& rhs) {
     lhs.swap(rhs);
 }
 
@@ -0,0 +1,612 @@
+#ifndef __UNROLLED_LIST_H__
+#define __UNROLLED_LIST_H__
+
+#include <initializer_list>
+
+#include "allocator.h"
+#include "construct.h"
+#include "algobase.h"
+#include "exceptdef.h"
+#include "iterator.h"
+#include "type_traits.h"
+#include "util.h"
+
+// 这个文件定义了unrolled_list，展开链表：每个结点存放一小段连续的元素
+
+/*
+* 普通的list每个元素一个结点，两个指针16字节的额外开销，遍历时每一步都可能cache miss。
+* vector在中间插入是O(n)的。unrolled_list折中一下：双向循环链表的每个结点里放一个小数组，
+* 默认整个结点大约256字节，结点内部的元素是连续的，从data()[0]开始存放count_个。
+*
+* 迭代器由 (结点指针, 结点内下标) 组成，end()是(header_, 0)。
+*
+* 插入：
+*   结点没满，结点内把后面的元素往后挪一位，最多挪N个，O(1)。
+*   结点满了，如果插在结点的最后（比如push_back）或者最前面（push_front），直接新建一个结点，这样顺序插入时结点都是满的；
+*   否则把结点从中间分裂成两个半满的结点，再插入。
+* 删除：
+*   结点内把后面的元素往前挪一位。结点空了就释放；
+*   不足半满时，如果和后继（或者前驱）结点加起来放得下，就合并成一个结点，这样相邻两个结点的平均装载率不低于一半。
+*
+* 插入和删除会让被修改的结点（以及分裂/合并涉及的结点）上的迭代器失效，insert和erase会返回新的有效迭代器。
+* 结点内移动元素要求T的移动构造和移动赋值不抛出异常。
+*/
+
+namespace mystl {
+
+// 结点大小，包括两个指针和一个计数
+#ifndef MYSTL_UNROLLED_LIST_NODE_BYTES
+#define MYSTL_UNROLLED_LIST_NODE_BYTES 256
+#endif
+
+// 根据T的大小决定一个结点放多少个元素，至少4个
+template <class T>
+struct unrolled_list_node_size {
+    static constexpr size_t bytes = MYSTL_UNROLLED_LIST_NODE_BYTES - 3 * sizeof(void*);
+    static constexpr size_t value = bytes / sizeof(T) < 4 ? 4 : bytes / sizeof(T);
+};
+
+// 结点的链接部分，头结点只有这一部分
+struct unrolled_list_node_base {
+    unrolled_list_node_base* prev_;
+    unrolled_list_node_base* next_;
+};
+
+template <class T, size_t N>
+struct unrolled_list_node : public unrolled_list_node_base {
+    size_t count_;                              // 结点内元素个数
+    alignas(T) unsigned char data_[N * sizeof(T)];  // 未初始化的内存
+
+    T* data() { return reinterpret_cast<T*>(data_); }
+};
+
+// 迭代器的设计
+template <class T, size_t N, class Ref, class Ptr>
+struct unrolled_list_iterator {
+    typedef unrolled_list_iterator<T, N, T&, T*> iterator;
+    typedef unrolled_list_iterator<T, N, const T&, const T*> const_iterator;
+    typedef unrolled_list_iterator self;
+
+    typedef bidirectional_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef Ptr pointer;
+    typedef Ref reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    typedef unrolled_list_node_base* base_ptr;
+    typedef unrolled_list_node<T, N>* node_ptr;
+
+    base_ptr node_;     // 所在结点
+    size_type index_;   // 结点内的下标
+
+    unrolled_list_iterator() : node_(nullptr), index_(0) {}
+    unrolled_list_iterator(base_ptr x, size_type i) : node_(x), index_(i) {}
+    unrolled_list_iterator(const iterator& rhs) : node_(rhs.node_), index_(rhs.index_) {}
+
+    node_ptr node() const { return static_cast<node_ptr>(node_); }
+
+    reference operator*() const { return node()->data()[index_]; }
+    pointer operator->() const { return &(operator*()); }
+
+    self& operator++() {
+        if(++index_ == node()->count_) {
+            node_ = node_->next_;
+            index_ = 0;
+        }
+        return *this;
+    }
+
+    self operator++(int) {
+        self tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    self& operator--() {
+        if(index_ == 0) {
+            node_ = node_->prev_;
+            index_ = node()->count_;
+        }
+        --index_;
+        return *this;
+    }
+
+    self operator--(int) {
+        self tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    bool operator==(const self& rhs) const { return node_ == rhs.node_ && index_ == rhs.index_; }
+    bool operator!=(const self& rhs) const { return !(*this == rhs); }
+};
+
+// 模板类 unrolled_list，N为每个结点存放的元素个数
+template <class T, size_t N = unrolled_list_node_size<T>::value>
+class unrolled_list {
+    static_assert(N >= 2, "unrolled_list node must hold at least 2 elements");
+
+public:
+    typedef mystl::allocator<T> allocator_type;
+    typedef mystl::allocator<T> data_allocator;
+    typedef mystl::allocator<unrolled_list_node<T, N>> node_allocator;
+    typedef mystl::allocator<unrolled_list_node_base> base_allocator;
+
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    typedef unrolled_list_iterator<T, N, T&, T*> iterator;
+    typedef unrolled_list_iterator<T, N, const T&, const T*> const_iterator;
+    typedef mystl::reverse_iterator<iterator> reverse_iterator;
+    typedef mystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    typedef unrolled_list_node_base* base_ptr;
+    typedef unrolled_list_node<T, N>* node_ptr;
+
+private:
+    base_ptr header_;   // 头结点，环形链表
+    size_type size_;    // 元素个数
+
+public:
+    // 构造、移动、拷贝、赋值和析构函数
+    unrolled_list() { init(); }
+
+    explicit unrolled_list(size_type n) {
+        init();
+        fill_append(n, value_type());
+    }
+
+    unrolled_list(size_type n, const value_type& value) {
+        init();
+        fill_append(n, value);
+    }
+
+    template <class Iterator>
+    unrolled_list(Iterator first, Iterator last) {
+        typedef typename is_integral<Iterator>::value is_Int;
+        init();
+        range_init_aux(first, last, is_Int());
+    }
+
+    unrolled_list(std::initializer_list<T> ilist) {
+        init();
+        copy_append(ilist.begin(), ilist.end());
+    }
+
+    unrolled_list(const unrolled_list& rhs) {
+        init();
+        copy_append(rhs.begin(), rhs.end());
+    }
+
+    unrolled_list(unrolled_list&& rhs) noexcept : header_(rhs.header_), size_(rhs.size_) {
+        rhs.header_ = nullptr;
+        rhs.size_ = 0;
+    }
+
+    unrolled_list& operator=(const unrolled_list& rhs) {
+        if(this != &rhs) {
+            unrolled_list tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    unrolled_list& operator=(unrolled_list&& rhs) noexcept {
+        unrolled_list tmp(mystl::move(rhs));
+        swap(tmp);
+        return *this;
+    }
+
+    unrolled_list& operator=(std::initializer_list<T> ilist) {
+        unrolled_list tmp(ilist);
+        swap(tmp);
+        return *this;
+    }
+
+    ~unrolled_list() {
+        if(header_) {
+            clear();
+            base_allocator::deallocate(header_);
+            header_ = nullptr;
+        }
+    }
+
+public:
+    // 迭代器相关操作
+    iterator begin() { return iterator(header_->next_, 0); }
+    const_iterator begin() const { return const_iterator(header_->next_, 0); }
+    iterator end() { return iterator(header_, 0); }
+    const_iterator end() const { return const_iterator(header_, 0); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    // 容量相关操作
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+
+    // 每个结点最多存放的元素个数
+    static constexpr size_type node_capacity() { return N; }
+
+    // 元素访问相关操作
+    reference front() {
+        MYSTL_DEBUG(!empty());
+        return *begin();
+    }
+
+    const_reference front() const {
+        MYSTL_DEBUG(!empty());
+        return *begin();
+    }
+
+    reference back() {
+        MYSTL_DEBUG(!empty());
+        return *(--end());
+    }
+
+    const_reference back() const {
+        MYSTL_DEBUG(!empty());
+        return *(--end());
+    }
+
+    // insert / emplace
+    template <class... Args>
+    iterator emplace(iterator pos, Args&&... args);
+
+    iterator insert(iterator pos, const value_type& value) { return emplace(pos, value); }
+    iterator insert(iterator pos, value_type&& value) { return emplace(pos, mystl::move(value)); }
+
+    // 插入n个value，返回第一个插入的元素
+    iterator insert(iterator pos, size_type n, const value_type& value);
+
+    template <class Iterator>
+    iterator insert(iterator pos, Iterator first, Iterator last) {
+        typedef typename is_integral<Iterator>::value is_Int;
+        return range_insert_aux(pos, first, last, is_Int());
+    }
+
+    template <class... Args>
+    void emplace_back(Args&&... args) { emplace(end(), mystl::forward<Args>(args)...); }
+
+    template <class... Args>
+    void emplace_front(Args&&... args) { emplace(begin(), mystl::forward<Args>(args)...); }
+
+    void push_back(const value_type& value) { emplace(end(), value); }
+    void push_back(value_type&& value) { emplace(end(), mystl::move(value)); }
+    void push_front(const value_type& value) { emplace(begin(), value); }
+    void push_front(value_type&& value) { emplace(begin(), mystl::move(value)); }
+
+    void pop_front() {
+        MYSTL_DEBUG(!empty());
+        erase(begin());
+    }
+
+    void pop_back() {
+        MYSTL_DEBUG(!empty());
+        erase(--end());
+    }
+
+    // erase，返回被删除元素的下一个元素的迭代器
+    iterator erase(iterator pos);
+    iterator erase(iterator first, iterator last);
+
+    void clear();
+
+    void resize(size_type new_size) { resize(new_size, value_type()); }
+    void resize(size_type new_size, const value_type& value);
+
+    void swap(unrolled_list& rhs) noexcept {
+        mystl::swap(header_, rhs.header_);
+        mystl::swap(size_, rhs.size_);
+    }
+
+private:
+    static node_ptr as_node(base_ptr x) { return static_cast<node_ptr>(x); }
+
+    void init() {
+        header_ = base_allocator::allocate(1);
+        header_->prev_ = header_->next_ = header_;
+        size_ = 0;
+    }
+
+    // 创建一个空结点，不构造任何元素
+    node_ptr create_node() {
+        node_ptr x = node_allocator::allocate(1);
+        x->count_ = 0;
+        return x;
+    }
+
+    // 析构结点内的元素并释放结点
+    void destroy_node(node_ptr x) {
+        mystl::destroy(x->data(), x->data() + x->count_);
+        node_allocator::deallocate(x);
+    }
+
+    // 把x连接到pos之前
+    static void link_before(base_ptr pos, base_ptr x) {
+        x->next_ = pos;
+        x->prev_ = pos->prev_;
+        pos->prev_->next_ = x;
+        pos->prev_ = x;
+    }
+
+    static void unlink(base_ptr x) {
+        x->prev_->next_ = x->next_;
+        x->next_->prev_ = x->prev_;
+    }
+
+    // 把满结点x的后一半移动到新结点，新结点连接在x之后并返回
+    node_ptr split_node(node_ptr x);
+
+    // 把x的后继结点的元素全部移动到x的末尾，并释放后继结点
+    void merge_next(node_ptr x);
+
+    // 在结点x的下标i处放入value，x一定没有满
+    static void insert_in_node(node_ptr x, size_type i, value_type&& value);
+
+    void fill_append(size_type n, const value_type& value) {
+        try {
+            for(; n > 0 ; --n) emplace(end(), value);
+        } catch(...) {
+            clear();
+            base_allocator::deallocate(header_);
+            header_ = nullptr;
+            throw;
+        }
+    }
+
+    template <class Integer>
+    void range_init_aux(Integer n, Integer value, true_type) {
+        fill_append(n, value);
+    }
+
+    template <class Iterator>
+    void range_init_aux(Iterator first, Iterator last, false_type) {
+        copy_append(first, last);
+    }
+
+    template <class Integer>
+    iterator range_insert_aux(iterator pos, Integer n, Integer value, true_type) {
+        return insert(pos, static_cast<size_type>(n), static_cast<value_type>(value));
+    }
+
+    template <class Iterator>
+    iterator range_insert_aux(iterator pos, Iterator first, Iterator last, false_type);
+
+    template <class Iterator>
+    void copy_append(Iterator first, Iterator last) {
+        try {
+            for(; first != last ; ++first) emplace(end(), *first);
+        } catch(...) {
+            clear();
+            base_allocator::deallocate(header_);
+            header_ = nullptr;
+            throw;
+        }
+    }
+};
+
+template <class T, size_t N>
+typename unrolled_list<T, N>::node_ptr
+unrolled_list<T, N>::split_node(node_ptr x) {
+    node_ptr y = create_node();
+    const size_type half = x->count_ / 2;
+    T* src = x->data();
+    T* dst = y->data();
+    for(size_type i = half ; i < x->count_ ; ++i) {
+        mystl::construct(dst + (i - half), mystl::move(src[i]));
+        mystl::destroy(src + i);
+    }
+    y->count_ = x->count_ - half;
+    x->count_ = half;
+    link_before(x->next_, y);
+    return y;
+}
+
+template <class T, size_t N>
+void unrolled_list<T, N>::merge_next(node_ptr x) {
+    node_ptr y = as_node(x->next_);
+    T* src = y->data();
+    T* dst = x->data() + x->count_;
+    for(size_type i = 0 ; i < y->count_ ; ++i) {
+        mystl::construct(dst + i, mystl::move(src[i]));
+        mystl::destroy(src + i);
+    }
+    x->count_ += y->count_;
+    unlink(y);
+    node_allocator::deallocate(y);
+}
+
+template <class T, size_t N>
+void unrolled_list<T, N>::insert_in_node(node_ptr x, size_type i, value_type&& value) {
+    T* p = x->data();
+    const size_type c = x->count_;
+    if(i == c) {
+        mystl::construct(p + c, mystl::move(value));
+    }else {
+        // 最后一个元素移动到未初始化的位置，其余往后移动一位
+        mystl::construct(p + c, mystl::move(p[c - 1]));
+        for(size_type k = c - 1 ; k > i ; --k) {
+            p[k] = mystl::move(p[k - 1]);
+        }
+        p[i] = mystl::move(value);
+    }
+    ++x->count_;
+}
+
+template <class T, size_t N>
+template <class... Args>
+typename unrolled_list<T, N>::iterator
+unrolled_list<T, N>::emplace(iterator pos, Args&&... args) {
+    // 先构造出来，既处理了args引用容器内元素的情况，也保证构造抛出异常时容器不变
+    value_type value(mystl::forward<Args>(args)...);
+
+    base_ptr b = pos.node_;
+    size_type i = pos.index_;
+    if(b == header_) {
+        // end()，放到最后一个结点的末尾
+        if(header_->prev_ == header_) {
+            link_before(header_, create_node());
+        }
+        b = header_->prev_;
+        i = as_node(b)->count_;
+    }else if(i == 0 && b->prev_ != header_ && as_node(b->prev_)->count_ < N) {
+        // 插在结点的最前面，前驱还有空位就放到前驱的末尾，不用挪动元素
+        b = b->prev_;
+        i = as_node(b)->count_;
+    }
+
+    node_ptr x = as_node(b);
+    if(x->count_ == N) {
+        if(i == N) {
+            // 插在满结点的最后，新建结点
+            node_ptr y = create_node();
+            link_before(x->next_, y);
+            x = y;
+            i = 0;
+        }else if(i == 0) {
+            // 插在满结点的最前面，新建结点
+            node_ptr y = create_node();
+            link_before(x, y);
+            x = y;
+        }else {
+            node_ptr y = split_node(x);
+            if(i > x->count_) {
+                i -= x->count_;
+                x = y;
+            }
+        }
+    }
+    insert_in_node(x, i, mystl::move(value));
+    ++size_;
+    return iterator(x, i);
+}
+
+// 依次插在上一个新元素的后面，前面的元素可能因为分裂换了结点，所以最后从最后一个新元素往回走到第一个
+template <class T, size_t N>
+typename unrolled_list<T, N>::iterator
+unrolled_list<T, N>::insert(iterator pos, size_type n, const value_type& value) {
+    if(n == 0) return pos;
+    iterator cur = emplace(pos, value);
+    for(size_type k = 1 ; k < n ; ++k) {
+        cur = emplace(++cur, value);
+    }
+    for(size_type k = 1 ; k < n ; ++k) --cur;
+    return cur;
+}
+
+template <class T, size_t N>
+template <class Iterator>
+typename unrolled_list<T, N>::iterator
+unrolled_list<T, N>::range_insert_aux(iterator pos, Iterator first, Iterator last, false_type) {
+    if(first == last) return pos;
+    iterator cur = emplace(pos, *first);
+    size_type n = 1;
+    for(++first ; first != last ; ++first, ++n) {
+        cur = emplace(++cur, *first);
+    }
+    for(; n > 1 ; --n) --cur;
+    return cur;
+}
+
+template <class T, size_t N>
+typename unrolled_list<T, N>::iterator
+unrolled_list<T, N>::erase(iterator pos) {
+    MYSTL_DEBUG(pos != end());
+    node_ptr x = pos.node();
+    size_type i = pos.index_;
+    T* p = x->data();
+    for(size_type k = i ; k + 1 < x->count_ ; ++k) {
+        p[k] = mystl::move(p[k + 1]);
+    }
+    mystl::destroy(p + x->count_ - 1);
+    --x->count_;
+    --size_;
+
+    if(x->count_ == 0) {
+        base_ptr next = x->next_;
+        unlink(x);
+        node_allocator::deallocate(x);
+        return iterator(next, 0);
+    }
+
+    // 不足半满，尝试和相邻的结点合并
+    if(x->count_ < N / 2) {
+        if(x->next_ != header_ && x->count_ + as_node(x->next_)->count_ <= N) {
+            merge_next(x);
+        }else if(x->prev_ != header_ && x->count_ + as_node(x->prev_)->count_ <= N) {
+            node_ptr prev = as_node(x->prev_);
+            i += prev->count_;
+            merge_next(prev);
+            x = prev;
+        }
+    }
+    if(i == x->count_) return iterator(x->next_, 0);
+    return iterator(x, i);
+}
+
+template <class T, size_t N>
+typename unrolled_list<T, N>::iterator
+unrolled_list<T, N>::erase(iterator first, iterator last) {
+    // 合并结点会让last失效，所以先数出个数
+    size_type n = mystl::distance(first, last);
+    for(; n > 0 ; --n) {
+        first = erase(first);
+    }
+    return first;
+}
+
+template <class T, size_t N>
+void unrolled_list<T, N>::clear() {
+    base_ptr cur = header_->next_;
+    while(cur != header_) {
+        base_ptr next = cur->next_;
+        destroy_node(as_node(cur));
+        cur = next;
+    }
+    header_->prev_ = header_->next_ = header_;
+    size_ = 0;
+}
+
+template <class T, size_t N>
+void unrolled_list<T, N>::resize(size_type new_size, const value_type& value) {
+    while(size_ > new_size) pop_back();
+    while(size_ < new_size) emplace(end(), value);
+}
+
+// 重载比较操作符
+template <class T, size_t N>
+bool operator==(const unrolled_list<T, N>& lhs, const unrolled_list<T, N>& rhs) {
+    return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, size_t N>
+bool operator!=(const unrolled_list<T, N>& lhs, const unrolled_list<T, N>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <class T, size_t N>
+bool operator<(const unrolled_list<T, N>& lhs, const unrolled_list<T, N>& rhs) {
+    return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, size_t N>
+void swap(unrolled_list<T, N>& lhs, unrolled_list<T, N>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif
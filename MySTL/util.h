@@ -56,6 +56,33 @@ void swap(Tp& lhs, Tp& rhs) {
     rhs = mystl::move(tmp);
 }
 
+// 告诉有序容器输入区间已经排好序，可以跳过查找直接建树
+// sorted_unique：严格递增，没有重复键值；sorted_equivalent：非递减，允许重复键值
+struct sorted_unique_t { explicit sorted_unique_t() = default; };
+constexpr sorted_unique_t sorted_unique{};
+
+struct sorted_equivalent_t { explicit sorted_equivalent_t() = default; };
+constexpr sorted_equivalent_t sorted_equivalent{};
+
+// 成员指针Ptr对应的字节偏移，相当于offsetof，但是接受成员指针
+// 标准布局保证偏移对所有T对象都一样，于是第一次调用时构造一个临时的T，从这个真实对象上量出偏移并缓存，之后只读缓存
+template <class T, class Member, Member T::*Ptr>
+inline ptrdiff_t member_offset() {
+    static_assert(std::is_standard_layout<T>::value, "member_offset requires a standard-layout type");
+    static_assert(std::is_default_constructible<T>::value, "member_offset requires a default-constructible type");
+    static const ptrdiff_t offset = [] {
+        const T object{};
+        return reinterpret_cast<const char*>(&(object.*Ptr)) - reinterpret_cast<const char*>(&object);
+    }();
+    return offset;
+}
+
+// 由成员的地址和成员指针得到所属对象的地址，侵入式容器用它从hook找回对象
+template <class T, class Member, Member T::*Ptr>
+T* owner_of(Member* member) {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(member) - member_offset<T, Member, Ptr>());
+}
+
 // pair
 template <class T1, class T2>
 struct pair{
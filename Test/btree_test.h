@@ -0,0 +1,166 @@
+#ifndef __BTREE_TEST_H__
+#define __BTREE_TEST_H__
+
+#include <iostream>
+#include <set>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "../MySTL/btree_set.h"
+#include "../MySTL/btree_map.h"
+#include "../MySTL/set.h"
+#include "../MySTL/map.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace btree_test {
+
+void test() {
+    std::cout << "--------------------------btree_set / btree_map test-----------------------" << std::endl;
+    int a[] = { 5,4,3,2,1 };
+    mystl::btree_set<int> s1;
+    mystl::btree_set<int> s2(a, a + 5);
+    mystl::btree_set<int> s3{ 9,1,8,2,7,3 };
+    mystl::btree_set<int> s4(s3);
+    mystl::btree_set<int> s5(std::move(s4));
+    mystl::btree_multiset<int> ms1{ 3,1,3,2,3 };
+
+    FUN_AFTER(s1, s1.insert(a, a + 5));
+    FUN_AFTER(s1, s1.insert(s1.end(), 6));
+    FUN_AFTER(s1, s1.emplace(0));
+    FUN_AFTER(s1, s1.erase(s1.begin()));
+    FUN_AFTER(s1, s1.erase(3));
+    FUN_AFTER(s1, s1.erase(s1.find(4), s1.end()));
+    FUN_VALUE(*s3.lower_bound(4));
+    FUN_VALUE(*s3.upper_bound(8));
+    FUN_VALUE(*s3.rbegin());
+    FUN_VALUE(ms1.count(3));
+    FUN_AFTER(ms1, ms1.erase(3));
+    std::cout << std::boolalpha;
+    FUN_VALUE((s3.find(5) == s3.end()));
+    FUN_VALUE((s2 == mystl::btree_set<int>{ 1,2,3,4,5 }));
+    std::cout << std::noboolalpha;
+    FUN_AFTER(s1, s1.swap(s5));
+
+    mystl::btree_map<int, int> m1;
+    for(int i = 0 ; i < 5 ; ++i) m1[i] = i * i;
+    m1.insert(mystl::pair<int, int>(2, 100));  // 已存在，插入失败
+    std::cout << "m1 :";
+    for(auto& p : m1) std::cout << " <" << p.first << "," << p.second << ">";
+    std::cout << std::endl;
+    FUN_VALUE(m1.at(3));
+    mystl::btree_multimap<int, int> mm1;
+    for(int i = 0 ; i < 6 ; ++i) mm1.insert(mystl::pair<int, int>(i % 2, i));   // 相等的键保持插入顺序
+    std::cout << "mm1 :";
+    for(auto& p : mm1) std::cout << " <" << p.first << "," << p.second << ">";
+    std::cout << std::endl;
+    FUN_VALUE(mm1.count(1));
+
+    // 一个结点能放多少个元素
+    FUN_VALUE((mystl::btree<int, int>::N));
+    FUN_VALUE(sizeof(mystl::btree<int, int>::leaf_node));
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    srand(time(0));
+    mystl::vector<int> keys(M);
+    for(int i = 0 ; i < M ; ++i) keys[i] = rand();
+
+    std::set<int> stdSet;
+    mystl::set<int> mystlSet;
+    mystl::btree_set<int> btreeSet;
+
+    // 随机插入
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) stdSet.insert(keys[i]);
+    auto end = high_resolution_clock::now();
+    std::cout << "std::set insert " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) mystlSet.insert(keys[i]);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::set insert " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) btreeSet.insert(keys[i]);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::btree_set insert " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    // 随机查找
+    long long hits1 = 0, hits2 = 0, hits3 = 0;
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) hits1 += stdSet.find(keys[M - 1 - i] ^ (i & 1)) != stdSet.end();
+    end = high_resolution_clock::now();
+    std::cout << "std::set find " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) hits2 += mystlSet.find(keys[M - 1 - i] ^ (i & 1)) != mystlSet.end();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::set find " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) hits3 += btreeSet.find(keys[M - 1 - i] ^ (i & 1)) != btreeSet.end();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::btree_set find " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    std::cout << "find hits equal : " << (hits1 == hits2 && hits2 == hits3) << std::endl;
+
+    // 顺序遍历
+    long long sum1 = 0, sum2 = 0, sum3 = 0;
+    start = high_resolution_clock::now();
+    for(auto x : stdSet) sum1 += x;
+    end = high_resolution_clock::now();
+    std::cout << "std::set iterate " << stdSet.size() << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(auto x : mystlSet) sum2 += x;
+    end = high_resolution_clock::now();
+    std::cout << "mystl::set iterate " << mystlSet.size() << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(auto x : btreeSet) sum3 += x;
+    end = high_resolution_clock::now();
+    std::cout << "mystl::btree_set iterate " << btreeSet.size() << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    std::cout << "iterate sum equal : " << (sum1 == sum2 && sum2 == sum3) << std::endl;
+
+    // 内存：红黑树每个元素一个结点，B树每个结点放很多元素
+    std::cout << "mystl::set node bytes : " << mystlSet.size() * sizeof(mystl::rb_tree_node<int>) << std::endl;
+    std::cout << "mystl::btree_set node bytes : " << btreeSet.bytes_used() << ", height : " << btreeSet.height() << std::endl;
+
+    // 随机删除一半
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; i += 2) mystlSet.erase(keys[i]);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::set erase " << M / 2 << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; i += 2) btreeSet.erase(keys[i]);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::btree_set erase " << M / 2 << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    std::cout << "size equal : " << (mystlSet.size() == btreeSet.size()) << std::endl;
+
+    // map 随机插入
+    {
+        mystl::map<int, int> mystlMap;
+        mystl::btree_map<int, int> btreeMap;
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) mystlMap[keys[i]] = i;
+        end = high_resolution_clock::now();
+        std::cout << "mystl::map operator[] " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) btreeMap[keys[i]] = i;
+        end = high_resolution_clock::now();
+        std::cout << "mystl::btree_map operator[] " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+        std::cout << "size equal : " << (mystlMap.size() == btreeMap.size()) << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+}
+
+#endif
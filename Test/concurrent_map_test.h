@@ -0,0 +1,172 @@
+#ifndef __CONCURRENT_MAP_TEST_H__
+#define __CONCURRENT_MAP_TEST_H__
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <atomic>
+#include <thread>
+#include <shared_mutex>
+#include <mutex>
+#include <vector>
+
+#include "../MySTL/concurrent_map.h"
+#include "../MySTL/map.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace concurrent_map_test {
+
+// readers个线程共做total次查找，同时一个写者不停地插入删除（每次修改后让出CPU，模拟读多写少），返回读者用时ms
+template <class FindFn, class WriteFn>
+long long run_readers(int readers, int total, FindFn find, WriteFn write, long long& hits) {
+    std::atomic<bool> stop(false);
+    std::atomic<long long> sum(0);
+    std::thread writer([&] {
+        for(int i = 0 ; !stop.load(std::memory_order_relaxed) ; ++i) {
+            write(i);
+            std::this_thread::yield();
+        }
+    });
+    std::vector<std::thread> threads;
+    auto start = high_resolution_clock::now();
+    for(int r = 0 ; r < readers ; ++r) {
+        threads.push_back(std::thread([&, r] {
+            long long local = 0;
+            for(int i = r ; i < total ; i += readers) local += find(i);
+            sum += local;
+        }));
+    }
+    for(auto& t : threads) t.join();
+    auto end = high_resolution_clock::now();
+    stop = true;
+    writer.join();
+    hits = sum.load();
+    return duration_cast<milliseconds>(end - start).count();
+}
+
+void test() {
+    std::cout << "--------------------------concurrent_map test-----------------------" << std::endl;
+    mystl::concurrent_map<int, int> m1{ { 3,30 },{ 1,10 },{ 5,50 } };
+    MAP_COUT(m1);
+    FUN_VALUE(m1.insert(2, 20));
+    FUN_VALUE(m1.insert(2, 0));
+    FUN_VALUE(m1.insert_or_assign(3, 300));
+    FUN_VALUE(m1.erase(1));
+    FUN_VALUE(m1.erase(4));
+    MAP_COUT(m1);
+    FUN_VALUE(m1.find(3)->second);
+    FUN_VALUE(m1.lower_bound(4)->first);
+    FUN_VALUE(m1.upper_bound(2)->first);
+    FUN_VALUE(m1.count(5));
+    FUN_VALUE(m1.size());
+    int value = 0;
+    std::cout << std::boolalpha;
+    FUN_VALUE(m1.try_get(5, value));
+    FUN_VALUE((m1.find(1) == m1.end()));
+    m1.clear();
+    FUN_VALUE(m1.empty());
+    std::cout << std::noboolalpha;
+
+    // 写者插入删除的同时，读者扫描的结果始终有序
+    {
+        mystl::concurrent_map<int, int> m2;
+        std::atomic<bool> stop(false);
+        std::atomic<int> disorder(0);
+        std::thread writer([&] {
+            for(int i = 0 ; i < 100000 ; ++i) {
+                int k = (i * 7919) % 1000;
+                if(i & 1) m2.erase(k);
+                else m2.insert_or_assign(k, k);
+            }
+            stop = true;
+        });
+        std::thread reader([&] {
+            while(!stop.load()) {
+                int prev = -1;
+                for(auto& p : m2) {
+                    if(p.first <= prev || p.second != p.first) ++disorder;
+                    prev = p.first;
+                }
+            }
+        });
+        writer.join();
+        reader.join();
+        std::cout << "scan while writing, disorder : " << disorder.load() << std::endl;
+    }
+
+    // 每个epoch_domain各自给线程分配记录，一个domain的临界区不影响另一个domain推进epoch
+    {
+        mystl::epoch_domain d1;
+        std::cout << std::boolalpha;
+        {
+            mystl::epoch_domain d2;
+            d1.enter();
+            FUN_VALUE((d1.local_record() != d2.local_record()));
+            FUN_VALUE(d2.try_advance());
+            FUN_VALUE(d1.try_advance());
+            FUN_VALUE(d1.try_advance());
+            d1.exit();
+            std::thread t([&] { d2.retire(new int(0)); });
+            t.join();
+        }
+        mystl::epoch_domain d3;
+        FUN_VALUE((d3.local_record() != d1.local_record()));
+        std::cout << std::noboolalpha;
+    }
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // 读多写少：读者查找的同时有一个写者在改，对比 读写锁 + mystl::map
+    const int K = M / 10;
+    srand(time(0));
+    mystl::vector<int> keys(K);
+    for(int i = 0 ; i < K ; ++i) keys[i] = rand();
+
+    mystl::map<int, int> table;
+    std::shared_mutex rw;
+    mystl::concurrent_map<int, int> ctable;
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < K ; ++i) table[keys[i]] = i;
+    auto end = high_resolution_clock::now();
+    std::cout << "mystl::map insert " << K << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < K ; ++i) ctable.insert_or_assign(keys[i], i);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::concurrent_map insert " << K << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    const int readers[] = { 1, 2, 4, 8 };
+    for(int r : readers) {
+        long long hits1 = 0, hits2 = 0;
+        long long t1 = run_readers(r, M,
+            [&](int i) {
+                std::shared_lock<std::shared_mutex> lock(rw);
+                return table.find(keys[i % K]) != table.end();
+            },
+            [&](int i) {
+                std::unique_lock<std::shared_mutex> lock(rw);
+                if(i & 1) table.erase(-i);
+                else table[-i - 1] = i;
+            }, hits1);
+        long long t2 = run_readers(r, M,
+            [&](int i) { return ctable.contains(keys[i % K]); },
+            [&](int i) {
+                if(i & 1) ctable.erase(-i);
+                else ctable.insert_or_assign(-i - 1, i);
+            }, hits2);
+        std::cout << r << " readers + 1 writer, " << M << " finds : "
+                  << "shared_mutex + mystl::map " << t1 << " ms, "
+                  << "mystl::concurrent_map " << t2 << " ms, hits equal : " << (hits1 == hits2) << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef __CONCURRENT_UNORDERED_MAP_TEST_H__
+#define __CONCURRENT_UNORDERED_MAP_TEST_H__
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <vector>
+
+#include "../MySTL/concurrent_unordered_map.h"
+#include "../MySTL/unordered_map.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace concurrent_unordered_map_test {
+
+// threads个线程共做total次fn(i)，fn返回的值加起来放进hits，返回用时ms
+template <class Fn>
+long long run_threads(int threads, int total, Fn fn, long long& hits) {
+    std::atomic<long long> sum(0);
+    std::vector<std::thread> pool;
+    auto start = high_resolution_clock::now();
+    for(int t = 0 ; t < threads ; ++t) {
+        pool.push_back(std::thread([&, t] {
+            long long local = 0;
+            for(int i = t ; i < total ; i += threads) local += fn(i);
+            sum += local;
+        }));
+    }
+    for(auto& th : pool) th.join();
+    auto end = high_resolution_clock::now();
+    hits = sum.load();
+    return duration_cast<milliseconds>(end - start).count();
+}
+
+void test() {
+    std::cout << "--------------------------concurrent_unordered_map test-----------------------" << std::endl;
+    mystl::concurrent_unordered_map<int, int> m1{ { 3,30 },{ 1,10 },{ 5,50 } };
+    FUN_VALUE(m1.insert(2, 20));
+    FUN_VALUE(m1.insert(2, 0));
+    FUN_VALUE(m1.insert_or_assign(3, 300));
+    FUN_VALUE(m1.insert_or_update(7, [](int& v) { v += 70; }));
+    FUN_VALUE(m1.insert_or_update(7, [](int& v) { v += 70; }));
+    FUN_VALUE(m1.erase(1));
+    FUN_VALUE(m1.erase(4));
+    FUN_VALUE(m1.size());
+    int value = 0;
+    std::cout << std::boolalpha;
+    FUN_VALUE(m1.try_get(7, value));
+    FUN_VALUE(value);
+    FUN_VALUE(m1.contains(1));
+    FUN_VALUE(m1.visit(3, [](const int& v) { std::cout << "visit 3 : " << v << std::endl; }));
+    long long sum = 0;
+    m1.for_each([&](const mystl::pair<int, int>& p) { sum += p.second; });
+    FUN_VALUE(sum);
+    m1.clear();
+    FUN_VALUE(m1.empty());
+    std::cout << std::noboolalpha;
+
+    // 多个线程同时计数，表从很小开始，计数的同时在不停地扩容
+    {
+        mystl::concurrent_unordered_map<int, int> counter(16, 8);
+        const int threads = 4, total = 400000;
+        long long inserted = 0;
+        run_threads(threads, total, [&](int i) { return counter.insert_or_update(i % 50000, [](int& v) { ++v; }); }, inserted);
+        long long count = 0;
+        counter.for_each([&](const mystl::pair<int, int>& p) { count += p.second; });
+        std::cout << "concurrent counting, keys : " << counter.size() << ", inserted : " << inserted << ", sum : " << count
+                  << ", expected : " << total << ", buckets : " << counter.bucket_count() << std::endl;
+    }
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // 1到8个线程共做M次操作：90%查找，5%插入，5%删除，对比 一把mutex + mystl::unordered_map
+    const int K = M / 10;
+    srand(time(0));
+    mystl::vector<int> keys(2 * K);
+    for(int i = 0 ; i < 2 * K ; ++i) keys[i] = rand();
+
+    mystl::unordered_map<int, int> table;
+    std::mutex mtx;
+    mystl::concurrent_unordered_map<int, int> ctable;
+    for(int i = 0 ; i < K ; ++i) {
+        table.insert(mystl::pair<int, int>(keys[i], i));
+        ctable.insert(keys[i], i);
+    }
+
+    const int threads[] = { 1, 2, 4, 8 };
+    for(int t : threads) {
+        long long hits1 = 0, hits2 = 0;
+        long long t1 = run_threads(t, M, [&](int i) {
+            const int k = keys[(i * 7) % (2 * K)];
+            std::lock_guard<std::mutex> lock(mtx);
+            if(i % 20 == 0) table.insert(mystl::pair<int, int>(k, i));
+            else if(i % 20 == 1) table.erase(k);
+            else return static_cast<int>(table.count(k));
+            return 0;
+        }, hits1);
+        long long t2 = run_threads(t, M, [&](int i) {
+            const int k = keys[(i * 7) % (2 * K)];
+            if(i % 20 == 0) ctable.insert_or_assign(k, i);
+            else if(i % 20 == 1) ctable.erase(k);
+            else return static_cast<int>(ctable.count(k));
+            return 0;
+        }, hits2);
+        std::cout << t << " threads, " << M << " mixed operations : "
+                  << "mutex + mystl::unordered_map " << t1 << " ms, "
+                  << "mystl::concurrent_unordered_map " << t2 << " ms, hits : " << hits1 << " / " << hits2 << std::endl;
+    }
+
+    // 从空表开始并发插入，插入过程中一直在扩容
+    for(int t : threads) {
+        mystl::concurrent_unordered_map<int, int> grow;
+        long long inserted = 0;
+        long long ms = run_threads(t, M, [&](int i) { return static_cast<int>(grow.insert(keys[i % (2 * K)] ^ i, i)); }, inserted);
+        std::cout << t << " threads insert " << M << " elements from empty use the time :" << ms
+                  << " ms, size : " << grow.size() << " / " << inserted << ", buckets : " << grow.bucket_count() << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef __FLAT_HASH_TEST_H__
+#define __FLAT_HASH_TEST_H__
+
+#include <iostream>
+#include <unordered_map>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "../MySTL/flat_hash_set.h"
+#include "../MySTL/flat_hash_map.h"
+#include "../MySTL/unordered_map.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace flat_hash_test {
+
+void test() {
+    std::cout << "--------------------------flat_hash_set / flat_hash_map test-----------------------" << std::endl;
+    int a[] = { 5,3,1,3,4 };
+    mystl::flat_hash_set<int> s1;
+    mystl::flat_hash_set<int> s2(a, a + 5);
+    mystl::flat_hash_set<int> s3{ 9,1,8,2,7,3 };
+    mystl::flat_hash_set<int> s4(s3);
+
+    COUT(s2);
+    FUN_AFTER(s1, s1.insert(a, a + 5));
+    FUN_AFTER(s1, s1.insert(6));
+    FUN_AFTER(s1, s1.erase(3));
+    FUN_AFTER(s1, s1.erase(s1.find(5)));
+    FUN_AFTER(s4, s4.erase(s4.begin(), s4.end()));
+    FUN_VALUE(s3.count(8));
+    FUN_VALUE(s3.size());
+    FUN_VALUE(s3.bucket_count());
+    std::cout << std::boolalpha;
+    FUN_VALUE(s3.contains(2));
+    FUN_VALUE(s4.empty());
+    std::cout << std::noboolalpha;
+
+    mystl::flat_hash_map<int, int> m1{ { 3,30 },{ 1,10 },{ 2,20 },{ 1,100 } };
+    m1[5] = 50;
+    m1.insert(mystl::pair<int, int>(4, 40));
+    MAP_COUT(m1);
+    FUN_VALUE(m1.at(2));
+    FUN_VALUE(m1.find(3)->second);
+    FUN_VALUE(m1.try_emplace(3, 0).second);
+    FUN_VALUE(m1.erase(1));
+    FUN_VALUE(m1.erase(1));
+    FUN_VALUE(m1.size());
+    MAP_COUT(m1);
+    m1.clear();
+    FUN_VALUE(m1.size());
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // 随机key，查找一半命中一半不命中
+    srand(time(0));
+    mystl::vector<int> keys(M);
+    for(int i = 0 ; i < M ; ++i) keys[i] = rand();
+
+    std::unordered_map<int, int> stdUm;
+    mystl::unordered_map<int, int> mystlUm;
+    mystl::flat_hash_map<int, int> flatUm;
+
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) stdUm.insert(std::pair<int, int>(keys[i], i));
+    auto end = high_resolution_clock::now();
+    std::cout << "std::unordered_map insert " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) mystlUm.insert(mystl::pair<int, int>(keys[i], i));
+    end = high_resolution_clock::now();
+    std::cout << "mystl::unordered_map insert " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) flatUm.insert(mystl::pair<int, int>(keys[i], i));
+    end = high_resolution_clock::now();
+    std::cout << "mystl::flat_hash_map insert " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    long long sum1 = 0, sum2 = 0, sum3 = 0;
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) sum1 += stdUm.find(keys[M - 1 - i] ^ (i & 1)) != stdUm.end();
+    end = high_resolution_clock::now();
+    std::cout << "std::unordered_map find " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) sum2 += mystlUm.find(keys[M - 1 - i] ^ (i & 1)) != mystlUm.end();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::unordered_map find " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) sum3 += flatUm.find(keys[M - 1 - i] ^ (i & 1)) != flatUm.end();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::flat_hash_map find " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    std::cout << "size equal : " << (stdUm.size() == flatUm.size() && mystlUm.size() == flatUm.size()) << std::endl;
+    std::cout << "find hits equal : " << (sum1 == sum2 && sum2 == sum3) << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) stdUm.erase(keys[i]);
+    end = high_resolution_clock::now();
+    std::cout << "std::unordered_map erase " << M << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) mystlUm.erase(keys[i]);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::unordered_map erase " << M << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) flatUm.erase(keys[i]);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::flat_hash_map erase " << M << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    std::cout << "all erased : " << (stdUm.empty() && mystlUm.empty() && flatUm.empty()) << std::endl;
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef __FLAT_TEST_H__
+#define __FLAT_TEST_H__
+
+#include <iostream>
+#include <map>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "../MySTL/flat_set.h"
+#include "../MySTL/flat_map.h"
+#include "../MySTL/map.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace flat_test {
+
+void test() {
+    std::cout << "--------------------------flat_set / flat_map test-----------------------" << std::endl;
+    int a[] = { 5,3,1,3,4 };
+    mystl::flat_set<int> s1;
+    mystl::flat_set<int> s2(a, a + 5);
+    mystl::flat_set<int> s3{ 9,1,8,2,7,3 };
+    mystl::flat_set<int> s4(mystl::sorted_unique, s3.begin(), s3.end());
+
+    COUT(s2);
+    FUN_AFTER(s1, s1.insert(a, a + 5));
+    FUN_AFTER(s1, s1.insert(s3.begin(), s3.end()));
+    FUN_AFTER(s1, s1.insert(6));
+    FUN_AFTER(s1, s1.insert(s1.end(), 10));
+    FUN_AFTER(s1, s1.erase(s1.begin()));
+    FUN_AFTER(s1, s1.erase(8));
+    FUN_AFTER(s1, s1.erase(s1.find(4), s1.find(7)));
+    FUN_VALUE(*s1.lower_bound(5));
+    FUN_VALUE(*s1.upper_bound(7));
+    std::cout << std::boolalpha;
+    FUN_VALUE(s1.contains(9));
+    FUN_VALUE((s3 == s4));
+    std::cout << std::noboolalpha;
+
+    mystl::flat_map<int, int> m1{ { 3,30 },{ 1,10 },{ 2,20 },{ 1,100 } };
+    m1[5] = 50;
+    m1.insert(mystl::pair<int, int>(4, 40));
+    COUT(m1);
+    FUN_VALUE(m1.at(2));
+    FUN_VALUE(m1.find(3)->second);
+    FUN_VALUE(m1.rbegin()->second);
+    m1.rbegin()->second = 500;
+    FUN_VALUE(m1.crbegin()->first);
+    FUN_VALUE(m1.at(5));
+    FUN_AFTER(m1, m1.erase(1));
+    mystl::flat_multimap<int, int> mm1{ { 1,1 },{ 2,2 },{ 1,3 } };
+    mm1.insert(mystl::pair<int, int>(1, 4));
+    FUN_VALUE(mm1.count(1));
+    COUT(mm1);
+
+    // 乱序且有大量重复键的批量插入：flat_map保留最先出现的，flat_multimap保持插入顺序
+    mystl::vector<mystl::pair<int, int>> dup;
+    for(int i = 0 ; i < 60 ; ++i) dup.push_back(mystl::pair<int, int>((i * 7) % 5, i));
+    mystl::flat_map<int, int> m2(dup.begin(), dup.end());
+    COUT(m2);
+    mystl::flat_multimap<int, int> mm2(dup.begin(), dup.end());
+    mm2.insert(dup.begin(), dup.end());
+    bool in_order = true;
+    auto mit = mm2.begin();
+    for(int k = 0 ; k < 5 ; ++k) {
+        for(int round = 0 ; round < 2 ; ++round) {
+            for(int i = 0 ; i < 60 ; ++i) {
+                if(dup[i].first != k) continue;
+                if(mit == mm2.end() || mit->first != k || mit->second != i) in_order = false;
+                else ++mit;
+            }
+        }
+    }
+    std::cout << std::boolalpha;
+    FUN_VALUE(mm2.size());
+    FUN_VALUE(in_order);
+    std::cout << std::noboolalpha;
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // 一次建好，之后大量查询
+    srand(time(0));
+    mystl::vector<mystl::pair<int, int>> data;
+    data.reserve(M);
+    for(int i = 0 ; i < M ; ++i) data.push_back(mystl::pair<int, int>(rand(), i));
+
+    std::map<int, int> stdMap;
+    mystl::map<int, int> mystlMap;
+    mystl::flat_map<int, int> flatMap;
+
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) stdMap.insert(std::make_pair(data[i].first, data[i].second));
+    auto end = high_resolution_clock::now();
+    std::cout << "std::map build from " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    mystlMap.insert(data.begin(), data.end());
+    end = high_resolution_clock::now();
+    std::cout << "mystl::map build from " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    flatMap.insert(data.begin(), data.end());
+    end = high_resolution_clock::now();
+    std::cout << "mystl::flat_map build from " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    long long sum1 = 0, sum2 = 0, sum3 = 0;
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) sum1 += stdMap.find(data[M - 1 - i].first ^ (i & 1)) != stdMap.end();
+    end = high_resolution_clock::now();
+    std::cout << "std::map find " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) sum2 += mystlMap.find(data[M - 1 - i].first ^ (i & 1)) != mystlMap.end();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::map find " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) sum3 += flatMap.find(data[M - 1 - i].first ^ (i & 1)) != flatMap.end();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::flat_map find " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    std::cout << "size equal : " << (stdMap.size() == flatMap.size() && mystlMap.size() == flatMap.size()) << std::endl;
+    std::cout << "find hits equal : " << (sum1 == sum2 && sum2 == sum3) << std::endl;
+
+    // 顺序遍历
+    sum1 = sum3 = 0;
+    start = high_resolution_clock::now();
+    for(auto& p : stdMap) sum1 += p.first;
+    end = high_resolution_clock::now();
+    std::cout << "std::map iterate " << stdMap.size() << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(auto p : flatMap) sum3 += p.first;
+    end = high_resolution_clock::now();
+    std::cout << "mystl::flat_map iterate " << flatMap.size() << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    std::cout << "iterate key sum equal : " << (sum1 == sum3) << std::endl;
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef __FORWARD_LIST_TEST_H__
+#define __FORWARD_LIST_TEST_H__
+
+#include <iostream>
+#include <forward_list>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "../MySTL/forward_list.h"
+#include "../MySTL/list.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace forward_list_test {
+
+template <class Container>
+bool check(Container& con) {
+    auto it = con.begin();
+    if(it == con.end()) return true;
+    for(auto next = it ; ++next != con.end() ; it = next) {
+        if(*next < *it) return false;
+    }
+    return true;
+}
+
+void test() {
+    std::cout << "--------------------------forward_list test-----------------------" << std::endl;
+    int a[] = { 1,2,3,4,5 };
+    mystl::forward_list<int> l1;
+    mystl::forward_list<int> l2(5);
+    mystl::forward_list<int> l3(5, 1);
+    mystl::forward_list<int> l4(a, a + 5);
+    mystl::forward_list<int> l5(l4);
+    mystl::forward_list<int> l6(std::move(l5));
+    mystl::forward_list<int> l7{ 1,2,3,4,5,6,7,8,9 };
+    mystl::forward_list<int> l8;
+    l8 = l3;
+    mystl::forward_list<int> l9;
+    l9 = std::move(l3);
+
+    FUN_AFTER(l1, l1.assign(8, 8));
+    FUN_AFTER(l1, l1.assign(a, a + 5));
+    FUN_AFTER(l1, l1.assign({ 1,2,3,4,5,6 }));
+    FUN_AFTER(l1, l1.insert_after(l1.before_begin(), 0));
+    FUN_AFTER(l1, l1.insert_after(l1.begin(), 2, 7));
+    FUN_AFTER(l1, l1.insert_after(l1.before_begin(), a, a + 3));
+    FUN_AFTER(l1, l1.push_front(9));
+    FUN_AFTER(l1, l1.emplace_front(10));
+    FUN_AFTER(l1, l1.pop_front());
+    FUN_AFTER(l1, l1.erase_after(l1.begin()));
+    FUN_AFTER(l1, l1.erase_after(l1.begin(), l1.end()));
+    FUN_AFTER(l1, l1.resize(5));
+    FUN_AFTER(l1, l1.resize(3, 2));
+    FUN_AFTER(l1, l1.splice_after(l1.before_begin(), l4));
+    FUN_AFTER(l1, l1.splice_after(l1.before_begin(), l6, l6.begin()));
+    FUN_AFTER(l1, l1.splice_after(l1.begin(), l7, l7.before_begin(), l7.end()));
+    COUT(l6);
+    COUT(l7);
+    FUN_VALUE(mystl::distance(l1.begin(), l1.end()));
+    FUN_AFTER(l1, l1.remove(2));
+    FUN_AFTER(l1, l1.sort());
+    FUN_AFTER(l1, l1.unique());
+    FUN_AFTER(l1, l1.merge(l8));
+    FUN_AFTER(l1, l1.sort(std::greater<int>()));
+    FUN_AFTER(l1, l1.reverse());
+    FUN_AFTER(l1, l1.remove_if([](int x) { return x % 2 == 0; }));
+    FUN_VALUE(l1.front());
+    FUN_AFTER(l1, l1.swap(l9));
+    std::cout << std::boolalpha;
+    FUN_VALUE(l1.empty());
+    FUN_VALUE((l2 == mystl::forward_list<int>(5, 0)));
+    std::cout << std::noboolalpha;
+    FUN_AFTER(l1, l1.clear());
+    // 稳定性：按个位排序，十位保持原来的相对顺序
+    mystl::forward_list<int> l10{ 13,21,42,11,33,22,41,12,31,43 };
+    FUN_AFTER(l10, l10.sort([](int a, int b) { return a % 10 < b % 10; }));
+    FUN_VALUE(sizeof(mystl::forward_list_node<int>));
+    FUN_VALUE(sizeof(mystl::list_node<int>));
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    srand(time(0));
+    std::forward_list<int> stdList;
+    mystl::forward_list<int> mystlFList;
+    mystl::list<int> mystlList;
+
+    // push_front
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) stdList.push_front(rand() % M);
+    auto end = high_resolution_clock::now();
+    std::cout << "std::forward_list push_front " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) mystlFList.push_front(rand() % M);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::forward_list push_front " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) mystlList.push_front(rand() % M);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::list push_front " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    // sort
+    start = high_resolution_clock::now();
+    stdList.sort();
+    end = high_resolution_clock::now();
+    std::cout << "std::forward_list sort " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    mystlFList.sort();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::forward_list sort " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    mystlList.sort();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::list sort " << M << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    std::cout << "std::forward_list is sorted :" << check(stdList) << std::endl;
+    std::cout << "mystl::forward_list is sorted :" << check(mystlFList) << std::endl;
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -1,11 +1,117 @@
 #ifndef __HASHTABLE_TEST_H__
 #define __HASHTABLE_TEST_H__
 
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
 #include "../MySTL/hashtable.h"
+#include "../MySTL/vector.h"
 #include "test.h"
 
+using namespace std::chrono;
+
 namespace hashtable_test {
 
+// 用RangePolicy把哈希值映射到bucket，插入keys之后查找M次（一半命中），输出用时
+template <class RangePolicy>
+void measure_lookup(const char* name, const mystl::vector<int>& keys, int M) {
+    mystl::hashtable<int, int, mystl::hash<int>, mystl::identity<int>, mystl::equal_to<int>, RangePolicy> ht;
+    const int n = static_cast<int>(keys.size());
+    auto start = high_resolution_clock::now();
+    ht.insert_unique(keys.begin(), keys.end());
+    auto end = high_resolution_clock::now();
+    std::cout << name << " insert " << n << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms, ";
+
+    long long hits = 0;
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < M ; ++i) hits += ht.count(keys[i % n] ^ (i & 1));
+    end = high_resolution_clock::now();
+    std::cout << "find " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms, hits : " << hits << std::endl;
+}
+
+// 改进之前的mystl::hash：直接返回key本身
+struct identity_hash {
+    size_t operator()(uint64_t k) const { return static_cast<size_t>(k); }
+};
+
+// 插入keys后统计最长的链和查找一个已有key平均要比较几次，再把每个key查找一遍
+template <class Hash>
+void measure_chains(const char* name, const mystl::vector<uint64_t>& keys) {
+    mystl::hashtable<uint64_t, uint64_t, Hash> ht;
+    ht.insert_unique(keys.begin(), keys.end());
+    size_t longest = 0;
+    double probes = 0;
+    for(size_t b = 0 ; b < ht.bucket_count() ; ++b) {
+        size_t len = ht.elems_in_bucket(b);
+        if(len > longest) longest = len;
+        probes += len * (len + 1) / 2.0;
+    }
+    const int n = static_cast<int>(keys.size());
+    long long hits = 0;
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < n ; ++i) hits += ht.count(keys[i]);
+    auto end = high_resolution_clock::now();
+    std::cout << name << " longest chain : " << longest << ", average probes : " << probes / n
+              << ", find " << hits << " times use the time :" << duration_cast<microseconds>(end - start).count() << " us" << std::endl;
+}
+
+// 同样的字符串哈希，但标成fast，hashtable就不在结点里缓存哈希值
+struct uncached_string_hash : public mystl::hash<std::string> {
+    typedef int is_fast_hash;
+};
+
+// 字符串key：插入（中途多次rehash）、再rehash一次、全部查找一遍、遍历一遍，输出各自的用时
+template <class Hash>
+void measure_string_keys(const char* name, const mystl::vector<std::string>& keys) {
+    mystl::hashtable<std::string, std::string, Hash> ht;
+    const int n = static_cast<int>(keys.size());
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < n ; ++i) ht.insert_unique(keys[i]);
+    auto end = high_resolution_clock::now();
+    std::cout << name << " insert " << n << " strings use the time :" << duration_cast<milliseconds>(end - start).count() << " ms, ";
+
+    start = high_resolution_clock::now();
+    ht.resize(ht.bucket_count() * 2 + 1);
+    end = high_resolution_clock::now();
+    std::cout << "rehash : " << duration_cast<milliseconds>(end - start).count() << " ms, ";
+
+    long long hits = 0;
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < n ; ++i) hits += ht.count(keys[i]);
+    end = high_resolution_clock::now();
+    std::cout << "find " << hits << " : " << duration_cast<milliseconds>(end - start).count() << " ms, ";
+
+    size_t total = 0;
+    start = high_resolution_clock::now();
+    for(auto it = ht.begin() ; it != ht.end() ; ++it) total += it->size();
+    end = high_resolution_clock::now();
+    std::cout << "iterate " << total << " bytes : " << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+}
+
+// 逐个插入keys，记录每次插入的耗时，输出总时间和p50/p99/p999/max延迟
+// 一次性rehash时跨过阈值的那次插入要搬完所有结点，渐进式rehash把它分摊到之后的插入里
+void measure_insert_latency(const char* name, bool incremental, const mystl::vector<int>& keys) {
+    mystl::hashtable<int, int> ht;
+    ht.set_incremental_rehash(incremental);
+    const int n = static_cast<int>(keys.size());
+    mystl::vector<long long> lat(n);
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < n ; ++i) {
+        auto t0 = high_resolution_clock::now();
+        ht.insert_equal(keys[i]);
+        auto t1 = high_resolution_clock::now();
+        lat[i] = duration_cast<nanoseconds>(t1 - t0).count();
+    }
+    auto end = high_resolution_clock::now();
+    mystl::sort(lat.begin(), lat.end());
+    std::cout << name << " insert " << n << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms"
+              << ", p50 : " << lat[n / 2] << " ns, p99 : " << lat[n / 100 * 99] << " ns, p999 : " << lat[n / 1000 * 999]
+              << " ns, max : " << lat[n - 1] / 1000 << " us" << std::endl;
+}
+
 void test() {
     std::cout << "--------------------------hashtable test-----------------------" << std::endl;
     mystl::hashtable<int,int> ht;
@@ -38,6 +144,80 @@ void test() {
     FUN_AFTER(ht, ht.insert_unique(num, num + 5));
     FUN_AFTER(ht, ht.erase(3));
     FUN_AFTER(ht, ht.erase(ht.begin()));
+
+    // 不做混合的哈希函数：高低32位相同的key也要散开，不能全挤进一个bucket
+    struct raw_hash {
+        size_t operator()(uint64_t k) const { return static_cast<size_t>(k); }
+    };
+    mystl::hashtable<uint64_t, uint64_t, raw_hash> raw;
+    for(uint64_t i = 1 ; i <= 20000 ; ++i) raw.insert_unique((i << 32) | i);
+    size_t longest = 0;
+    for(size_t b = 0 ; b < raw.bucket_count() ; ++b) longest = mystl::max(longest, raw.elems_in_bucket(b));
+    FUN_VALUE(raw.size());
+    FUN_VALUE(longest);
+    // 复制出来的表沿用渐进式rehash的设置
+    ht.set_incremental_rehash(true);
+    mystl::hashtable<int,int> ht2(ht);
+    std::cout << std::boolalpha;
+    FUN_VALUE(ht2.incremental_rehash());
+    // 正在准备新表时被赋值，之后的插入不能换回按赋值前的大小准备的表
+    mystl::hashtable<int,int> ht3, ht4;
+    ht3.set_incremental_rehash(true);
+    ht4.set_incremental_rehash(true);
+    for(int i = 0 ; i < 100000 ; ++i) ht4.insert_unique(i);
+    for(int i = 0 ; ht3.bucket_count() < 1000 || ht3.size() <= ht3.bucket_count() ; ++i) ht3.insert_unique(i);
+    ht3.insert_unique(-1);
+    ht3 = ht4;
+    for(int i = 0 ; i < 20 ; ++i) ht3.insert_unique(-2 - i);
+    FUN_VALUE((ht3.bucket_count() >= ht4.bucket_count()));
+    FUN_VALUE((ht3.size() == ht4.size() + 20));
+    std::cout << std::noboolalpha;
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // 表很小时数据都在cache里，每次查找的开销主要是算下标，取模的除法最明显；表很大时主要是cache miss
+    srand(time(0));
+    const int sizes[] = { 1000, M / 10 };
+    for(int n : sizes) {
+        mystl::vector<int> keys(n);
+        for(int i = 0 ; i < n ; ++i) keys[i] = rand();
+        measure_lookup<mystl::hashtable_prime_policy>("prime %  ", keys, M);
+        measure_lookup<mystl::hashtable_fastmod_policy>("fastmod  ", keys, M);
+        measure_lookup<mystl::hashtable_pow2_policy>("pow2     ", keys, M);
+    }
+
+    // 按规律生成的key：连续的ID、按8字节和页对齐的地址、高低32位相同的ID
+    // fastmod算下标前会先混合，直接返回key本身也不会挤进少数几个bucket，这里对比两种哈希函数的链长和查找时间
+    const int K = 20000;
+    mystl::vector<uint64_t> sequential(K), aligned8(K), aligned4k(K), mirrored(K);
+    for(int i = 0 ; i < K ; ++i) {
+        sequential[i] = i;
+        aligned8[i] = 0x7f0000000000ull + i * 8ull;
+        aligned4k[i] = 0x7f0000000000ull + i * 4096ull;
+        mirrored[i] = (static_cast<uint64_t>(i) << 32) | i;
+    }
+    const mystl::vector<uint64_t>* patterns[] = { &sequential, &aligned8, &aligned4k, &mirrored };
+    const char* names[] = { "sequential", "aligned 8 ", "aligned 4k", "hi == lo  " };
+    for(int p = 0 ; p < 4 ; ++p) {
+        std::cout << names[p] << " : ";
+        measure_chains<identity_hash>("identity    ", *patterns[p]);
+        std::cout << names[p] << " : ";
+        measure_chains<mystl::hash<uint64_t>>("mystl::hash ", *patterns[p]);
+    }
+
+    // 字符串key的哈希比较贵，结点缓存哈希值后rehash和迭代器++不用再哈希，查找时先比哈希值
+    mystl::vector<std::string> strs(M / 10);
+    for(int i = 0 ; i < M / 10 ; ++i) strs[i] = "user:session:" + std::to_string(rand()) + ":" + std::to_string(i);
+    measure_string_keys<mystl::hash<std::string>>("cached hash  ", strs);
+    measure_string_keys<uncached_string_hash>("uncached hash", strs);
+
+    // 插入延迟的尾部：一次性rehash vs 渐进式rehash
+    mystl::vector<int> big(M);
+    for(int i = 0 ; i < M ; ++i) big[i] = rand();
+    measure_insert_latency("rehash at once ", false, big);
+    measure_insert_latency("incremental    ", true, big);
     std::cout << std::endl;
 }
 
@@ -0,0 +1,97 @@
+#ifndef __INTERVAL_MAP_TEST_H__
+#define __INTERVAL_MAP_TEST_H__
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "../MySTL/interval_map.h"
+#include "../MySTL/map.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace interval_map_test {
+
+void test() {
+    std::cout << "--------------------------interval_map test-----------------------" << std::endl;
+    mystl::interval_map<int, char> m1{ { { 1,5 },'a' },{ { 3,9 },'b' },{ { 10,12 },'c' } };
+    FUN_VALUE(*m1.insert(0, 100, 'd'));
+    FUN_VALUE(*m1.insert(6, 7, 'e'));
+    MAP_COUT(m1);
+    std::cout << "overlapping [4,7) :";
+    m1.find_overlapping(4, 7, [](mystl::interval_map<int, char>::iterator it) { std::cout << " " << it->second; });
+    std::cout << std::endl;
+    std::cout << "containing 10 :";
+    m1.find_containing(10, [](mystl::interval_map<int, char>::iterator it) { std::cout << " " << it->second; });
+    std::cout << std::endl;
+    FUN_VALUE(m1.count_overlapping(5, 6));
+    FUN_VALUE(m1.find_first_overlapping(9, 10)->second);
+    m1.find_containing(6, [](mystl::interval_map<int, char>::iterator it) { it->second = 'E'; });
+    const mystl::interval_map<int, char>& cm1 = m1;
+    std::cout << "const overlapping [6,7) :";
+    cm1.find_overlapping(6, 7, [](mystl::interval_map<int, char>::const_iterator it) { std::cout << " " << it->second; });
+    std::cout << std::endl;
+    FUN_VALUE(cm1.find_first_overlapping(6, 7)->second);
+    FUN_VALUE(m1.erase(0, 100));
+    std::cout << std::boolalpha;
+    FUN_VALUE(m1.overlaps(9, 10));
+    FUN_VALUE(m1.overlaps(5, 6));
+    std::cout << std::noboolalpha;
+    MAP_COUT(m1);
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // 时间区间：大部分区间很短，1%的区间很长（长期存在的会话、租约等）
+    // 以左端点为键的multimap只能从头扫描到lower_bound(hi)，interval_map按子树最大右端点剪枝
+    const int K = M / 10;
+    const int Q = 100;
+    srand(time(0));
+    mystl::multimap<long long, mystl::pair<long long, int>> by_start;
+    mystl::interval_map<long long, int> intervals;
+    mystl::vector<long long> starts(K), ends(K);
+    for(int i = 0 ; i < K ; ++i) {
+        starts[i] = static_cast<long long>(rand()) % (K * 10LL);
+        ends[i] = starts[i] + (i % 100 == 0 ? K * 5LL : 1 + rand() % 20);
+    }
+
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < K ; ++i) by_start.insert(mystl::pair<long long, mystl::pair<long long, int>>(starts[i], mystl::pair<long long, int>(ends[i], i)));
+    auto end = high_resolution_clock::now();
+    std::cout << "mystl::multimap insert " << K << " intervals use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < K ; ++i) intervals.insert(starts[i], ends[i], i);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::interval_map insert " << K << " intervals use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    long long found1 = 0, found2 = 0;
+    start = high_resolution_clock::now();
+    for(int q = 0 ; q < Q ; ++q) {
+        long long lo = starts[q * 7 % K], hi = lo + 10;
+        auto last = by_start.lower_bound(hi);
+        for(auto it = by_start.begin() ; it != last ; ++it) {
+            if(lo < it->second.first) ++found1;
+        }
+    }
+    end = high_resolution_clock::now();
+    std::cout << "mystl::multimap scan " << Q << " overlap queries use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int q = 0 ; q < Q ; ++q) {
+        long long lo = starts[q * 7 % K], hi = lo + 10;
+        intervals.find_overlapping(lo, hi, [&](mystl::interval_map<long long, int>::iterator) { ++found2; });
+    }
+    end = high_resolution_clock::now();
+    std::cout << "mystl::interval_map find_overlapping " << Q << " queries use the time :" << duration_cast<microseconds>(end - start).count() << " us" << std::endl;
+    std::cout << "overlaps found equal : " << (found1 == found2) << std::endl;
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef __INTRUSIVE_TEST_H__
+#define __INTRUSIVE_TEST_H__
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "../MySTL/intrusive_list.h"
+#include "../MySTL/intrusive_set.h"
+#include "../MySTL/list.h"
+#include "../MySTL/set.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace intrusive_test {
+
+// 同一个对象同时在一个链表和一棵树里
+struct item {
+    int key;
+    mystl::intrusive_list_hook list_hook;
+    mystl::intrusive_set_hook set_hook;
+
+    item() : key(0) {}
+    explicit item(int k) : key(k) {}
+    bool operator<(const item& rhs) const { return key < rhs.key; }
+};
+
+std::ostream& operator<<(std::ostream& os, const item& x) {
+    return os << x.key;
+}
+
+typedef mystl::intrusive_list<item, &item::list_hook> item_list;
+typedef mystl::intrusive_set<item, &item::set_hook> item_set;
+typedef mystl::intrusive_multiset<item, &item::set_hook> item_multiset;
+
+void test() {
+    std::cout << "--------------------------intrusive container test-----------------------" << std::endl;
+    item items[8] = { item(5), item(3), item(8), item(1), item(3), item(9), item(2), item(7) };
+
+    item_list l1;
+    item_set s1;
+    for(auto& x : items) {
+        l1.push_back(x);
+        s1.insert(x);   // 第二个3插入失败
+    }
+    COUT(l1);
+    COUT(s1);
+    FUN_VALUE(l1.size());
+    FUN_VALUE(s1.size());
+    std::cout << std::boolalpha;
+    FUN_VALUE(items[4].set_hook.is_linked());
+    FUN_VALUE((s1.find(item(8)) != s1.end()));
+    FUN_VALUE((s1.find(item(4)) != s1.end()));
+    std::cout << std::noboolalpha;
+    FUN_VALUE(*s1.lower_bound(item(4)));
+    FUN_VALUE(*s1.upper_bound(item(8)));
+    FUN_VALUE(*s1.rbegin());
+
+    // 通过对象直接删除，不需要查找
+    FUN_AFTER(s1, s1.remove(items[2]));
+    FUN_AFTER(l1, l1.remove(items[2]));
+    FUN_AFTER(l1, l1.pop_front());
+    FUN_AFTER(l1, l1.erase(l1.iterator_to(items[5])));
+    FUN_AFTER(s1, s1.erase(s1.begin()));
+
+    item_list l2;
+    l2.push_back(items[0]);
+    FUN_AFTER(l1, l1.splice(l1.begin(), l2));
+    FUN_AFTER(l1, l1.splice(l1.end(), l1, l1.begin()));
+    FUN_VALUE(l1.front());
+    FUN_VALUE(l1.back());
+    FUN_AFTER(l1, l1.clear());
+    std::cout << std::boolalpha;
+    FUN_VALUE(items[0].list_hook.is_linked());
+    std::cout << std::noboolalpha;
+
+    item_multiset ms;
+    s1.clear();
+    for(auto& x : items) ms.insert(x);
+    COUT(ms);
+    FUN_VALUE(ms.count(item(3)));
+    FUN_AFTER(ms, ms.erase(ms.find(item(3))));
+    FUN_AFTER(ms, ms.clear());
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 1000000;    // 100w
+
+    srand(time(0));
+    mystl::vector<int> keys(M);
+    for(int i = 0 ; i < M ; ++i) keys[i] = rand();
+
+    // 对象本身已经存在，比较把它们放进索引的开销
+    {
+        mystl::vector<item> objs(M);
+        for(int i = 0 ; i < M ; ++i) objs[i].key = keys[i];
+
+        auto start = high_resolution_clock::now();
+        mystl::set<int> s;
+        mystl::list<item*> l;
+        for(int i = 0 ; i < M ; ++i) {
+            s.insert(objs[i].key);
+            l.push_back(&objs[i]);
+        }
+        long long hits = 0;
+        for(int i = 0 ; i < M ; ++i) hits += s.find(keys[i]) != s.end();
+        auto end = high_resolution_clock::now();
+        std::cout << "mystl::set + mystl::list index " << M << " objects and find use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        item_multiset is;
+        item_list il;
+        for(int i = 0 ; i < M ; ++i) {
+            is.insert(objs[i]);
+            il.push_back(objs[i]);
+        }
+        long long hits2 = 0;
+        for(int i = 0 ; i < M ; ++i) hits2 += is.find(item(keys[i])) != is.end();
+        end = high_resolution_clock::now();
+        std::cout << "intrusive_multiset + intrusive_list index " << M << " objects and find use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+        std::cout << "find hits equal : " << (hits == hits2) << std::endl;
+
+        // 按对象删除
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) {
+            s.erase(objs[i].key);
+        }
+        l.clear();
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set + mystl::list remove " << M << " objects use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) {
+            is.remove(objs[i]);
+            il.remove(objs[i]);
+        }
+        end = high_resolution_clock::now();
+        std::cout << "intrusive_multiset + intrusive_list remove " << M << " objects use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -10,12 +10,12 @@
 
 namespace list_test{
 
-template <class Container>
-bool check(Container& con) {
+template <class Container, class Compare = std::less<int>>
+bool check(Container& con, Compare comp = Compare()) {
     for(auto it = con.begin() ; it != --con.end() ; ++it) {
         auto next = it;
         ++next;
-        if(*next < *it) return false;
+        if(comp(*next, *it)) return false;
     }
     return true;
 }
@@ -59,6 +59,9 @@ void test() {
     FUN_AFTER(l1, l1.splice(l1.begin(), l5, l5.begin()));
     FUN_AFTER(l1, l1.splice(l1.end(), l6, l6.begin(), ++l6.begin()));
     FUN_VALUE(l1.size());
+    FUN_VALUE(l4.size());
+    FUN_VALUE(l5.size());
+    FUN_VALUE(l6.size());
     FUN_AFTER(l1, l1.remove(0));
     FUN_VALUE(l1.size());
     FUN_AFTER(l1, l1.assign({ 9,5,3,3,7,1,3,2,2,0,10 }));
@@ -83,6 +86,9 @@ void test() {
     FUN_VALUE(l1.max_size());
     mystl::list<int> l11{ 9,5,3,3,7,1,3,2,2,0,10 };
     FUN_AFTER(l11, l11.sort());
+    // 稳定性：按个位排序，十位保持原来的相对顺序
+    mystl::list<int> l12{ 13,21,42,11,33,22,41,12,31,43 };
+    FUN_AFTER(l12, l12.sort([](int a, int b) { return a % 10 < b % 10; }));
     std::cout << std::endl;
 
     std::cout << "Performance Testing \n";
@@ -129,6 +135,35 @@ void test() {
 
     std::cout << "stdList is sorted :" << check(stdList) << std::endl;
     std::cout << "mystlList is sorted :" << check(mystlList) << std::endl;
+
+    // 已经有序的输入
+    start = high_resolution_clock::now();
+    stdList.sort();
+    end = high_resolution_clock::now();
+    duration = duration_cast<milliseconds>(end - start);
+    std::cout << "std::list sort " << M << " sorted elements use the time :" << duration.count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    mystlList.sort();
+    end = high_resolution_clock::now();
+    duration = duration_cast<milliseconds>(end - start);
+    std::cout << "mystl::list sort " << M << " sorted elements use the time :" << duration.count() << " ms" << std::endl;
+
+    // 逆序的输入
+    start = high_resolution_clock::now();
+    stdList.sort(std::greater<int>());
+    end = high_resolution_clock::now();
+    duration = duration_cast<milliseconds>(end - start);
+    std::cout << "std::list sort " << M << " reverse sorted elements use the time :" << duration.count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    mystlList.sort(std::greater<int>());
+    end = high_resolution_clock::now();
+    duration = duration_cast<milliseconds>(end - start);
+    std::cout << "mystl::list sort " << M << " reverse sorted elements use the time :" << duration.count() << " ms" << std::endl;
+
+    std::cout << "stdList is sorted :" << check(stdList, std::greater<int>()) << std::endl;
+    std::cout << "mystlList is sorted :" << check(mystlList, std::greater<int>()) << std::endl;
 }
 
 } // namespace list_test
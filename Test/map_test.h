@@ -4,6 +4,9 @@
 #include <iostream>
 #include <initializer_list>
 #include <map>
+#include <vector>
+#include <string>
+#include <string_view>
 
 #include "../MySTL/map.h"
 #include "../MySTL/vector.h"
@@ -15,14 +18,6 @@ namespace map_test {
 // pair 的宏定义
 #define PAIR    mystl::pair<int, int>
 
-// map 的遍历输出
-#define MAP_COUT(m) do { \
-    std::string m_name = #m; \
-    std::cout << m_name << " :"; \
-    for (auto it : m)    std::cout << " <" << it.first << "," << it.second << ">"; \
-    std::cout << std::endl; \
-} while(0)  \
-
 // map 的函数操作
 #define MAP_FUN_AFTER(con, fun) do { \
     std::string str = #fun; \
@@ -95,6 +90,27 @@ void test() {
     std::cout << std::noboolalpha;
     FUN_VALUE(m1.size());
     FUN_VALUE(m1.max_size());
+    mystl::map<int, int> m11(mystl::sorted_unique, v.begin(), v.end());
+    MAP_COUT(m11);
+    MAP_FUN_AFTER(m11, m11.insert(mystl::sorted_unique, v.begin(), v.end()));
+    // node handle：摘下结点，修改键值后插回，结点不重新分配
+    auto nh = m11.extract(0);
+    nh.value().first = 10;
+    MAP_FUN_AFTER(m11, m11.insert(std::move(nh)));
+    mystl::multimap<int, int> mm1;
+    MAP_FUN_AFTER(mm1, mm1.insert(m11.extract(m11.begin())));
+    MAP_FUN_AFTER(mm1, mm1.merge(m11));
+    MAP_COUT(m11);
+    // 异构查找：less<>是透明比较，直接用const char*查找，不构造std::string
+    mystl::map<std::string, int, mystl::less<>> m12;
+    m12["apple"] = 1;
+    m12["banana"] = 2;
+    m12["cherry"] = 3;
+    FUN_VALUE(m12.find("banana")->second);
+    FUN_VALUE(m12.count("durian"));
+    FUN_VALUE(m12.lower_bound("b")->first);
+    FUN_VALUE(m12.erase("apple"));
+    FUN_VALUE(m12.size());
 
 
     std::cout << "<-----Performance Testing---------> \n";
@@ -118,6 +134,112 @@ void test() {
     end = high_resolution_clock::now();
     duration = duration_cast<milliseconds>(end - start);
     std::cout << "mystl::map insert " << M <<" elements use the time :" << duration.count() << " ms" << std::endl;
+
+    // 从有序的快照重建map
+    mystl::vector<PAIR> snapshot;
+    std::vector<std::pair<int, int>> stdSnapshot;
+    snapshot.reserve(M);
+    stdSnapshot.reserve(M);
+    for(int i = 0 ; i < M ; ++i) {
+        snapshot.push_back(PAIR(i, i));
+        stdSnapshot.push_back({i, i});
+    }
+
+    start = high_resolution_clock::now();
+    {
+        std::map<int, int> m(stdSnapshot.begin(), stdSnapshot.end());
+    }
+    end = high_resolution_clock::now();
+    std::cout << "std::map construct from " << M << " sorted elements use the time :"
+              << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    {
+        mystl::map<int, int> m;
+        for(auto& p : snapshot) m.insert(p);
+    }
+    end = high_resolution_clock::now();
+    std::cout << "mystl::map insert one by one " << M << " sorted elements use the time :"
+              << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    {
+        mystl::map<int, int> m(snapshot.begin(), snapshot.end());
+    }
+    end = high_resolution_clock::now();
+    std::cout << "mystl::map construct from " << M << " sorted elements use the time :"
+              << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    {
+        mystl::map<int, int> m(mystl::sorted_unique, snapshot.begin(), snapshot.end());
+    }
+    end = high_resolution_clock::now();
+    std::cout << "mystl::map construct with sorted_unique from " << M << " elements use the time :"
+              << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    // 把一个map中的元素全部移动到另一个map：erase + insert 与 extract + insert，value为一个64字节的字符串
+    {
+        mystl::map<int, std::string> from;
+        mystl::map<int, std::string> to;
+        for(int i = 0 ; i < M ; ++i) from.insert(mystl::pair<int, std::string>(i, std::string(64, 'x')));
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) {
+            auto it = from.find(i);
+            to.insert(*it);
+            from.erase(it);
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::map erase + insert move " << M << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) {
+            from.insert(to.extract(i));
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::map extract + insert move " << M << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        to.merge(from);
+        end = high_resolution_clock::now();
+        std::cout << "mystl::map merge " << M << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    }
+
+    // 用一段字符缓冲（string_view）查找std::string的map：
+    // less<std::string>要先构造临时的std::string，less<>直接和string_view比较
+    {
+        const int K = M / 10;
+        mystl::vector<std::string> names(K);
+        for(int i = 0 ; i < K ; ++i) names[i] = "user-name-longer-than-sso-" + std::to_string(i);
+        mystl::map<std::string, int> plain;
+        mystl::map<std::string, int, mystl::less<>> transparent;
+        for(int i = 0 ; i < K ; ++i) {
+            plain[names[i]] = i;
+            transparent[names[i]] = i;
+        }
+        long long sum1 = 0, sum2 = 0;
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) {
+            std::string_view key(names[i % K]);
+            sum1 += plain.find(std::string(key))->second;
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::map<std::string, int> find " << M << " times by string_view use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) {
+            std::string_view key(names[i % K]);
+            sum2 += transparent.find(key)->second;
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::map<std::string, int, less<>> find " << M << " times by string_view use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+        std::cout << "find results equal : " << (sum1 == sum2) << std::endl;
+    }
     std::cout << std::endl;
 
     //MAP_COUT(mystlMap);
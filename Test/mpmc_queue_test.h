@@ -0,0 +1,122 @@
+#ifndef __MPMC_QUEUE_TEST_H__
+#define __MPMC_QUEUE_TEST_H__
+
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "../MySTL/mpmc_queue.h"
+#include "../MySTL/queue.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace mpmc_queue_test {
+
+// producers个线程共push total个元素，consumers个线程pop，返回耗时ms，同时检查总和
+template <class PushFn, class PopFn>
+long long run_contention(int producers, int consumers, int total, PushFn push, PopFn pop, bool& ok) {
+    std::atomic<long long> sum(0);
+    std::atomic<int> remain(total);
+    std::vector<std::thread> threads;     // mystl::vector不支持只能移动的类型
+    auto start = high_resolution_clock::now();
+    for(int p = 0 ; p < producers ; ++p) {
+        threads.push_back(std::thread([=] {
+            for(int i = p ; i < total ; i += producers) push(i);
+        }));
+    }
+    for(int c = 0 ; c < consumers ; ++c) {
+        threads.push_back(std::thread([&] {
+            long long local = 0;
+            int v;
+            while(remain.load(std::memory_order_relaxed) > 0) {
+                if(pop(v)) {
+                    local += v;
+                    remain.fetch_sub(1, std::memory_order_relaxed);
+                }else {
+                    std::this_thread::yield();
+                }
+            }
+            sum += local;
+        }));
+    }
+    for(auto& t : threads) t.join();
+    auto end = high_resolution_clock::now();
+    ok = sum.load() == static_cast<long long>(total) * (total - 1) / 2;
+    return duration_cast<milliseconds>(end - start).count();
+}
+
+void test() {
+    std::cout << "--------------------------mpmc_queue test-----------------------" << std::endl;
+    mystl::mpmc_queue<int> q1(6);     // 容量取整为8
+    int a[] = { 1,2,3,4,5,6,7,8,9 };
+
+    FUN_VALUE(q1.capacity());
+    FUN_VALUE(q1.try_push(0));
+    FUN_VALUE(q1.try_push_bulk(a, 9));    // 只能放下7个
+    FUN_VALUE(q1.size());
+    FUN_VALUE(q1.try_push(10));
+    int value = -1;
+    FUN_VALUE(q1.try_pop(value));
+    FUN_VALUE(value);
+    int out[8];
+    FUN_VALUE(q1.try_pop_bulk(out, 8));
+    for(int i = 0 ; i < 7 ; ++i) std::cout << out[i] << " ";
+    std::cout << std::endl;
+    std::cout << std::boolalpha;
+    FUN_VALUE(q1.empty());
+    FUN_VALUE(q1.try_pop(value));
+    std::cout << std::noboolalpha;
+
+    // 阻塞接口：2个生产者2个消费者
+    {
+        const int K = 100000;
+        std::atomic<long long> sum(0);
+        std::thread p1([&] { for(int i = 0 ; i < K ; i += 2) q1.push(i); });
+        std::thread p2([&] { for(int i = 1 ; i < K ; i += 2) q1.push(i); });
+        std::thread c1([&] { int v; long long s = 0; for(int i = 0 ; i < K / 2 ; ++i) { q1.wait_pop(v); s += v; } sum += s; });
+        std::thread c2([&] { int v; long long s = 0; for(int i = 0 ; i < K / 2 ; ++i) { q1.wait_pop(v); s += v; } sum += s; });
+        p1.join(); p2.join(); c1.join(); c2.join();
+        std::cout << "blocking sum : " << sum.load() << " expect : " << (long long)K * (K - 1) / 2 << std::endl;
+    }
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+    const int counts[] = { 1, 2, 4, 8 };
+
+    for(int producers : counts) {
+        for(int consumers : counts) {
+            bool ok1 = false, ok2 = false;
+
+            mystl::queue<int> que;
+            std::mutex mtx;
+            long long t1 = run_contention(producers, consumers, M,
+                [&](int v) { std::lock_guard<std::mutex> lock(mtx); que.push(v); },
+                [&](int& v) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    if(que.empty()) return false;
+                    v = que.front();
+                    que.pop();
+                    return true;
+                }, ok1);
+
+            mystl::mpmc_queue<int> mq(4096);
+            long long t2 = run_contention(producers, consumers, M,
+                [&](int v) { mq.push(v); },
+                [&](int& v) { return mq.try_pop(v); }, ok2);
+
+            std::cout << producers << " producers " << consumers << " consumers transfer " << M << " elements : "
+                      << "mutex + mystl::queue " << t1 << " ms" << (ok1 ? "" : " (WRONG)") << ", "
+                      << "mystl::mpmc_queue " << t2 << " ms" << (ok2 ? "" : " (WRONG)") << std::endl;
+        }
+    }
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef __PERSISTENT_MAP_TEST_H__
+#define __PERSISTENT_MAP_TEST_H__
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "../MySTL/persistent_map.h"
+#include "../MySTL/map.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace persistent_map_test {
+
+void test() {
+    std::cout << "--------------------------persistent_map test-----------------------" << std::endl;
+    mystl::persistent_map<int, int> v0{ { 3,30 },{ 1,10 },{ 2,20 } };
+    auto v1 = v0.insert(4, 40);
+    auto v2 = v1.insert_or_assign(1, 100);
+    auto v3 = v2.erase(3);
+    auto snap = v3.snapshot();
+    // 每个版本都保持不变
+    MAP_COUT(v0);
+    MAP_COUT(v1);
+    MAP_COUT(v2);
+    MAP_COUT(v3);
+    FUN_VALUE(v3.at(1));
+    FUN_VALUE(v0.at(1));
+    FUN_VALUE(v3.count(3));
+    FUN_VALUE(v3.lower_bound(2)->first);
+    FUN_VALUE((--v3.end())->first);
+    // 迭代器持有所属版本的根：map变成新版本或者临时对象销毁以后，仍然在原来的版本上移动
+    auto cur = v1.insert(5, 50);
+    auto it = cur.find(1);
+    cur = cur.erase(2);
+    FUN_VALUE((++it)->first);
+    auto tmp_it = v3.insert(0, 0).begin();
+    FUN_VALUE((++tmp_it)->first);
+    std::cout << std::boolalpha;
+    FUN_VALUE(snap.same_version(v3));
+    FUN_VALUE((v1.insert(4, 0) == v1));
+    FUN_VALUE((v0 == v3));
+    std::cout << std::noboolalpha;
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // 路由表：写者每做U次更新发布一个快照，发布P次
+    // mystl::map发布时要整棵树拷贝，persistent_map的快照是O(1)的
+    const int K = M / 10;
+    const int U = 100;
+    const int P = 100;
+    srand(time(0));
+    mystl::vector<int> keys(K);
+    for(int i = 0 ; i < K ; ++i) keys[i] = rand();
+
+    mystl::map<int, int> table;
+    mystl::persistent_map<int, int> ptable;
+    auto start = high_resolution_clock::now();
+    for(int i = 0 ; i < K ; ++i) table[keys[i]] = i;
+    auto end = high_resolution_clock::now();
+    std::cout << "mystl::map insert " << K << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < K ; ++i) ptable = ptable.insert_or_assign(keys[i], i);
+    end = high_resolution_clock::now();
+    std::cout << "mystl::persistent_map insert " << K << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    long long hits1 = 0, hits2 = 0;
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < K ; ++i) hits1 += table.find(keys[K - 1 - i] ^ (i & 1)) != table.end();
+    end = high_resolution_clock::now();
+    std::cout << "mystl::map find " << K << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    start = high_resolution_clock::now();
+    for(int i = 0 ; i < K ; ++i) hits2 += ptable.contains(keys[K - 1 - i] ^ (i & 1));
+    end = high_resolution_clock::now();
+    std::cout << "mystl::persistent_map find " << K << " random elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    std::cout << "find hits equal : " << (hits1 == hits2) << std::endl;
+
+    {
+        mystl::vector<mystl::map<int, int>> published;
+        start = high_resolution_clock::now();
+        for(int p = 0 ; p < P ; ++p) {
+            for(int u = 0 ; u < U ; ++u) table[keys[(p * U + u) % K]] = -u;
+            published.push_back(table);    // 整棵树拷贝
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::map " << P << " publishes (" << U << " updates + copy " << K << " elements) use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    }
+    {
+        mystl::vector<mystl::persistent_map<int, int>> published;
+        start = high_resolution_clock::now();
+        for(int p = 0 ; p < P ; ++p) {
+            for(int u = 0 ; u < U ; ++u) ptable = ptable.insert_or_assign(keys[(p * U + u) % K], -u);
+            published.push_back(ptable.snapshot());    // O(1)
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::persistent_map " << P << " publishes (" << U << " updates + snapshot) use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    }
+    std::cout << "size equal : " << (table.size() == ptable.size()) << std::endl;
+    std::cout << std::endl;
+}
+
+}
+
+#endif
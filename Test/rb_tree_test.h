@@ -1,10 +1,22 @@
 #ifndef __RB_TREE_TEST_H__
 #define __RB_TREE_TEST_H__
 
+#include <iostream>
+#include <set>
+#include <map>
+#include <chrono>
+#include <cstdint>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 #include "../MySTL/rb_tree.h"
+#include "../MySTL/set.h"
+#include "../MySTL/map.h"
 #include "test.h"
 
+using namespace std::chrono;
+
 namespace rb_tree_test {
 
 template <class T1, class T2>
@@ -14,6 +26,48 @@ struct Comp {
     }
 };
 
+// 当前堆上已分配的字节数，包含malloc自己的块头和对齐，非glibc平台返回0
+inline size_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// 插入n个元素，输出用时和平均每个元素占用的堆内存
+template <class Container, class Insert>
+void measure_per_node(const char* name, int n, Insert insert) {
+    size_t before = heap_in_use();
+    auto start = high_resolution_clock::now();
+    {
+        Container c;
+        for(int i = 0 ; i < n ; ++i) insert(c, static_cast<uint64_t>(i) * 2654435761u);
+        auto end = high_resolution_clock::now();
+        size_t after = heap_in_use();
+        std::cout << name << " insert " << n << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms, heap bytes per element : "
+                  << static_cast<double>(after - before) / n << std::endl;
+    }
+}
+
+// 构造n个元素的容器，输出拷贝构造和clear的用时
+template <class Container>
+void measure_copy_clear(const char* name, int n) {
+    Container c;
+    for(int i = 0 ; i < n ; ++i) c.insert(c.end(), static_cast<uint64_t>(i));
+    auto start = high_resolution_clock::now();
+    Container copy(c);
+    auto end = high_resolution_clock::now();
+    std::cout << name << " copy " << n << " elements use the time :"
+              << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    start = high_resolution_clock::now();
+    copy.clear();
+    end = high_resolution_clock::now();
+    std::cout << name << " clear " << n << " elements use the time :"
+              << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+}
+
 void test() {
     std::cout << "--------------------------rb_tree test-----------------------" << std::endl;
     mystl::rb_tree<int, int/* , Comp */> t1;    // key value
@@ -52,6 +106,39 @@ void test() {
     FUN_AFTER(t2, t2.erase(4));
     //std::cout << t2.erase(4) << std::endl;
     FUN_AFTER(t2, t2.erase(t2.begin(), --t2.end()));
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // 结点布局：定义MYSTL_RB_TREE_COMPACT_NODE时颜色放进parent_的最低位
+#ifdef MYSTL_RB_TREE_COMPACT_NODE
+    std::cout << "node layout : compact" << std::endl;
+#else
+    std::cout << "node layout : default" << std::endl;
+#endif
+    FUN_VALUE(sizeof(mystl::rb_tree_node_base<uint64_t>));
+    FUN_VALUE(sizeof(mystl::rb_tree_node<uint64_t>));
+    FUN_VALUE(sizeof(mystl::rb_tree_node<mystl::pair<uint64_t, uint64_t>>));
+
+    // 实际占用还要算上malloc的块头和16字节对齐
+    measure_per_node<std::set<uint64_t>>("std::set<uint64_t>", M,
+        [](std::set<uint64_t>& c, uint64_t v) { c.insert(v); });
+    measure_per_node<mystl::set<uint64_t>>("mystl::set<uint64_t>", M,
+        [](mystl::set<uint64_t>& c, uint64_t v) { c.insert(v); });
+    measure_per_node<std::map<uint64_t, uint64_t>>("std::map<uint64_t, uint64_t>", M,
+        [](std::map<uint64_t, uint64_t>& c, uint64_t v) { c[v] = v; });
+    measure_per_node<mystl::map<uint64_t, uint64_t>>("mystl::map<uint64_t, uint64_t>", M,
+        [](mystl::map<uint64_t, uint64_t>& c, uint64_t v) { c[v] = v; });
+
+    // 拷贝和clear都是非递归的；定义MYSTL_RB_TREE_NODE_POOL时结点从内存池分配，拷贝前一次预留，clear时整批归还
+#ifdef MYSTL_RB_TREE_NODE_POOL
+    std::cout << "node allocator : node_pool" << std::endl;
+#else
+    std::cout << "node allocator : mystl::allocator" << std::endl;
+#endif
+    measure_copy_clear<std::set<uint64_t>>("std::set<uint64_t>", M);
+    measure_copy_clear<mystl::set<uint64_t>>("mystl::set<uint64_t>", M);
     std::cout << std::endl;
 }
 
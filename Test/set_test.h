@@ -3,9 +3,15 @@
 
 #include <iostream>
 #include <set>
+#include <vector>
 #include <chrono>
+#include <cstdlib>
+#include <ctime>
 
 #include "../MySTL/set.h"
+#include "../MySTL/vector.h"
+#include "../MySTL/set_algo.h"
+#include "../MySTL/iterator.h"
 #include "test.h"
 
 using namespace std::chrono;
@@ -64,6 +70,50 @@ void test() {
     std::cout << std::noboolalpha;
     FUN_VALUE(s1.size());
     FUN_VALUE(s1.max_size());
+    // 有序区间直接建树
+    int b[] = { 1,2,3,4,5,6,7,8,9,10 };
+    mystl::set<int> s11(b, b + 10);
+    mystl::set<int> s12(mystl::sorted_unique, b, b + 10);
+    COUT(s11);
+    COUT(s12);
+    FUN_AFTER(s12, s12.insert(a, a + 5));
+    FUN_AFTER(s12, s12.insert(mystl::sorted_unique, b, b + 10));
+    // std的迭代器也能直接建树
+    std::vector<int> sb(b, b + 10);
+    mystl::multiset<int> s19(mystl::sorted_equivalent, sb.begin(), sb.end());
+    COUT(s19);
+    // node handle：摘下结点，改键值后插入另一个set
+    mystl::set<int> s13{ 1,2,3 };
+    mystl::set<int> s14{ 3,4,5 };
+    auto nh = s13.extract(1);
+    nh.value() = 6;
+    FUN_AFTER(s14, s14.insert(std::move(nh)));
+    FUN_VALUE(s14.insert(s13.extract(s13.begin())).inserted);
+    FUN_AFTER(s13, s13.merge(s14));
+    COUT(s14);
+    // order statistic
+    mystl::order_statistic_set<int> s15{ 5,1,9,3,7 };
+    FUN_VALUE(*s15.nth(2));
+    FUN_VALUE(s15.rank(7));
+    FUN_VALUE(s15.index_of(s15.find(9)));
+    FUN_VALUE(s15.distance(s15.begin(), s15.end()));
+    FUN_AFTER(s15, s15.erase(3));
+    FUN_VALUE(*s15.nth(1));
+    // 基于join/split的集合操作
+    mystl::set<int> s16{ 1,3,5,7,9 };
+    mystl::set<int> s17{ 3,4,5,6 };
+    FUN_AFTER(s16, s16.union_with(s17));
+    FUN_AFTER(s16, s16.intersect_with(mystl::set<int>{ 1,4,5,6,8,9 }));
+    FUN_AFTER(s16, s16.difference_with(s17));
+    auto s18 = s16.split(5);
+    COUT(s18);
+    FUN_AFTER(s16, s16.join(s18));
+    FUN_VALUE(s16.split(7, 1).size());
+    mystl::order_statistic_set<int> s20{ 2,4,6,8,10 };
+    auto s21 = s20.split(5);
+    FUN_VALUE(s20.size());
+    FUN_VALUE(s21.size());
+    FUN_VALUE(*s21.nth(1));
 
 
     std::cout << "<-----Performance Testing---------> \n";
@@ -87,6 +137,143 @@ void test() {
     end = high_resolution_clock::now();
     duration = duration_cast<milliseconds>(end - start);
     std::cout << "mystl::set insert " << M <<" elements use the time :" << duration.count() << " ms" << std::endl;
+
+    // 区间构造：有序、基本有序（每100个元素交换一对）、随机三种输入
+    srand(time(0));
+    mystl::vector<int> sorted(M), nearly(M), random(M);
+    for(int i = 0 ; i < M ; ++i) {
+        sorted[i] = nearly[i] = i;
+        random[i] = rand();
+    }
+    for(int i = 0 ; i + 1 < M ; i += 100) mystl::swap(nearly[i], nearly[i + 1]);
+
+    start = high_resolution_clock::now();
+    {
+        mystl::set<int> s(mystl::sorted_unique, sorted.begin(), sorted.end());
+    }
+    end = high_resolution_clock::now();
+    std::cout << "mystl::set construct with sorted_unique from " << M << " elements use the time :"
+              << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+    const char* names[] = { "sorted", "nearly sorted", "random" };
+    mystl::vector<int>* inputs[] = { &sorted, &nearly, &random };
+    for(int k = 0 ; k < 3 ; ++k) {
+        const int* first = inputs[k]->begin();
+        const int* last = inputs[k]->end();
+
+        start = high_resolution_clock::now();
+        {
+            std::set<int> s(first, last);
+        }
+        end = high_resolution_clock::now();
+        std::cout << "std::set construct from " << M << " " << names[k] << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        {
+            mystl::set<int> s;
+            for(const int* p = first ; p != last ; ++p) s.insert(*p);
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set insert one by one " << M << " " << names[k] << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        {
+            mystl::set<int> s(first, last);
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set construct from " << M << " " << names[k] << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    }
+
+    // 排名查询：mystl::distance 逐个数 与 order_statistic_set::rank
+    {
+        const int K = M / 10;
+        const int Q = 100;
+        mystl::set<int> plain(random.begin(), random.begin() + K);
+        mystl::order_statistic_set<int> ranked(random.begin(), random.begin() + K);
+        size_t sum1 = 0, sum2 = 0;
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < Q ; ++i) {
+            sum1 += mystl::distance(plain.begin(), plain.lower_bound(random[i * 7]));
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set distance " << Q << " rank queries on " << K << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < Q ; ++i) {
+            sum2 += ranked.rank(random[i * 7]);
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::order_statistic_set rank " << Q << " rank queries on " << K << " elements use the time :"
+                  << duration_cast<microseconds>(end - start).count() << " us" << std::endl;
+        std::cout << "rank results equal : " << (sum1 == sum2) << std::endl;
+
+        start = high_resolution_clock::now();
+        {
+            mystl::set<int> tmp(random.begin(), random.end());
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set construct from " << M << " random elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        {
+            mystl::order_statistic_set<int> tmp(random.begin(), random.end());
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::order_statistic_set construct from " << M << " random elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    }
+
+    // 大集合合并小集合：set_union到新容器 与 union_with
+    {
+        const int D = 1000;
+        mystl::set<int> base(random.begin(), random.end());
+        mystl::set<int> delta(random.begin(), random.begin() + D);
+        for(int i = 0 ; i < D ; ++i) delta.insert(rand());
+
+        start = high_resolution_clock::now();
+        mystl::vector<int> out;
+        mystl::set_union(base.begin(), base.end(), delta.begin(), delta.end(), mystl::back_inserter(out));
+        mystl::set<int> merged(mystl::sorted_unique, out.begin(), out.end());
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set_union " << base.size() << " and " << delta.size() << " elements into a new set use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        base.union_with(delta);
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set union_with " << delta.size() << " elements into " << M << " elements use the time :"
+                  << duration_cast<microseconds>(end - start).count() << " us" << std::endl;
+        std::cout << "union size equal : " << (base.size() == merged.size()) << std::endl;
+
+        start = high_resolution_clock::now();
+        base.difference_with(delta);
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set difference_with " << delta.size() << " elements use the time :"
+                  << duration_cast<microseconds>(end - start).count() << " us" << std::endl;
+
+        // 两边一样大时，顺序与并行
+        mystl::set<int> big(random.begin() + M / 2, random.end());
+        mystl::set<int> other(random.begin(), random.begin() + M / 2);
+        mystl::set<int> big2(big), other2(other);
+        start = high_resolution_clock::now();
+        big.union_with(mystl::move(other));
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set union_with " << big2.size() << " and " << other2.size() << " elements use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        big2.union_with(mystl::move(other2), true);
+        end = high_resolution_clock::now();
+        std::cout << "mystl::set parallel union_with use the time :"
+                  << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+        std::cout << "union size equal : " << (big.size() == big2.size()) << std::endl;
+    }
+
     std::cout << std::endl;
 
     //COUT(stdSet);
@@ -0,0 +1,131 @@
+#ifndef __SPSC_QUEUE_TEST_H__
+#define __SPSC_QUEUE_TEST_H__
+
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "../MySTL/spsc_queue.h"
+#include "../MySTL/queue.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace spsc_queue_test {
+
+void test() {
+    std::cout << "--------------------------spsc_queue test-----------------------" << std::endl;
+    mystl::spsc_queue<int> q1(5);     // 容量取整为8
+    int a[] = { 1,2,3,4,5,6,7,8,9 };
+
+    FUN_VALUE(q1.capacity());
+    FUN_VALUE(q1.try_push(1));
+    FUN_VALUE(q1.try_push(2));
+    FUN_VALUE(q1.front());
+    FUN_VALUE(q1.size());
+    q1.pop();
+    FUN_VALUE(q1.front());
+    FUN_VALUE(q1.try_push_bulk(a, 9));    // 只能放下7个
+    FUN_VALUE(q1.size());
+    FUN_VALUE(q1.try_push(10));
+    int out[8];
+    FUN_VALUE(q1.try_pop_bulk(out, 8));
+    for(int i = 0 ; i < 8 ; ++i) std::cout << out[i] << " ";
+    std::cout << std::endl;
+    int value = 0;
+    FUN_VALUE(q1.try_pop(value));
+    std::cout << std::boolalpha;
+    FUN_VALUE(q1.empty());
+    std::cout << std::noboolalpha;
+
+    // 两个线程之间传递，检查顺序和总和
+    const int K = 100000;
+    long long sum = 0;
+    bool ordered = true;
+    std::thread consumer([&] {
+        int expect = 0;
+        for(int i = 0 ; i < K ; ++i) {
+            int v;
+            q1.wait_pop(v);
+            if(v != expect++) ordered = false;
+            sum += v;
+        }
+    });
+    for(int i = 0 ; i < K ; ++i) {
+        q1.push(i);
+    }
+    consumer.join();
+    std::cout << "ordered : " << ordered << "  sum : " << sum << std::endl;
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+
+    // mutex + mystl::queue
+    {
+        mystl::queue<int> que;
+        std::mutex mtx;
+        auto start = high_resolution_clock::now();
+        std::thread c([&] {
+            int got = 0;
+            while(got < M) {
+                std::lock_guard<std::mutex> lock(mtx);
+                while(!que.empty()) {
+                    que.pop();
+                    ++got;
+                }
+            }
+        });
+        for(int i = 0 ; i < M ; ++i) {
+            std::lock_guard<std::mutex> lock(mtx);
+            que.push(i);
+        }
+        c.join();
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        std::cout << "mutex + mystl::queue transfer " << M << " elements use the time :" << duration.count() << " ms" << std::endl;
+    }
+
+    // spsc_queue 单个push/pop
+    {
+        mystl::spsc_queue<int> que(4096);
+        auto start = high_resolution_clock::now();
+        std::thread c([&] {
+            int v;
+            for(int i = 0 ; i < M ; ++i) que.wait_pop(v);
+        });
+        for(int i = 0 ; i < M ; ++i) que.push(i);
+        c.join();
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        std::cout << "mystl::spsc_queue transfer " << M << " elements use the time :" << duration.count() << " ms" << std::endl;
+    }
+
+    // spsc_queue 批量push/pop
+    {
+        mystl::spsc_queue<int> que(4096);
+        const int B = 64;
+        auto start = high_resolution_clock::now();
+        std::thread c([&] {
+            int buf[B];
+            int got = 0;
+            while(got < M) got += que.wait_pop_bulk(buf, B);
+        });
+        int buf[B];
+        for(int i = 0 ; i < M ; i += B) {
+            for(int j = 0 ; j < B ; ++j) buf[j] = i + j;
+            que.push_bulk(buf, i + B <= M ? B : M - i);
+        }
+        c.join();
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<milliseconds>(end - start);
+        std::cout << "mystl::spsc_queue bulk(" << B << ") transfer " << M << " elements use the time :" << duration.count() << " ms" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+}
+
+#endif
@@ -9,14 +9,26 @@
 
 #include "vector_test.h"
 #include "list_test.h"
+#include "unrolled_list_test.h"
+#include "forward_list_test.h"
 #include "deque_test.h"
 #include "stack_queue_test.h"
+#include "spsc_queue_test.h"
+#include "mpmc_queue_test.h"
 #include "rb_tree_test.h"
 #include "set_test.h"
 #include "map_test.h"
+#include "btree_test.h"
+#include "flat_test.h"
+#include "persistent_map_test.h"
+#include "concurrent_map_test.h"
+#include "interval_map_test.h"
+#include "intrusive_test.h"
 #include "hashtable_test.h"
 #include "unordered_set_test.h"
 #include "unordered_map_test.h"
+#include "flat_hash_test.h"
+#include "concurrent_unordered_map_test.h"
 
 /*
 *   本次测试在 Ubuntu 22.04     2核处理器       内存4GB
@@ -70,19 +82,31 @@ int main() {
 
     /* vector_test::test();
     list_test::test();
+    unrolled_list_test::test();
+    forward_list_test::test();
     deque_test::test(); */
 
     /* stack_queue_test::stack_test();
     stack_queue_test::queue_test();
-    stack_queue_test::priority_queue_test(); */
+    stack_queue_test::priority_queue_test();
+    spsc_queue_test::test();
+    mpmc_queue_test::test(); */
 
     /* rb_tree_test::test();
     set_test::test();
     map_test::test(); 
+    btree_test::test();
+    flat_test::test();
+    persistent_map_test::test();
+    concurrent_map_test::test();
+    interval_map_test::test();
+    intrusive_test::test();
 
     hashtable_test::test();
     unordered_set_test::test(); 
-    unordered_map_test::test(); */
+    unordered_map_test::test();
+    flat_hash_test::test();
+    concurrent_unordered_map_test::test(); */
 
     
 
@@ -16,6 +16,15 @@ namespace mystl {
 } while(0)                                      \
 
 
+// map类容器的遍历输出，元素是有first和second的pair
+#define MAP_COUT(m) do {                        \
+    std::string m_name = #m;                    \
+    std::cout << m_name << " :";                \
+    for(auto& it : m)                           \
+        std::cout << " <" << it.first << "," << it.second << ">"; \
+    std::cout << std::endl;                     \
+} while(0)                                      \
+
 // 输出调用函数后的容器内元素的结果
 #define FUN_AFTER(container, fun) do {              \
     std::string fun_name = #fun;                    \
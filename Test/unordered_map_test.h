@@ -6,10 +6,18 @@
 
 #include <iostream>
 #include <unordered_map>
+#include <string>
+#include <string_view>
 
 
 namespace unordered_map_test {
 
+// 透明的哈希函数，std::string、const char*、string_view都按string_view哈希，结果一致
+struct string_hash {
+    typedef int is_transparent;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+};
+
 //#define PAIR    mystl::pair<int,int>
 
 /* // map 的遍历输出
@@ -90,10 +98,19 @@ void test() {
     FUN_VALUE(um1.bucket_count());
     FUN_VALUE(um1.count(1));
     MAP_VALUE(*um1.find(3));
-    auto first = *um1.equal_range(3).first;
-    auto second = *um1.equal_range(3).second;
-    std::cout << " um1.equal_range(3) : from <" << first.first << ", " << first.second
-        << "> to <" << second.first << ", " << second.second << ">" << std::endl;
+    // 元素的顺序由哈希值决定，3可能是最后一个，这时second是end，不能解引用
+    auto range = um1.equal_range(3);
+    std::cout << " um1.equal_range(3) : from <" << range.first->first << ", " << range.first->second << "> to ";
+    if(range.second == um1.end()) std::cout << "end" << std::endl;
+    else std::cout << "<" << range.second->first << ", " << range.second->second << ">" << std::endl;
+    // 异构查找：hasher和key_equal都是透明的
+    mystl::unordered_map<std::string, int, string_hash, mystl::equal_to<>> um15;
+    um15["apple"] = 1;
+    um15["banana"] = 2;
+    FUN_VALUE(um15.find("banana")->second);
+    FUN_VALUE(um15.count(std::string_view("apple")));
+    FUN_VALUE(um15.erase("apple"));
+    FUN_VALUE(um15.size());
 
     std::cout << "<----------------------Performance Testing-------------------------> \n";
     std::unordered_map<int,int> stdUm;
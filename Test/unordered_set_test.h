@@ -61,9 +61,11 @@ void test() {
     FUN_VALUE(us1.bucket_count());
     FUN_VALUE(us1.count(1));
     FUN_VALUE(*us1.find(3));
-    auto first = *us1.equal_range(3).first;
-    auto second = *us1.equal_range(3).second;
-    std::cout << "us1.equal_range(3) : from " << first << " to " << second << std::endl;
+    // 元素的顺序由哈希值决定，3可能是最后一个，这时second是end，不能解引用
+    auto range = us1.equal_range(3);
+    std::cout << "us1.equal_range(3) : from " << *range.first << " to ";
+    if(range.second == us1.end()) std::cout << "end" << std::endl;
+    else std::cout << *range.second << std::endl;
 
     std::cout << std::endl;
     std::cout << "****************Performance Testing******************* \n";
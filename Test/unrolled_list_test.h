@@ -0,0 +1,203 @@
+#ifndef __UNROLLED_LIST_TEST_H__
+#define __UNROLLED_LIST_TEST_H__
+
+#include <iostream>
+#include <list>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+#include "../MySTL/unrolled_list.h"
+#include "../MySTL/list.h"
+#include "../MySTL/vector.h"
+#include "test.h"
+
+using namespace std::chrono;
+
+namespace unrolled_list_test {
+
+// 随机地在游标处插入和删除，和std::list对照，检查结果是否一致
+template <class UnrolledList>
+bool random_check(int ops) {
+    UnrolledList ul;
+    std::list<int> sl;
+    auto uit = ul.begin();
+    auto sit = sl.begin();
+    for(int i = 0 ; i < ops ; ++i) {
+        int r = rand() % 8;
+        if(r < 4 || sl.empty()) {
+            uit = ul.insert(uit, i);
+            sit = sl.insert(sit, i);
+        }else if(r < 6) {
+            if(sit == sl.end()) { --uit; --sit; }
+            uit = ul.erase(uit);
+            sit = sl.erase(sit);
+        }else if(r == 6) {
+            if(sit != sl.end()) { ++uit; ++sit; }
+        }else {
+            if(sit != sl.begin()) { --uit; --sit; }
+        }
+    }
+    if(ul.size() != sl.size()) return false;
+    auto it = sl.begin();
+    for(auto v : ul) {
+        if(v != *it++) return false;
+    }
+    return true;
+}
+
+void test() {
+    std::cout << "--------------------------unrolled_list test-----------------------" << std::endl;
+    int a[] = { 1,2,3,4,5 };
+    mystl::unrolled_list<int> ul1;
+    mystl::unrolled_list<int> ul2(5);
+    mystl::unrolled_list<int> ul3(5, 1);
+    mystl::unrolled_list<int> ul4(a, a + 5);
+    mystl::unrolled_list<int> ul5(ul4);
+    mystl::unrolled_list<int> ul6(std::move(ul5));
+    mystl::unrolled_list<int> ul7{ 1,2,3,4,5,6,7,8,9 };
+    mystl::unrolled_list<int> ul8;
+    ul8 = ul3;
+    mystl::unrolled_list<int> ul9;
+    ul9 = std::move(ul3);
+
+    FUN_VALUE(ul1.node_capacity());
+    FUN_AFTER(ul1, ul1.insert(ul1.end(), 6));
+    FUN_AFTER(ul1, ul1.insert(ul1.begin(), 2, 7));
+    FUN_AFTER(ul1, ul1.insert(ul1.begin(), a, a + 5));
+    FUN_AFTER(ul1, ul1.push_back(2));
+    FUN_AFTER(ul1, ul1.push_front(1));
+    FUN_VALUE(ul1.size());
+    FUN_AFTER(ul1, ul1.pop_front());
+    FUN_AFTER(ul1, ul1.pop_back());
+    FUN_AFTER(ul1, ul1.erase(ul1.begin()));
+    FUN_AFTER(ul1, ul1.resize(10));
+    FUN_AFTER(ul1, ul1.resize(3));
+    FUN_AFTER(ul1, ul1.erase(ul1.begin(), ul1.end()));
+    FUN_AFTER(ul1, ul1.swap(ul7));
+    FUN_VALUE(ul1.front());
+    FUN_VALUE(ul1.back());
+    FUN_VALUE(*ul1.rbegin());
+    std::cout << std::boolalpha;
+    FUN_VALUE(ul1.empty());
+    FUN_VALUE((ul4 == ul6));
+    FUN_VALUE((ul2 < ul8));
+    std::cout << std::noboolalpha;
+    COUT(ul6);
+    COUT(ul9);
+
+    // 每个结点只放4个元素，频繁地分裂和合并
+    mystl::unrolled_list<int, 4> small;
+    for(int i = 0 ; i < 10 ; ++i) small.push_back(i);
+    auto it = small.begin();
+    mystl::advance(it, 5);
+    FUN_AFTER(small, it = small.insert(it, 100));
+    FUN_AFTER(small, it = small.insert(it, 101));
+    FUN_AFTER(small, small.erase(small.begin(), ++small.begin()));
+    FUN_VALUE(*it);
+    std::cout << std::boolalpha;
+    typedef mystl::unrolled_list<int, 4> small_list;
+    FUN_VALUE(random_check<small_list>(100000));
+    FUN_VALUE(random_check<mystl::unrolled_list<int>>(100000));
+    std::cout << std::noboolalpha;
+
+    std::cout << "<-----Performance Testing---------> \n";
+    const int N = 100000000;  // 1e
+    const int M = 10000000;   // 1000w
+    const int K = 100000;     // 10w
+
+    srand(time(0));
+
+    // push_back
+    {
+        std::list<int> stdList;
+        auto start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) stdList.push_back(i);
+        auto end = high_resolution_clock::now();
+        std::cout << "std::list push_back " << M << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        mystl::unrolled_list<int> ul;
+        start = high_resolution_clock::now();
+        for(int i = 0 ; i < M ; ++i) ul.push_back(i);
+        end = high_resolution_clock::now();
+        std::cout << "mystl::unrolled_list push_back " << M << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        // 遍历
+        long long sum1 = 0, sum2 = 0;
+        start = high_resolution_clock::now();
+        for(auto v : stdList) sum1 += v;
+        end = high_resolution_clock::now();
+        std::cout << "std::list traverse " << M << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        start = high_resolution_clock::now();
+        for(auto v : ul) sum2 += v;
+        end = high_resolution_clock::now();
+        std::cout << "mystl::unrolled_list traverse " << M << " elements use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+        std::cout << "sum equal : " << (sum1 == sum2) << std::endl;
+    }
+
+    // 模拟编辑缓冲区：K个元素，游标随机地小范围移动，在游标处插入或删除，共M次操作
+    {
+        const int steps = 16;
+        mystl::vector<int> moves(M);
+        for(int i = 0 ; i < M ; ++i) moves[i] = rand() % (2 * steps + 1) - steps;
+
+        mystl::list<int> l(K, 0);
+        auto start = high_resolution_clock::now();
+        auto lit = l.begin();
+        mystl::advance(lit, K / 2);
+        for(int i = 0 ; i < M ; ++i) {
+            int d = moves[i];
+            for(; d > 0 && lit != l.end() ; --d) ++lit;
+            for(; d < 0 && lit != l.begin() ; ++d) --lit;
+            if(i & 1) {
+                if(lit == l.end()) --lit;
+                lit = l.erase(lit);
+            }else {
+                lit = l.insert(lit, i);
+            }
+        }
+        auto end = high_resolution_clock::now();
+        std::cout << "mystl::list edit " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        mystl::unrolled_list<int> ul(K, 0);
+        start = high_resolution_clock::now();
+        auto uit = ul.begin();
+        mystl::advance(uit, K / 2);
+        for(int i = 0 ; i < M ; ++i) {
+            int d = moves[i];
+            for(; d > 0 && uit != ul.end() ; --d) ++uit;
+            for(; d < 0 && uit != ul.begin() ; ++d) --uit;
+            if(i & 1) {
+                if(uit == ul.end()) --uit;
+                uit = ul.erase(uit);
+            }else {
+                uit = ul.insert(uit, i);
+            }
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::unrolled_list edit " << M << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+
+        // vector的插入删除是O(n)的，只做K次
+        mystl::vector<int> v(K, 0);
+        start = high_resolution_clock::now();
+        size_t pos = K / 2;
+        for(int i = 0 ; i < K ; ++i) {
+            long long p = static_cast<long long>(pos) + moves[i];
+            pos = p < 0 ? 0 : (p > static_cast<long long>(v.size()) ? v.size() : p);
+            if(i & 1) {
+                if(pos == v.size()) --pos;
+                v.erase(v.begin() + pos);
+            }else {
+                v.insert(v.begin() + pos, i);
+            }
+        }
+        end = high_resolution_clock::now();
+        std::cout << "mystl::vector edit " << K << " times use the time :" << duration_cast<milliseconds>(end - start).count() << " ms" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+}
+
+#endif